@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2014 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <glib.h>
+#include <iostream>
+#include <list>
+#include <string>
+#include <StringUtils.h>
+
+struct BenchmarkItem {
+	std::string m_label;
+	int m_n;
+
+	BenchmarkItem(const std::string &label, const int &n)
+	: m_label(label),
+	  m_n(n)
+	{
+	}
+
+	virtual ~BenchmarkItem() {
+	}
+
+	virtual void setup(void) {
+	}
+	virtual void run(void) {
+	}
+	virtual void teardown(void) {
+	}
+};
+
+class BenchmarkReporter {
+public:
+	BenchmarkReporter()
+	: m_items(),
+	  m_maxLabelLength(0)
+	{
+	}
+
+	void registerItem(BenchmarkItem &item) {
+		m_items.push_back(&item);
+		if (item.m_label.size() > m_maxLabelLength) {
+			m_maxLabelLength = item.m_label.size();
+		}
+	}
+
+	void run() {
+		reportHeader();
+
+		for (std::list<BenchmarkItem *>::iterator it = m_items.begin();
+		     it != m_items.end();
+		     ++it) {
+			BenchmarkItem *item = *it;
+			runItem(item);
+		}
+	}
+private:
+	std::list<BenchmarkItem *> m_items;
+	unsigned int m_maxLabelLength;
+
+	void reportHeader(void) {
+		using mlpl::StringUtils::sprintf;
+		std::cout << sprintf("%*s: ", m_maxLabelLength, "Label");
+		std::cout << "    Total";
+		std::cout << " ";
+		std::cout << "  Average";
+		std::cout << " ";
+		std::cout << "   Median";
+		std::cout << std::endl;
+	}
+
+	void runItem(BenchmarkItem *item) {
+		reportLabel(item->m_label);
+
+		std::list<double> elapsedTimes;
+		GTimer *timer = g_timer_new();
+		for (int i = 0; i < item->m_n; i++) {
+			item->setup();
+			g_timer_start(timer);
+			item->run();
+			g_timer_stop(timer);
+			elapsedTimes.push_back(g_timer_elapsed(timer, NULL));
+			item->teardown();
+		}
+		g_timer_destroy(timer);
+		reportElapsedTimeStatistics(elapsedTimes);
+		std::cout << std::endl;
+	}
+
+	void reportLabel(const std::string &label) {
+		using mlpl::StringUtils::sprintf;
+		std::cout << sprintf("%*s: ", m_maxLabelLength, label.c_str());
+	}
+
+	void reportElapsedTimeStatistics(std::list<double> &elapsedTimes) {
+		reportElapsedTimeTotal(elapsedTimes);
+		std::cout << " ";
+		reportElapsedTimeAverage(elapsedTimes);
+		std::cout << " ";
+		reportElapsedTimeMedian(elapsedTimes);
+	}
+
+	void reportElapsedTimeTotal(std::list<double> &elapsedTimes) {
+		reportElapsedTime(computeTotalElapsedTime(elapsedTimes));
+	}
+
+	double computeTotalElapsedTime(std::list<double> &elapsedTimes) {
+		double total = 0.0;
+
+		for (std::list<double>::iterator it = elapsedTimes.begin();
+		     it != elapsedTimes.end();
+		     ++it) {
+			double &elapsedTime = *it;
+			total += elapsedTime;
+		}
+
+		return total;
+	}
+
+	void reportElapsedTimeAverage(std::list<double> &elapsedTimes) {
+		reportElapsedTime(computeAverageElapsedTime(elapsedTimes));
+	}
+
+	double computeAverageElapsedTime(std::list<double> &elapsedTimes) {
+		double total = computeTotalElapsedTime(elapsedTimes);
+		return total / elapsedTimes.size();
+	}
+
+	void reportElapsedTimeMedian(std::list<double> &elapsedTimes) {
+		reportElapsedTime(computeMedianElapsedTime(elapsedTimes));
+	}
+
+	static bool compareElapsedTime(const double &elapsedTime1,
+				const double &elapsedTime2)
+	{
+		return elapsedTime1 > elapsedTime2;
+	}
+
+	double computeMedianElapsedTime(std::list<double> &elapsedTimes) {
+		elapsedTimes.sort(compareElapsedTime);
+
+		int i = 0;
+		int median = elapsedTimes.size() / 2;
+		for (std::list<double>::iterator it = elapsedTimes.begin();
+		     it != elapsedTimes.end();
+		     ++it, i++) {
+			if (i < median) {
+				continue;
+			}
+			double &elapsedTime = *it;
+			return elapsedTime;
+		}
+
+		return 0.0;
+	}
+
+	void reportElapsedTime(const double &elapsedTime) {
+		using mlpl::StringUtils::sprintf;
+
+		double oneSecond = 1.0;
+		double oneMillisecond = oneSecond / 1000.0;
+		double oneMicrosecond = oneMillisecond / 1000.0;
+
+		if (elapsedTime < oneMicrosecond) {
+			std::cout << sprintf("(%.3fus)",
+					elapsedTime * 1000.0 * 1000.0);
+		} else if (elapsedTime < oneMillisecond) {
+			std::cout << sprintf("(%.3fms)", elapsedTime * 1000.0);
+		} else {
+			std::cout << sprintf("(%.3fs) ", elapsedTime);
+		}
+	}
+};
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2014 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+// Compares the textual SQL path and the prepared statement path of
+// DBAgent::insert() and DBAgent::select().
+//
+// Usage: bench-db-agent-insert [MySQL DB name]
+//   DBAgentMySQL is also measured when the DB name is given.
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <glib.h>
+#include <memory>
+#include <StringUtils.h>
+#include <Params.h>
+#include "DBAgentSQLite3.h"
+#include "DBAgentMySQL.h"
+#include "Benchmark.h"
+
+using namespace std;
+using namespace mlpl;
+
+static const char *BENCH_DB_NAME = "bench-db-agent-insert";
+static const size_t NUM_ROWS = 1000;
+
+static const ColumnDef COLUMN_DEF_BENCH[] = {
+{
+	"id",                              // columnName
+	SQL_COLUMN_TYPE_BIGUINT,           // type
+	20,                                // columnLength
+	0,                                 // decFracLength
+	false,                             // canBeNull
+	SQL_KEY_PRI,                       // keyType
+	SQL_COLUMN_FLAG_AUTO_INC,          // flags
+	NULL,                              // defaultValue
+},{
+	"host_id",                         // columnName
+	SQL_COLUMN_TYPE_INT,               // type
+	11,                                // columnLength
+	0,                                 // decFracLength
+	false,                             // canBeNull
+	SQL_KEY_IDX,                       // keyType
+	0,                                 // flags
+	NULL,                              // defaultValue
+},{
+	"name",                            // columnName
+	SQL_COLUMN_TYPE_VARCHAR,           // type
+	255,                               // columnLength
+	0,                                 // decFracLength
+	false,                             // canBeNull
+	SQL_KEY_NONE,                      // keyType
+	0,                                 // flags
+	NULL,                              // defaultValue
+},{
+	"value",                           // columnName
+	SQL_COLUMN_TYPE_DOUBLE,            // type
+	15,                                // columnLength
+	4,                                 // decFracLength
+	false,                             // canBeNull
+	SQL_KEY_NONE,                      // keyType
+	0,                                 // flags
+	NULL,                              // defaultValue
+},{
+	"time",                            // columnName
+	SQL_COLUMN_TYPE_DATETIME,          // type
+	0,                                 // columnLength
+	0,                                 // decFracLength
+	false,                             // canBeNull
+	SQL_KEY_NONE,                      // keyType
+	0,                                 // flags
+	NULL,                              // defaultValue
+}
+};
+
+static const DBAgent::TableProfile tableProfileBench(
+  "bench_table", COLUMN_DEF_BENCH, ARRAY_SIZE(COLUMN_DEF_BENCH)
+);
+
+struct InsertBenchmarkItem : public BenchmarkItem {
+	DBAgent &m_dbAgent;
+	bool     m_prepared;
+
+	InsertBenchmarkItem(const string &label, int n, DBAgent &dbAgent,
+	                    bool prepared)
+	: BenchmarkItem(label, n),
+	  m_dbAgent(dbAgent),
+	  m_prepared(prepared)
+	{
+	}
+
+	virtual void setup(void) override {
+		m_dbAgent.setPreparedStatementEnabled(m_prepared);
+		m_dbAgent.createTable(tableProfileBench);
+	}
+
+	virtual void run(void) override {
+		m_dbAgent.begin();
+		for (size_t i = 0; i < NUM_ROWS; i++) {
+			DBAgent::InsertArg arg(tableProfileBench);
+			arg.add(AUTO_INCREMENT_VALUE_U64);
+			arg.add(static_cast<int>(i % 100));
+			arg.add(StringUtils::sprintf("It's item #%zd", i));
+			arg.add(i * 1.5);
+			arg.add(CURR_DATETIME);
+			m_dbAgent.insert(arg);
+		}
+		m_dbAgent.commit();
+	}
+
+	virtual void teardown(void) override {
+		m_dbAgent.dropTable(tableProfileBench.name);
+	}
+};
+
+struct SelectBenchmarkItem : public BenchmarkItem {
+	DBAgent &m_dbAgent;
+	bool     m_prepared;
+
+	SelectBenchmarkItem(const string &label, int n, DBAgent &dbAgent,
+	                    bool prepared)
+	: BenchmarkItem(label, n),
+	  m_dbAgent(dbAgent),
+	  m_prepared(prepared)
+	{
+	}
+
+	virtual void setup(void) override {
+		m_dbAgent.setPreparedStatementEnabled(m_prepared);
+		m_dbAgent.createTable(tableProfileBench);
+		m_dbAgent.begin();
+		for (size_t i = 0; i < NUM_ROWS; i++) {
+			DBAgent::InsertArg arg(tableProfileBench);
+			arg.add(AUTO_INCREMENT_VALUE_U64);
+			arg.add(static_cast<int>(i % 100));
+			arg.add(StringUtils::sprintf("item #%zd", i));
+			arg.add(i * 1.5);
+			arg.add(CURR_DATETIME);
+			m_dbAgent.insert(arg);
+		}
+		m_dbAgent.commit();
+	}
+
+	// The same query is repeated like polling by the REST clients.
+	virtual void run(void) override {
+		for (size_t i = 0; i < NUM_ROWS; i++) {
+			DBAgent::SelectExArg arg(tableProfileBench);
+			for (size_t idx = 0; idx < tableProfileBench.numColumns;
+			     idx++) {
+				arg.add(idx);
+			}
+			arg.condition = "host_id=1";
+			m_dbAgent.select(arg);
+		}
+	}
+
+	virtual void teardown(void) override {
+		m_dbAgent.dropTable(tableProfileBench.name);
+	}
+};
+
+static void registerItems(BenchmarkReporter &reporter, const string &name,
+                          DBAgent &dbAgent, int n,
+                          list<unique_ptr<BenchmarkItem>> &items)
+{
+	auto add = [&](BenchmarkItem *item) {
+		items.emplace_back(item);
+		reporter.registerItem(*item);
+	};
+	add(new InsertBenchmarkItem(name + " insert (text)", n, dbAgent,
+	                            false));
+	add(new InsertBenchmarkItem(name + " insert (prepared)", n, dbAgent,
+	                            true));
+	add(new SelectBenchmarkItem(name + " select (text)", n, dbAgent,
+	                            false));
+	add(new SelectBenchmarkItem(name + " select (prepared)", n, dbAgent,
+	                            true));
+}
+
+int
+main(int argc, char **argv)
+{
+	BenchmarkReporter reporter;
+	list<unique_ptr<BenchmarkItem>> items;
+	int n = 10;
+
+	const string dbDir = g_get_tmp_dir();
+	const string dbPath =
+	  StringUtils::sprintf("%s/%s.db", dbDir.c_str(), BENCH_DB_NAME);
+	unlink(dbPath.c_str());
+	DBAgentSQLite3 sqliteAgent(BENCH_DB_NAME, dbDir);
+	registerItems(reporter, "SQLite3", sqliteAgent, n, items);
+
+	unique_ptr<DBAgentMySQL> mysqlAgent;
+	if (argc >= 2) {
+		DBAgentMySQL::init();
+		mysqlAgent.reset(new DBAgentMySQL(argv[1]));
+		if (mysqlAgent->isTableExisting(tableProfileBench.name))
+			mysqlAgent->dropTable(tableProfileBench.name);
+		registerItems(reporter, "MySQL", *mysqlAgent, n, items);
+	}
+
+	reporter.run();
+
+	unlink(dbPath.c_str());
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+// Compares adding items one by one and as a list with
+// DBTablesMonitoring. The latter is used by addItemInfoList().
+//
+// Usage: bench-item-upsert [number of items]
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <glib.h>
+#include <memory>
+#include <StringUtils.h>
+#include "DBAgentSQLite3.h"
+#include "DBTablesMonitoring.h"
+#include "Benchmark.h"
+
+using namespace std;
+using namespace mlpl;
+
+static const char *BENCH_DB_NAME = "bench-item-upsert";
+static const size_t DEFAULT_NUM_ITEMS = 100000;
+
+struct BenchDBTablesMonitoring : public DBTablesMonitoring {
+	using DBTablesMonitoring::addItemInfoWithoutTransaction;
+	using DBTablesMonitoring::addItemInfoListWithoutTransaction;
+};
+
+static void makeItemInfoList(ItemInfoList &itemInfoList,
+                             const ServerIdType &serverId,
+                             const size_t &numItems, const int &generation)
+{
+	ItemInfo itemInfo;
+	itemInfo.serverId = serverId;
+	itemInfo.globalHostId = INVALID_HOST_ID;
+	itemInfo.hostIdInServer = "1";
+	itemInfo.lastValueTime.tv_sec = generation;
+	itemInfo.lastValueTime.tv_nsec = 0;
+	itemInfo.valueType = ITEM_INFO_VALUE_TYPE_FLOAT;
+	itemInfo.unit = "B";
+	for (size_t i = 0; i < numItems; i++) {
+		itemInfo.id = StringUtils::sprintf("%zd", i);
+		itemInfo.brief = StringUtils::sprintf("Item #%zd", i);
+		itemInfo.lastValue = StringUtils::sprintf("%d", generation);
+		// Half of items change one of their categories.
+		itemInfo.categoryNames = {
+		  "Memory",
+		  StringUtils::sprintf("Group %zd-%d", i % 10,
+		                       (i % 2) ? generation : 0)
+		};
+		itemInfoList.push_back(itemInfo);
+	}
+}
+
+struct ItemUpsertBenchmarkItem : public BenchmarkItem {
+	DBAgent      &m_dbAgent;
+	bool          m_asList;
+	bool          m_update;
+	size_t        m_numItems;
+	ServerIdType  m_serverId;
+	ItemInfoList  m_itemInfoList;
+
+	ItemUpsertBenchmarkItem(const string &label, int n, DBAgent &dbAgent,
+	                        bool asList, bool update,
+	                        const size_t &numItems,
+	                        const ServerIdType &firstServerId)
+	: BenchmarkItem(label, n),
+	  m_dbAgent(dbAgent),
+	  m_asList(asList),
+	  m_update(update),
+	  m_numItems(numItems),
+	  m_serverId(firstServerId)
+	{
+	}
+
+	// Every iteration uses a new server ID so that it doesn't depend on
+	// the items added in the previous iterations.
+	virtual void setup(void) override {
+		m_serverId++;
+		m_itemInfoList.clear();
+		if (m_update) {
+			ItemInfoList itemInfoList;
+			makeItemInfoList(itemInfoList, m_serverId, m_numItems,
+			                 1);
+			addItems(itemInfoList, true);
+		}
+		makeItemInfoList(m_itemInfoList, m_serverId, m_numItems, 2);
+	}
+
+	virtual void run(void) override {
+		addItems(m_itemInfoList, m_asList);
+	}
+
+	void addItems(const ItemInfoList &itemInfoList, bool asList) {
+		m_dbAgent.begin();
+		if (asList) {
+			BenchDBTablesMonitoring::
+			  addItemInfoListWithoutTransaction(m_dbAgent,
+			                                    itemInfoList);
+		} else {
+			for (const auto &itemInfo : itemInfoList) {
+				BenchDBTablesMonitoring::
+				  addItemInfoWithoutTransaction(m_dbAgent,
+				                                itemInfo);
+			}
+		}
+		m_dbAgent.commit();
+	}
+};
+
+int
+main(int argc, char **argv)
+{
+	BenchmarkReporter reporter;
+	list<unique_ptr<BenchmarkItem>> items;
+	int n = 3;
+	size_t numItems = DEFAULT_NUM_ITEMS;
+	if (argc >= 2)
+		numItems = atoi(argv[1]);
+
+	const string dbDir = g_get_tmp_dir();
+	const string dbPath =
+	  StringUtils::sprintf("%s/%s.db", dbDir.c_str(), BENCH_DB_NAME);
+	unlink(dbPath.c_str());
+	DBAgentSQLite3 dbAgent(BENCH_DB_NAME, dbDir);
+	// Create the tables
+	DBTablesMonitoring dbMonitoring(dbAgent);
+
+	auto add = [&](BenchmarkItem *item) {
+		items.emplace_back(item);
+		reporter.registerItem(*item);
+	};
+	const string label = StringUtils::sprintf("%zd items", numItems);
+	add(new ItemUpsertBenchmarkItem(label + " insert (one by one)", n,
+	                                dbAgent, false, false, numItems, 0));
+	add(new ItemUpsertBenchmarkItem(label + " insert (list)", n,
+	                                dbAgent, true, false, numItems, 100));
+	add(new ItemUpsertBenchmarkItem(label + " update (one by one)", n,
+	                                dbAgent, false, true, numItems, 200));
+	add(new ItemUpsertBenchmarkItem(label + " update (list)", n,
+	                                dbAgent, true, true, numItems, 300));
+
+	reporter.run();
+
+	unlink(dbPath.c_str());
+	return EXIT_SUCCESS;
+}
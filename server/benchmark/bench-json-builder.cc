@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+// Compares building a large reply with json-glib's JsonBuilder, which
+// creates a node tree before the serialization, and JSONBuilder, which
+// writes the output directly.
+
+#include <stdlib.h>
+#include <json-glib/json-glib.h>
+#include <StringUtils.h>
+#include <JSONBuilder.h>
+#include "Benchmark.h"
+
+using namespace std;
+using namespace mlpl;
+
+// Each row imitates an element of "events" in the reply of /event.
+static const size_t NUM_ROWS = 5000;
+
+struct JSONGLibBuilderBenchmarkItem : public BenchmarkItem {
+	JSONGLibBuilderBenchmarkItem(int n)
+	: BenchmarkItem("json-glib JsonBuilder", n)
+	{
+	}
+
+	virtual void run(void) override {
+		JsonBuilder *builder = json_builder_new();
+		json_builder_begin_object(builder);
+		json_builder_set_member_name(builder, "events");
+		json_builder_begin_array(builder);
+		for (size_t i = 0; i < NUM_ROWS; i++) {
+			json_builder_begin_object(builder);
+			json_builder_set_member_name(builder, "unifiedId");
+			json_builder_add_int_value(builder, i);
+			json_builder_set_member_name(builder, "serverId");
+			json_builder_add_int_value(builder, 1);
+			json_builder_set_member_name(builder, "time");
+			json_builder_add_int_value(builder, 1420070400 + i);
+			json_builder_set_member_name(builder, "type");
+			json_builder_add_int_value(builder, 1);
+			json_builder_set_member_name(builder, "hostId");
+			json_builder_add_string_value(builder, "10105");
+			json_builder_set_member_name(builder, "brief");
+			json_builder_add_string_value(
+			  builder, "Zabbix agent on host is unreachable");
+			json_builder_end_object(builder);
+		}
+		json_builder_end_array(builder);
+		json_builder_end_object(builder);
+
+		JsonGenerator *generator = json_generator_new();
+		JsonNode *root = json_builder_get_root(builder);
+		json_generator_set_root(generator, root);
+		gchar *str = json_generator_to_data(generator, NULL);
+		string json = str;
+		g_free(str);
+		json_node_free(root);
+		g_object_unref(generator);
+		g_object_unref(builder);
+	}
+};
+
+struct StreamingJSONBuilderBenchmarkItem : public BenchmarkItem {
+	StreamingJSONBuilderBenchmarkItem(int n)
+	: BenchmarkItem("JSONBuilder", n)
+	{
+	}
+
+	virtual void run(void) override {
+		JSONBuilder agent;
+		agent.startObject();
+		agent.startArray("events");
+		for (size_t i = 0; i < NUM_ROWS; i++) {
+			agent.startObject();
+			agent.add("unifiedId", i);
+			agent.add("serverId", 1);
+			agent.add("time", 1420070400 + i);
+			agent.add("type", 1);
+			agent.add("hostId", "10105");
+			agent.add("brief",
+			          "Zabbix agent on host is unreachable");
+			agent.endObject();
+		}
+		agent.endArray();
+		agent.endObject();
+		string json;
+		agent.takeGenerated(json);
+	}
+};
+
+int
+main(int argc, char **argv)
+{
+#ifndef GLIB_VERSION_2_36
+	g_type_init();
+#endif // GLIB_VERSION_2_36
+	BenchmarkReporter reporter;
+	int n = 100;
+
+	JSONGLibBuilderBenchmarkItem jsonGLibBuilderBenchmarkItem(n);
+	reporter.registerItem(jsonGLibBuilderBenchmarkItem);
+
+	StreamingJSONBuilderBenchmarkItem streamingJSONBuilderBenchmarkItem(n);
+	reporter.registerItem(streamingJSONBuilderBenchmarkItem);
+
+	reporter.run();
+
+	return EXIT_SUCCESS;
+}
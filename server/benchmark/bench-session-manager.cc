@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+// Measures the throughput of SessionManager::getSession() called from
+// several threads at the same time.
+//
+// Usage: bench-session-manager [number of sessions] [number of calls]
+
+#include <stdlib.h>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <StringUtils.h>
+#include "SessionManager.h"
+#include "Benchmark.h"
+
+using namespace std;
+using namespace mlpl;
+
+static const size_t DEFAULT_NUM_SESSIONS = 10000;
+static const size_t DEFAULT_NUM_CALLS = 1000000;
+
+struct GetSessionBenchmarkItem : public BenchmarkItem {
+	const vector<string> &m_sessionIds;
+	size_t m_numThreads;
+	size_t m_numCalls;
+
+	GetSessionBenchmarkItem(const string &label, int n,
+	                        const vector<string> &sessionIds,
+	                        const size_t &numThreads,
+	                        const size_t &numCalls)
+	: BenchmarkItem(label, n),
+	  m_sessionIds(sessionIds),
+	  m_numThreads(numThreads),
+	  m_numCalls(numCalls)
+	{
+	}
+
+	// The calls are divided equally among the threads. So the total
+	// number of the calls is the same in every item.
+	virtual void run(void) override {
+		vector<thread> threads;
+		const size_t numCallsPerThread = m_numCalls / m_numThreads;
+		for (size_t i = 0; i < m_numThreads; i++) {
+			threads.emplace_back(getSessions, &m_sessionIds, i,
+			                     numCallsPerThread);
+		}
+		for (auto &th : threads)
+			th.join();
+	}
+
+	static void getSessions(const vector<string> *sessionIds,
+	                        const size_t offset, const size_t numCalls) {
+		SessionManager *sessionMgr = SessionManager::getInstance();
+		const size_t numSessions = sessionIds->size();
+		for (size_t i = 0; i < numCalls; i++) {
+			const string &sessionId =
+			  (*sessionIds)[(offset + i * 7) % numSessions];
+			SessionPtr session = sessionMgr->getSession(sessionId);
+			if (!session.hasData())
+				abort();
+		}
+	}
+};
+
+int
+main(int argc, char **argv)
+{
+	BenchmarkReporter reporter;
+	list<unique_ptr<BenchmarkItem>> items;
+	int n = 3;
+	size_t numSessions = DEFAULT_NUM_SESSIONS;
+	size_t numCalls = DEFAULT_NUM_CALLS;
+	if (argc >= 2)
+		numSessions = atoi(argv[1]);
+	if (argc >= 3)
+		numCalls = atoi(argv[2]);
+
+	SessionManager *sessionMgr = SessionManager::getInstance();
+	vector<string> sessionIds;
+	for (size_t i = 0; i < numSessions; i++)
+		sessionIds.push_back(sessionMgr->create(i));
+
+	auto add = [&](BenchmarkItem *item) {
+		items.emplace_back(item);
+		reporter.registerItem(*item);
+	};
+	const size_t threadCounts[] = {1, 2, 4, 8, 16};
+	for (auto numThreads : threadCounts) {
+		const string label = StringUtils::sprintf(
+		  "%zd calls on %zd sessions (%zd threads)",
+		  numCalls, numSessions, numThreads);
+		add(new GetSessionBenchmarkItem(label, n, sessionIds,
+		                                numThreads, numCalls));
+	}
+
+	reporter.run();
+
+	SessionManager::reset();
+	return EXIT_SUCCESS;
+}
@@ -19,6 +19,7 @@
 
 #include "AMQPConnection.h"
 #include <string.h>
+#include <inttypes.h>
 
 using namespace std;
 using namespace mlpl;
@@ -34,6 +35,9 @@ public:
 	amqp_socket_t *m_socket;
 	bool m_socketOpened;
 	amqp_channel_t m_channel;
+	// Incremented on every connection. Delivery tags are only valid on
+	// the connection where the message is delivered.
+	uint64_t m_connectionSerial;
 
 	Impl(const AMQPConnectionInfo &info)
 	: m_connection(NULL),
@@ -42,7 +46,8 @@ public:
 	  m_info(info),
 	  m_socket(NULL),
 	  m_socketOpened(false),
-	  m_channel(0)
+	  m_channel(0),
+	  m_connectionSerial(0)
 	{
 		const char *virtualHost = getVirtualHost();
 		if (string(virtualHost) == "/") {
@@ -489,6 +494,7 @@ bool AMQPConnection::connect(void)
 {
 	m_impl->m_connection = amqp_new_connection();
 	if (initializeConnection()) {
+		m_impl->m_connectionSerial++;
 		return true;
 	} else {
 		m_impl->disposeConnection();
@@ -558,6 +564,23 @@ void AMQPConnection::logErrorResponse(const char *context,
 	return m_impl->logErrorResponse(context, reply);
 }
 
+bool AMQPConnection::setPrefetchCount(const uint16_t &count)
+{
+	const uint32_t prefetchSize = 0; // No limit
+	const amqp_boolean_t global = false;
+	const amqp_basic_qos_ok_t *response =
+	  amqp_basic_qos(getConnection(), getChannel(),
+			 prefetchSize, count, global);
+	if (!response) {
+		const amqp_rpc_reply_t reply =
+			amqp_get_rpc_reply(getConnection());
+		logErrorResponse("set prefetch count", reply);
+		disposeConnection();
+		return false;
+	}
+	return true;
+}
+
 amqp_channel_t AMQPConnection::getChannel(void)
 {
 	return m_impl->getChannel();
@@ -575,11 +598,15 @@ bool AMQPConnection::startConsuming(void)
 	if (!m_impl->declareConsumerQueue())
 		return false;
 
+	const uint16_t prefetchCount = m_impl->m_info.getPrefetchCount();
+	if (prefetchCount > 0 && !setPrefetchCount(prefetchCount))
+		return false;
+
 	const amqp_bytes_t queue =
 		amqp_cstring_bytes(getConsumerQueueName().c_str());
 	const amqp_bytes_t consumer_tag = amqp_empty_bytes;
 	const amqp_boolean_t no_local = false;
-	const amqp_boolean_t no_ack = true;
+	const amqp_boolean_t no_ack = (prefetchCount == 0);
 	const amqp_boolean_t exclusive = false;
 	const amqp_table_t arguments = amqp_empty_table;
 	const amqp_basic_consume_ok_t *response;
@@ -604,6 +631,61 @@ bool AMQPConnection::startConsuming(void)
 }
 
 bool AMQPConnection::consume(AMQPMessage &message)
+{
+	struct timeval timeout = {
+		getTimeout(),
+		0
+	};
+	return consume(message, timeout);
+}
+
+size_t AMQPConnection::consumeBatch(vector<AMQPMessage> &messages,
+				    const size_t &maxMessages,
+				    const size_t &timeoutMSec)
+{
+	size_t numConsumed = 0;
+	struct timeval timeout = {
+		static_cast<time_t>(timeoutMSec / 1000),
+		static_cast<suseconds_t>((timeoutMSec % 1000) * 1000)
+	};
+	while (numConsumed < maxMessages) {
+		AMQPMessage message;
+		if (!consume(message, timeout))
+			break;
+		messages.push_back(message);
+		numConsumed++;
+		// Only take messages that have already arrived.
+		timeout.tv_sec = 0;
+		timeout.tv_usec = 0;
+	}
+	return numConsumed;
+}
+
+bool AMQPConnection::ack(const AMQPMessage &message)
+{
+	if (!isConnected())
+		return false;
+	if (message.connectionSerial != m_impl->m_connectionSerial) {
+		// The broker will deliver it again.
+		MLPL_DBG("Ignore an ack for a previous connection: %" PRIu64
+			 "\n", message.deliveryTag);
+		return false;
+	}
+
+	const amqp_boolean_t multiple = false;
+	const int status = amqp_basic_ack(getConnection(),
+					  getChannel(),
+					  message.deliveryTag,
+					  multiple);
+	if (status != AMQP_STATUS_OK) {
+		m_impl->logErrorResponse("ack a message", status);
+		m_impl->disposeConnection();
+		return false;
+	}
+	return true;
+}
+
+bool AMQPConnection::consume(AMQPMessage &message, struct timeval &timeout)
 {
 	if (!isConnected())
 		return false;
@@ -612,10 +694,6 @@ bool AMQPConnection::consume(AMQPMessage &message)
 
 	amqp_maybe_release_buffers(getConnection());
 
-	struct timeval timeout = {
-		getTimeout(),
-		0
-	};
 	const int flags = 0;
 	amqp_envelope_t envelope;
 	amqp_rpc_reply_t reply = amqp_consume_message(getConnection(),
@@ -633,6 +711,8 @@ bool AMQPConnection::consume(AMQPMessage &message)
 		  static_cast<int>(contentType->len));
 		message.body.assign(static_cast<char*>(body->bytes),
 				    static_cast<int>(body->len));
+		message.deliveryTag = envelope.delivery_tag;
+		message.connectionSerial = m_impl->m_connectionSerial;
 		amqp_destroy_envelope(&envelope);
 		break;
 	}
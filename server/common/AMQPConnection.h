@@ -19,6 +19,7 @@
 #pragma once
 #include "AMQPConnectionInfo.h"
 #include <glib.h>
+#include <vector>
 #include <unistd.h>
 #include <Logger.h>
 #include <StringUtils.h>
@@ -32,6 +33,15 @@ class AMQPConnection;
 struct AMQPMessage {
 	std::string contentType;
 	std::string body;
+	uint64_t deliveryTag;
+	// Identifies the connection where the message was delivered.
+	uint64_t connectionSerial;
+
+	AMQPMessage(void)
+	: deliveryTag(0),
+	  connectionSerial(0)
+	{
+	}
 };
 
 struct AMQPJSONMessage : public AMQPMessage {
@@ -55,6 +65,36 @@ public:
 	bool isConnected(void);
 	bool startConsuming(void);
 	bool consume(AMQPMessage &message);
+
+	/**
+	 * Consume messages at once.
+	 *
+	 * It waits for the first message up to the given timeout. Then the
+	 * messages that have already arrived are taken without waiting.
+	 *
+	 * @param messages Consumed messages are appended to this vector.
+	 * @param maxMessages The maximum number of messages to consume.
+	 * @param timeoutMSec A timeout for the first message in millisecond.
+	 *
+	 * @return The number of consumed messages.
+	 */
+	size_t consumeBatch(std::vector<AMQPMessage> &messages,
+			    const size_t &maxMessages,
+			    const size_t &timeoutMSec);
+
+	/**
+	 * Acknowledge a consumed message.
+	 *
+	 * This is needed only when a prefetch count is set to the
+	 * AMQPConnectionInfo. It has to be called in the thread that
+	 * consumes messages. An ack for a message delivered before a
+	 * reconnection is ignored because the broker delivers it again.
+	 *
+	 * @param message A message returned by consume() or consumeBatch().
+	 * @return true on success. Otherwise false.
+	 */
+	bool ack(const AMQPMessage &message);
+
 	bool publish(const AMQPMessage &message);
 	bool purgeAllQueues(void);
 	bool deleteAllQueues(void);
@@ -62,6 +102,8 @@ public:
 protected:
 	bool initializeConnection(void);
 	time_t getTimeout(void);
+	bool consume(AMQPMessage &message, struct timeval &timeout);
+	bool setPrefetchCount(const uint16_t &count);
 	bool openSocket(void);
 	bool login(void);
 	bool openChannel(void);
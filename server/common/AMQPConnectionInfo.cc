@@ -27,6 +27,7 @@
 
 static const char  *DEFAULT_URL     = "amqp://localhost";
 static const time_t DEFAULT_TIMEOUT = 1;
+static const uint16_t DEFAULT_PREFETCH_COUNT = 0;
 
 using namespace std;
 using namespace mlpl;
@@ -35,7 +36,8 @@ struct AMQPConnectionInfo::Impl {
 	Impl()
 	: m_URLBuf(NULL),
 	  m_parsedURL(),
-	  m_timeout(DEFAULT_TIMEOUT)
+	  m_timeout(DEFAULT_TIMEOUT),
+	  m_prefetchCount(DEFAULT_PREFETCH_COUNT)
 	{
 		amqp_default_connection_info(&m_parsedURL);
 		setURL(DEFAULT_URL);
@@ -54,6 +56,7 @@ struct AMQPConnectionInfo::Impl {
 		m_consumerQueueName = rhs.m_consumerQueueName;
 		m_publisherQueueName = rhs.m_publisherQueueName;
 		m_timeout = rhs.m_timeout;
+		m_prefetchCount = rhs.m_prefetchCount;
 		m_tlsCertificatePath = rhs.m_tlsCertificatePath;
 		m_tlsKeyPath = rhs.m_tlsKeyPath;
 		m_tlsCACertificatePath = rhs.m_tlsCACertificatePath;
@@ -69,6 +72,7 @@ struct AMQPConnectionInfo::Impl {
 		m_consumerQueueName = rhs.m_consumerQueueName;
 		m_publisherQueueName = rhs.m_publisherQueueName;
 		m_timeout = rhs.m_timeout;
+		m_prefetchCount = rhs.m_prefetchCount;
 		m_tlsCertificatePath = rhs.m_tlsCertificatePath;
 		m_tlsKeyPath = rhs.m_tlsKeyPath;
 		m_tlsCACertificatePath = rhs.m_tlsCACertificatePath;
@@ -98,6 +102,7 @@ struct AMQPConnectionInfo::Impl {
 	string m_consumerQueueName;
 	string m_publisherQueueName;
 	time_t m_timeout;
+	uint16_t m_prefetchCount;
 	string m_tlsCertificatePath;
 	string m_tlsKeyPath;
 	string m_tlsCACertificatePath;
@@ -206,6 +211,16 @@ void AMQPConnectionInfo::setTimeout(const time_t &timeout)
 	m_impl->m_timeout = timeout;
 }
 
+uint16_t AMQPConnectionInfo::getPrefetchCount(void) const
+{
+	return m_impl->m_prefetchCount;
+}
+
+void AMQPConnectionInfo::setPrefetchCount(const uint16_t &count)
+{
+	m_impl->m_prefetchCount = count;
+}
+
 const string &AMQPConnectionInfo::getTLSCertificatePath(void) const
 {
 	return m_impl->m_tlsCertificatePath;
@@ -20,6 +20,7 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <stdint.h>
 #include "Params.h"
 
 class AMQPConnectionInfo {
@@ -47,6 +48,27 @@ public:
 	time_t getTimeout(void) const;
 	void setTimeout(const time_t &timeout);
 
+	/**
+	 * Get the maximum number of unacknowledged messages.
+	 *
+	 * @return
+	 * The prefetch count. 0 means that messages are acknowledged
+	 * automatically when they are delivered.
+	 */
+	uint16_t getPrefetchCount(void) const;
+
+	/**
+	 * Set the maximum number of unacknowledged messages.
+	 *
+	 * If it isn't 0, the broker sends at most the given number of
+	 * messages that are not acknowledged yet and each consumed message
+	 * has to be acknowledged with AMQPConnection::ack(). Messages that
+	 * aren't acknowledged are delivered again after reconnection.
+	 *
+	 * @param count The prefetch count.
+	 */
+	void setPrefetchCount(const uint16_t &count);
+
 	const std::string &getTLSCertificatePath(void) const;
 	void setTLSCertificatePath(const std::string &path);
 
@@ -28,11 +28,16 @@
 #include <StringUtils.h>
 #include <amqp_tcp_socket.h>
 #include <amqp_ssl_socket.h>
+#include <mutex>
 
 using namespace std;
 using namespace mlpl;
 
 const vector<size_t> retryInterval = { 1, 2, 5, 10, 30 };
+static const size_t CONSUME_BATCH_SIZE = 16;
+// Acks are sent between consumes. So wait for messages only for a short
+// time when acks are used not to delay them.
+static const size_t ACK_FLUSH_INTERVAL_MSEC = 100;
 
 struct AMQPConsumer::Impl {
 	Impl()
@@ -51,7 +56,31 @@ struct AMQPConsumer::Impl {
 	AMQPMessageHandler *m_handler;
 	SimpleSemaphore m_waitSem;
 	ConnectionChangeCallback m_connChangeCallback;
+	mutex m_pendingAcksLock;
+	vector<AMQPMessage> m_pendingAcks;
 
+	bool isAckEnabled(void)
+	{
+		return m_connection->getConnectionInfo().getPrefetchCount() > 0;
+	}
+
+	size_t getConsumeTimeoutMSec(void)
+	{
+		if (isAckEnabled())
+			return ACK_FLUSH_INTERVAL_MSEC;
+		return m_connection->getConnectionInfo().getTimeout() * 1000;
+	}
+
+	void flushAcks(void)
+	{
+		vector<AMQPMessage> acks;
+		{
+			lock_guard<mutex> lock(m_pendingAcksLock);
+			acks.swap(m_pendingAcks);
+		}
+		for (auto &message : acks)
+			m_connection->ack(message);
+	}
 };
 
 AMQPConsumer::AMQPConsumer(const AMQPConnectionInfo &connectionInfo,
@@ -86,6 +115,23 @@ void AMQPConsumer::setConnectionChangeCallback(ConnectionChangeCallback cb)
 	m_impl->m_connChangeCallback = cb;
 }
 
+void AMQPConsumer::ack(const AMQPMessage &message)
+{
+	if (!m_impl->isAckEnabled())
+		return;
+	// Don't copy the body. Only the delivery information is needed.
+	AMQPMessage ackMessage;
+	ackMessage.deliveryTag = message.deliveryTag;
+	ackMessage.connectionSerial = message.connectionSerial;
+	lock_guard<mutex> lock(m_impl->m_pendingAcksLock);
+	m_impl->m_pendingAcks.push_back(ackMessage);
+}
+
+void AMQPConsumer::flushAcks(void)
+{
+	m_impl->flushAcks();
+}
+
 gpointer AMQPConsumer::mainThread(HatoholThreadArg *arg)
 {
 	ConnectionStatus status = CONN_INIT;
@@ -126,12 +172,16 @@ gpointer AMQPConsumer::mainThread(HatoholThreadArg *arg)
 		}
 
 		i = 0; // reset wait counter
-		AMQPMessage message;
-		const bool consumed = m_impl->m_connection->consume(message);
-		if (!consumed)
-			continue;
-
-		m_impl->m_handler->handle(*this, message);
+		m_impl->flushAcks();
+		vector<AMQPMessage> messages;
+		m_impl->m_connection->consumeBatch(
+		  messages, CONSUME_BATCH_SIZE,
+		  m_impl->getConsumeTimeoutMSec());
+		for (auto &message : messages) {
+			if (isExitRequested())
+				break;
+			m_impl->m_handler->handle(*this, message);
+		}
 	}
 	return NULL;
 }
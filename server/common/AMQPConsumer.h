@@ -43,6 +43,25 @@ public:
 	std::shared_ptr<AMQPConnection> getConnection(void);
 	void setConnectionChangeCallback(ConnectionChangeCallback cb);
 
+	/**
+	 * Acknowledge a consumed message.
+	 *
+	 * It can be called from any thread. The ack is sent by the thread of
+	 * this consumer before it consumes the next messages. If no prefetch
+	 * count is set to the connection, nothing is done.
+	 *
+	 * @param message A message passed to the AMQPMessageHandler.
+	 */
+	void ack(const AMQPMessage &message);
+
+	/**
+	 * Send the queued acks.
+	 *
+	 * It must be called by the thread of this consumer or after the
+	 * thread exits because the connection isn't thread safe.
+	 */
+	void flushAcks(void);
+
 protected:
 	virtual gpointer mainThread(HatoholThreadArg *arg) override;
 
@@ -23,7 +23,10 @@
 #include "AMQPPublisher.h"
 #include "HatoholArmPluginInterfaceHAPI2.h"
 #include "JSONBuilder.h"
+#include "JSONPullParser.h"
+#include <BoundedQueue.h>
 #include <mutex>
+#include <thread>
 
 using namespace std;
 using namespace mlpl;
@@ -48,6 +51,26 @@ std::list<HAPI2ProcedureDef> defaultValidProcedureList = {
 	{HAP,    NOTIFICATION, HAPI2_UPDATE_MONITORING_SERVER_INFO, MANDATORY},
 };
 
+typedef map<HAPI2ProcedureName, string> StreamingArrayMap;
+
+struct DetachedArray {
+	string member;
+	// The span of the array in the original message
+	size_t begin;
+	size_t end;
+
+	DetachedArray(void)
+	: begin(0),
+	  end(0)
+	{
+	}
+
+	bool isDetached(void) const
+	{
+		return !member.empty();
+	}
+};
+
 struct JSONRPCObject {
 	enum class Type {
 		INVALID,
@@ -56,18 +79,102 @@ struct JSONRPCObject {
 		RESPONSE
 	};
 
+	// These have to be declared before m_parser because they are used
+	// to initialize it.
+	DetachedArray m_detachedArray;
+	string m_skeleton;
+
 	JSONParser m_parser;
 	Type m_type;
 	string m_methodName;
 	string m_id;
 	string m_errorMessage;
 
-	JSONRPCObject(const string &json)
-	: m_parser(json), m_type(Type::INVALID)
+	JSONRPCObject(const string &json,
+		      const StreamingArrayMap &streamingArrayMap =
+		        StreamingArrayMap())
+	: m_parser(detachStreamingArray(json, streamingArrayMap)),
+	  m_type(Type::INVALID)
 	{
 		parse(m_parser);
 	}
 
+	/**
+	 * Replace a streaming array in "params" with an empty array so that
+	 * the rows in it aren't loaded into the JSONParser at once.
+	 *
+	 * @return
+	 * The JSON to be parsed by JSONParser. It's the given json itself
+	 * if the method doesn't have a streaming array.
+	 */
+	const string &detachStreamingArray(
+	  const string &json, const StreamingArrayMap &streamingArrayMap)
+	{
+		if (streamingArrayMap.empty())
+			return json;
+
+		typedef JSONPullParser::TokenType TokenType;
+		JSONPullParser reader(json);
+		if (reader.next() != JSONPullParser::TOKEN_START_OBJECT)
+			return json;
+
+		string method;
+		map<string, pair<size_t, size_t> > arraySpans;
+		while (true) {
+			TokenType type = reader.next();
+			if (type == JSONPullParser::TOKEN_END_OBJECT)
+				break;
+			if (type != JSONPullParser::TOKEN_MEMBER)
+				return json;
+			const string name = reader.getString();
+			type = reader.next();
+			if (name == "method" &&
+			    type == JSONPullParser::TOKEN_STRING) {
+				method = reader.getString();
+				continue;
+			}
+			if (name != "params" ||
+			    type != JSONPullParser::TOKEN_START_OBJECT) {
+				if (!reader.skipChildren())
+					return json;
+				continue;
+			}
+			while (true) {
+				type = reader.next();
+				if (type == JSONPullParser::TOKEN_END_OBJECT)
+					break;
+				if (type != JSONPullParser::TOKEN_MEMBER)
+					return json;
+				const string member = reader.getString();
+				type = reader.next();
+				const size_t begin = reader.getTokenOffset();
+				if (!reader.skipChildren())
+					return json;
+				if (type == JSONPullParser::TOKEN_START_ARRAY) {
+					arraySpans[member] =
+					  make_pair(begin, reader.getOffset());
+				}
+			}
+		}
+
+		auto it = streamingArrayMap.find(method);
+		if (it == streamingArrayMap.end())
+			return json;
+		auto spanIt = arraySpans.find(it->second);
+		if (spanIt == arraySpans.end())
+			return json;
+
+		m_detachedArray.member = it->second;
+		m_detachedArray.begin = spanIt->second.first;
+		m_detachedArray.end = spanIt->second.second;
+		m_skeleton.reserve(json.size() - (m_detachedArray.end -
+						  m_detachedArray.begin) + 2);
+		m_skeleton.append(json, 0, m_detachedArray.begin);
+		m_skeleton += "[]";
+		m_skeleton.append(json, m_detachedArray.end, string::npos);
+		return m_skeleton;
+	}
+
 	void parse(JSONParser &parser)
 	{
 		if (parser.hasError()) {
@@ -205,13 +312,143 @@ struct JSONRPCObject {
 	}
 };
 
+// The number of messages that can wait for each stage of the pipeline.
+// Keep it small because a message may have thousands of rows.
+static const size_t PIPELINE_QUEUE_SIZE = 4;
+static const size_t WAIT_INTERVAL_MSEC = 1000;
+// The number of messages being handled without acks. It has to be larger
+// than the number of messages in the pipeline to keep it busy.
+static const uint16_t PREFETCH_COUNT = 32;
+
+/**
+ * A thread that takes elements from a bounded queue and processes them one
+ * by one in the queued order.
+ */
+template<typename T>
+class PipelineStage : public HatoholThreadBase {
+public:
+	typedef function<void (T &elem, PipelineStage<T> &stage)> Processor;
+
+	PipelineStage(const size_t &capacity, Processor processor)
+	: m_queue(capacity),
+	  m_processor(processor)
+	{
+	}
+
+	virtual ~PipelineStage()
+	{
+		if (isStarted())
+			exitSync();
+	}
+
+	/**
+	 * Queue an element. It blocks while the queue is full so that the
+	 * caller doesn't get ahead of this stage.
+	 *
+	 * @param elem An element to be queued.
+	 * @param caller
+	 * A thread that calls this method. Waiting is canceled when its exit
+	 * is requested.
+	 * @return true if the element is queued. Otherwise false.
+	 */
+	bool push(const T &elem, const HatoholThreadBase &caller)
+	{
+		while (!m_queue.push(elem, WAIT_INTERVAL_MSEC)) {
+			if (isExitRequested() || caller.isExitRequested())
+				return false;
+			MLPL_DBG("Waiting for a free slot of the pipeline.\n");
+		}
+		return true;
+	}
+
+protected:
+	gpointer mainThread(HatoholThreadArg *arg) override
+	{
+		while (!isExitRequested()) {
+			T elem;
+			if (!m_queue.pop(elem, WAIT_INTERVAL_MSEC))
+				continue;
+			m_processor(elem, *this);
+		}
+		if (m_queue.size() > 0) {
+			MLPL_INFO("Discarded %zd queued message(s).\n",
+				  m_queue.size());
+		}
+		return NULL;
+	}
+
+private:
+	BoundedQueue<T> m_queue;
+	Processor       m_processor;
+};
+
+/**
+ * Received messages are processed by a pipeline of three threads:
+ *
+ *   AMQPConsumer -> parser -> dispatcher
+ *
+ * The consumer thread only receives messages. The parser thread parses
+ * them and the dispatcher thread calls the procedure handlers, which write
+ * the data to the DB, and sends the responses. So receiving and parsing
+ * the next message don't wait for the DB.
+ *
+ * Each stage has a bounded queue. When the dispatcher is behind, the
+ * consumer stops receiving and the broker holds the rest of the messages.
+ * The messages are still handled one by one in the received order.
+ */
 class HatoholArmPluginInterfaceHAPI2::AMQPHAPI2MessageHandler
   : public AMQPMessageHandler
 {
 public:
 	AMQPHAPI2MessageHandler(HatoholArmPluginInterfaceHAPI2 &hapi2)
-	: m_hapi2(hapi2)
+	: m_hapi2(hapi2),
+	  m_streamingBody(NULL)
+	{
+	}
+
+	virtual ~AMQPHAPI2MessageHandler()
 	{
+		stop();
+	}
+
+	/**
+	 * Start the parser and the dispatcher threads. Messages are handled
+	 * in the caller's thread until this method is called.
+	 *
+	 * @param connectionInfo
+	 * A connection information to send responses. The dispatcher has
+	 * its own connection because an AMQPConnection isn't thread safe.
+	 */
+	void start(const AMQPConnectionInfo &connectionInfo)
+	{
+		if (m_parserStage)
+			return;
+		m_publisher.reset(new AMQPPublisher(connectionInfo));
+		m_dispatcherStage.reset(new ReceivedMessageStage(
+		  PIPELINE_QUEUE_SIZE,
+		  [this](ReceivedMessagePtr &received,
+			 ReceivedMessageStage &stage) {
+			dispatch(*received, *m_publisher, stage);
+		  }));
+		m_parserStage.reset(new ReceivedMessageStage(
+		  PIPELINE_QUEUE_SIZE,
+		  [this](ReceivedMessagePtr &received,
+			 ReceivedMessageStage &stage) {
+			parse(*received);
+			m_dispatcherStage->push(received, stage);
+		  }));
+		m_dispatcherStage->start();
+		m_parserStage->start();
+	}
+
+	/**
+	 * Stop the threads. It must be called after the consumer stops.
+	 */
+	void stop(void)
+	{
+		m_parserStage.reset();
+		m_dispatcherStage.reset();
+		m_publisher.reset();
 	}
 
 	bool handle(AMQPConsumer &consumer, const AMQPMessage &message) override
@@ -220,7 +457,87 @@ public:
 			 message.contentType.c_str(),
 			 message.body.c_str());
 
-		JSONRPCObject object(message.body);
+		ReceivedMessagePtr received = make_shared<ReceivedMessage>();
+		received->message = message;
+		received->consumer = &consumer;
+		if (m_parserStage)
+			return m_parserStage->push(received, consumer);
+
+		AMQPPublisher publisher(consumer.getConnection());
+		parse(*received);
+		dispatch(*received, publisher, consumer);
+		return true;
+	}
+
+	void sendResponse(AMQPPublisher &publisher,
+			  const HatoholThreadBase &caller,
+			  const AMQPJSONMessage &response)
+	{
+		publisher.setMessage(response);
+		bool succeeded = false;
+		do {
+			succeeded = publisher.publish();
+			if (!succeeded)
+				sleep(1);
+		} while (!succeeded && !caller.isExitRequested());
+		publisher.clear();
+	}
+
+	void addStreamingArray(const HAPI2ProcedureName &type,
+			       const string &member)
+	{
+		m_streamingArrayMap[type] = member;
+	}
+
+	/**
+	 * Get the array that was detached from the message being handled.
+	 *
+	 * @return
+	 * true if the member is detached and the caller is the thread that
+	 * handles the message. Otherwise false.
+	 */
+	bool getStreamingArray(const string &member,
+			       const char *&data, size_t &length) const
+	{
+		if (!m_streamingBody)
+			return false;
+		if (m_handlingThread != this_thread::get_id())
+			return false;
+		if (m_detachedArray.member != member)
+			return false;
+		data = m_streamingBody->c_str() + m_detachedArray.begin;
+		length = m_detachedArray.end - m_detachedArray.begin;
+		return true;
+	}
+
+private:
+	struct ReceivedMessage {
+		AMQPMessage message;
+		AMQPConsumer *consumer;
+		unique_ptr<JSONRPCObject> object;
+	};
+	typedef shared_ptr<ReceivedMessage> ReceivedMessagePtr;
+	typedef PipelineStage<ReceivedMessagePtr> ReceivedMessageStage;
+
+	void parse(ReceivedMessage &received)
+	{
+		received.object.reset(
+		  new JSONRPCObject(received.message.body,
+				    m_streamingArrayMap));
+	}
+
+	void dispatch(ReceivedMessage &received, AMQPPublisher &publisher,
+		      const HatoholThreadBase &caller)
+	{
+		// Ack only after the message has been handled. If the handler
+		// throws an exception, e.g. on a DB error, or the server stops
+		// before that, the message isn't acked and the broker delivers
+		// it again.
+		auto ack = [&received] {
+			received.consumer->ack(received.message);
+		};
+		JSONRPCObject &object = *received.object;
+		const string &body = received.message.body;
 		AMQPJSONMessage response;
 
 		if (object.m_parser.hasError()) {
@@ -230,23 +547,32 @@ public:
 						     NULL);
 			MLPL_WARN("Invalid JSON: %s\n",
 				  object.m_errorMessage.c_str());
-			sendResponse(consumer, response);
-			return true;
+			sendResponse(publisher, caller, response);
+			// Delivering it again never succeeds.
+			ack();
+			return;
 		}
 
 		switch(object.m_type) {
 		case JSONRPCObject::Type::PROCEDURE:
+			setStreamingArray(body, object);
 			response.body = m_hapi2.interpretHandler(
 					  object.m_methodName,
 					  object.m_parser);
-			sendResponse(consumer, response);
+			clearStreamingArray();
+			ack();
+			sendResponse(publisher, caller, response);
 			break;
 		case JSONRPCObject::Type::NOTIFICATION:
+			setStreamingArray(body, object);
 			m_hapi2.interpretHandler(object.m_methodName,
 						 object.m_parser);
+			clearStreamingArray();
+			ack();
 			break;
 		case JSONRPCObject::Type::RESPONSE:
 			m_hapi2.handleResponse(object.m_id, object.m_parser);
+			ack();
 			break;
 		case JSONRPCObject::Type::INVALID:
 		default:
@@ -257,29 +583,37 @@ public:
 						     &object.m_parser);
 			MLPL_WARN("Invalid JSON-RPC object: %s\n",
 				  object.m_errorMessage.c_str());
-			sendResponse(consumer, response);
+			sendResponse(publisher, caller, response);
+			// Delivering it again never succeeds.
+			ack();
 			break;
 		}
+	}
 
-		return true;
+	void setStreamingArray(const string &body,
+			       const JSONRPCObject &object)
+	{
+		if (!object.m_detachedArray.isDetached())
+			return;
+		m_streamingBody = &body;
+		m_detachedArray = object.m_detachedArray;
+		m_handlingThread = this_thread::get_id();
 	}
 
-	void sendResponse(AMQPConsumer &consumer,
-			  const AMQPJSONMessage &response)
+	void clearStreamingArray(void)
 	{
-		shared_ptr<AMQPConnection> connection = consumer.getConnection();
-		AMQPPublisher publisher(connection);
-		publisher.setMessage(response);
-		bool succeeded = false;
-		do {
-			succeeded = publisher.publish();
-			if (!succeeded)
-				sleep(1);
-		} while (!succeeded && !consumer.isExitRequested());
+		m_streamingBody = NULL;
+		m_detachedArray = DetachedArray();
 	}
 
-private:
 	HatoholArmPluginInterfaceHAPI2 &m_hapi2;
+	unique_ptr<AMQPPublisher> m_publisher;
+	unique_ptr<ReceivedMessageStage> m_parserStage;
+	unique_ptr<ReceivedMessageStage> m_dispatcherStage;
+	StreamingArrayMap m_streamingArrayMap;
+	const string *m_streamingBody;
+	DetachedArray m_detachedArray;
+	thread::id m_handlingThread;
 };
 
 struct HatoholArmPluginInterfaceHAPI2::Impl
@@ -356,6 +690,8 @@ struct HatoholArmPluginInterfaceHAPI2::Impl
 		info.setTLSKeyPath(m_pluginInfo.tlsKeyPath);
 		info.setTLSCACertificatePath(m_pluginInfo.tlsCACertificatePath);
 		info.setTLSVerifyEnabled(m_pluginInfo.isTLSVerifyEnabled());
+		if (m_communicationMode == MODE_SERVER)
+			info.setPrefetchCount(PREFETCH_COUNT);
 	}
 
 	void setupAMQPConnection(void)
@@ -388,6 +724,7 @@ struct HatoholArmPluginInterfaceHAPI2::Impl
 			onConnectFailure();
 			return;
 		}
+		m_handler.start(m_connectionInfo);
 		m_consumer->start();
 	}
 
@@ -449,8 +786,13 @@ struct HatoholArmPluginInterfaceHAPI2::Impl
 
 	void stop(void)
 	{
-		if (m_consumer) {
+		if (m_consumer)
 			m_consumer->exitSync();
+		// The pipeline refers to the consumer to send acks.
+		m_handler.stop();
+		if (m_consumer) {
+			// Send the acks queued after the consumer thread exited.
+			m_consumer->flushAcks();
 			delete m_consumer;
 			m_consumer = nullptr;
 		}
@@ -516,6 +858,59 @@ string HatoholArmPluginInterfaceHAPI2::interpretHandler(
 	return (this->*handler)(parser);
 }
 
+void HatoholArmPluginInterfaceHAPI2::registerStreamingArray(
+  const HAPI2ProcedureName &type, const string &member)
+{
+	m_impl->m_handler.addStreamingArray(type, member);
+}
+
+bool HatoholArmPluginInterfaceHAPI2::forEachElement(
+  JSONParser &parser, const string &member,
+  const function<bool (JSONParser &)> &func)
+{
+	const char *data = NULL;
+	size_t length = 0;
+	if (m_impl->m_handler.getStreamingArray(member, data, length)) {
+		JSONPullParser reader(data, length);
+		if (reader.next() != JSONPullParser::TOKEN_START_ARRAY)
+			return false;
+		while (true) {
+			const JSONPullParser::TokenType type = reader.next();
+			if (type == JSONPullParser::TOKEN_END_ARRAY)
+				return true;
+			if (type == JSONPullParser::TOKEN_ERROR)
+				return false;
+			const size_t begin = reader.getTokenOffset();
+			if (!reader.skipChildren())
+				return false;
+			JSONParser element(
+			  string(data + begin, reader.getOffset() - begin));
+			if (element.hasError())
+				return false;
+			if (!func(element))
+				return false;
+		}
+	}
+
+	if (!parser.startObject(member))
+		return false;
+	const size_t num = parser.countElements();
+	for (size_t i = 0; i < num; i++) {
+		if (!parser.startElement(i)) {
+			parser.endObject();
+			return false;
+		}
+		const bool succeeded = func(parser);
+		parser.endElement();
+		if (!succeeded) {
+			parser.endObject();
+			return false;
+		}
+	}
+	parser.endObject();
+	return true;
+}
+
 void HatoholArmPluginInterfaceHAPI2::handleResponse(
   const string id, JSONParser &parser)
 {
@@ -20,6 +20,7 @@
 #pragma once
 #include <string>
 #include <random>
+#include <functional>
 #include "HatoholThreadBase.h"
 #include "HatoholException.h"
 #include "JSONParser.h"
@@ -162,6 +163,43 @@ public:
 				      ProcedureHandler handler);
 	std::string interpretHandler(const HAPI2ProcedureName &type,
 				     JSONParser &parser);
+
+	/**
+	 * Register an array member in "params" of a procedure that is
+	 * parsed row by row.
+	 *
+	 * When a message of the procedure is received, the array isn't
+	 * loaded into the JSONParser given to the handler. It is replaced
+	 * with an empty array and the handler has to read it with
+	 * forEachElement().
+	 *
+	 * @param type HAPI2ProcedureName
+	 * @param member A name of the array member in "params".
+	 */
+	void registerStreamingArray(const HAPI2ProcedureName &type,
+				    const std::string &member);
+
+	/**
+	 * Call a function for each element of an array member.
+	 *
+	 * If the array has been detached from the parser by
+	 * registerStreamingArray(), each element is parsed into a small
+	 * JSONParser one by one. Otherwise the elements in the parser are
+	 * visited.
+	 *
+	 * @param parser
+	 * A parser whose current position is the object that has the member.
+	 * @param member A name of the array member.
+	 * @param func
+	 * A function called with a parser positioned at each element. The
+	 * iteration stops when it returns false.
+	 *
+	 * @return
+	 * true if all elements are visited. false if an element cannot be
+	 * parsed or func returns false.
+	 */
+	bool forEachElement(JSONParser &parser, const std::string &member,
+			    const std::function<bool (JSONParser &)> &func);
 	void handleResponse(const std::string id, JSONParser &parser);
 
 	virtual void start(void);
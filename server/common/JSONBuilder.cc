@@ -17,6 +17,9 @@
  * <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdio>
+#include <cstring>
+#include <inttypes.h>
 #include "JSONBuilder.h"
 using namespace std;
 
@@ -25,36 +28,34 @@ using namespace std;
 // ---------------------------------------------------------------------------
 JSONBuilder::JSONBuilder(void)
 {
-	m_builder = json_builder_new();
 }
 
 JSONBuilder::~JSONBuilder()
 {
-	if (m_builder)
-		g_object_unref(m_builder);
 }
 
 string JSONBuilder::generate(void)
 {
-	JsonGenerator *generator = json_generator_new();
-	JsonNode *root = json_builder_get_root(m_builder);
-	json_generator_set_root(generator, root);
-
-	gchar *str = json_generator_to_data(generator, NULL);
-	string json_str = str;
+	return m_buffer;
+}
 
-	g_free(str);
-	json_node_free(root);
-	g_object_unref(generator);
+void JSONBuilder::takeGenerated(string &dest)
+{
+	dest.clear();
+	dest.swap(m_buffer);
+	m_isFirstStack.clear();
+}
 
-	return json_str;
+void JSONBuilder::reserve(const size_t &size)
+{
+	m_buffer.reserve(size);
 }
 
 void JSONBuilder::startObject(const char *member)
 {
-	if (member)
-		json_builder_set_member_name(m_builder, member);
-	json_builder_begin_object(m_builder);
+	startValue(member);
+	m_buffer += '{';
+	m_isFirstStack.push_back(true);
 }
 
 void JSONBuilder::startObject(const string &member)
@@ -64,56 +65,133 @@ void JSONBuilder::startObject(const string &member)
 
 void JSONBuilder::endObject(void)
 {
-	json_builder_end_object(m_builder);
+	m_buffer += '}';
+	m_isFirstStack.pop_back();
 }
 
 void JSONBuilder::startArray(const string &member)
 {
-	json_builder_set_member_name(m_builder, member.c_str());
-	json_builder_begin_array(m_builder);
+	startValue(member.c_str());
+	m_buffer += '[';
+	m_isFirstStack.push_back(true);
 }
 
 void JSONBuilder::endArray(void)
 {
-	json_builder_end_array(m_builder);
+	m_buffer += ']';
+	m_isFirstStack.pop_back();
 }
 
 void JSONBuilder::addNull(const string &member)
 {
-	json_builder_set_member_name(m_builder, member.c_str());
-	json_builder_add_null_value(m_builder);
+	startValue(member.c_str());
+	m_buffer += "null";
 }
 
 void JSONBuilder::add(const string &member, const string &value)
 {
-	json_builder_set_member_name(m_builder, member.c_str());
-	json_builder_add_string_value(m_builder, value.c_str());
+	startValue(member.c_str());
+	appendString(value.c_str(), value.size());
 }
 
 void JSONBuilder::add(const string &member, gint64 value)
 {
-	json_builder_set_member_name(m_builder, member.c_str());
-	json_builder_add_int_value(m_builder, value);
+	startValue(member.c_str());
+	char buf[32];
+	const int len = snprintf(buf, sizeof(buf), "%" PRId64, value);
+	m_buffer.append(buf, len);
 }
 
 void JSONBuilder::add(const gint64 value)
 {
-	json_builder_add_int_value(m_builder, value);
+	startValue(NULL);
+	char buf[32];
+	const int len = snprintf(buf, sizeof(buf), "%" PRId64, value);
+	m_buffer.append(buf, len);
 }
 
 void JSONBuilder::add(const string &value)
 {
-	json_builder_add_string_value(m_builder, value.c_str());
+	startValue(NULL);
+	appendString(value.c_str(), value.size());
 }
 
 void JSONBuilder::addTrue(const string &member)
 {
-	json_builder_set_member_name(m_builder, member.c_str());
-	json_builder_add_boolean_value(m_builder, TRUE);
+	startValue(member.c_str());
+	m_buffer += "true";
 }
 
 void JSONBuilder::addFalse(const string &member)
 {
-	json_builder_set_member_name(m_builder, member.c_str());
-	json_builder_add_boolean_value(m_builder, FALSE);
+	startValue(member.c_str());
+	m_buffer += "false";
+}
+
+// ---------------------------------------------------------------------------
+// Private methods
+// ---------------------------------------------------------------------------
+void JSONBuilder::startValue(const char *member)
+{
+	if (!m_isFirstStack.empty()) {
+		if (m_isFirstStack.back())
+			m_isFirstStack.back() = false;
+		else
+			m_buffer += ',';
+	}
+	if (member) {
+		appendString(member, strlen(member));
+		m_buffer += ':';
+	}
+}
+
+void JSONBuilder::appendString(const char *str, const size_t &length)
+{
+	static const char HEX[] = "0123456789abcdef";
+	m_buffer += '"';
+	// Copy runs of characters that don't need the escape at once.
+	size_t runStart = 0;
+	for (size_t i = 0; i < length; i++) {
+		const unsigned char c = str[i];
+		const char *escaped = NULL;
+		switch (c) {
+		case '"':
+			escaped = "\\\"";
+			break;
+		case '\\':
+			escaped = "\\\\";
+			break;
+		case '\b':
+			escaped = "\\b";
+			break;
+		case '\f':
+			escaped = "\\f";
+			break;
+		case '\n':
+			escaped = "\\n";
+			break;
+		case '\r':
+			escaped = "\\r";
+			break;
+		case '\t':
+			escaped = "\\t";
+			break;
+		default:
+			if (c >= 0x20)
+				continue;
+			break;
+		}
+		m_buffer.append(str + runStart, i - runStart);
+		runStart = i + 1;
+		if (escaped) {
+			m_buffer += escaped;
+		} else {
+			const char unicodeEscape[] = {
+			  '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xf]
+			};
+			m_buffer.append(unicodeEscape, sizeof(unicodeEscape));
+		}
+	}
+	m_buffer.append(str + runStart, length - runStart);
+	m_buffer += '"';
 }
@@ -19,14 +19,45 @@
 
 #pragma once
 #include <string>
-#include <json-glib/json-glib.h>
+#include <vector>
+#include <glib.h>
 
+/**
+ * A JSON writer that appends each element to a string buffer as soon as
+ * it is added. Unlike a DOM builder, no intermediate tree is created. So
+ * the peak memory is about the size of the output.
+ *
+ * The output is compact (no white spaces) and members are written in the
+ * added order.
+ */
 class JSONBuilder
 {
 public:
 	JSONBuilder(void);
 	~JSONBuilder();
+
+	/**
+	 * Get a copy of the generated JSON string.
+	 *
+	 * @return a JSON string.
+	 */
 	std::string generate(void);
+
+	/**
+	 * Move the generated JSON string out of the builder without a copy.
+	 * The builder is empty after this call.
+	 *
+	 * @param dest The JSON string is stored in this variable.
+	 */
+	void takeGenerated(std::string &dest);
+
+	/**
+	 * Reserve the buffer to reduce reallocations.
+	 *
+	 * @param size An expected size of the output in bytes.
+	 */
+	void reserve(const size_t &size);
+
 	void startObject(const char *member = NULL);
 	void startObject(const std::string &member);
 	void endObject(void);
@@ -41,6 +72,11 @@ public:
 	void addNull(const std::string &member);
 
 private:
-	JsonBuilder *m_builder;
-};
+	void startValue(const char *member);
+	void appendString(const char *str, const size_t &length);
 
+	std::string       m_buffer;
+	// Each element is true if no value has been written in the
+	// container yet.
+	std::vector<bool> m_isFirstStack;
+};
@@ -0,0 +1,400 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include "JSONPullParser.h"
+using namespace std;
+
+// ---------------------------------------------------------------------------
+// Public methods
+// ---------------------------------------------------------------------------
+JSONPullParser::JSONPullParser(const char *data, const size_t &length)
+: m_data(data),
+  m_length(length),
+  m_pos(0),
+  m_tokenOffset(0),
+  m_tokenType(TOKEN_END),
+  m_int64(0),
+  m_double(0),
+  m_needComma(false),
+  m_afterMember(false),
+  m_rootFinished(false)
+{
+}
+
+JSONPullParser::JSONPullParser(const char *data)
+: JSONPullParser(data, strlen(data))
+{
+}
+
+JSONPullParser::JSONPullParser(const string &data)
+: JSONPullParser(data.c_str(), data.size())
+{
+}
+
+JSONPullParser::~JSONPullParser()
+{
+}
+
+JSONPullParser::TokenType JSONPullParser::next(void)
+{
+	if (hasError())
+		return TOKEN_ERROR;
+
+	skipWhiteSpaces();
+	m_tokenOffset = m_pos;
+
+	if (m_containerStack.empty()) {
+		if (!m_rootFinished)
+			return m_tokenType = readValue();
+		if (m_pos != m_length)
+			return setError("Unexpected data after the root value");
+		return m_tokenType = TOKEN_END;
+	}
+
+	if (m_afterMember) {
+		m_afterMember = false;
+		return m_tokenType = readValue();
+	}
+
+	const char closer = (m_containerStack.back() == '{') ? '}' : ']';
+	if (consume(closer)) {
+		m_containerStack.pop_back();
+		finishValue();
+		return m_tokenType = (closer == '}') ?
+		                     TOKEN_END_OBJECT : TOKEN_END_ARRAY;
+	}
+	if (m_needComma) {
+		if (!consume(','))
+			return setError("Expected ',' or a closing bracket");
+		skipWhiteSpaces();
+		m_tokenOffset = m_pos;
+	}
+	if (closer == ']')
+		return m_tokenType = readValue();
+
+	if (!consume('"'))
+		return setError("Expected a member name");
+	if (!readString(m_string))
+		return TOKEN_ERROR;
+	skipWhiteSpaces();
+	if (!consume(':'))
+		return setError("Expected ':'");
+	m_afterMember = true;
+	return m_tokenType = TOKEN_MEMBER;
+}
+
+bool JSONPullParser::skipChildren(void)
+{
+	if (m_tokenType != TOKEN_START_OBJECT &&
+	    m_tokenType != TOKEN_START_ARRAY)
+		return !hasError();
+	const size_t depth = getDepth();
+	while (getDepth() >= depth) {
+		if (next() == TOKEN_ERROR)
+			return false;
+	}
+	return true;
+}
+
+JSONPullParser::TokenType JSONPullParser::getTokenType(void) const
+{
+	return m_tokenType;
+}
+
+const string &JSONPullParser::getString(void) const
+{
+	return m_string;
+}
+
+int64_t JSONPullParser::getInt64(void) const
+{
+	return m_int64;
+}
+
+double JSONPullParser::getDouble(void) const
+{
+	if (m_tokenType == TOKEN_INT64)
+		return m_int64;
+	return m_double;
+}
+
+size_t JSONPullParser::getTokenOffset(void) const
+{
+	return m_tokenOffset;
+}
+
+size_t JSONPullParser::getOffset(void) const
+{
+	return m_pos;
+}
+
+size_t JSONPullParser::getDepth(void) const
+{
+	return m_containerStack.size();
+}
+
+bool JSONPullParser::hasError(void) const
+{
+	return !m_errorMessage.empty();
+}
+
+const string &JSONPullParser::getErrorMessage(void) const
+{
+	return m_errorMessage;
+}
+
+// ---------------------------------------------------------------------------
+// Private methods
+// ---------------------------------------------------------------------------
+JSONPullParser::TokenType JSONPullParser::setError(const char *message)
+{
+	m_errorMessage = message;
+	m_errorMessage += " at offset ";
+	m_errorMessage += to_string(m_pos);
+	return m_tokenType = TOKEN_ERROR;
+}
+
+void JSONPullParser::skipWhiteSpaces(void)
+{
+	while (m_pos < m_length) {
+		const char c = m_data[m_pos];
+		if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+			break;
+		m_pos++;
+	}
+}
+
+bool JSONPullParser::consume(const char &c)
+{
+	if (m_pos >= m_length || m_data[m_pos] != c)
+		return false;
+	m_pos++;
+	return true;
+}
+
+JSONPullParser::TokenType JSONPullParser::readValue(void)
+{
+	if (m_pos >= m_length)
+		return setError("Unexpected end of data");
+
+	switch (m_data[m_pos]) {
+	case '{':
+		m_pos++;
+		m_containerStack.push_back('{');
+		m_needComma = false;
+		return TOKEN_START_OBJECT;
+	case '[':
+		m_pos++;
+		m_containerStack.push_back('[');
+		m_needComma = false;
+		return TOKEN_START_ARRAY;
+	case '"':
+		m_pos++;
+		if (!readString(m_string))
+			return TOKEN_ERROR;
+		finishValue();
+		return TOKEN_STRING;
+	case 't':
+		return readLiteral("true", TOKEN_TRUE);
+	case 'f':
+		return readLiteral("false", TOKEN_FALSE);
+	case 'n':
+		return readLiteral("null", TOKEN_NULL);
+	default:
+		break;
+	}
+	return readNumber();
+}
+
+JSONPullParser::TokenType JSONPullParser::readLiteral(
+  const char *literal, const TokenType &type)
+{
+	const size_t len = strlen(literal);
+	if (m_length - m_pos < len ||
+	    strncmp(m_data + m_pos, literal, len) != 0)
+		return setError("Invalid literal");
+	m_pos += len;
+	finishValue();
+	return type;
+}
+
+JSONPullParser::TokenType JSONPullParser::readNumber(void)
+{
+	const size_t start = m_pos;
+	bool isInteger = true;
+	if (m_pos < m_length && m_data[m_pos] == '-')
+		m_pos++;
+	const size_t digitsStart = m_pos;
+	while (m_pos < m_length) {
+		const char c = m_data[m_pos];
+		if (c >= '0' && c <= '9') {
+			m_pos++;
+		} else if (c == '.' || c == 'e' || c == 'E' ||
+		           c == '+' || c == '-') {
+			isInteger = false;
+			m_pos++;
+		} else {
+			break;
+		}
+	}
+	if (m_pos == digitsStart)
+		return setError("Invalid value");
+
+	// strtoll() and strtod() need a NULL-terminated string.
+	const string number(m_data + start, m_pos - start);
+	char *end = NULL;
+	if (isInteger) {
+		errno = 0;
+		m_int64 = strtoll(number.c_str(), &end, 10);
+		if (errno == 0 && *end == '\0') {
+			finishValue();
+			return TOKEN_INT64;
+		}
+	}
+	m_double = strtod(number.c_str(), &end);
+	if (*end != '\0')
+		return setError("Invalid number");
+	finishValue();
+	return TOKEN_DOUBLE;
+}
+
+bool JSONPullParser::readString(string &dest)
+{
+	dest.clear();
+	size_t runStart = m_pos;
+	while (m_pos < m_length) {
+		const unsigned char c = m_data[m_pos];
+		if (c == '"') {
+			dest.append(m_data + runStart, m_pos - runStart);
+			m_pos++;
+			return true;
+		}
+		if (c < 0x20) {
+			setError("Control character in a string");
+			return false;
+		}
+		if (c != '\\') {
+			m_pos++;
+			continue;
+		}
+
+		dest.append(m_data + runStart, m_pos - runStart);
+		m_pos++;
+		if (m_pos >= m_length)
+			break;
+		const char escaped = m_data[m_pos++];
+		switch (escaped) {
+		case '"':
+		case '\\':
+		case '/':
+			dest += escaped;
+			break;
+		case 'b':
+			dest += '\b';
+			break;
+		case 'f':
+			dest += '\f';
+			break;
+		case 'n':
+			dest += '\n';
+			break;
+		case 'r':
+			dest += '\r';
+			break;
+		case 't':
+			dest += '\t';
+			break;
+		case 'u':
+			if (!readUnicodeEscape(dest))
+				return false;
+			break;
+		default:
+			setError("Invalid escape sequence");
+			return false;
+		}
+		runStart = m_pos;
+	}
+	setError("Unterminated string");
+	return false;
+}
+
+bool JSONPullParser::readUnicodeEscape(string &dest)
+{
+	auto readHex4 = [&](uint32_t &code) {
+		if (m_length - m_pos < 4)
+			return false;
+		code = 0;
+		for (size_t i = 0; i < 4; i++) {
+			const char c = m_data[m_pos++];
+			code <<= 4;
+			if (c >= '0' && c <= '9')
+				code |= c - '0';
+			else if (c >= 'a' && c <= 'f')
+				code |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				code |= c - 'A' + 10;
+			else
+				return false;
+		}
+		return true;
+	};
+
+	uint32_t code;
+	if (!readHex4(code)) {
+		setError("Invalid unicode escape");
+		return false;
+	}
+	if (code >= 0xd800 && code <= 0xdbff) {
+		uint32_t low;
+		if (!consume('\\') || !consume('u') || !readHex4(low) ||
+		    low < 0xdc00 || low > 0xdfff) {
+			setError("Invalid surrogate pair");
+			return false;
+		}
+		code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+	}
+
+	// Encode as UTF-8
+	if (code < 0x80) {
+		dest += static_cast<char>(code);
+	} else if (code < 0x800) {
+		dest += static_cast<char>(0xc0 | (code >> 6));
+		dest += static_cast<char>(0x80 | (code & 0x3f));
+	} else if (code < 0x10000) {
+		dest += static_cast<char>(0xe0 | (code >> 12));
+		dest += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+		dest += static_cast<char>(0x80 | (code & 0x3f));
+	} else {
+		dest += static_cast<char>(0xf0 | (code >> 18));
+		dest += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+		dest += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+		dest += static_cast<char>(0x80 | (code & 0x3f));
+	}
+	return true;
+}
+
+void JSONPullParser::finishValue(void)
+{
+	m_needComma = true;
+	if (m_containerStack.empty())
+		m_rootFinished = true;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * A pull-based JSON tokenizer.
+ *
+ * Unlike JSONParser, it doesn't build any tree. The caller gets tokens one
+ * by one with next(). So the memory usage doesn't depend on the size of
+ * the input except for the input itself.
+ *
+ * The given data has to be alive while the parser is used.
+ */
+class JSONPullParser {
+public:
+	enum TokenType {
+		TOKEN_ERROR,
+		TOKEN_END,
+		TOKEN_START_OBJECT,
+		TOKEN_END_OBJECT,
+		TOKEN_START_ARRAY,
+		TOKEN_END_ARRAY,
+		TOKEN_MEMBER,
+		TOKEN_STRING,
+		TOKEN_INT64,
+		TOKEN_DOUBLE,
+		TOKEN_TRUE,
+		TOKEN_FALSE,
+		TOKEN_NULL,
+	};
+
+	JSONPullParser(const char *data, const size_t &length);
+	JSONPullParser(const char *data);
+	JSONPullParser(const std::string &data);
+	virtual ~JSONPullParser();
+
+	/**
+	 * Read the next token.
+	 *
+	 * @return
+	 * The type of the token. TOKEN_END is returned after the root value
+	 * is read. Once TOKEN_ERROR is returned, it is returned forever.
+	 */
+	TokenType next(void);
+
+	/**
+	 * Skip the rest of the container.
+	 *
+	 * If the current token is TOKEN_START_OBJECT or TOKEN_START_ARRAY,
+	 * tokens are read until the corresponding end token. Otherwise,
+	 * nothing is done.
+	 *
+	 * @return false if an error occurs. Otherwise true.
+	 */
+	bool skipChildren(void);
+
+	TokenType getTokenType(void) const;
+
+	/**
+	 * Get the member name for TOKEN_MEMBER or the value for TOKEN_STRING.
+	 * Escape sequences are already decoded.
+	 */
+	const std::string &getString(void) const;
+
+	int64_t getInt64(void) const;
+
+	/**
+	 * Get the value of TOKEN_DOUBLE or TOKEN_INT64.
+	 */
+	double getDouble(void) const;
+
+	/**
+	 * Get the offset of the first byte of the current token.
+	 */
+	size_t getTokenOffset(void) const;
+
+	/**
+	 * Get the offset of the byte just after the current token.
+	 */
+	size_t getOffset(void) const;
+
+	/**
+	 * Get the number of the containers that enclose the current position.
+	 */
+	size_t getDepth(void) const;
+
+	bool hasError(void) const;
+	const std::string &getErrorMessage(void) const;
+
+private:
+	TokenType setError(const char *message);
+	void skipWhiteSpaces(void);
+	bool consume(const char &c);
+	TokenType readValue(void);
+	TokenType readLiteral(const char *literal, const TokenType &type);
+	TokenType readNumber(void);
+	bool readString(std::string &dest);
+	bool readUnicodeEscape(std::string &dest);
+	void finishValue(void);
+
+	const char        *m_data;
+	size_t             m_length;
+	size_t             m_pos;
+	size_t             m_tokenOffset;
+	TokenType          m_tokenType;
+	std::string        m_string;
+	int64_t            m_int64;
+	double             m_double;
+	std::string        m_errorMessage;
+
+	// '{' or '[' for each container that is not closed yet.
+	std::vector<char>  m_containerStack;
+	// true if a value has already been read in the current container.
+	bool               m_needComma;
+	// true if the last token is TOKEN_MEMBER.
+	bool               m_afterMember;
+	bool               m_rootFinished;
+};
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <thread>
+#include <LockFreeQueue.h>
+#include <SimpleSemaphore.h>
+
+namespace mlpl {
+
+/**
+ * A queue with a fixed capacity whose push() blocks while it is full and
+ * pop() blocks while it is empty.
+ *
+ * It's used to connect stages of a pipeline: a fast producer is slowed
+ * down to the pace of the consumer instead of queueing without limit.
+ * Any number of threads can push and pop at the same time.
+ */
+template<typename T>
+class BoundedQueue {
+public:
+	/**
+	 * A constructor.
+	 *
+	 * @param capacity The maximum number of elements.
+	 */
+	BoundedQueue(const size_t &capacity)
+	: m_capacity(capacity),
+	  m_queue(capacity),
+	  m_freeSlots(capacity),
+	  m_numElements(0)
+	{
+	}
+
+	virtual ~BoundedQueue()
+	{
+	}
+
+	/**
+	 * Push an element. If the queue is full, wait until an element is
+	 * popped.
+	 *
+	 * @param elem An element to be pushed.
+	 * @param timeoutInMSec A timeout in millisecond.
+	 * @return true on success. false if it timed out.
+	 */
+	bool push(const T &elem, const size_t &timeoutInMSec)
+	{
+		if (m_freeSlots.timedWait(timeoutInMSec) !=
+		    SimpleSemaphore::STAT_OK)
+			return false;
+		// A free slot has been reserved, but the cell at the tail may
+		// still be being popped by another consumer. It's released soon.
+		while (!m_queue.tryPush(elem))
+			std::this_thread::yield();
+		m_numElements.post();
+		return true;
+	}
+
+	/**
+	 * Pop an element. If the queue is empty, wait until an element is
+	 * pushed.
+	 *
+	 * @param dest The popped element is stored to this variable.
+	 * @param timeoutInMSec A timeout in millisecond.
+	 * @return true on success. false if it timed out.
+	 */
+	bool pop(T &dest, const size_t &timeoutInMSec)
+	{
+		if (m_numElements.timedWait(timeoutInMSec) !=
+		    SimpleSemaphore::STAT_OK)
+			return false;
+		// An element has been reserved, but the cell at the head may
+		// still be being pushed by another producer. It's published soon.
+		while (!m_queue.tryPop(dest))
+			std::this_thread::yield();
+		m_freeSlots.post();
+		return true;
+	}
+
+	/**
+	 * Return the number of elements in the queue.
+	 *
+	 * The value may be stale when other threads are pushing or popping.
+	 *
+	 * @return the number of elements.
+	 */
+	size_t size(void) const
+	{
+		return m_queue.size();
+	}
+
+	/**
+	 * Return the maximum number of elements.
+	 *
+	 * @return the capacity.
+	 */
+	size_t capacity(void) const
+	{
+		return m_capacity;
+	}
+
+private:
+	const size_t     m_capacity;
+	LockFreeQueue<T> m_queue;
+	SimpleSemaphore  m_freeSlots;
+	SimpleSemaphore  m_numElements;
+};
+
+} // namespace mlpl
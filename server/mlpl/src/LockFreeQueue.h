@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace mlpl {
+
+/**
+ * A bounded multi-producer multi-consumer queue without locks.
+ *
+ * Each cell has a sequence number that tells producers and consumers
+ * whether the cell is ready for them. So a push and a pop only need one
+ * compare-and-swap on the head or the tail in the normal case.
+ *
+ * This class never blocks. Callers that want to sleep until an element
+ * arrives should combine it with a semaphore.
+ */
+template<typename T>
+class LockFreeQueue {
+public:
+	/**
+	 * A constructor.
+	 *
+	 * @param capacity
+	 * The maximum number of elements. It is rounded up to a power of two.
+	 */
+	LockFreeQueue(const size_t &capacity)
+	: m_cells(roundUpToPowerOfTwo(capacity)),
+	  m_mask(m_cells.size() - 1),
+	  m_head(0),
+	  m_tail(0)
+	{
+		for (size_t i = 0; i < m_cells.size(); i++)
+			m_cells[i].sequence = i;
+	}
+
+	virtual ~LockFreeQueue()
+	{
+	}
+
+	/**
+	 * Push an element.
+	 *
+	 * @param elem An element to be pushed.
+	 * @return true on success. false if the queue is full.
+	 */
+	bool tryPush(const T &elem)
+	{
+		size_t pos = m_tail.load(std::memory_order_relaxed);
+		Cell *cell;
+		while (true) {
+			cell = &m_cells[pos & m_mask];
+			const size_t seq =
+			  cell->sequence.load(std::memory_order_acquire);
+			const intptr_t diff =
+			  static_cast<intptr_t>(seq) -
+			  static_cast<intptr_t>(pos);
+			if (diff == 0) {
+				if (m_tail.compare_exchange_weak(
+				      pos, pos + 1, std::memory_order_relaxed))
+					break;
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = m_tail.load(std::memory_order_relaxed);
+			}
+		}
+		cell->data = elem;
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Pop an element.
+	 *
+	 * @param dest The popped element is stored to this variable.
+	 * @return true on success. false if the queue is empty.
+	 */
+	bool tryPop(T &dest)
+	{
+		size_t pos = m_head.load(std::memory_order_relaxed);
+		Cell *cell;
+		while (true) {
+			cell = &m_cells[pos & m_mask];
+			const size_t seq =
+			  cell->sequence.load(std::memory_order_acquire);
+			const intptr_t diff =
+			  static_cast<intptr_t>(seq) -
+			  static_cast<intptr_t>(pos + 1);
+			if (diff == 0) {
+				if (m_head.compare_exchange_weak(
+				      pos, pos + 1, std::memory_order_relaxed))
+					break;
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = m_head.load(std::memory_order_relaxed);
+			}
+		}
+		// Don't keep a copy in the cell. It may hold a large object
+		// (e.g. via a smart pointer) until the cell is reused.
+		dest = std::move(cell->data);
+		cell->sequence.store(pos + m_mask + 1,
+		                     std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Return the number of elements in the queue.
+	 *
+	 * The value may be stale when other threads are pushing or popping.
+	 *
+	 * @return the number of elements.
+	 */
+	size_t size(void) const
+	{
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		const size_t tail = m_tail.load(std::memory_order_relaxed);
+		return (tail > head) ? (tail - head) : 0;
+	}
+
+	/**
+	 * Return the maximum number of elements.
+	 *
+	 * @return the capacity.
+	 */
+	size_t capacity(void) const
+	{
+		return m_cells.size();
+	}
+
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T                   data;
+
+		Cell(void)
+		: sequence(0),
+		  data()
+		{
+		}
+
+		// Only used by std::vector to allocate the cells.
+		Cell(const Cell &cell)
+		: sequence(0),
+		  data()
+		{
+		}
+	};
+
+	static size_t roundUpToPowerOfTwo(const size_t &num)
+	{
+		size_t size = 2;
+		while (size < num)
+			size <<= 1;
+		return size;
+	}
+
+	// The head and the tail are on other cache lines than the cells
+	// so that producers and consumers don't invalidate each other.
+	static const size_t CACHE_LINE_SIZE = 64;
+
+	std::vector<Cell>   m_cells;
+	const size_t        m_mask;
+	char                m_padding0[CACHE_LINE_SIZE];
+	std::atomic<size_t> m_head;
+	char                m_padding1[CACHE_LINE_SIZE];
+	std::atomic<size_t> m_tail;
+	char                m_padding2[CACHE_LINE_SIZE];
+};
+
+} // namespace mlpl
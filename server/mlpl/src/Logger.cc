@@ -23,20 +23,30 @@
 #include <string>
 #include <syslog.h>
 #include <unistd.h>
+#include <inttypes.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 using namespace std;
 #include "Logger.h"
 using namespace mlpl;
 #include <string.h>
 #include "StringUtils.h"
 #include "SmartTime.h"
+#include "LockFreeQueue.h"
 
 static const char* LogHeaders [MLPL_NUM_LOG_LEVEL] = {
 	"BUG", "CRIT", "ERR", "WARN", "INFO", "DBG",
 };
 
-LogLevel Logger::m_currLogLevel = MLPL_LOG_LEVEL_NOT_SET;
+atomic<int> Logger::m_currLogLevel(MLPL_LOG_LEVEL_NOT_SET);
 pthread_rwlock_t Logger::m_rwlock = PTHREAD_RWLOCK_INITIALIZER;
 bool Logger::syslogoutputFlag = true;
 ReadWriteLock Logger::lock;
@@ -47,6 +57,179 @@ bool Logger::extraInfoFlag[256];
 pid_t Logger::pid = 0;
 __thread pid_t Logger::tid =0;
 
+// A record has to be small because each thread has DEFAULT_ASYNC_BUFFER_SIZE
+// records.
+static const size_t ASYNC_RECORD_SIZE = 512;
+static const chrono::milliseconds ASYNC_FLUSH_INTERVAL(100);
+const size_t Logger::DEFAULT_ASYNC_BUFFER_SIZE = 256;
+const size_t Logger::MAX_ASYNC_MESSAGE_LENGTH = ASYNC_RECORD_SIZE - 1;
+
+struct LogRecord {
+	uint64_t sequence;
+	size_t   length;
+	char     text[ASYNC_RECORD_SIZE];
+};
+
+struct ThreadLogBuffer {
+	LockFreeQueue<LogRecord> queue;
+
+	ThreadLogBuffer(const size_t &capacity)
+	: queue(capacity)
+	{
+	}
+};
+
+typedef shared_ptr<ThreadLogBuffer> ThreadLogBufferPtr;
+
+struct Logger::AsyncImpl {
+	static atomic<bool>   enabled;
+	static mutex          controlLock; // for enable and disable
+	static thread        *flusher;
+	static size_t         bufferSize;
+
+	// The following three are protected by 'lock'.
+	static mutex                    lock;
+	static condition_variable       flusherCond;
+	static bool                     quitRequest;
+	static list<ThreadLogBufferPtr> threadBuffers;
+
+	// Only one thread drains the buffers at a time.
+	static mutex                    writeLock;
+	static vector<LogRecord>        records;
+	static uint64_t                 numReportedDropped;
+
+	static atomic<uint64_t> sequence;
+	static atomic<uint64_t> numWritten;
+	static atomic<uint64_t> numDropped;
+	static atomic<uint64_t> numTruncated;
+
+	static thread_local ThreadLogBufferPtr threadBuffer;
+
+	static ThreadLogBuffer &getThreadBuffer(void)
+	{
+		if (!threadBuffer) {
+			threadBuffer =
+			  make_shared<ThreadLogBuffer>(bufferSize);
+			lock_guard<mutex> guard(lock);
+			threadBuffers.push_back(threadBuffer);
+		}
+		return *threadBuffer;
+	}
+
+	static bool vappend(LogRecord &record, const char *fmt, va_list ap)
+	{
+		const size_t room = sizeof(record.text) - record.length;
+		const int len = vsnprintf(&record.text[record.length], room,
+		                          fmt, ap);
+		if (len < 0)
+			return false;
+		if (static_cast<size_t>(len) < room) {
+			record.length += len;
+			return true;
+		}
+		record.length = sizeof(record.text) - 1;
+		return false;
+	}
+
+	__attribute__((__format__ (__printf__, 2, 3)))
+	static bool append(LogRecord &record, const char *fmt, ...)
+	{
+		va_list ap;
+		va_start(ap, fmt);
+		const bool succeeded = vappend(record, fmt, ap);
+		va_end(ap);
+		return succeeded;
+	}
+
+	// The header is made in the same format as createHeader() without
+	// allocating memory.
+	static void push(LogLevel level, const char *fileName, int lineNumber,
+	                 const char *fmt, va_list ap)
+	{
+		LogRecord record;
+		record.sequence = sequence++;
+		record.length = 0;
+		bool succeeded = true;
+		if (extraInfoFlag[static_cast<uint8_t>('C')]) {
+			timespec currTime;
+			clock_gettime(CLOCK_REALTIME, &currTime);
+			succeeded &= append(record, "[%ld.%09ld] ",
+			                    currTime.tv_sec, currTime.tv_nsec);
+		}
+		if (extraInfoFlag[static_cast<uint8_t>('P')])
+			succeeded &= append(record, "P:%d ", pid);
+		if (extraInfoFlag[static_cast<uint8_t>('T')]) {
+			if (tid == 0)
+				tid = syscall(SYS_gettid);
+			succeeded &= append(record, "T:%d ", tid);
+		}
+		succeeded &= append(record, "[%s] <%s:%d> ",
+		                    LogHeaders[level], fileName, lineNumber);
+		succeeded &= vappend(record, fmt, ap);
+		if (!succeeded) {
+			// vsnprintf() can fail before anything is written.
+			if (record.length == 0)
+				record.length = 1;
+			record.text[record.length - 1] = '\n';
+			numTruncated++;
+		}
+
+		if (!getThreadBuffer().queue.tryPush(record))
+			numDropped++;
+		if (level <= MLPL_LOG_ERR)
+			flush();
+	}
+
+	static void write(const LogRecord &record)
+	{
+		fwrite(record.text, 1, record.length, stderr);
+		Logger::lock.readLock();
+		if (syslogoutputFlag) {
+			connectSyslogIfNeeded();
+			Logger::lock.unlock();
+			syslog(LOG_INFO, "%.*s",
+			       static_cast<int>(record.length), record.text);
+		} else {
+			Logger::lock.unlock();
+		}
+	}
+
+	static void run(void)
+	{
+		unique_lock<mutex> guard(lock);
+		while (!quitRequest) {
+			flusherCond.wait_for(guard, ASYNC_FLUSH_INTERVAL);
+			guard.unlock();
+			flush();
+			guard.lock();
+		}
+	}
+
+	// The flusher thread doesn't exist in a child process.
+	static void disableInChild(void)
+	{
+		enabled = false;
+		flusher = NULL;
+	}
+};
+
+atomic<bool>   Logger::AsyncImpl::enabled(false);
+mutex          Logger::AsyncImpl::controlLock;
+thread        *Logger::AsyncImpl::flusher = NULL;
+size_t         Logger::AsyncImpl::bufferSize = DEFAULT_ASYNC_BUFFER_SIZE;
+mutex          Logger::AsyncImpl::lock;
+condition_variable Logger::AsyncImpl::flusherCond;
+bool           Logger::AsyncImpl::quitRequest = false;
+list<ThreadLogBufferPtr> Logger::AsyncImpl::threadBuffers;
+mutex          Logger::AsyncImpl::writeLock;
+vector<LogRecord> Logger::AsyncImpl::records;
+uint64_t       Logger::AsyncImpl::numReportedDropped = 0;
+atomic<uint64_t> Logger::AsyncImpl::sequence(0);
+atomic<uint64_t> Logger::AsyncImpl::numWritten(0);
+atomic<uint64_t> Logger::AsyncImpl::numDropped(0);
+atomic<uint64_t> Logger::AsyncImpl::numTruncated(0);
+thread_local ThreadLogBufferPtr Logger::AsyncImpl::threadBuffer;
+
 class Initializer : public Logger {
 	public:
 		Initializer() {
@@ -62,6 +245,14 @@ Initializer init;
 void Logger::log(LogLevel level, const char *fileName, int lineNumber,
                  const char *fmt, ...)
 {
+	if (AsyncImpl::enabled.load(memory_order_acquire)) {
+		va_list ap;
+		va_start(ap, fmt);
+		AsyncImpl::push(level, fileName, lineNumber, fmt, ap);
+		va_end(ap);
+		return;
+	}
+
 	string extraInfoString = createExtraInfoString();
 	string header = createHeader(level, fileName, lineNumber, extraInfoString);
 
@@ -82,24 +273,6 @@ void Logger::log(LogLevel level, const char *fileName, int lineNumber,
 	}
 }
 
-// ----------------------------------------------------------------------------
-// Protected methods
-// ----------------------------------------------------------------------------
-bool Logger::shouldLog(LogLevel level)
-{
-	bool ret = false;
-	pthread_rwlock_rdlock(&m_rwlock);
-	if (m_currLogLevel == MLPL_LOG_LEVEL_NOT_SET) {
-		pthread_rwlock_unlock(&m_rwlock);
-		setCurrLogLevel();
-		pthread_rwlock_rdlock(&m_rwlock);
-	}
-	if (level <= m_currLogLevel)
-		ret = true;
-	pthread_rwlock_unlock(&m_rwlock);
-	return ret;
-}
-
 void Logger::enableSyslogOutput(void)
 {
 	lock.writeLock();
@@ -114,6 +287,112 @@ void Logger::disableSyslogOutput(void)
 	lock.unlock();
 }
 
+void Logger::enableAsyncOutput(const size_t &bufferSize)
+{
+	lock_guard<mutex> controlGuard(AsyncImpl::controlLock);
+	if (AsyncImpl::enabled)
+		return;
+
+	static once_flag registered;
+	call_once(registered, [] {
+		atexit(disableAsyncOutput);
+		pthread_atfork(NULL, NULL, AsyncImpl::disableInChild);
+	});
+
+	AsyncImpl::bufferSize = bufferSize;
+	AsyncImpl::quitRequest = false;
+	AsyncImpl::flusher = new thread(AsyncImpl::run);
+	AsyncImpl::enabled = true;
+}
+
+void Logger::disableAsyncOutput(void)
+{
+	lock_guard<mutex> controlGuard(AsyncImpl::controlLock);
+	if (!AsyncImpl::enabled)
+		return;
+	AsyncImpl::enabled = false;
+	{
+		lock_guard<mutex> guard(AsyncImpl::lock);
+		AsyncImpl::quitRequest = true;
+	}
+	AsyncImpl::flusherCond.notify_one();
+	AsyncImpl::flusher->join();
+	delete AsyncImpl::flusher;
+	AsyncImpl::flusher = NULL;
+	flush();
+}
+
+bool Logger::isAsyncOutputEnabled(void)
+{
+	return AsyncImpl::enabled;
+}
+
+void Logger::flush(void)
+{
+	lock_guard<mutex> writeGuard(AsyncImpl::writeLock);
+
+	// The buffers of exited threads are removed after they are drained.
+	// They can't receive messages any more.
+	vector<ThreadLogBufferPtr> buffers;
+	vector<ThreadLogBufferPtr> exitedBuffers;
+	{
+		lock_guard<mutex> guard(AsyncImpl::lock);
+		for (auto &buffer : AsyncImpl::threadBuffers) {
+			if (buffer.use_count() == 1)
+				exitedBuffers.push_back(buffer);
+			else
+				buffers.push_back(buffer);
+		}
+	}
+	buffers.insert(buffers.end(),
+	               exitedBuffers.begin(), exitedBuffers.end());
+
+	vector<LogRecord> &records = AsyncImpl::records;
+	LogRecord record;
+	for (auto &buffer : buffers) {
+		while (buffer->queue.tryPop(record))
+			records.push_back(record);
+	}
+
+	// Messages of all threads are written in the order of log() calls.
+	vector<const LogRecord *> sortedRecords;
+	sortedRecords.reserve(records.size());
+	for (const auto &rec : records)
+		sortedRecords.push_back(&rec);
+	sort(sortedRecords.begin(), sortedRecords.end(),
+	     [](const LogRecord *lhs, const LogRecord *rhs) {
+		return lhs->sequence < rhs->sequence;
+	});
+	for (auto rec : sortedRecords)
+		AsyncImpl::write(*rec);
+	AsyncImpl::numWritten += records.size();
+	records.clear();
+
+	const uint64_t numDropped = AsyncImpl::numDropped;
+	if (numDropped > AsyncImpl::numReportedDropped) {
+		fprintf(stderr, "[WARN] <%s:%d> Dropped log messages: %"
+		        PRIu64 "\n", __FILE__, __LINE__,
+		        numDropped - AsyncImpl::numReportedDropped);
+		AsyncImpl::numReportedDropped = numDropped;
+	}
+
+	if (exitedBuffers.empty())
+		return;
+	lock_guard<mutex> guard(AsyncImpl::lock);
+	for (auto &buffer : exitedBuffers)
+		AsyncImpl::threadBuffers.remove(buffer);
+}
+
+void Logger::getAsyncStatistics(AsyncStatistics &stat)
+{
+	stat.numWritten   = AsyncImpl::numWritten;
+	stat.numDropped   = AsyncImpl::numDropped;
+	stat.numTruncated = AsyncImpl::numTruncated;
+}
+
+// ----------------------------------------------------------------------------
+// Protected methods
+// ----------------------------------------------------------------------------
 void Logger::setCurrLogLevel(void)
 {
 	pthread_rwlock_wrlock(&m_rwlock);
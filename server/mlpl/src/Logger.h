@@ -19,6 +19,8 @@
 
 #pragma once
 #include <pthread.h>
+#include <stdint.h>
+#include <atomic>
 #include <string>
 #include "ReadWriteLock.h"
 
@@ -38,15 +40,74 @@ enum LogLevel {
 
 class Logger {
 public:
+	struct AsyncStatistics {
+		uint64_t numWritten;
+		// Messages lost because the buffer of the thread was full.
+		uint64_t numDropped;
+		// Messages cut at MAX_ASYNC_MESSAGE_LENGTH.
+		uint64_t numTruncated;
+	};
+
 	static const char *LEVEL_ENV_VAR_NAME;
 	static const char *MLPL_LOGGER_FLAGS;
+	static const size_t DEFAULT_ASYNC_BUFFER_SIZE;
+	static const size_t MAX_ASYNC_MESSAGE_LENGTH;
+
 	static void log(LogLevel level,
 	                const char *fileName, int lineNumber,
 	                const char *fmt, ...)
 		__attribute__((__format__ (__printf__, 4, 5)));
-	static bool shouldLog(LogLevel level);
+
+	static bool shouldLog(LogLevel level)
+	{
+		// The level is set only once. So an atomic load is enough
+		// after that.
+		int currLevel = m_currLogLevel.load(std::memory_order_acquire);
+		if (currLevel == MLPL_LOG_LEVEL_NOT_SET) {
+			setCurrLogLevel();
+			currLevel = m_currLogLevel.load(
+			              std::memory_order_acquire);
+		}
+		return level <= currLevel;
+	}
+
 	static void enableSyslogOutput(void);
 	static void disableSyslogOutput(void);
+
+	/**
+	 * Write messages in a background thread.
+	 *
+	 * After this call, log() formats a message into the ring buffer of
+	 * the calling thread and returns without I/O. A message is dropped
+	 * if the buffer is full. A message at MLPL_LOG_ERR or more severe
+	 * flushes all buffers before log() returns.
+	 *
+	 * It should be called after fork() such as daemon(), because
+	 * the asynchronous output is disabled in a child process.
+	 *
+	 * @param bufferSize
+	 * The number of messages that the buffer of each thread can hold.
+	 * It is applied to the threads that log for the first time after
+	 * this call.
+	 */
+	static void enableAsyncOutput(
+	  const size_t &bufferSize = DEFAULT_ASYNC_BUFFER_SIZE);
+
+	/**
+	 * Stop the background thread after writing buffered messages.
+	 * It's called automatically at exit.
+	 */
+	static void disableAsyncOutput(void);
+
+	static bool isAsyncOutputEnabled(void);
+
+	/**
+	 * Write buffered messages in the calling thread.
+	 */
+	static void flush(void);
+
+	static void getAsyncStatistics(AsyncStatistics &stat);
+
 protected:
 	static void setCurrLogLevel(void);
 	static void connectSyslogIfNeeded(void);
@@ -59,7 +120,9 @@ protected:
 	static void addCurrentTime(std::string &extraInfoSrting);
 	static void setupProcessId(void);
 private:
-	static LogLevel m_currLogLevel;
+	struct AsyncImpl;
+
+	static std::atomic<int> m_currLogLevel;
 	static pthread_rwlock_t m_rwlock;
 	static bool syslogoutputFlag;
 	static ReadWriteLock lock;
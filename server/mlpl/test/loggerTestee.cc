@@ -34,6 +34,9 @@ int main(int argc, char **argv)
 		return EXIT_FAILURE;
 	}
 	string level = argv[1];
+	// Buffered messages are written at exit.
+	if (argc >= 3 && string(argv[2]) == "async")
+		Logger::enableAsyncOutput();
 	if (level == "DBG")
 		MLPL_DBG("%s\n", testString);
 	else if (level == "INFO")
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <cppcutter.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include "BoundedQueue.h"
+
+using namespace std;
+using namespace mlpl;
+
+namespace testBoundedQueue {
+
+// ----------------------------------------------------------------------------
+// test cases
+// ----------------------------------------------------------------------------
+void test_pushAndPop(void)
+{
+	BoundedQueue<int> q(3);
+	cppcut_assert_equal(true, q.push(1, 0));
+	cppcut_assert_equal(true, q.push(-5, 0));
+	cppcut_assert_equal((size_t)2, q.size());
+
+	int val = 0;
+	cppcut_assert_equal(true, q.pop(val, 0));
+	cppcut_assert_equal(1, val);
+	cppcut_assert_equal(true, q.pop(val, 0));
+	cppcut_assert_equal(-5, val);
+	cppcut_assert_equal((size_t)0, q.size());
+}
+
+void test_capacity(void)
+{
+	BoundedQueue<int> q(5);
+	cppcut_assert_equal((size_t)5, q.capacity());
+}
+
+void test_pushToFull(void)
+{
+	BoundedQueue<int> q(3);
+	for (int i = 0; i < 3; i++)
+		cppcut_assert_equal(true, q.push(i, 0));
+	cppcut_assert_equal(false, q.push(3, 10));
+}
+
+void test_popFromEmpty(void)
+{
+	BoundedQueue<int> q(3);
+	int val = 3;
+	cppcut_assert_equal(false, q.pop(val, 10));
+	cppcut_assert_equal(3, val);
+}
+
+void test_pushWaitsForPop(void)
+{
+	BoundedQueue<int> q(1);
+	cppcut_assert_equal(true, q.push(1, 0));
+
+	atomic<bool> pushed(false);
+	thread producer([&] {
+		pushed = q.push(2, 5000);
+	});
+	int val = -1;
+	cppcut_assert_equal(true, q.pop(val, 0));
+	cppcut_assert_equal(1, val);
+	producer.join();
+
+	cppcut_assert_equal(true, pushed.load());
+	cppcut_assert_equal(true, q.pop(val, 0));
+	cppcut_assert_equal(2, val);
+}
+
+void test_multipleProducersAndConsumers(void)
+{
+	const int numThreads = 4;
+	const int numElementsPerProducer = 10000;
+	BoundedQueue<int> q(8);
+	atomic<int64_t> sum(0);
+	atomic<int> numPopped(0);
+
+	vector<thread> threads;
+	for (int i = 0; i < numThreads; i++) {
+		threads.push_back(thread([&, i] {
+			for (int j = 1; j <= numElementsPerProducer; j++)
+				q.push(i * numElementsPerProducer + j, 5000);
+		}));
+		threads.push_back(thread([&] {
+			for (int j = 0; j < numElementsPerProducer; j++) {
+				int val = 0;
+				if (!q.pop(val, 5000))
+					break;
+				sum += val;
+				numPopped++;
+			}
+		}));
+	}
+	for (auto &t : threads)
+		t.join();
+
+	// Each element is popped exactly once.
+	const int64_t numElements = numThreads * numElementsPerProducer;
+	cppcut_assert_equal((int)numElements, numPopped.load());
+	cppcut_assert_equal(numElements * (numElements + 1) / 2, sum.load());
+	cppcut_assert_equal((size_t)0, q.size());
+}
+
+} // namespace testBoundedQueue
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <cppcutter.h>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include "LockFreeQueue.h"
+
+using namespace std;
+using namespace mlpl;
+
+namespace testLockFreeQueue {
+
+// ----------------------------------------------------------------------------
+// test cases
+// ----------------------------------------------------------------------------
+void test_pushAndPop(void)
+{
+	LockFreeQueue<int> q(8);
+	cppcut_assert_equal(true, q.tryPush(1));
+	cppcut_assert_equal(true, q.tryPush(-5));
+	cppcut_assert_equal(true, q.tryPush(8));
+	cppcut_assert_equal((size_t)3, q.size());
+
+	int val = 0;
+	cppcut_assert_equal(true, q.tryPop(val));
+	cppcut_assert_equal(1, val);
+	cppcut_assert_equal(true, q.tryPop(val));
+	cppcut_assert_equal(-5, val);
+	cppcut_assert_equal(true, q.tryPop(val));
+	cppcut_assert_equal(8, val);
+	cppcut_assert_equal((size_t)0, q.size());
+}
+
+void test_popFromEmpty(void)
+{
+	LockFreeQueue<int> q(4);
+	int val = 3;
+	cppcut_assert_equal(false, q.tryPop(val));
+	cppcut_assert_equal(3, val);
+}
+
+void test_capacity(void)
+{
+	LockFreeQueue<int> q(5);
+	cppcut_assert_equal((size_t)8, q.capacity());
+}
+
+void test_pushToFull(void)
+{
+	LockFreeQueue<int> q(4);
+	for (int i = 0; i < 4; i++)
+		cppcut_assert_equal(true, q.tryPush(i));
+	cppcut_assert_equal(false, q.tryPush(4));
+
+	// The cell can be reused after a pop.
+	int val = -1;
+	cppcut_assert_equal(true, q.tryPop(val));
+	cppcut_assert_equal(0, val);
+	cppcut_assert_equal(true, q.tryPush(4));
+}
+
+void test_wrapAround(void)
+{
+	LockFreeQueue<int> q(2);
+	for (int i = 0; i < 100; i++) {
+		int val = -1;
+		cppcut_assert_equal(true, q.tryPush(i));
+		cppcut_assert_equal(true, q.tryPop(val));
+		cppcut_assert_equal(i, val);
+	}
+}
+
+void test_multipleProducersAndConsumers(void)
+{
+	const size_t numThreads = 4;
+	const size_t numElementsPerThread = 10000;
+	const size_t numElements = numThreads * numElementsPerThread;
+	LockFreeQueue<size_t> q(64);
+	vector<atomic<size_t>> counts(numElements);
+	atomic<size_t> numPopped(0);
+
+	vector<thread> threads;
+	for (size_t i = 0; i < numThreads; i++) {
+		threads.push_back(thread([&, i] {
+			const size_t offset = i * numElementsPerThread;
+			for (size_t j = 0; j < numElementsPerThread; j++) {
+				while (!q.tryPush(offset + j))
+					this_thread::yield();
+			}
+		}));
+		threads.push_back(thread([&] {
+			size_t val;
+			while (numPopped < numElements) {
+				if (!q.tryPop(val)) {
+					this_thread::yield();
+					continue;
+				}
+				counts[val]++;
+				numPopped++;
+			}
+		}));
+	}
+	for (auto &thr : threads)
+		thr.join();
+
+	for (size_t i = 0; i < numElements; i++)
+		cppcut_assert_equal((size_t)1, counts[i].load());
+}
+
+} // namespace testLockFreeQueue
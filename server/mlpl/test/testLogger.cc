@@ -135,7 +135,7 @@ static long stringToLong(string stringInteger)
 }
 
 static void _assertLogOutput(const char *envLevel, const char *outLevel,
-                             bool expectOut)
+                             bool expectOut, bool async = false)
 {
 	cppcut_assert_equal(0, setenv(Logger::LEVEL_ENV_VAR_NAME, envLevel, 1));
 	const gchar *testDir = cut_get_test_directory();
@@ -143,6 +143,8 @@ static void _assertLogOutput(const char *envLevel, const char *outLevel,
 	const gchar *commandPath = cut_build_path(testDir, "loggerTestee",
 						   NULL);
 	string commandLine = commandPath + string(" ") + string(outLevel);
+	if (async)
+		commandLine += " async";
 	g_spawnRet = g_spawn_command_line_sync(commandLine.c_str(),
 	                                       &g_standardOutput,
 	                                       &g_standardError,
@@ -165,7 +167,8 @@ static void _assertLogOutput(const char *envLevel, const char *outLevel,
 	expectStr += "\n";
 	cppcut_assert_equal(expectStr, word);
 }
-#define assertLogOutput(EL,OL,EXP) cut_trace(_assertLogOutput(EL,OL,EXP))
+#define assertLogOutput(EL,OL,EXP,...) \
+  cut_trace(_assertLogOutput(EL,OL,EXP,##__VA_ARGS__))
 
 static void _assertWaitSyslogUpdate(int fd, int timeout, bool &timedOut)
 {
@@ -454,6 +457,39 @@ void test_envLevelBUG(void)
 	assertLogOutput("BUG", "BUG",  true);
 }
 
+void test_asyncOutput(void)
+{
+	const bool async = true;
+	assertLogOutput("INFO", "DBG",  false, async);
+	assertLogOutput("INFO", "INFO", true,  async);
+	assertLogOutput("INFO", "WARN", true,  async);
+	assertLogOutput("INFO", "ERR",  true,  async);
+	assertLogOutput("INFO", "BUG",  true,  async);
+}
+
+void test_asyncStatistics(void)
+{
+	Logger::AsyncStatistics stat0;
+	Logger::getAsyncStatistics(stat0);
+
+	Logger::disableSyslogOutput();
+	Logger::enableAsyncOutput();
+	cppcut_assert_equal(true, Logger::isAsyncOutputEnabled());
+	Logger::log(MLPL_LOG_INFO, "test file", 1, "%s\n", testString);
+	const string longString(Logger::MAX_ASYNC_MESSAGE_LENGTH, 'a');
+	Logger::log(MLPL_LOG_INFO, "test file", 2, "%s\n",
+	            longString.c_str());
+	// Buffered messages are written.
+	Logger::disableAsyncOutput();
+	cppcut_assert_equal(false, Logger::isAsyncOutputEnabled());
+
+	Logger::AsyncStatistics stat1;
+	Logger::getAsyncStatistics(stat1);
+	cppcut_assert_equal(stat0.numWritten + 2, stat1.numWritten);
+	cppcut_assert_equal(stat0.numDropped, stat1.numDropped);
+	cppcut_assert_equal(stat0.numTruncated + 1, stat1.numTruncated);
+}
+
 void test_syslogoutput(void)
 {
 	assertSyslogOutput("Test message", "Test message",  true);
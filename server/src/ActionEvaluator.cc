@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <atomic>
+#include <map>
+#include <vector>
+#include <BoundedQueue.h>
+#include <ReadWriteLock.h>
+#include <Reaper.h>
+#include "ActionEvaluator.h"
+#include "ActionManager.h"
+#include "HatoholThreadBase.h"
+#include "ThreadLocalDBCache.h"
+
+using namespace std;
+using namespace mlpl;
+
+const size_t ActionEvaluator::DEFAULT_NUM_WORKERS = 2;
+const size_t ActionEvaluator::QUEUE_CAPACITY = 64;
+
+static const size_t WAIT_INTERVAL_MSEC = 1000;
+
+typedef shared_ptr<EventInfoList> EventInfoListPtr;
+
+class ActionEvaluator::Worker : public HatoholThreadBase {
+public:
+	Worker(atomic<uint64_t> &numEvaluatedEvents)
+	: m_queue(QUEUE_CAPACITY),
+	  m_numEvaluatedEvents(numEvaluatedEvents)
+	{
+	}
+
+	virtual ~Worker()
+	{
+		if (isStarted())
+			exitSync();
+	}
+
+	/**
+	 * Queue events. It blocks while the queue is full.
+	 *
+	 * @return
+	 * true if the caller had to wait for a free slot. The caller counts
+	 * it in the statistics.
+	 */
+	bool push(const EventInfoListPtr &eventList)
+	{
+		if (m_queue.push(eventList, 0))
+			return false;
+		MLPL_DBG("Waiting for a free slot of action evaluation.\n");
+		while (!m_queue.push(eventList, WAIT_INTERVAL_MSEC))
+			;
+		return true;
+	}
+
+	size_t getQueueDepth(void) const
+	{
+		return m_queue.size();
+	}
+
+protected:
+	gpointer mainThread(HatoholThreadArg *arg) override
+	{
+		// The DB connection is cached for this thread.
+		ThreadLocalDBCache cache;
+		cache.getAction();
+
+		EventInfoListPtr eventList;
+		while (!isExitRequested()) {
+			if (m_queue.pop(eventList, WAIT_INTERVAL_MSEC))
+				evaluate(*eventList);
+		}
+		// The events have already been stored in the DB. So the
+		// remaining ones are evaluated before exiting.
+		while (m_queue.pop(eventList, 0))
+			evaluate(*eventList);
+		return NULL;
+	}
+
+private:
+	void evaluate(const EventInfoList &eventList)
+	{
+		try {
+			ActionManager actionManager;
+			actionManager.checkEvents(eventList);
+		} catch (const exception &e) {
+			MLPL_ERR("Failed to evaluate actions of %zd event(s): "
+			         "%s\n", eventList.size(), e.what());
+		}
+		m_numEvaluatedEvents += eventList.size();
+	}
+
+	BoundedQueue<EventInfoListPtr> m_queue;
+	atomic<uint64_t>              &m_numEvaluatedEvents;
+};
+
+struct ActionEvaluator::Impl {
+	// evaluate() takes the read lock and start()/stop() take the
+	// write lock so that the workers don't go away while pushing.
+	mutable ReadWriteLock rwlock;
+	vector<unique_ptr<Worker>> workers;
+	atomic<uint64_t> numQueuedEvents;
+	atomic<uint64_t> numEvaluatedEvents;
+	atomic<uint64_t> numQueueFullWaits;
+
+	Impl(void)
+	: numQueuedEvents(0),
+	  numEvaluatedEvents(0),
+	  numQueueFullWaits(0)
+	{
+	}
+
+	Worker &getWorker(const ServerIdType &serverId)
+	{
+		// The cast keeps the index valid for a negative server ID.
+		const size_t idx = static_cast<size_t>(serverId) %
+		                   workers.size();
+		return *workers[idx];
+	}
+};
+
+// ---------------------------------------------------------------------------
+// Public methods
+// ---------------------------------------------------------------------------
+ActionEvaluator::ActionEvaluator(void)
+: m_impl(new Impl())
+{
+}
+
+ActionEvaluator::~ActionEvaluator()
+{
+	stop();
+}
+
+void ActionEvaluator::start(const size_t &numWorkers)
+{
+	m_impl->rwlock.writeLock();
+	Reaper<ReadWriteLock> unlocker(&m_impl->rwlock, ReadWriteLock::unlock);
+	if (!m_impl->workers.empty())
+		return;
+	const size_t num = numWorkers ? numWorkers : DEFAULT_NUM_WORKERS;
+	for (size_t i = 0; i < num; i++) {
+		Worker *worker = new Worker(m_impl->numEvaluatedEvents);
+		m_impl->workers.emplace_back(worker);
+		worker->start();
+	}
+	MLPL_INFO("Started %zd action evaluator(s).\n", num);
+}
+
+void ActionEvaluator::stop(void)
+{
+	m_impl->rwlock.writeLock();
+	Reaper<ReadWriteLock> unlocker(&m_impl->rwlock, ReadWriteLock::unlock);
+	for (auto &worker : m_impl->workers)
+		worker->exitSync();
+	m_impl->workers.clear();
+}
+
+bool ActionEvaluator::isStarted(void) const
+{
+	m_impl->rwlock.readLock();
+	Reaper<ReadWriteLock> unlocker(&m_impl->rwlock, ReadWriteLock::unlock);
+	return !m_impl->workers.empty();
+}
+
+void ActionEvaluator::evaluate(const EventInfoList &eventList)
+{
+	if (eventList.empty())
+		return;
+
+	m_impl->rwlock.readLock();
+	Reaper<ReadWriteLock> unlocker(&m_impl->rwlock, ReadWriteLock::unlock);
+	if (m_impl->workers.empty()) {
+		ActionManager actionManager;
+		actionManager.checkEvents(eventList);
+		return;
+	}
+
+	// Split the events for each worker keeping their order.
+	map<Worker *, EventInfoListPtr> eventListMap;
+	for (const auto &eventInfo : eventList) {
+		EventInfoListPtr &list =
+		  eventListMap[&m_impl->getWorker(eventInfo.serverId)];
+		if (!list)
+			list = make_shared<EventInfoList>();
+		list->push_back(eventInfo);
+	}
+	m_impl->numQueuedEvents += eventList.size();
+	for (auto &pair : eventListMap) {
+		if (pair.first->push(pair.second))
+			m_impl->numQueueFullWaits++;
+	}
+}
+
+void ActionEvaluator::getStatistics(Statistics &stat) const
+{
+	m_impl->rwlock.readLock();
+	Reaper<ReadWriteLock> unlocker(&m_impl->rwlock, ReadWriteLock::unlock);
+	stat.numWorkers = m_impl->workers.size();
+	stat.queueDepth = 0;
+	for (const auto &worker : m_impl->workers)
+		stat.queueDepth += worker->getQueueDepth();
+	stat.numQueuedEvents = m_impl->numQueuedEvents;
+	stat.numEvaluatedEvents = m_impl->numEvaluatedEvents;
+	stat.numQueueFullWaits = m_impl->numQueueFullWaits;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#include <memory>
+#include <stdint.h>
+#include "Monitoring.h"
+
+/**
+ * Evaluates actions of added events in worker threads.
+ *
+ * Event lists are passed to a worker selected by the server ID of each
+ * event. So the events of a server are evaluated in the added order by one
+ * worker. Until start() is called, actions are evaluated synchronously in
+ * the caller thread.
+ */
+class ActionEvaluator
+{
+public:
+	static const size_t DEFAULT_NUM_WORKERS;
+	// The maximum number of event lists queued for each worker.
+	static const size_t QUEUE_CAPACITY;
+
+	struct Statistics {
+		size_t   numWorkers;
+		// The number of event lists that wait for evaluation.
+		size_t   queueDepth;
+		uint64_t numQueuedEvents;
+		uint64_t numEvaluatedEvents;
+		// The number of times that a caller waited for a free slot
+		// because the queue of the worker was full.
+		uint64_t numQueueFullWaits;
+	};
+
+	ActionEvaluator(void);
+	virtual ~ActionEvaluator();
+
+	/**
+	 * Start worker threads.
+	 *
+	 * @param numWorkers
+	 * The number of workers. If it is 0, DEFAULT_NUM_WORKERS is used.
+	 */
+	void start(const size_t &numWorkers = 0);
+
+	/**
+	 * Stop worker threads. Queued events are evaluated before the
+	 * workers exit.
+	 */
+	void stop(void);
+
+	bool isStarted(void) const;
+
+	/**
+	 * Evaluate actions of events.
+	 *
+	 * If the workers are running, this method returns as soon as the
+	 * events are queued. It waits only when the queue is full.
+	 *
+	 * @param eventList Events that have been stored in the DB.
+	 */
+	void evaluate(const EventInfoList &eventList);
+
+	void getStatistics(Statistics &stat) const;
+
+private:
+	class Worker;
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
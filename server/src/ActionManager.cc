@@ -532,11 +532,8 @@ void ActionManager::checkEvents(const EventInfoList &eventList)
 			if (shouldSkipByLog(eventInfo, dbAction))
 				continue;
 		}
-		ActionsQueryOption option(USER_ID_SYSTEM);
 		// TODO: sort IncidentSender type actions by priority
-		option.setActionType(ACTION_ALL);
-		option.setTargetEventInfo(&eventInfo);
-		dbAction.getActionList(actionDefList, option);
+		dbAction.getActionListForEvent(actionDefList, eventInfo);
 		ActionDefListIterator actIt = actionDefList.begin();
 		ActionIdType incidentSenderActionId = 0;
 		for (; actIt != actionDefList.end(); ++actIt) {
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "ActionMatcher.h"
+
+using namespace std;
+
+typedef vector<size_t> ActionIndexVect;
+
+struct ActionMatcher::Impl {
+	// Sorted by the action ID
+	vector<ActionDef> actionDefs;
+
+	// Each action is registered to one of the following by the most
+	// selective condition it has.
+	unordered_map<TriggerIdType, ActionIndexVect>   triggerIdMap;
+	unordered_map<LocalHostIdType, ActionIndexVect> hostIdMap;
+	unordered_map<HostgroupIdType, ActionIndexVect> hostgroupIdMap;
+	unordered_map<ServerIdType, ActionIndexVect>    serverIdMap;
+	ActionIndexVect                                 unindexedActions;
+
+	Impl(const ActionDefList &actionDefList)
+	: actionDefs(actionDefList.begin(), actionDefList.end())
+	{
+		sort(actionDefs.begin(), actionDefs.end(),
+		     [](const ActionDef &lhs, const ActionDef &rhs) {
+			return lhs.id < rhs.id;
+		});
+		for (size_t idx = 0; idx < actionDefs.size(); idx++)
+			registerAction(idx);
+	}
+
+	void registerAction(const size_t &idx)
+	{
+		const ActionCondition &cond = actionDefs[idx].condition;
+		if (cond.isEnable(ACTCOND_TRIGGER_ID))
+			triggerIdMap[cond.triggerId].push_back(idx);
+		else if (cond.isEnable(ACTCOND_HOST_ID))
+			hostIdMap[cond.hostIdInServer].push_back(idx);
+		else if (cond.isEnable(ACTCOND_HOST_GROUP_ID))
+			hostgroupIdMap[cond.hostgroupId].push_back(idx);
+		else if (cond.isEnable(ACTCOND_SERVER_ID))
+			serverIdMap[cond.serverId].push_back(idx);
+		else
+			unindexedActions.push_back(idx);
+	}
+
+	template <typename K>
+	static void collect(ActionIndexVect &candidates,
+	                    const unordered_map<K, ActionIndexVect> &map,
+	                    const K &key)
+	{
+		auto it = map.find(key);
+		if (it == map.end())
+			return;
+		candidates.insert(candidates.end(),
+		                  it->second.begin(), it->second.end());
+	}
+
+	static bool matchSeverity(const ActionCondition &cond,
+	                          const EventInfo &eventInfo)
+	{
+		if (!cond.isEnable(ACTCOND_TRIGGER_SEVERITY))
+			return true;
+		switch (cond.triggerSeverityCompType) {
+		case CMP_EQ:
+			return eventInfo.severity == cond.triggerSeverity;
+		case CMP_EQ_GT:
+			return eventInfo.severity >= cond.triggerSeverity;
+		default:
+			return false;
+		}
+	}
+
+	// Conditions except the host group
+	static bool matchBasicConditions(const ActionCondition &cond,
+	                                 const EventInfo &eventInfo)
+	{
+		if (cond.isEnable(ACTCOND_SERVER_ID) &&
+		    cond.serverId != eventInfo.serverId)
+			return false;
+		if (cond.isEnable(ACTCOND_HOST_ID) &&
+		    cond.hostIdInServer != eventInfo.hostIdInServer)
+			return false;
+		if (cond.isEnable(ACTCOND_TRIGGER_ID) &&
+		    cond.triggerId != eventInfo.triggerId)
+			return false;
+		if (cond.isEnable(ACTCOND_TRIGGER_STATUS) &&
+		    cond.triggerStatus != eventInfo.status)
+			return false;
+		return matchSeverity(cond, eventInfo);
+	}
+};
+
+// ---------------------------------------------------------------------------
+// Public methods
+// ---------------------------------------------------------------------------
+ActionMatcher::ActionMatcher(const ActionDefList &actionDefList)
+: m_impl(new Impl(actionDefList))
+{
+}
+
+ActionMatcher::~ActionMatcher()
+{
+}
+
+void ActionMatcher::match(ActionDefList &actionDefList,
+                          const EventInfo &eventInfo,
+                          HostgroupIdSetGetter getHostgroupIdSet) const
+{
+	HostgroupIdSet hostgroupIdSet;
+	bool gotHostgroupIdSet = false;
+	auto getHostgroupIdSetOnce = [&]() -> const HostgroupIdSet & {
+		if (!gotHostgroupIdSet) {
+			getHostgroupIdSet(hostgroupIdSet, eventInfo);
+			gotHostgroupIdSet = true;
+		}
+		return hostgroupIdSet;
+	};
+
+	ActionIndexVect candidates;
+	Impl::collect(candidates, m_impl->triggerIdMap, eventInfo.triggerId);
+	Impl::collect(candidates, m_impl->hostIdMap, eventInfo.hostIdInServer);
+	Impl::collect(candidates, m_impl->serverIdMap, eventInfo.serverId);
+	candidates.insert(candidates.end(),
+	                  m_impl->unindexedActions.begin(),
+	                  m_impl->unindexedActions.end());
+	if (!m_impl->hostgroupIdMap.empty()) {
+		for (auto &hostgroupId : getHostgroupIdSetOnce())
+			Impl::collect(candidates, m_impl->hostgroupIdMap,
+			              hostgroupId);
+	}
+	// Each action is in only one index. So there's no duplication.
+	sort(candidates.begin(), candidates.end());
+
+	for (auto idx : candidates) {
+		const ActionDef &actionDef = m_impl->actionDefs[idx];
+		const ActionCondition &cond = actionDef.condition;
+		if (!Impl::matchBasicConditions(cond, eventInfo))
+			continue;
+		if (cond.isEnable(ACTCOND_HOST_GROUP_ID)) {
+			const HostgroupIdSet &hostgroupIds =
+			  getHostgroupIdSetOnce();
+			if (hostgroupIds.find(cond.hostgroupId) ==
+			    hostgroupIds.end())
+				continue;
+		}
+		actionDefList.push_back(actionDef);
+	}
+}
+
+size_t ActionMatcher::getNumberOfActions(void) const
+{
+	return m_impl->actionDefs.size();
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#include <functional>
+#include <memory>
+#include "DBTablesAction.h"
+
+/**
+ * An in-memory index of action definitions to find actions whose
+ * conditions match an event.
+ *
+ * The result is the same as DBTablesAction::getActionList() with
+ * ActionsQueryOption::setTargetEventInfo() except that the validity of
+ * the owners and the incident trackers is not checked.
+ */
+class ActionMatcher
+{
+public:
+	/**
+	 * A function that gets the host groups of the event's host. It's
+	 * called only when an action with a host group condition is a
+	 * candidate.
+	 */
+	typedef std::function<void (HostgroupIdSet &hostgroupIdSet,
+	                            const EventInfo &eventInfo)>
+	  HostgroupIdSetGetter;
+
+	ActionMatcher(const ActionDefList &actionDefList);
+	virtual ~ActionMatcher();
+
+	/**
+	 * Get actions whose conditions match the event.
+	 *
+	 * @param actionDefList
+	 * Matched actions are added to this list in the order of the action ID.
+	 * @param eventInfo A target event.
+	 * @param getHostgroupIdSet A function to get host groups of the host.
+	 */
+	void match(ActionDefList &actionDefList, const EventInfo &eventInfo,
+	           HostgroupIdSetGetter getHostgroupIdSet) const;
+
+	size_t getNumberOfActions(void) const;
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
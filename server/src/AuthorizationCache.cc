@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <ReadWriteLock.h>
+#include <Reaper.h>
+#include "AuthorizationCache.h"
+#include "ThreadLocalDBCache.h"
+
+using namespace std;
+using namespace mlpl;
+
+struct AuthorizationCache::Entry::Impl {
+	const UserIdType    userId;
+	ServerHostGrpSetMap srvHostGrpSetMap;
+
+	// The following are filled lazily. std::map is used so that
+	// the returned references are kept valid by later insertions.
+	mutex                                   lock;
+	map<OperationPrivilegeFlag, ServerIdSet> serverIdSetMap;
+	map<string, string>                     conditionMap;
+
+	Impl(const UserIdType &_userId)
+	: userId(_userId)
+	{
+	}
+};
+
+typedef unordered_map<UserIdType, AuthorizationCache::EntryPtr> EntryMap;
+
+struct AuthorizationCache::Impl {
+	static ReadWriteLock rwlock;
+	static EntryMap      entryMap;
+	static uint64_t      generation;
+};
+
+ReadWriteLock AuthorizationCache::Impl::rwlock;
+EntryMap      AuthorizationCache::Impl::entryMap;
+uint64_t      AuthorizationCache::Impl::generation = 0;
+
+// ---------------------------------------------------------------------------
+// AuthorizationCache::Entry
+// ---------------------------------------------------------------------------
+AuthorizationCache::Entry::Entry(const UserIdType &userId)
+: m_impl(new Impl(userId))
+{
+	ThreadLocalDBCache cache;
+	cache.getUser().getServerHostGrpSetMap(m_impl->srvHostGrpSetMap,
+	                                       userId);
+}
+
+AuthorizationCache::Entry::~Entry()
+{
+}
+
+const UserIdType &AuthorizationCache::Entry::getUserId(void) const
+{
+	return m_impl->userId;
+}
+
+const ServerHostGrpSetMap &
+AuthorizationCache::Entry::getServerHostGrpSetMap(void) const
+{
+	return m_impl->srvHostGrpSetMap;
+}
+
+const ServerIdSet &AuthorizationCache::Entry::getValidServerIdSet(
+  const OperationPrivilegeFlag &flags, ServerIdSetLoader loader)
+{
+	{
+		lock_guard<mutex> lock(m_impl->lock);
+		auto it = m_impl->serverIdSetMap.find(flags);
+		if (it != m_impl->serverIdSetMap.end())
+			return it->second;
+	}
+
+	// The loader accesses the DB. So it's called without the lock.
+	// If another thread stores the result first, it's used.
+	ServerIdSet serverIdSet;
+	loader(serverIdSet);
+	lock_guard<mutex> lock(m_impl->lock);
+	return m_impl->serverIdSetMap.emplace(flags, serverIdSet).first->second;
+}
+
+const string &AuthorizationCache::Entry::getCondition(
+  const string &key, ConditionMaker maker)
+{
+	{
+		lock_guard<mutex> lock(m_impl->lock);
+		auto it = m_impl->conditionMap.find(key);
+		if (it != m_impl->conditionMap.end())
+			return it->second;
+	}
+
+	const string condition = maker();
+	lock_guard<mutex> lock(m_impl->lock);
+	return m_impl->conditionMap.emplace(key, condition).first->second;
+}
+
+// ---------------------------------------------------------------------------
+// Public methods
+// ---------------------------------------------------------------------------
+AuthorizationCache::EntryPtr AuthorizationCache::get(const UserIdType &userId)
+{
+	uint64_t generation;
+	{
+		Impl::rwlock.readLock();
+		Reaper<ReadWriteLock> unlocker(&Impl::rwlock,
+		                               ReadWriteLock::unlock);
+		auto it = Impl::entryMap.find(userId);
+		if (it != Impl::entryMap.end())
+			return it->second;
+		generation = Impl::generation;
+	}
+
+	EntryPtr entry = make_shared<Entry>(userId);
+
+	Impl::rwlock.writeLock();
+	Reaper<ReadWriteLock> unlocker(&Impl::rwlock, ReadWriteLock::unlock);
+	// Don't store the entry if the access list may have been changed
+	// while it was read.
+	if (Impl::generation != generation)
+		return entry;
+	return Impl::entryMap.emplace(userId, entry).first->second;
+}
+
+void AuthorizationCache::invalidate(void)
+{
+	Impl::rwlock.writeLock();
+	Reaper<ReadWriteLock> unlocker(&Impl::rwlock, ReadWriteLock::unlock);
+	Impl::entryMap.clear();
+	Impl::generation++;
+}
+
+uint64_t AuthorizationCache::getGeneration(void)
+{
+	Impl::rwlock.readLock();
+	Reaper<ReadWriteLock> unlocker(&Impl::rwlock, ReadWriteLock::unlock);
+	return Impl::generation;
+}
+
+size_t AuthorizationCache::getNumberOfEntries(void)
+{
+	Impl::rwlock.readLock();
+	Reaper<ReadWriteLock> unlocker(&Impl::rwlock, ReadWriteLock::unlock);
+	return Impl::entryMap.size();
+}
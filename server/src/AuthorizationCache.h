@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include "Params.h"
+#include "OperationPrivilege.h"
+
+/**
+ * A process-wide cache of the information to authorize data queries of
+ * each user.
+ *
+ * An Entry is a read-only snapshot of a user's access list. It is shared
+ * among threads and can be used safely even after invalidate() is
+ * called. In that case, the next get() returns a new Entry.
+ *
+ * invalidate() has to be called when the access list, the users or the
+ * monitoring servers are changed.
+ */
+class AuthorizationCache {
+public:
+	class Entry {
+	public:
+		typedef std::function<void (ServerIdSet &serverIdSet)>
+		  ServerIdSetLoader;
+		typedef std::function<std::string (void)> ConditionMaker;
+
+		Entry(const UserIdType &userId);
+		virtual ~Entry();
+
+		const UserIdType &getUserId(void) const;
+
+		/**
+		 * Get the allowed servers and host groups of the user.
+		 */
+		const ServerHostGrpSetMap &getServerHostGrpSetMap(void) const;
+
+		/**
+		 * Get the valid servers for the privilege flags.
+		 *
+		 * @param flags Operation privilege flags.
+		 * @param loader
+		 * A function to get the valid servers. It's called only when
+		 * the result for the flags is not cached.
+		 *
+		 * @return The valid servers.
+		 */
+		const ServerIdSet &getValidServerIdSet(
+		  const OperationPrivilegeFlag &flags,
+		  ServerIdSetLoader loader);
+
+		/**
+		 * Get an SQL condition derived from the entry.
+		 *
+		 * @param key
+		 * A key that identifies the condition such as the column names.
+		 * @param maker
+		 * A function to make the condition. It's called only when the
+		 * condition for the key is not cached.
+		 *
+		 * @return The condition.
+		 */
+		const std::string &getCondition(const std::string &key,
+		                                ConditionMaker maker);
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> m_impl;
+	};
+	typedef std::shared_ptr<Entry> EntryPtr;
+
+	/**
+	 * Get the entry of the user. The access list is read from the DB
+	 * if the entry is not cached.
+	 *
+	 * @param userId A user ID.
+	 *
+	 * @return The entry of the user.
+	 */
+	static EntryPtr get(const UserIdType &userId);
+
+	/**
+	 * Drop all the entries. It bumps the generation.
+	 */
+	static void invalidate(void);
+
+	/**
+	 * Get the generation that is incremented by invalidate().
+	 */
+	static uint64_t getGeneration(void);
+
+	static size_t getNumberOfEntries(void);
+
+private:
+	struct Impl;
+};
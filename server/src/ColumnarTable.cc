@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2014 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <inttypes.h>
+#include <StringUtils.h>
+#include "ColumnarTable.h"
+#include "SQLUtils.h"
+#include "Utils.h"
+
+using namespace std;
+using namespace mlpl;
+
+// ---------------------------------------------------------------------------
+// ColumnarTable
+// ---------------------------------------------------------------------------
+ColumnarTable::ColumnarTable(const vector<SQLColumnType> &columnTypes)
+: m_columns(columnTypes.size()),
+  m_numRows(0),
+  m_nextColumn(0)
+{
+	for (size_t i = 0; i < columnTypes.size(); i++) {
+		m_columns[i].type = columnTypes[i];
+		m_columns[i].storageType = getStorageType(columnTypes[i]);
+	}
+}
+
+void ColumnarTable::reserve(const size_t &numRows)
+{
+	for (auto &col : m_columns) {
+		switch (col.storageType) {
+		case STORAGE_INT:
+			col.ints.reserve(numRows);
+			break;
+		case STORAGE_UINT64:
+			col.uint64s.reserve(numRows);
+			break;
+		case STORAGE_DOUBLE:
+			col.doubles.reserve(numRows);
+			break;
+		case STORAGE_STRING:
+			col.strings.reserve(numRows);
+			break;
+		}
+		col.nullFlags.reserve(numRows);
+	}
+}
+
+size_t ColumnarTable::getNumberOfRows(void) const
+{
+	return m_numRows;
+}
+
+size_t ColumnarTable::getNumberOfColumns(void) const
+{
+	return m_columns.size();
+}
+
+const SQLColumnType &ColumnarTable::getColumnType(const size_t &column) const
+{
+	return m_columns[column].type;
+}
+
+void ColumnarTable::addNull(void)
+{
+	Column &col = m_columns[m_nextColumn];
+	// The value of NULL is the same as SQLUtils::createFromString().
+	switch (col.storageType) {
+	case STORAGE_INT:
+		col.ints.push_back(0);
+		break;
+	case STORAGE_UINT64:
+		col.uint64s.push_back(0);
+		break;
+	case STORAGE_DOUBLE:
+		col.doubles.push_back(0);
+		break;
+	case STORAGE_STRING:
+		col.strings.push_back({m_arena.size(), 0});
+		break;
+	}
+	col.nullFlags.push_back(true);
+	forwardColumn();
+}
+
+void ColumnarTable::addInt(const int &val)
+{
+	nextColumn(STORAGE_INT).ints.push_back(val);
+	forwardColumn();
+}
+
+void ColumnarTable::addUint64(const uint64_t &val)
+{
+	nextColumn(STORAGE_UINT64).uint64s.push_back(val);
+	forwardColumn();
+}
+
+void ColumnarTable::addDouble(const double &val)
+{
+	nextColumn(STORAGE_DOUBLE).doubles.push_back(val);
+	forwardColumn();
+}
+
+void ColumnarTable::addString(const char *str, const size_t &length)
+{
+	Column &col = nextColumn(STORAGE_STRING);
+	col.strings.push_back({m_arena.size(), length});
+	m_arena.append(str, length);
+	forwardColumn();
+}
+
+void ColumnarTable::addFromString(const char *str, const size_t &length)
+{
+	if (!str) {
+		addNull();
+		return;
+	}
+
+	switch (m_columns[m_nextColumn].type) {
+	case SQL_COLUMN_TYPE_INT:
+		addInt(atoi(str));
+		break;
+	case SQL_COLUMN_TYPE_BIGUINT:
+		addUint64(strtoull(str, NULL, 10));
+		break;
+	case SQL_COLUMN_TYPE_VARCHAR:
+	case SQL_COLUMN_TYPE_CHAR:
+	case SQL_COLUMN_TYPE_TEXT:
+		addString(str, length);
+		break;
+	case SQL_COLUMN_TYPE_DOUBLE:
+		addDouble(atof(str));
+		break;
+	case SQL_COLUMN_TYPE_DATETIME:
+		addInt((int)SQLUtils::parseDatetime(str));
+		break;
+	case NUM_SQL_COLUMN_TYPES:
+	default:
+		THROW_HATOHOL_EXCEPTION("Unknown column type: %d\n",
+		                        m_columns[m_nextColumn].type);
+	}
+}
+
+ColumnarTable::StorageType
+ColumnarTable::getStorageType(const SQLColumnType &type)
+{
+	switch (type) {
+	case SQL_COLUMN_TYPE_INT:
+	case SQL_COLUMN_TYPE_DATETIME:
+		return STORAGE_INT;
+	case SQL_COLUMN_TYPE_BIGUINT:
+		return STORAGE_UINT64;
+	case SQL_COLUMN_TYPE_VARCHAR:
+	case SQL_COLUMN_TYPE_CHAR:
+	case SQL_COLUMN_TYPE_TEXT:
+		return STORAGE_STRING;
+	case SQL_COLUMN_TYPE_DOUBLE:
+		return STORAGE_DOUBLE;
+	case NUM_SQL_COLUMN_TYPES:
+	default:
+		break;
+	}
+	THROW_HATOHOL_EXCEPTION("Unknown column type: %d\n", type);
+	return STORAGE_INT;
+}
+
+ColumnarTable::Column &
+ColumnarTable::nextColumn(const StorageType &storageType)
+{
+	Column &col = m_columns[m_nextColumn];
+	HATOHOL_ASSERT(col.storageType == storageType,
+	               "Type mismatch: column: %zd, %d, %d",
+	               m_nextColumn, col.storageType, storageType);
+	col.nullFlags.push_back(false);
+	return col;
+}
+
+void ColumnarTable::forwardColumn(void)
+{
+	m_nextColumn++;
+	if (m_nextColumn < m_columns.size())
+		return;
+	m_nextColumn = 0;
+	m_numRows++;
+}
+
+// ---------------------------------------------------------------------------
+// ColumnarTableStream
+// ---------------------------------------------------------------------------
+template<> uint64_t ColumnarTableStream::read<string, uint64_t>(void)
+{
+	string str;
+	uint64_t dest;
+	*this >> str;
+	Utils::conv(dest, str);
+	return dest;
+}
+
+template<> string ColumnarTableStream::read<int, string>(void)
+{
+	return StringUtils::sprintf("%d", read<int>());
+}
+
+template<> string ColumnarTableStream::read<uint64_t, string>(void)
+{
+	return StringUtils::sprintf("%" PRIu64, read<uint64_t>());
+}
+
+ColumnarTableStream::ColumnarTableStream(const ColumnarTable &table,
+                                         const size_t &row)
+: m_table(table),
+  m_row(row),
+  m_column(0)
+{
+}
+
+void ColumnarTableStream::setRow(const size_t &row)
+{
+	m_row = row;
+	m_column = 0;
+}
+
+bool ColumnarTableStream::isNull(void) const
+{
+	return m_table.isNull(m_row, m_column);
+}
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2014 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <type_traits>
+#include <stdint.h>
+#include "HatoholException.h"
+#include "SQLProcessorTypes.h"
+
+/**
+ * A table of SELECT results that is stored column by column.
+ *
+ * Unlike ItemTable, no object is allocated per cell. Values of
+ * each column are stored in a contiguous array of its native type and
+ * the strings of all columns are stored in a single arena.
+ *
+ * Values are added from the left column to the right column
+ * row by row.
+ */
+class ColumnarTable {
+public:
+	ColumnarTable(const std::vector<SQLColumnType> &columnTypes);
+
+	/**
+	 * Reserve the storage.
+	 *
+	 * @param numRows An expected number of rows.
+	 */
+	void reserve(const size_t &numRows);
+
+	size_t getNumberOfRows(void) const;
+	size_t getNumberOfColumns(void) const;
+	const SQLColumnType &getColumnType(const size_t &column) const;
+
+	void addNull(void);
+	void addInt(const int &val);
+	void addUint64(const uint64_t &val);
+	void addDouble(const double &val);
+	void addString(const char *str, const size_t &length);
+
+	/**
+	 * Add a value of the next column from the textual representation
+	 * such as MYSQL_ROW.
+	 *
+	 * @param str
+	 * A string. NULL means the NULL of SQL.
+	 *
+	 * @param length The length of str.
+	 */
+	void addFromString(const char *str, const size_t &length);
+
+	bool isNull(const size_t &row, const size_t &column) const
+	{
+		return m_columns[column].nullFlags[row];
+	}
+
+	const int &getInt(const size_t &row, const size_t &column) const
+	{
+		const Column &col = getColumn(column, STORAGE_INT);
+		return col.ints[row];
+	}
+
+	const uint64_t &getUint64(const size_t &row,
+	                          const size_t &column) const
+	{
+		const Column &col = getColumn(column, STORAGE_UINT64);
+		return col.uint64s[row];
+	}
+
+	const double &getDouble(const size_t &row, const size_t &column) const
+	{
+		const Column &col = getColumn(column, STORAGE_DOUBLE);
+		return col.doubles[row];
+	}
+
+	std::string getString(const size_t &row, const size_t &column) const
+	{
+		const Column &col = getColumn(column, STORAGE_STRING);
+		const StringRef &ref = col.strings[row];
+		return std::string(m_arena, ref.offset, ref.length);
+	}
+
+private:
+	enum StorageType {
+		STORAGE_INT,
+		STORAGE_UINT64,
+		STORAGE_DOUBLE,
+		STORAGE_STRING,
+	};
+
+	struct StringRef {
+		size_t offset;
+		size_t length;
+	};
+
+	struct Column {
+		SQLColumnType          type;
+		StorageType            storageType;
+		std::vector<int>       ints;
+		std::vector<uint64_t>  uint64s;
+		std::vector<double>    doubles;
+		std::vector<StringRef> strings;
+		std::vector<bool>      nullFlags;
+	};
+
+	std::vector<Column> m_columns;
+	std::string         m_arena;
+	size_t              m_numRows;
+	size_t              m_nextColumn;
+
+	static StorageType getStorageType(const SQLColumnType &type);
+
+	const Column &getColumn(const size_t &column,
+	                        const StorageType &storageType) const
+	{
+		HATOHOL_ASSERT(column < m_columns.size(),
+		               "Invalid column: %zd (%zd)",
+		               column, m_columns.size());
+		const Column &col = m_columns[column];
+		HATOHOL_ASSERT(col.storageType == storageType,
+		               "Type mismatch: column: %zd, %d, %d",
+		               column, col.storageType, storageType);
+		return col;
+	}
+
+	Column &nextColumn(const StorageType &storageType);
+	void forwardColumn(void);
+};
+
+typedef std::shared_ptr<ColumnarTable> ColumnarTablePtr;
+
+/**
+ * A cursor of a row in a ColumnarTable.
+ *
+ * It has the same interface as ItemGroupStream for reading values.
+ * So a reader of ItemGroupStream can be migrated by replacing the
+ * type of the stream.
+ */
+class ColumnarTableStream {
+public:
+	ColumnarTableStream(const ColumnarTable &table, const size_t &row);
+
+	/**
+	 * Move the cursor to the first column of the given row.
+	 *
+	 * @param row A row index.
+	 */
+	void setRow(const size_t &row);
+
+	/**
+	 * Check if the value at the current position is NULL.
+	 *
+	 * This method doesn't move the stream position.
+	 *
+	 * @return true if it is NULL.
+	 */
+	bool isNull(void) const;
+
+	template <typename NATIVE_TYPE>
+	NATIVE_TYPE read(void)
+	{
+		NATIVE_TYPE val;
+		*this >> val;
+		return val;
+	}
+
+	template <typename NATIVE_TYPE, typename CAST_TYPE>
+	CAST_TYPE read(void)
+	{
+		return static_cast<CAST_TYPE>(read<NATIVE_TYPE>());
+	}
+
+	void operator>>(int &rhs)
+	{
+		rhs = m_table.getInt(m_row, m_column++);
+	}
+
+	void operator>>(uint64_t &rhs)
+	{
+		rhs = m_table.getUint64(m_row, m_column++);
+	}
+
+	void operator>>(double &rhs)
+	{
+		rhs = m_table.getDouble(m_row, m_column++);
+	}
+
+	void operator>>(std::string &rhs)
+	{
+		rhs = m_table.getString(m_row, m_column++);
+	}
+
+	void operator>>(time_t &rhs)
+	{
+		rhs = read<int, time_t>();
+	}
+
+	/**
+	 * Read an enum value that is stored as an integer.
+	 */
+	template <typename T>
+	typename std::enable_if<std::is_enum<T>::value>::type
+	operator>>(T &rhs)
+	{
+		rhs = read<int, T>();
+	}
+
+private:
+	const ColumnarTable &m_table;
+	size_t               m_row;
+	size_t               m_column;
+};
+
+template<> uint64_t ColumnarTableStream::read<std::string, uint64_t>(void);
+template<> std::string ColumnarTableStream::read<int, std::string>(void);
+template<> std::string ColumnarTableStream::read<uint64_t, std::string>(void);
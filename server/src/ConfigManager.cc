@@ -119,7 +119,8 @@ CommandLineOptions::CommandLineOptions(void)
   foreground(FALSE),
   testMode(FALSE),
   faceRestPort(-1),
-  faceRestNumWorkers(0)
+  faceRestNumWorkers(0),
+  asyncLog(FALSE)
 {
 }
 
@@ -137,10 +138,17 @@ struct ConfigManager::Impl {
 	string                dbServerAddress;
 	int                   dbServerPort;
 	bool                  testMode;
+	bool                  asyncLog;
 	AtomicValue<int>      faceRestPort;
 	string                user;
 	string                pidFilePath;
 	int                   faceRestNumWorkers;
+	int                   faceRestMaxNumWorkers;
+	int                   actionNumWorkers;
+	int                   jsonGateBatchSize;
+	int                   jsonGateBatchIntervalMSec;
+	int                   onDemandFetchMaxRunningFetchers;
+	int                   onDemandFetchCacheTTLSec;
 
 	// methods
 	Impl(void)
@@ -148,9 +156,16 @@ struct ConfigManager::Impl {
 	  dbServerAddress("localhost"),
 	  dbServerPort(0),
 	  testMode(false),
+	  asyncLog(false),
 	  faceRestPort(0),
 	  pidFilePath(DEFAULT_PID_FILE_PATH),
-	  faceRestNumWorkers(0)
+	  faceRestNumWorkers(0),
+	  faceRestMaxNumWorkers(0),
+	  actionNumWorkers(0),
+	  jsonGateBatchSize(0),
+	  jsonGateBatchIntervalMSec(0),
+	  onDemandFetchMaxRunningFetchers(0),
+	  onDemandFetchCacheTTLSec(-1)
 	{
 	}
 
@@ -210,6 +225,9 @@ struct ConfigManager::Impl {
 
 		loadConfigFileMySQLGroup(keyFile);
 		loadConfigFileFaceRestGroup(keyFile);
+		loadConfigFileActionGroup(keyFile);
+		loadConfigFileJSONGateGroup(keyFile);
+		loadConfigFileOnDemandFetchGroup(keyFile);
 
 		return true;
 	}
@@ -225,6 +243,8 @@ struct ConfigManager::Impl {
 			foreground = true;
 		if (cmdLineOpts.testMode)
 			testMode = true;
+		if (cmdLineOpts.asyncLog)
+			asyncLog = true;
 		if (cmdLineOpts.faceRestPort >= 0)
 			faceRestPort = cmdLineOpts.faceRestPort;
 		if (cmdLineOpts.pidFilePath)
@@ -281,6 +301,90 @@ private:
 		} else {
 			MLPL_WARN("ConfigFile: [FaceRest] workers=%d: Invalid value. Ignored.\n", num);
 		}
+
+		if (!g_key_file_has_key(keyFile, group, "max-workers", NULL))
+			return;
+		gint maxNum = g_key_file_get_integer(keyFile, group,
+						     "max-workers", NULL);
+		if (maxNum > 0) {
+			getInstance()->setFaceRestMaxNumWorkers(maxNum);
+			MLPL_INFO("ConfigFile: [FaceRest] max-workers=%d\n",
+			          maxNum);
+		} else {
+			MLPL_WARN("ConfigFile: [FaceRest] max-workers=%d: Invalid value. Ignored.\n", maxNum);
+		}
+	}
+
+	void loadConfigFileActionGroup(GKeyFile *keyFile)
+	{
+		const gchar *group = "Action";
+
+		if (!g_key_file_has_key(keyFile, group, "workers", NULL))
+			return;
+		gint num = g_key_file_get_integer(keyFile, group,
+						  "workers", NULL);
+		if (num > 0) {
+			getInstance()->setActionNumWorkers(num);
+			MLPL_INFO("ConfigFile: [Action] workers=%d\n", num);
+		} else {
+			MLPL_WARN("ConfigFile: [Action] workers=%d: Invalid value. Ignored.\n", num);
+		}
+	}
+
+	void loadConfigFileJSONGateGroup(GKeyFile *keyFile)
+	{
+		const gchar *group = "JSONGate";
+
+		if (g_key_file_has_key(keyFile, group, "batch-size", NULL)) {
+			gint num = g_key_file_get_integer(keyFile, group,
+							  "batch-size", NULL);
+			if (num > 0) {
+				getInstance()->setJSONGateBatchSize(num);
+				MLPL_INFO("ConfigFile: [JSONGate] batch-size=%d\n", num);
+			} else {
+				MLPL_WARN("ConfigFile: [JSONGate] batch-size=%d: Invalid value. Ignored.\n", num);
+			}
+		}
+
+		if (!g_key_file_has_key(keyFile, group, "batch-interval-msec",
+		                        NULL))
+			return;
+		gint msec = g_key_file_get_integer(keyFile, group,
+						   "batch-interval-msec", NULL);
+		if (msec > 0) {
+			getInstance()->setJSONGateBatchIntervalMSec(msec);
+			MLPL_INFO("ConfigFile: [JSONGate] batch-interval-msec=%d\n", msec);
+		} else {
+			MLPL_WARN("ConfigFile: [JSONGate] batch-interval-msec=%d: Invalid value. Ignored.\n", msec);
+		}
+	}
+
+	void loadConfigFileOnDemandFetchGroup(GKeyFile *keyFile)
+	{
+		const gchar *group = "OnDemandFetch";
+
+		if (g_key_file_has_key(keyFile, group, "max-running-fetchers",
+		                       NULL)) {
+			gint num = g_key_file_get_integer(
+			  keyFile, group, "max-running-fetchers", NULL);
+			if (num > 0) {
+				getInstance()->setOnDemandFetchMaxRunningFetchers(num);
+				MLPL_INFO("ConfigFile: [OnDemandFetch] max-running-fetchers=%d\n", num);
+			} else {
+				MLPL_WARN("ConfigFile: [OnDemandFetch] max-running-fetchers=%d: Invalid value. Ignored.\n", num);
+			}
+		}
+
+		if (!g_key_file_has_key(keyFile, group, "cache-ttl-sec", NULL))
+			return;
+		gint sec = g_key_file_get_integer(keyFile, group,
+						  "cache-ttl-sec", NULL);
+		if (sec >= 0) {
+			getInstance()->setOnDemandFetchCacheTTLSec(sec);
+			MLPL_INFO("ConfigFile: [OnDemandFetch] cache-ttl-sec=%d\n", sec);
+		} else {
+			MLPL_WARN("ConfigFile: [OnDemandFetch] cache-ttl-sec=%d: Invalid value. Ignored.\n", sec);
+		}
 	}
 };
 
@@ -331,6 +435,10 @@ bool ConfigManager::parseCommandLine(gint *argc, gchar ***argv,
 		{"face-rest-workers",
 		 'T', 0, G_OPTION_ARG_CALLBACK, (gpointer)parseFaceRestNumWorkers,
 		 "Number of FaceRest worker threads", NULL},
+		{"async-log",
+		 'L', 0, G_OPTION_ARG_NONE,
+		 &cmdLineOpts->asyncLog,
+		 "Write log messages in a background thread", NULL},
 		{ NULL }
 	};
 
@@ -468,6 +576,11 @@ bool ConfigManager::isTestMode(void) const
 	return m_impl->testMode;
 }
 
+bool ConfigManager::isAsyncLogEnabled(void) const
+{
+	return m_impl->asyncLog;
+}
+
 int ConfigManager::getFaceRestPort(void) const
 {
 	return m_impl->faceRestPort;
@@ -498,6 +611,66 @@ void ConfigManager::setFaceRestNumWorkers(const int &num)
 	m_impl->faceRestNumWorkers = num;
 }
 
+int ConfigManager::getFaceRestMaxNumWorkers(void) const
+{
+	return m_impl->faceRestMaxNumWorkers;
+}
+
+void ConfigManager::setFaceRestMaxNumWorkers(const int &num)
+{
+	m_impl->faceRestMaxNumWorkers = num;
+}
+
+int ConfigManager::getActionNumWorkers(void) const
+{
+	return m_impl->actionNumWorkers;
+}
+
+void ConfigManager::setActionNumWorkers(const int &num)
+{
+	m_impl->actionNumWorkers = num;
+}
+
+int ConfigManager::getJSONGateBatchSize(void) const
+{
+	return m_impl->jsonGateBatchSize;
+}
+
+void ConfigManager::setJSONGateBatchSize(const int &num)
+{
+	m_impl->jsonGateBatchSize = num;
+}
+
+int ConfigManager::getJSONGateBatchIntervalMSec(void) const
+{
+	return m_impl->jsonGateBatchIntervalMSec;
+}
+
+void ConfigManager::setJSONGateBatchIntervalMSec(const int &msec)
+{
+	m_impl->jsonGateBatchIntervalMSec = msec;
+}
+
+int ConfigManager::getOnDemandFetchMaxRunningFetchers(void) const
+{
+	return m_impl->onDemandFetchMaxRunningFetchers;
+}
+
+void ConfigManager::setOnDemandFetchMaxRunningFetchers(const int &num)
+{
+	m_impl->onDemandFetchMaxRunningFetchers = num;
+}
+
+int ConfigManager::getOnDemandFetchCacheTTLSec(void) const
+{
+	return m_impl->onDemandFetchCacheTTLSec;
+}
+
+void ConfigManager::setOnDemandFetchCacheTTLSec(const int &sec)
+{
+	m_impl->onDemandFetchCacheTTLSec = sec;
+}
+
 // ---------------------------------------------------------------------------
 // Protected methods
 // ---------------------------------------------------------------------------
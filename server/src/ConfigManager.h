@@ -33,6 +33,7 @@ struct CommandLineOptions {
 	gboolean  testMode;
 	gint      faceRestPort;
 	gint      faceRestNumWorkers;
+	gboolean  asyncLog;
 
 	CommandLineOptions(void);
 };
@@ -97,6 +98,13 @@ public:
 
 	bool isTestMode(void) const;
 
+	/**
+	 * Check if log messages are written in a background thread.
+	 *
+	 * @return true if --async-log is specified.
+	 */
+	bool isAsyncLogEnabled(void) const;
+
 	/**
 	 * Get the port for FaceRest.
 	 *
@@ -116,6 +124,75 @@ public:
 
 	void setFaceRestNumWorkers(const int &num);
 
+	/**
+	 * Get the maximum number of FaceRest workers.
+	 *
+	 * @return
+	 * A value of 'max-workers' in the [FaceRest] group of the config file
+	 * if it is specified. Otherwise, 0 is returned.
+	 */
+	int getFaceRestMaxNumWorkers(void) const;
+
+	void setFaceRestMaxNumWorkers(const int &num);
+
+	/**
+	 * Get the number of threads that evaluate actions of events.
+	 *
+	 * @return
+	 * A value of 'workers' in the [Action] group of the config file
+	 * if it is specified. Otherwise, 0 is returned.
+	 */
+	int getActionNumWorkers(void) const;
+
+	void setActionNumWorkers(const int &num);
+
+	/**
+	 * Get the maximum number of events that a JSON gate stores at once.
+	 *
+	 * @return
+	 * A value of 'batch-size' in the [JSONGate] group of the config file
+	 * if it is specified. Otherwise, 0 is returned.
+	 */
+	int getJSONGateBatchSize(void) const;
+
+	void setJSONGateBatchSize(const int &num);
+
+	/**
+	 * Get the maximum time that a JSON gate holds an event before
+	 * storing it.
+	 *
+	 * @return
+	 * A value of 'batch-interval-msec' in the [JSONGate] group of the
+	 * config file if it is specified. Otherwise, 0 is returned.
+	 */
+	int getJSONGateBatchIntervalMSec(void) const;
+
+	void setJSONGateBatchIntervalMSec(const int &msec);
+
+	/**
+	 * Get the maximum number of the on-demand fetches of items or
+	 * triggers that run at the same time.
+	 *
+	 * @return
+	 * A value of 'max-running-fetchers' in the [OnDemandFetch] group of
+	 * the config file if it is specified. Otherwise, 0 is returned.
+	 */
+	int getOnDemandFetchMaxRunningFetchers(void) const;
+
+	void setOnDemandFetchMaxRunningFetchers(const int &num);
+
+	/**
+	 * Get the time for which a completed on-demand fetch of items or
+	 * triggers of a host is reused.
+	 *
+	 * @return
+	 * A value of 'cache-ttl-sec' in the [OnDemandFetch] group of the
+	 * config file if it is specified. Otherwise, -1 is returned.
+	 */
+	int getOnDemandFetchCacheTTLSec(void) const;
+
+	void setOnDemandFetchCacheTTLSec(const int &sec);
+
 protected:
 	void loadConfFile(void);
 	static gboolean parseLogLevel(
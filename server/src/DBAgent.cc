@@ -70,6 +70,12 @@ const char *DBConnectInfo::getPassword(void) const
 struct DBAgent::Impl
 {
 	static DBTermCodec         dbTermCodec;
+	bool                       preparedStatementEnabled;
+
+	Impl(void)
+	: preparedStatementEnabled(true)
+	{
+	}
 };
 
 DBTermCodec    DBAgent::Impl::dbTermCodec;
@@ -169,6 +175,57 @@ void DBAgent::InsertArg::add(const time_t &val,
 	row->addNewItem(val, nullFlag);
 }
 
+// ---------------------------------------------------------------------------
+// DBAgent::InsertBatchArg
+// ---------------------------------------------------------------------------
+const size_t DBAgent::InsertBatchArg::DEFAULT_MAX_ROWS_PER_STATEMENT = 1000;
+
+// The default max_allowed_packet of MySQL 5.5 is 1MiB.
+const size_t DBAgent::InsertBatchArg::DEFAULT_MAX_BYTES_PER_STATEMENT =
+  512 * 1024;
+
+DBAgent::InsertBatchArg::InsertBatchArg(const TableProfile &profile)
+: tableProfile(profile),
+  upsertOnDuplicate(false),
+  maxRowsPerStatement(DEFAULT_MAX_ROWS_PER_STATEMENT),
+  maxBytesPerStatement(DEFAULT_MAX_BYTES_PER_STATEMENT)
+{
+}
+
+void DBAgent::InsertBatchArg::add(const InsertArg &insertArg)
+{
+	HATOHOL_ASSERT(&insertArg.tableProfile == &tableProfile,
+	               "Table profile mismatch: %s, %s",
+	               insertArg.tableProfile.name, tableProfile.name);
+	rows.push_back(ItemGroupPtr(insertArg.row));
+}
+
+bool DBAgent::InsertBatchArg::isInsertIdAssignable(void) const
+{
+	if (!tableProfile.uniqueKeyColumnIndexes.empty())
+		return false;
+
+	int primaryKeyIndex = -1;
+	for (size_t i = 0; i < tableProfile.numColumns; i++) {
+		const ColumnDef &columnDef = tableProfile.columnDefs[i];
+		if (columnDef.keyType != SQL_KEY_PRI)
+			continue;
+		if (!(columnDef.flags & SQL_COLUMN_FLAG_AUTO_INC))
+			return false;
+		primaryKeyIndex = i;
+		break;
+	}
+	if (primaryKeyIndex < 0)
+		return false;
+
+	for (const auto &row : rows) {
+		const ItemData *item = row->getItemAt(primaryKeyIndex);
+		if (!isAutoIncrementValue(item))
+			return false;
+	}
+	return true;
+}
+
 // ---------------------------------------------------------------------------
 // DBAgent::UpdateArg
 // ---------------------------------------------------------------------------
@@ -245,7 +302,8 @@ DBAgent::SelectExArg::SelectExArg(const TableProfile &profile)
   limit(0),
   offset(0),
   useFullName(false),
-  useDistinct(false)
+  useDistinct(false),
+  useColumnarTable(false)
 {
 }
 
@@ -348,6 +406,7 @@ void DBAgent::TransactionProc::postproc(DBAgent &dbAgent)
 // Public methods
 // ---------------------------------------------------------------------------
 DBAgent::DBAgent(void)
+: m_impl(new Impl())
 {
 }
 
@@ -362,6 +421,21 @@ void DBAgent::dropTable(const std::string &tableName)
 	execSql(sql);
 }
 
+void DBAgent::insertBatch(const InsertBatchArg &insertBatchArg)
+{
+	const bool assignInsertIds = insertBatchArg.isInsertIdAssignable();
+	insertBatchArg.insertIds.clear();
+	for (const auto &row : insertBatchArg.rows) {
+		InsertArg arg(insertBatchArg.tableProfile);
+		for (size_t i = 0; i < row->getNumberOfItems(); i++)
+			arg.row->add(row->getItemAt(i));
+		arg.upsertOnDuplicate = insertBatchArg.upsertOnDuplicate;
+		insert(arg);
+		if (assignInsertIds)
+			insertBatchArg.insertIds.push_back(getLastInsertId());
+	}
+}
+
 void DBAgent::fixupIndexes(const TableProfile &tableProfile)
 {
 	typedef map<string, IndexInfo *>   IndexNameInfoMap;
@@ -731,6 +805,16 @@ const DBTermCodec *DBAgent::getDBTermCodec(void) const
 	return &Impl::dbTermCodec;
 }
 
+void DBAgent::setPreparedStatementEnabled(const bool &enabled)
+{
+	m_impl->preparedStatementEnabled = enabled;
+}
+
+bool DBAgent::isPreparedStatementEnabled(void) const
+{
+	return m_impl->preparedStatementEnabled;
+}
+
 void DBAgent::createIndex(const TableProfile &tableProfile,
                           const IndexDef &indexDef)
 {
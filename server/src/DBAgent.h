@@ -26,6 +26,7 @@
 #include "Params.h"
 #include "SQLProcessorTypes.h"
 #include "DBTermCodec.h"
+#include "ColumnarTable.h"
 
 static const int CURR_DATETIME = -1;
 
@@ -124,6 +125,49 @@ public:
 		                                     = ITEM_DATA_NOT_NULL);
 	};
 
+	struct InsertBatchArg {
+		static const size_t DEFAULT_MAX_ROWS_PER_STATEMENT;
+		static const size_t DEFAULT_MAX_BYTES_PER_STATEMENT;
+
+		const TableProfile        &tableProfile;
+		std::vector<ItemGroupPtr>  rows;
+		bool                       upsertOnDuplicate;
+
+		// A statement is split when it exceeds either of them.
+		size_t                     maxRowsPerStatement;
+		size_t                     maxBytesPerStatement;
+
+		// output
+		/**
+		 * IDs of the auto-incremented primary key in the same order
+		 * as 'rows'. This is filled only when isInsertIdAssignable()
+		 * returns true. Otherwise it is empty.
+		 */
+		mutable std::vector<uint64_t> insertIds;
+
+		InsertBatchArg(const TableProfile &tableProfile);
+
+		/**
+		 * Add a row of the given InsertArg. The row is shared (not
+		 * copied) with the InsertArg.
+		 *
+		 * @param insertArg
+		 * An InsertArg instance. Its tableProfile must be the same as
+		 * this object's one.
+		 */
+		void add(const InsertArg &insertArg);
+
+		/**
+		 * Check if every row is surely newly inserted with an
+		 * auto-incremented ID. This is the case when the primary key
+		 * is an auto-increment column, the values of it in all rows
+		 * are AUTO_INCREMENT_VALUE, and there's no unique key.
+		 *
+		 * @return true if the IDs can be returned in 'insertIds'.
+		 */
+		bool isInsertIdAssignable(void) const;
+	};
+
 	struct UpdateArg {
 		const TableProfile             &tableProfile;
 		std::string                     condition;
@@ -167,8 +211,12 @@ public:
 		std::string                tableField;
 		bool                       useFullName;
 		bool                       useDistinct;
+		// When this is true, the result is stored to columnarTable
+		// instead of dataTable.
+		bool                       useColumnarTable;
 		// output
 		mutable ItemTablePtr        dataTable;
+		mutable ColumnarTablePtr    columnarTable;
 
 		SelectExArg(const TableProfile &tableProfile);
 		void add(const size_t &columnIndex);
@@ -224,6 +272,17 @@ public:
 	virtual void execSql(const std::string &sql) = 0;
 	virtual void createTable(const TableProfile &tableProfile) = 0;
 	virtual void insert(const InsertArg &insertArg) = 0;
+
+	/**
+	 * Insert (or upsert) multiple rows.
+	 *
+	 * The default implementation calls insert() for each row. Subclasses
+	 * can override this to insert rows with fewer statements.
+	 *
+	 * @param insertBatchArg An InsertBatchArg instance.
+	 */
+	virtual void insertBatch(const InsertBatchArg &insertBatchArg);
+
 	virtual void update(const UpdateArg &updateArg) = 0;
 	virtual void select(const SelectArg &selectArg) = 0;
 	virtual void select(const SelectExArg &selectExArg) = 0;
@@ -290,6 +349,19 @@ public:
 
 	virtual const DBTermCodec *getDBTermCodec(void) const;
 
+	/**
+	 * Enable or disable prepared statements.
+	 *
+	 * When it is enabled, a subclass may cache a prepared statement for
+	 * each statement shape (e.g. INSERT to a table) and bind values in
+	 * the binary form instead of rendering them into an SQL string.
+	 * It's enabled by default.
+	 *
+	 * @param enabled true to enable, false to disable.
+	 */
+	void setPreparedStatementEnabled(const bool &enabled);
+	bool isPreparedStatementEnabled(void) const;
+
 	/**
 	 * A exception that stops the running transaction and rolls back.
 	 * After this exception is thrown in a transaction,
@@ -366,6 +438,12 @@ public:
 		_runTransaction<const InsertArg, &DBAgent::insert>(arg);
 	}
 
+	void runTransaction(const InsertBatchArg &arg)
+	{
+		_runTransaction<const InsertBatchArg,
+		                &DBAgent::insertBatch>(arg);
+	}
+
 	void runTransaction(const SelectArg &arg)
 	{
 		_runTransaction<const SelectArg, &DBAgent::select>(arg);
@@ -432,5 +510,6 @@ protected:
 
 private:
 	struct Impl;
+	std::unique_ptr<Impl> m_impl;
 };
 
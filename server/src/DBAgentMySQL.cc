@@ -18,9 +18,16 @@
  */
 
 #include <mysql/errmsg.h>
+#include <mysql/mysqld_error.h>
 #include <unistd.h>
 #include <semaphore.h>
 #include <errno.h>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <type_traits>
 #include <AtomicValue.h>
 #include <SimpleSemaphore.h>
 #include "DBAgentMySQL.h"
@@ -45,25 +52,71 @@ struct DBAgentMySQL::Impl {
 	string host;
 	unsigned int port;
 	bool inTransaction;
+	int autoIncLockMode;
 	AtomicValue<bool> disposed;
 	SimpleSemaphore waitSem;
+	// Prepared statements keyed by the SQL text
+	map<string, MYSQL_STMT *> stmtMap;
+	// mysql_affected_rows() doesn't count the prepared statements.
+	bool useStmtAffectedRows;
+	uint64_t stmtAffectedRows;
 
 	Impl(void)
 	: connected(false),
 	  port(0),
 	  inTransaction(false),
+	  autoIncLockMode(-1),
 	  disposed(false),
-	  waitSem(0)
+	  waitSem(0),
+	  useStmtAffectedRows(false),
+	  stmtAffectedRows(0)
 	{
 	}
 
 	~Impl(void)
 	{
 		if (connected) {
+			clearStatements();
 			mysql_close(&mysql);
 		}
 	}
 
+	MYSQL_STMT *getStatement(const string &sql)
+	{
+		auto it = stmtMap.find(sql);
+		if (it != stmtMap.end())
+			return it->second;
+
+		MYSQL_STMT *stmt = mysql_stmt_init(&mysql);
+		if (!stmt)
+			return NULL;
+		if (mysql_stmt_prepare(stmt, sql.c_str(), sql.size())) {
+			MLPL_WARN("Failed to prepare: %s: (%u) %s\n",
+			          sql.c_str(), mysql_stmt_errno(stmt),
+			          mysql_stmt_error(stmt));
+			mysql_stmt_close(stmt);
+			return NULL;
+		}
+		stmtMap[sql] = stmt;
+		return stmt;
+	}
+
+	void closeStatement(const string &sql)
+	{
+		auto it = stmtMap.find(sql);
+		if (it == stmtMap.end())
+			return;
+		mysql_stmt_close(it->second);
+		stmtMap.erase(it);
+	}
+
+	void clearStatements(void)
+	{
+		for (auto &sqlStmt : stmtMap)
+			mysql_stmt_close(sqlStmt.second);
+		stmtMap.clear();
+	}
+
 	bool shouldRetry(unsigned int errorNumber)
 	{
 		return retryErrorSet.find(errorNumber) != retryErrorSet.end();
@@ -310,6 +363,22 @@ void DBAgentMySQL::createTable(const TableProfile &tableProfile)
 	execSql(query);
 }
 
+static string makeUpsertClause(const DBAgent::TableProfile &tableProfile)
+{
+	SeparatorInjector commaInjector(",");
+	string clause = " ON DUPLICATE KEY UPDATE ";
+	for (size_t i = 0; i < tableProfile.numColumns; i++) {
+		const ColumnDef &columnDef = tableProfile.columnDefs[i];
+		if (columnDef.keyType == SQL_KEY_PRI)
+			continue;
+		commaInjector(clause);
+		clause += StringUtils::sprintf("%s=VALUES(%s)",
+		                               columnDef.columnName,
+		                               columnDef.columnName);
+	}
+	return clause;
+}
+
 void DBAgentMySQL::insert(const DBAgent::InsertArg &insertArg)
 {
 	using mlpl::StringUtils::sprintf;
@@ -319,6 +388,12 @@ void DBAgentMySQL::insert(const DBAgent::InsertArg &insertArg)
 	HATOHOL_ASSERT(numColumns == insertArg.row->getNumberOfItems(),
 	               "numColumn: %zd != row: %zd",
 	               numColumns, insertArg.row->getNumberOfItems());
+#if MYSQL_VERSION_ID >= 50112
+	if (isPreparedStatementEnabled() &&
+	    insertWithPreparedStatement(insertArg)) {
+		return;
+	}
+#endif
 
 	SeparatorInjector commaInjector(",");
 	string query = StringUtils::sprintf("INSERT INTO %s (",
@@ -390,6 +465,78 @@ void DBAgentMySQL::insert(const DBAgent::InsertArg &insertArg)
 	execSql(query);
 }
 
+void DBAgentMySQL::insertBatch(const InsertBatchArg &insertBatchArg)
+{
+	HATOHOL_ASSERT(m_impl->connected, "Not connected.");
+	const bool assignInsertIds = insertBatchArg.isInsertIdAssignable();
+	if (assignInsertIds && !isAutoIncrementConsecutive()) {
+		DBAgent::insertBatch(insertBatchArg);
+		return;
+	}
+	insertBatchArg.insertIds.clear();
+
+	const TableProfile &tableProfile = insertBatchArg.tableProfile;
+	const size_t numColumns = tableProfile.numColumns;
+
+	SeparatorInjector commaInjector(",");
+	string header = StringUtils::sprintf("INSERT INTO %s (",
+	                                     tableProfile.name);
+	for (size_t i = 0; i < numColumns; i++) {
+		commaInjector(header);
+		header += tableProfile.columnDefs[i].columnName;
+	}
+	header += ") VALUES ";
+
+	string trailer;
+	if (insertBatchArg.upsertOnDuplicate)
+		trailer = makeUpsertClause(tableProfile);
+
+	string query;
+	size_t numRowsInQuery = 0;
+	auto flush = [&] {
+		if (numRowsInQuery == 0)
+			return;
+		query += trailer;
+		execSql(query);
+		if (assignInsertIds) {
+			// LAST_INSERT_ID() returns the ID of the first row.
+			const uint64_t firstId = getLastInsertId();
+			for (size_t i = 0; i < numRowsInQuery; i++)
+				insertBatchArg.insertIds.push_back(firstId + i);
+		}
+		query.clear();
+		numRowsInQuery = 0;
+	};
+
+	string values;
+	for (const auto &row : insertBatchArg.rows) {
+		HATOHOL_ASSERT(numColumns == row->getNumberOfItems(),
+		               "numColumn: %zd != row: %zd",
+		               numColumns, row->getNumberOfItems());
+		values = "(";
+		commaInjector.clear();
+		for (size_t i = 0; i < numColumns; i++) {
+			commaInjector(values);
+			values += getColumnValueString(&tableProfile.columnDefs[i],
+			                               row->getItemAt(i));
+		}
+		values += ")";
+
+		const size_t expectedSize =
+		  query.size() + 1 + values.size() + trailer.size();
+		if (numRowsInQuery >= insertBatchArg.maxRowsPerStatement ||
+		    expectedSize > insertBatchArg.maxBytesPerStatement)
+			flush();
+
+		if (numRowsInQuery == 0)
+			query = header;
+		else
+			query += ",";
+		query += values;
+		numRowsInQuery++;
+	}
+	flush();
+}
 
 void DBAgentMySQL::update(const UpdateArg &updateArg)
 {
@@ -444,8 +591,23 @@ void DBAgentMySQL::select(const SelectExArg &selectExArg)
 	}
 
 	MYSQL_ROW row;
-	VariableItemTablePtr dataTable;
 	size_t numColumns = selectExArg.statements.size();
+	if (selectExArg.useColumnarTable) {
+		ColumnarTablePtr table(
+		  new ColumnarTable(selectExArg.columnTypes));
+		table->reserve(mysql_num_rows(result));
+		while ((row = mysql_fetch_row(result))) {
+			const unsigned long *lengths =
+			  mysql_fetch_lengths(result);
+			for (size_t i = 0; i < numColumns; i++)
+				table->addFromString(row[i], lengths[i]);
+		}
+		mysql_free_result(result);
+		selectExArg.columnarTable = table;
+		return;
+	}
+
+	VariableItemTablePtr dataTable;
 	while ((row = mysql_fetch_row(result))) {
 		VariableItemGroupPtr itemGroup;
 		for (size_t i = 0; i < numColumns; i++) {
@@ -498,6 +660,8 @@ uint64_t DBAgentMySQL::getLastInsertId(void)
 uint64_t DBAgentMySQL::getNumberOfAffectedRows(void)
 {
 	HATOHOL_ASSERT(m_impl->connected, "Not connected.");
+	if (m_impl->useStmtAffectedRows)
+		return m_impl->stmtAffectedRows;
 	my_ulonglong num = mysql_affected_rows(&m_impl->mysql);
 	// According to the referece manual, mysql_affected_rows()
 	// doesn't return an error.
@@ -609,6 +773,8 @@ void DBAgentMySQL::sleepAndReconnect(unsigned int sleepTimeSec)
 {
 	m_impl->waitSem.timedWait(sleepTimeSec * 1000);
 
+	// Statements belong to the connection.
+	m_impl->clearStatements();
 	mysql_close(&m_impl->mysql);
 	m_impl->connected = false;
 	connect();
@@ -627,6 +793,7 @@ bool DBAgentMySQL::throwExceptionIfDisposed(void) const
 
 void DBAgentMySQL::queryWithRetry(const string &statement)
 {
+	m_impl->useStmtAffectedRows = false;
 	unsigned int errorNumber = 0;
 	size_t numRetry = DEFAULT_NUM_RETRY;
 	for (size_t i = 0; i < numRetry; i++) {
@@ -676,6 +843,212 @@ void DBAgentMySQL::queryWithRetry(const string &statement)
 	}
 }
 
+bool DBAgentMySQL::isAutoIncrementConsecutive(void)
+{
+	// The memory engine locks the whole table on every insert.
+	if (!Impl::engineStr.empty())
+		return true;
+	if (m_impl->autoIncLockMode >= 0)
+		return m_impl->autoIncLockMode <= 1;
+
+	// With the 'interleaved' mode (2), IDs of rows inserted by
+	// a multi-row INSERT may not be consecutive.
+	// http://dev.mysql.com/doc/refman/5.5/en/innodb-auto-increment-handling.html
+	try {
+		execSql("SELECT @@innodb_autoinc_lock_mode");
+	} catch (const HatoholException &e) {
+		MLPL_WARN("Failed to get innodb_autoinc_lock_mode: %s\n",
+		          e.getFancyMessage().c_str());
+		m_impl->autoIncLockMode = INT_MAX;
+		return false;
+	}
+	MYSQL_RES *result = mysql_store_result(&m_impl->mysql);
+	if (!result) {
+		THROW_HATOHOL_EXCEPTION(
+		  "Failed to call mysql_store_result: %s\n",
+		  mysql_error(&m_impl->mysql));
+	}
+	MYSQL_ROW row = mysql_fetch_row(result);
+	m_impl->autoIncLockMode = (row && row[0]) ? atoi(row[0]) : INT_MAX;
+	mysql_free_result(result);
+	return m_impl->autoIncLockMode <= 1;
+}
+
+#if MYSQL_VERSION_ID >= 50112
+namespace {
+// Holds MYSQL_BIND and the buffers they point to.
+class MySQLParamBinder {
+	// my_bool in old versions and bool in the newer ones.
+	typedef std::remove_pointer<decltype(MYSQL_BIND::is_null)>::type
+	  NullFlag;
+	union Value {
+		int         intValue;
+		long long   longlongValue;
+		double      doubleValue;
+		MYSQL_TIME  timeValue;
+	};
+
+	vector<MYSQL_BIND>          m_binds;
+	vector<Value>               m_values;
+	vector<unsigned long>       m_lengths;
+	std::unique_ptr<NullFlag[]> m_nullFlags;
+
+public:
+	MySQLParamBinder(const size_t &numParams)
+	: m_binds(numParams),
+	  m_values(numParams),
+	  m_lengths(numParams, 0),
+	  m_nullFlags(new NullFlag[numParams])
+	{
+		memset(m_binds.data(), 0, sizeof(MYSQL_BIND) * numParams);
+		for (size_t i = 0; i < numParams; i++) {
+			m_nullFlags[i] = 0;
+			m_binds[i].is_null = &m_nullFlags[i];
+			m_binds[i].length  = &m_lengths[i];
+		}
+	}
+
+	MYSQL_BIND *getBinds(void)
+	{
+		return m_binds.data();
+	}
+
+	// The bound string refers to the buffer of itemData.
+	void set(const size_t &idx, const ColumnDef &columnDef,
+	         const ItemData *itemData)
+	{
+		MYSQL_BIND &bind = m_binds[idx];
+		Value &value = m_values[idx];
+		if (itemData->isNull()) {
+			m_nullFlags[idx] = 1;
+			bind.buffer_type = MYSQL_TYPE_NULL;
+			return;
+		}
+
+		// The value is converted by the column type in the same way
+		// as DBAgent::getColumnValueString().
+		switch (columnDef.type) {
+		case SQL_COLUMN_TYPE_INT:
+			value.intValue = static_cast<const int &>(*itemData);
+			bind.buffer_type = MYSQL_TYPE_LONG;
+			bind.buffer = &value.intValue;
+			break;
+		case SQL_COLUMN_TYPE_BIGUINT:
+			value.longlongValue =
+			  static_cast<const uint64_t &>(*itemData);
+			bind.buffer_type = MYSQL_TYPE_LONGLONG;
+			bind.buffer = &value.longlongValue;
+			bind.is_unsigned = 1;
+			break;
+		case SQL_COLUMN_TYPE_VARCHAR:
+		case SQL_COLUMN_TYPE_CHAR:
+		case SQL_COLUMN_TYPE_TEXT:
+		{
+			const string &str = static_cast<const string &>(*itemData);
+			bind.buffer_type = MYSQL_TYPE_STRING;
+			bind.buffer = const_cast<char *>(str.c_str());
+			bind.buffer_length = str.size();
+			m_lengths[idx] = str.size();
+			break;
+		}
+		case SQL_COLUMN_TYPE_DOUBLE:
+		{
+			// The text path rounds a value with decFracLength.
+			const double scale = pow(10.0, columnDef.decFracLength);
+			const double val = static_cast<const double &>(*itemData);
+			value.doubleValue = round(val * scale) / scale;
+			bind.buffer_type = MYSQL_TYPE_DOUBLE;
+			bind.buffer = &value.doubleValue;
+			break;
+		}
+		case SQL_COLUMN_TYPE_DATETIME:
+			setDatetime(bind, value.timeValue,
+			            static_cast<const int &>(*itemData));
+			break;
+		default:
+			HATOHOL_ASSERT(false, "Unknown column type: %d (%s)",
+			               columnDef.type, columnDef.columnName);
+		}
+	}
+
+private:
+	// Same conversion as DBAgent::makeDatetimeString()
+	static void setDatetime(MYSQL_BIND &bind, MYSQL_TIME &mysqlTime,
+	                        const int &datetime)
+	{
+		time_t clock;
+		if (datetime == CURR_DATETIME)
+			time(&clock);
+		else
+			clock = (time_t)datetime;
+		struct tm tm;
+		localtime_r(&clock, &tm);
+
+		memset(&mysqlTime, 0, sizeof(mysqlTime));
+		mysqlTime.year   = 1900 + tm.tm_year;
+		mysqlTime.month  = tm.tm_mon + 1;
+		mysqlTime.day    = tm.tm_mday;
+		mysqlTime.hour   = tm.tm_hour;
+		mysqlTime.minute = tm.tm_min;
+		mysqlTime.second = tm.tm_sec;
+		mysqlTime.time_type = MYSQL_TIMESTAMP_DATETIME;
+		bind.buffer_type = MYSQL_TYPE_DATETIME;
+		bind.buffer = &mysqlTime;
+	}
+};
+} // namespace
+
+bool DBAgentMySQL::insertWithPreparedStatement(const InsertArg &insertArg)
+{
+	const TableProfile &tableProfile = insertArg.tableProfile;
+	const size_t numColumns = tableProfile.numColumns;
+
+	// Values are not embedded. So the statement can be reused for
+	// all rows inserted to the same table in the same way.
+	SeparatorInjector commaInjector(",");
+	string sql = StringUtils::sprintf("INSERT INTO %s (",
+	                                  tableProfile.name);
+	for (size_t i = 0; i < numColumns; i++) {
+		commaInjector(sql);
+		sql += tableProfile.columnDefs[i].columnName;
+	}
+	sql += ") VALUES (";
+	commaInjector.clear();
+	for (size_t i = 0; i < numColumns; i++) {
+		commaInjector(sql);
+		sql += "?";
+	}
+	sql += ")";
+	if (insertArg.upsertOnDuplicate)
+		sql += makeUpsertClause(tableProfile);
+
+	MYSQL_STMT *stmt = m_impl->getStatement(sql);
+	if (!stmt)
+		return false;
+
+	MySQLParamBinder binder(numColumns);
+	for (size_t i = 0; i < numColumns; i++) {
+		binder.set(i, tableProfile.columnDefs[i],
+		           insertArg.row->getItemAt(i));
+	}
+	if (mysql_stmt_bind_param(stmt, binder.getBinds()) ||
+	    mysql_stmt_execute(stmt)) {
+		// Let the text path report the error or reconnect.
+		const unsigned int errorNumber = mysql_stmt_errno(stmt);
+		if (errorNumber != ER_DUP_ENTRY) {
+			MLPL_WARN("Failed to execute: %s: (%u) %s\n",
+			          sql.c_str(), errorNumber,
+			          mysql_stmt_error(stmt));
+			m_impl->closeStatement(sql);
+		}
+		return false;
+	}
+	m_impl->stmtAffectedRows = mysql_stmt_affected_rows(stmt);
+	m_impl->useStmtAffectedRows = true;
+	return true;
+}
+#endif // MYSQL_VERSION_ID >= 50112
+
 string DBAgentMySQL::getColumnValueString(const ColumnDef *columnDef,
 					  const ItemData *itemData)
 {
@@ -54,6 +54,7 @@ public:
 	virtual void execSql(const std::string &sql) override;
 	virtual void createTable(const TableProfile &tableProfile) override;
 	virtual void insert(const InsertArg &insertArg) override;
+	virtual void insertBatch(const InsertBatchArg &insertBatchArg) override;
 	virtual void update(const UpdateArg &updateArg) override;
 	virtual void select(const SelectArg &selectArg) override;
 	virtual void select(const SelectExArg &selectExArg) override;
@@ -88,6 +89,26 @@ protected:
 	bool throwExceptionIfDisposed(void) const;
 	void queryWithRetry(const std::string &statement);
 
+	/**
+	 * Check if the IDs generated by a multi-row INSERT are consecutive.
+	 * It depends on innodb_autoinc_lock_mode. The result is cached
+	 * in the instance.
+	 *
+	 * @return true if the IDs are consecutive.
+	 */
+	bool isAutoIncrementConsecutive(void);
+
+	/**
+	 * Insert a row with a cached prepared statement.
+	 *
+	 * @param insertArg An InsertArg instance.
+	 *
+	 * @return
+	 * true if the row is inserted. Otherwise false is returned and
+	 * the caller should do it with the textual SQL statement.
+	 */
+	bool insertWithPreparedStatement(const InsertArg &insertArg);
+
 	// virtual methods
 	virtual std::string getColumnValueString(
 	  const ColumnDef *columnDef, const ItemData *itemData) override;
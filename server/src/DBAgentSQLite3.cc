@@ -21,6 +21,8 @@
 #include <cstdio>
 #include <stdarg.h>
 #include <inttypes.h>
+#include <cmath>
+#include <map>
 #include <gio/gio.h>
 #include <Mutex.h>
 #include <Logger.h>
@@ -33,6 +35,7 @@ using namespace mlpl;
 #include "ConfigManager.h"
 
 const static int TRANSACTION_TIME_OUT_MSEC = 30 * 1000;
+const static size_t MAX_PREPARED_STATEMENTS = 128;
 const char *DBAgentSQLite3::DEFAULT_DB_NAME = "DBAgentSQLite3-default";
 static __thread bool tls_lastUpsertDidUpdate = false;
 
@@ -59,6 +62,8 @@ struct DBAgentSQLite3::Impl {
 
 	string        dbPath;
 	sqlite3      *db;
+	// Prepared statements keyed by the SQL text
+	map<string, sqlite3_stmt *> stmtMap;
 
 	// methods
 	Impl(void)
@@ -68,6 +73,8 @@ struct DBAgentSQLite3::Impl {
 
 	~Impl(void)
 	{
+		// All statements have to be finalized before sqlite3_close()
+		clearStatements();
 		if (!db)
 			return;
 		int result = sqlite3_close(db);
@@ -76,6 +83,13 @@ struct DBAgentSQLite3::Impl {
 			MLPL_ERR("Failed to close sqlite: %d\n", result);
 		}
 	}
+
+	void clearStatements(void)
+	{
+		for (auto &sqlStmt : stmtMap)
+			sqlite3_finalize(sqlStmt.second);
+		stmtMap.clear();
+	}
 };
 
 DBTermCodecSQLite3 DBAgentSQLite3::Impl::dbTermCodec;
@@ -213,7 +227,30 @@ void DBAgentSQLite3::createTable(const TableProfile &tableProfile)
 void DBAgentSQLite3::insert(const DBAgent::InsertArg &insertArg)
 {
 	HATOHOL_ASSERT(m_impl->db, "m_impl->db is NULL");
-	insert(m_impl->db, insertArg);
+	if (isPreparedStatementEnabled())
+		insertWithPreparedStatement(insertArg);
+	else
+		insert(m_impl->db, insertArg);
+}
+
+void DBAgentSQLite3::insertBatch(const InsertBatchArg &insertBatchArg)
+{
+	HATOHOL_ASSERT(m_impl->db, "m_impl->db is NULL");
+	// SQLite3 on the supported platforms doesn't have
+	// 'ON CONFLICT DO UPDATE'. Since an upsert is emulated by an UPDATE
+	// after the INSERT failed, rows that may conflict are inserted
+	// one by one. It's not so expensive because there's no round trip.
+	if (insertBatchArg.upsertOnDuplicate &&
+	    !insertBatchArg.isInsertIdAssignable()) {
+		DBAgent::insertBatch(insertBatchArg);
+		return;
+	}
+#if SQLITE_VERSION_NUMBER >= 3007011
+	insertBatch(m_impl->db, insertBatchArg);
+#else
+	// Multiple rows in VALUES is supported since 3.7.11.
+	DBAgent::insertBatch(insertBatchArg);
+#endif
 }
 
 void DBAgentSQLite3::update(const UpdateArg &updateArg)
@@ -231,7 +268,26 @@ void DBAgentSQLite3::select(const SelectArg &selectArg)
 void DBAgentSQLite3::select(const SelectExArg &selectExArg)
 {
 	HATOHOL_ASSERT(m_impl->db, "m_impl->db is NULL");
-	select(m_impl->db, selectExArg);
+	if (!isPreparedStatementEnabled()) {
+		select(m_impl->db, selectExArg);
+		return;
+	}
+
+	sqlite3_stmt *stmt = getPreparedStatement(
+	                       makeSelectStatement(selectExArg));
+	int result;
+	try {
+		result = selectGetValues(selectExArg, stmt);
+	} catch (...) {
+		sqlite3_reset(stmt);
+		throw;
+	}
+	sqlite3_reset(stmt);
+	if (result != SQLITE_DONE) {
+		THROW_HATOHOL_EXCEPTION("Failed to call sqlite3_step(): %d",
+		                      result);
+	}
+	checkSelectResult(selectExArg);
 }
 
 void DBAgentSQLite3::deleteRows(const DeleteArg &deleteArg)
@@ -530,24 +586,16 @@ string DBAgentSQLite3::getColumnValueStringStatic(const ColumnDef *columnDef,
 	return valueStr;
 }
 
-void DBAgentSQLite3::insert(sqlite3 *db, const DBAgent::InsertArg &insertArg)
+string DBAgentSQLite3::makeValuesString(const TableProfile &tableProfile,
+                                        const ItemGroup *row)
 {
-	size_t numColumns = insertArg.row->getNumberOfItems();
-	HATOHOL_ASSERT(numColumns == insertArg.tableProfile.numColumns,
-	               "Invalid number of columns: %zd, %zd",
-	               numColumns, insertArg.tableProfile.numColumns);
-
-	// make a SQL statement
-	string sql = "INSERT ";
-	sql += "INTO ";
-	sql += insertArg.tableProfile.name;
-	sql += " VALUES (";
+	const size_t numColumns = row->getNumberOfItems();
+	string sql = "(";
 	for (size_t i = 0; i < numColumns; i++) {
 		if (i > 0)
 			sql += ",";
-		const ColumnDef &columnDef =
-		  insertArg.tableProfile.columnDefs[i];
-		const ItemData *itemData = insertArg.row->getItemAt(i);
+		const ColumnDef &columnDef = tableProfile.columnDefs[i];
+		const ItemData *itemData = row->getItemAt(i);
 		string valueStr;
 		if (itemData->isNull()) {
 			valueStr = "NULL";
@@ -563,6 +611,22 @@ void DBAgentSQLite3::insert(sqlite3 *db, const DBAgent::InsertArg &insertArg)
 		sql += valueStr;
 	}
 	sql += ")";
+	return sql;
+}
+
+void DBAgentSQLite3::insert(sqlite3 *db, const DBAgent::InsertArg &insertArg)
+{
+	size_t numColumns = insertArg.row->getNumberOfItems();
+	HATOHOL_ASSERT(numColumns == insertArg.tableProfile.numColumns,
+	               "Invalid number of columns: %zd, %zd",
+	               numColumns, insertArg.tableProfile.numColumns);
+
+	// make a SQL statement
+	string sql = "INSERT ";
+	sql += "INTO ";
+	sql += insertArg.tableProfile.name;
+	sql += " VALUES ";
+	sql += makeValuesString(insertArg.tableProfile, insertArg.row);
 
 	// exectute the SQL statement
 	char *errmsg;
@@ -588,6 +652,209 @@ void DBAgentSQLite3::insert(sqlite3 *db, const DBAgent::InsertArg &insertArg)
 	tls_lastUpsertDidUpdate = false;
 }
 
+void DBAgentSQLite3::insertBatch(sqlite3 *db,
+                                 const InsertBatchArg &insertBatchArg)
+{
+	const TableProfile &tableProfile = insertBatchArg.tableProfile;
+	const bool assignInsertIds = insertBatchArg.isInsertIdAssignable();
+	insertBatchArg.insertIds.clear();
+
+	// Multiple rows in VALUES are processed as a compound SELECT.
+	size_t maxRows = insertBatchArg.maxRowsPerStatement;
+	const int compoundLimit =
+	  sqlite3_limit(db, SQLITE_LIMIT_COMPOUND_SELECT, -1);
+	if (compoundLimit > 0 && maxRows > (size_t)compoundLimit)
+		maxRows = compoundLimit;
+
+	string header = "INSERT INTO ";
+	header += tableProfile.name;
+	header += " VALUES ";
+
+	string sql;
+	size_t numRowsInQuery = 0;
+	auto flush = [&] {
+		if (numRowsInQuery == 0)
+			return;
+		_execSql(db, sql);
+		if (assignInsertIds) {
+			// sqlite3_last_insert_rowid() returns the ID of
+			// the last row.
+			const uint64_t firstId =
+			  getLastInsertId(db) - numRowsInQuery + 1;
+			for (size_t i = 0; i < numRowsInQuery; i++)
+				insertBatchArg.insertIds.push_back(firstId + i);
+		}
+		sql.clear();
+		numRowsInQuery = 0;
+	};
+
+	for (const auto &row : insertBatchArg.rows) {
+		HATOHOL_ASSERT(
+		  row->getNumberOfItems() == tableProfile.numColumns,
+		  "Invalid number of columns: %zd, %zd",
+		  row->getNumberOfItems(), tableProfile.numColumns);
+		const string values = makeValuesString(tableProfile, row);
+		const size_t expectedSize = sql.size() + 1 + values.size();
+		if (numRowsInQuery >= maxRows ||
+		    expectedSize > insertBatchArg.maxBytesPerStatement)
+			flush();
+
+		if (numRowsInQuery == 0)
+			sql = header;
+		else
+			sql += ",";
+		sql += values;
+		numRowsInQuery++;
+	}
+	flush();
+	tls_lastUpsertDidUpdate = false;
+}
+
+void DBAgentSQLite3::insertWithPreparedStatement(
+  const DBAgent::InsertArg &insertArg)
+{
+	const TableProfile &tableProfile = insertArg.tableProfile;
+	size_t numColumns = insertArg.row->getNumberOfItems();
+	HATOHOL_ASSERT(numColumns == tableProfile.numColumns,
+	               "Invalid number of columns: %zd, %zd",
+	               numColumns, tableProfile.numColumns);
+
+	// The statement only depends on the table, so it's reused for
+	// all rows inserted to the table.
+	string sql = "INSERT INTO ";
+	sql += tableProfile.name;
+	sql += " VALUES (";
+	for (size_t i = 0; i < numColumns; i++)
+		sql += (i == 0) ? "?" : ",?";
+	sql += ")";
+
+	sqlite3 *db = m_impl->db;
+	sqlite3_stmt *stmt = getPreparedStatement(sql);
+	bindValues(stmt, tableProfile, insertArg.row);
+	const int result = sqlite3_step(stmt);
+	const bool duplicated = (result == SQLITE_CONSTRAINT) &&
+	                        isPrimaryOrUniqueKeyDuplicated(db);
+	const string errmsg = (result == SQLITE_DONE) ? "" : sqlite3_errmsg(db);
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+
+	if (insertArg.upsertOnDuplicate && duplicated) {
+		// See the comment in insert(sqlite3 *, const InsertArg &).
+		update(db, insertArg);
+		tls_lastUpsertDidUpdate = true;
+		return;
+	}
+	if (result != SQLITE_DONE) {
+		THROW_HATOHOL_EXCEPTION("Failed to exec: %d, %s, %s",
+		                      result, errmsg.c_str(), sql.c_str());
+	}
+	tls_lastUpsertDidUpdate = false;
+}
+
+sqlite3_stmt *DBAgentSQLite3::getPreparedStatement(const string &sql)
+{
+	auto it = m_impl->stmtMap.find(sql);
+	if (it != m_impl->stmtMap.end()) {
+		sqlite3_stmt *stmt = it->second;
+		sqlite3_reset(stmt);
+		sqlite3_clear_bindings(stmt);
+		return stmt;
+	}
+
+	// SELECT statements embed their conditions. So the number of
+	// them can grow without limit.
+	if (m_impl->stmtMap.size() >= MAX_PREPARED_STATEMENTS)
+		m_impl->clearStatements();
+
+	sqlite3_stmt *stmt = NULL;
+	int result = sqlite3_prepare_v2(m_impl->db, sql.c_str(), sql.size(),
+	                                &stmt, NULL);
+	if (result != SQLITE_OK) {
+		sqlite3_finalize(stmt);
+		THROW_HATOHOL_EXCEPTION(
+		  "Failed to call sqlite3_prepare_v2(): %d, %s, %s",
+		  result, sqlite3_errmsg(m_impl->db), sql.c_str());
+	}
+	m_impl->stmtMap[sql] = stmt;
+	return stmt;
+}
+
+void DBAgentSQLite3::bindValues(sqlite3_stmt *stmt,
+                                const TableProfile &tableProfile,
+                                const ItemGroup *row)
+{
+	for (size_t i = 0; i < row->getNumberOfItems(); i++) {
+		const ColumnDef &columnDef = tableProfile.columnDefs[i];
+		const ItemData *itemData = row->getItemAt(i);
+		const int index = i + 1;
+		int result = SQLITE_OK;
+		if (itemData->isNull()) {
+			result = sqlite3_bind_null(stmt, index);
+		} else if ((columnDef.flags & SQL_COLUMN_FLAG_AUTO_INC) &&
+		           isAutoIncrementValue(itemData)) {
+			// Same as makeValuesString()
+			result = sqlite3_bind_null(stmt, index);
+		} else {
+			// The value is converted by the column type in the
+			// same way as getColumnValueStringStatic().
+			switch (columnDef.type) {
+			case SQL_COLUMN_TYPE_INT:
+				result = sqlite3_bind_int(stmt, index,
+				  static_cast<const int &>(*itemData));
+				break;
+			case SQL_COLUMN_TYPE_BIGUINT:
+				result = sqlite3_bind_int64(stmt, index,
+				  static_cast<const uint64_t &>(*itemData));
+				break;
+			case SQL_COLUMN_TYPE_VARCHAR:
+			case SQL_COLUMN_TYPE_CHAR:
+			case SQL_COLUMN_TYPE_TEXT:
+			{
+				// The row lives until sqlite3_step() finishes.
+				const string &str =
+				  static_cast<const string &>(*itemData);
+				result = sqlite3_bind_text(stmt, index,
+				                           str.c_str(), str.size(),
+				                           SQLITE_STATIC);
+				break;
+			}
+			case SQL_COLUMN_TYPE_DOUBLE:
+			{
+				// The text path rounds a value with
+				// decFracLength.
+				const double scale =
+				  pow(10.0, columnDef.decFracLength);
+				const double val =
+				  static_cast<const double &>(*itemData);
+				result = sqlite3_bind_double(stmt, index,
+				  round(val * scale) / scale);
+				break;
+			}
+			case SQL_COLUMN_TYPE_DATETIME:
+			{
+				// Strip the quotes
+				const string datetime =
+				  makeDatetimeString(*itemData);
+				result = sqlite3_bind_text(stmt, index,
+				                           datetime.c_str() + 1,
+				                           datetime.size() - 2,
+				                           SQLITE_TRANSIENT);
+				break;
+			}
+			default:
+				HATOHOL_ASSERT(false,
+				  "Unknown column type: %d (%s)",
+				  columnDef.type, columnDef.columnName);
+			}
+		}
+		if (result != SQLITE_OK) {
+			THROW_HATOHOL_EXCEPTION(
+			  "Failed to call sqlite3_bind_*(): %d, %s",
+			  result, columnDef.columnName);
+		}
+	}
+}
+
 // TODO: Should be unified with DBAgent::makeUpdateStatement()
 string DBAgentSQLite3::makeUpdateStatementStatic(const UpdateArg &updateArg)
 {
@@ -736,12 +1003,33 @@ void DBAgentSQLite3::select(sqlite3 *db, const SelectExArg &selectExArg)
 	}
 
 	sqlite3_reset(stmt);
-	if (result != SQLITE_OK) {
-		sqlite3_finalize(stmt);
-		THROW_HATOHOL_EXCEPTION("Failed to call sqlite3_bind(): %d",
+	result = selectGetValues(selectExArg, stmt);
+	sqlite3_finalize(stmt);
+	if (result != SQLITE_DONE) {
+		THROW_HATOHOL_EXCEPTION("Failed to call sqlite3_step(): %d",
 		                      result);
 	}
+	checkSelectResult(selectExArg);
+}
+
+int DBAgentSQLite3::selectGetValues(const SelectExArg &selectExArg,
+                                    sqlite3_stmt *stmt)
+{
+	int result;
 	size_t numColumns = selectExArg.statements.size();
+	if (selectExArg.useColumnarTable) {
+		ColumnarTablePtr table(
+		  new ColumnarTable(selectExArg.columnTypes));
+		while ((result = sqlite3_step(stmt)) == SQLITE_ROW) {
+			for (size_t index = 0; index < numColumns; index++) {
+				addValue(*table, stmt, index,
+				         selectExArg.columnTypes[index]);
+			}
+		}
+		selectExArg.columnarTable = table;
+		return result;
+	}
+
 	VariableItemTablePtr dataTable;
 	while ((result = sqlite3_step(stmt)) == SQLITE_ROW) {
 		VariableItemGroupPtr itemGroup;
@@ -753,14 +1041,14 @@ void DBAgentSQLite3::select(sqlite3 *db, const SelectExArg &selectExArg)
 		dataTable->add(itemGroup);
 	}
 	selectExArg.dataTable = dataTable;
-	if (result != SQLITE_DONE) {
-		sqlite3_finalize(stmt);
-		THROW_HATOHOL_EXCEPTION("Failed to call sqlite3_step(): %d",
-		                      result);
-	}
-	sqlite3_finalize(stmt);
+	return result;
+}
 
-	// check the result
+void DBAgentSQLite3::checkSelectResult(const SelectExArg &selectExArg)
+{
+	if (selectExArg.useColumnarTable)
+		return;
+	size_t numColumns = selectExArg.statements.size();
 	size_t numTableRows = selectExArg.dataTable->getNumberOfRows();
 	size_t numTableColumns = selectExArg.dataTable->getNumberOfColumns();
 	HATOHOL_ASSERT((numTableRows == 0) ||
@@ -883,6 +1171,45 @@ ItemDataPtr DBAgentSQLite3::getValue(sqlite3_stmt *stmt,
 	return ItemDataPtr(itemData, false);
 }
 
+// Same conversion as getValue()
+void DBAgentSQLite3::addValue(ColumnarTable &table, sqlite3_stmt *stmt,
+                              size_t index, SQLColumnType columnType)
+{
+	if (sqlite3_column_type(stmt, index) == SQLITE_NULL) {
+		table.addNull();
+		return;
+	}
+
+	switch (columnType) {
+	case SQL_COLUMN_TYPE_INT:
+	case SQL_COLUMN_TYPE_DATETIME:
+		table.addInt(sqlite3_column_int(stmt, index));
+		break;
+
+	case SQL_COLUMN_TYPE_BIGUINT:
+		table.addUint64(sqlite3_column_int64(stmt, index));
+		break;
+
+	case SQL_COLUMN_TYPE_VARCHAR:
+	case SQL_COLUMN_TYPE_CHAR:
+	case SQL_COLUMN_TYPE_TEXT:
+	{
+		const char *str =
+		  (const char *)sqlite3_column_text(stmt, index);
+		const int length = sqlite3_column_bytes(stmt, index);
+		table.addString(str ? : "", str ? length : 0);
+		break;
+	}
+
+	case SQL_COLUMN_TYPE_DOUBLE:
+		table.addDouble(sqlite3_column_double(stmt, index));
+		break;
+
+	default:
+		HATOHOL_ASSERT(false, "Unknown column type: %d", columnType);
+	}
+}
+
 void DBAgentSQLite3::createIndexIfNotExistsEach(
   sqlite3 *db, const TableProfile &tableProfile, const string &indexName,
   const vector<size_t> &targetIndexes, const bool &isUniqueKey)
@@ -53,6 +53,7 @@ public:
 	virtual void execSql(const std::string &sql) override;
 	virtual void createTable(const TableProfile &tableProfile) override;
 	virtual void insert(const InsertArg &insertArg) override;
+	virtual void insertBatch(const InsertBatchArg &insertBatchArg) override;
 	virtual void update(const UpdateArg &updateArg) override;
 	virtual void select(const SelectArg &selectArg) override;
 	virtual void select(const SelectExArg &selectExArg) override;
@@ -88,19 +89,31 @@ protected:
 	static std::string getColumnValueStringStatic(const ColumnDef *columnDef,
 						      const ItemData *itemData);
 	static std::string makeUpdateStatementStatic(const UpdateArg &updateArg);
+	static std::string makeValuesString(const TableProfile &tableProfile,
+	                                    const ItemGroup *row);
 	static void insert(sqlite3 *db, const InsertArg &insertArg);
+	static void insertBatch(sqlite3 *db,
+	                        const InsertBatchArg &insertBatchArg);
 	static void update(sqlite3 *db, const UpdateArg &updateArg);
 	static void update(sqlite3 *db, const InsertArg &updateArg);
 	static void select(sqlite3 *db, const SelectArg &selectArg);
 	static void select(sqlite3 *db, const SelectExArg &selectExArg);
+	static int selectGetValues(const SelectExArg &selectExArg,
+	                           sqlite3_stmt *stmt);
+	static void checkSelectResult(const SelectExArg &selectExArg);
 	static void deleteRows(sqlite3 *db, const DeleteArg &deleteArg);
 	static void selectGetValuesIteration(const SelectArg &selectArg,
 	                                     sqlite3_stmt *stmt,
 	                                     VariableItemTablePtr &dataTable);
 	static uint64_t getLastInsertId(sqlite3 *db);
 	static uint64_t getNumberOfAffectedRows(sqlite3 *db);
+	static void bindValues(sqlite3_stmt *stmt,
+	                       const TableProfile &tableProfile,
+	                       const ItemGroup *row);
 	static ItemDataPtr getValue(sqlite3_stmt *stmt, size_t index,
 	                            SQLColumnType columnType);
+	static void addValue(ColumnarTable &table, sqlite3_stmt *stmt,
+	                     size_t index, SQLColumnType columnType);
 	static void createIndexIfNotExistsEach(
 	  sqlite3 *db, const TableProfile &tableProfile,
 	  const std::string &indexName,
@@ -108,6 +121,19 @@ protected:
 
 	void openDatabase(void);
 	void execSql(const char *fmt, ...);
+	void insertWithPreparedStatement(const InsertArg &insertArg);
+
+	/**
+	 * Get a prepared statement for the SQL from the cache.
+	 * It is prepared and cached if it hasn't been.
+	 *
+	 * @param sql A SQL statement.
+	 *
+	 * @return
+	 * A prepared statement that has been reset. It is owned by this
+	 * object and must not be finalized by the caller.
+	 */
+	sqlite3_stmt *getPreparedStatement(const std::string &sql);
 
 	// virtual methods
 	virtual std::string getColumnValueString(
@@ -18,6 +18,7 @@
  */
 
 #include <exception>
+#include <mutex>
 #include <SeparatorInjector.h>
 #include "Utils.h"
 #include "ConfigManager.h"
@@ -29,6 +30,7 @@
 #include "ItemGroupStream.h"
 #include "UnifiedDataStore.h"
 #include "DBTermCStringProvider.h"
+#include "ActionMatcher.h"
 using namespace std;
 using namespace mlpl;
 
@@ -350,6 +352,13 @@ static bool updateDB(
 
 struct DBTablesAction::Impl
 {
+	// The index for getActionListForEvent(). It is shared by all
+	// instances (threads). 'matcherGeneration' is incremented on every
+	// invalidation so that a matcher built from old data is not cached.
+	static std::mutex                        matcherMutex;
+	static shared_ptr<const ActionMatcher>   matcher;
+	static uint64_t                          matcherGeneration;
+
 	Impl(void)
 	{
 	}
@@ -359,6 +368,10 @@ struct DBTablesAction::Impl
 	}
 };
 
+std::mutex                      DBTablesAction::Impl::matcherMutex;
+shared_ptr<const ActionMatcher> DBTablesAction::Impl::matcher;
+uint64_t                        DBTablesAction::Impl::matcherGeneration = 0;
+
 struct deleteInvalidActionsContext {
 	guint timerId;
 	guint idleEventId;
@@ -392,6 +405,7 @@ void DBTablesAction::init(void)
 void DBTablesAction::reset(void)
 {
 	getSetupInfo().initialized = false;
+	invalidateActionMatcher();
 }
 
 const DBTables::SetupInfo &DBTablesAction::getConstSetupInfo(void)
@@ -465,6 +479,7 @@ HatoholError DBTablesAction::addAction(ActionDef &actionDef,
 	arg.add(ownerUserId);
 
 	getDBAgent().runTransaction(arg, actionDef.id);
+	invalidateActionMatcher();
 	return HTERR_OK;
 }
 
@@ -514,13 +529,12 @@ HatoholError DBTablesAction::updateAction(ActionDef &actionDef,
 	arg.add(IDX_ACTIONS_OWNER_USER_ID, ownerUserId);
 
 	getDBAgent().runTransaction(arg);
+	invalidateActionMatcher();
 	return HTERR_OK;
 }
 
-HatoholError DBTablesAction::getActionList(ActionDefList &actionDefList,
-					   const ActionsQueryOption &option)
+static void addActionDefColumns(DBAgent::SelectExArg &arg)
 {
-	DBAgent::SelectExArg arg(tableProfileActions);
 	arg.add(IDX_ACTIONS_ACTION_ID);
 	arg.add(IDX_ACTIONS_SERVER_ID);
 	arg.add(IDX_ACTIONS_HOST_ID);
@@ -534,6 +548,51 @@ HatoholError DBTablesAction::getActionList(ActionDefList &actionDefList,
 	arg.add(IDX_ACTIONS_WORKING_DIR);
 	arg.add(IDX_ACTIONS_TIMEOUT);
 	arg.add(IDX_ACTIONS_OWNER_USER_ID);
+}
+
+static void readActionDef(ItemGroupStream &itemGroupStream,
+                          ActionDef &actionDef)
+{
+	itemGroupStream >> actionDef.id;
+
+	// conditions
+	if (!itemGroupStream.getItem()->isNull())
+		actionDef.condition.enable(ACTCOND_SERVER_ID);
+	itemGroupStream >> actionDef.condition.serverId;
+
+	if (!itemGroupStream.getItem()->isNull())
+		actionDef.condition.enable(ACTCOND_HOST_ID);
+	itemGroupStream >> actionDef.condition.hostIdInServer;
+
+	if (!itemGroupStream.getItem()->isNull())
+		actionDef.condition.enable(ACTCOND_HOST_GROUP_ID);
+	itemGroupStream >> actionDef.condition.hostgroupId;
+
+	if (!itemGroupStream.getItem()->isNull())
+		actionDef.condition.enable(ACTCOND_TRIGGER_ID);
+	itemGroupStream >> actionDef.condition.triggerId;
+
+	if (!itemGroupStream.getItem()->isNull())
+		actionDef.condition.enable(ACTCOND_TRIGGER_STATUS);
+	itemGroupStream >> actionDef.condition.triggerStatus;
+
+	if (!itemGroupStream.getItem()->isNull())
+		actionDef.condition.enable(ACTCOND_TRIGGER_SEVERITY);
+	itemGroupStream >> actionDef.condition.triggerSeverity;
+
+	itemGroupStream >> actionDef.condition.triggerSeverityCompType;
+	itemGroupStream >> actionDef.type;
+	itemGroupStream >> actionDef.command;
+	itemGroupStream >> actionDef.workingDir;
+	itemGroupStream >> actionDef.timeout;
+	itemGroupStream >> actionDef.ownerUserId;
+}
+
+HatoholError DBTablesAction::getActionList(ActionDefList &actionDefList,
+					   const ActionsQueryOption &option)
+{
+	DBAgent::SelectExArg arg(tableProfileActions);
+	addActionDefColumns(arg);
 
 	// condition
 	arg.condition = option.getCondition();
@@ -557,46 +616,68 @@ HatoholError DBTablesAction::getActionList(ActionDefList &actionDefList,
 	for (; itemGrpItr != grpList.end(); ++itemGrpItr) {
 		ItemGroupStream itemGroupStream(*itemGrpItr);
 		ActionDef actionDef;
+		readActionDef(itemGroupStream, actionDef);
+		if (validator.isValid(actionDef))
+			actionDefList.push_back(actionDef);
+	}
 
-		itemGroupStream >> actionDef.id;
-
-		// conditions
-		if (!itemGroupStream.getItem()->isNull())
-			actionDef.condition.enable(ACTCOND_SERVER_ID);
-		itemGroupStream >> actionDef.condition.serverId;
-
-		if (!itemGroupStream.getItem()->isNull())
-			actionDef.condition.enable(ACTCOND_HOST_ID);
-		itemGroupStream >> actionDef.condition.hostIdInServer;
-
-		if (!itemGroupStream.getItem()->isNull())
-			actionDef.condition.enable(ACTCOND_HOST_GROUP_ID);
-		itemGroupStream >> actionDef.condition.hostgroupId;
+	return HTERR_OK;
+}
 
-		if (!itemGroupStream.getItem()->isNull())
-			actionDef.condition.enable(ACTCOND_TRIGGER_ID);
-		itemGroupStream >> actionDef.condition.triggerId;
+void DBTablesAction::getActionListForEvent(ActionDefList &actionDefList,
+                                           const EventInfo &eventInfo)
+{
+	shared_ptr<const ActionMatcher> matcher;
+	uint64_t generation;
+	{
+		lock_guard<std::mutex> lock(Impl::matcherMutex);
+		matcher = Impl::matcher;
+		generation = Impl::matcherGeneration;
+	}
 
-		if (!itemGroupStream.getItem()->isNull())
-			actionDef.condition.enable(ACTCOND_TRIGGER_STATUS);
-		itemGroupStream >> actionDef.condition.triggerStatus;
+	if (!matcher) {
+		DBAgent::SelectExArg arg(tableProfileActions);
+		addActionDefColumns(arg);
+		getDBAgent().runTransaction(arg);
+
+		ActionDefList allActionDefs;
+		const ItemGroupList &grpList =
+		  arg.dataTable->getItemGroupList();
+		for (const auto &itemGrp : grpList) {
+			ItemGroupStream itemGroupStream(itemGrp);
+			allActionDefs.push_back(ActionDef());
+			readActionDef(itemGroupStream, allActionDefs.back());
+		}
+		matcher = make_shared<const ActionMatcher>(allActionDefs);
 
-		if (!itemGroupStream.getItem()->isNull())
-			actionDef.condition.enable(ACTCOND_TRIGGER_SEVERITY);
-		itemGroupStream >> actionDef.condition.triggerSeverity;
+		lock_guard<std::mutex> lock(Impl::matcherMutex);
+		if (generation == Impl::matcherGeneration)
+			Impl::matcher = matcher;
+	}
 
-		itemGroupStream >> actionDef.condition.triggerSeverityCompType;
-		itemGroupStream >> actionDef.type;
-		itemGroupStream >> actionDef.command;
-		itemGroupStream >> actionDef.workingDir;
-		itemGroupStream >> actionDef.timeout;
-		itemGroupStream >> actionDef.ownerUserId;
+	auto getHostgroupIdSet = [](HostgroupIdSet &hostgroupIdSet,
+	                            const EventInfo &event) {
+		HostgroupMemberVect hostgrpMembers;
+		HostgroupMembersQueryOption option(USER_ID_SYSTEM);
+		option.setTargetServerId(event.serverId);
+		option.setTargetHostId(event.hostIdInServer);
+		UnifiedDataStore *uds = UnifiedDataStore::getInstance();
+		uds->getHostgroupMembers(hostgrpMembers, option);
+		for (const auto &hostgrpMember : hostgrpMembers)
+			hostgroupIdSet.insert(hostgrpMember.hostgroupIdInServer);
+	};
+	ActionDefList matchedActionDefs;
+	matcher->match(matchedActionDefs, eventInfo, getHostgroupIdSet);
+	if (matchedActionDefs.empty())
+		return;
 
+	// Owners and incident trackers can be deleted without touching
+	// the actions table. So they are checked every time.
+	ActionValidator validator;
+	for (auto &actionDef : matchedActionDefs) {
 		if (validator.isValid(actionDef))
-			actionDefList.push_back(actionDef);
+			actionDefList.push_back(move(actionDef));
 	}
-
-	return HTERR_OK;
 }
 
 static string makeIdListCondition(const ActionIdList &idList)
@@ -691,6 +772,7 @@ HatoholError DBTablesAction::deleteActions(const ActionIdList &idList,
 	} trx;
 	trx.arg.condition = makeConditionForDelete(idList, privilege);
 	getDBAgent().runTransaction(trx);
+	invalidateActionMatcher();
 
 	// Check the result
 	if (trx.numAffectedRows != idList.size()) {
@@ -1153,6 +1235,13 @@ gboolean DBTablesAction::deleteInvalidActionsCycl(gpointer data)
 	return G_SOURCE_REMOVE;
 }
 
+void DBTablesAction::invalidateActionMatcher(void)
+{
+	lock_guard<std::mutex> lock(Impl::matcherMutex);
+	Impl::matcher.reset();
+	Impl::matcherGeneration++;
+}
+
 void DBTablesAction::stopIdleDeleteAction(gpointer data)
 {
 	if (g_deleteActionCtx->timerId != INVALID_EVENT_ID)
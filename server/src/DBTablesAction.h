@@ -297,6 +297,20 @@ public:
 	                       const OperationPrivilege &privilege);
 	HatoholError getActionList(ActionDefList &actionDefList,
 	                           const ActionsQueryOption &option);
+
+	/**
+	 * Get actions whose conditions match the event.
+	 *
+	 * The result is the same as getActionList() with USER_ID_SYSTEM,
+	 * ACTION_ALL and ActionsQueryOption::setTargetEventInfo(). However,
+	 * the actions are read from the DB only once and matched with an
+	 * in-memory index until any action is added, updated or deleted.
+	 *
+	 * @param actionDefList Matched actions are added to this list.
+	 * @param eventInfo A target event.
+	 */
+	void getActionListForEvent(ActionDefList &actionDefList,
+	                           const EventInfo &eventInfo);
 	HatoholError deleteActions(const ActionIdList &idList,
 	                           const OperationPrivilege &privilege);
 	HatoholError updateAction(ActionDef &actionDef,
@@ -421,6 +435,12 @@ protected:
 
 	static void stopIdleDeleteAction(gpointer data);
 
+	/**
+	 * Discard the in-memory index for getActionListForEvent(). It's
+	 * called whenever the actions table is modified.
+	 */
+	static void invalidateActionMatcher(void);
+
 private:
 	struct Impl;
 	std::unique_ptr<Impl> m_impl;
@@ -23,6 +23,7 @@
 #include <Mutex.h>
 #include "DBAgentFactory.h"
 #include "DBTablesConfig.h"
+#include "AuthorizationCache.h"
 #include "ThreadLocalDBCache.h"
 #include "ConfigManager.h"
 #include "HatoholError.h"
@@ -871,10 +872,8 @@ string ServerQueryOption::getCondition(void) const
 		return condition;
 
 	// check allowed servers
-	ThreadLocalDBCache cache;
-	DBTablesUser &dbUser = cache.getUser();
-	ServerHostGrpSetMap srvHostGrpSetMap;
-	dbUser.getServerHostGrpSetMap(srvHostGrpSetMap, getUserId());
+	const ServerHostGrpSetMap &srvHostGrpSetMap =
+	  getDataQueryContext().getServerHostGrpSetMap();
 
 	size_t numServers = srvHostGrpSetMap.size();
 	if (numServers == 0) {
@@ -969,6 +968,7 @@ string IncidentTrackerQueryOption::getCondition(void) const
 void DBTablesConfig::reset(void)
 {
 	getSetupInfo().initialized = false;
+	AuthorizationCache::invalidate();
 }
 
 // TODO: Remove this method after replaced our conventional Arm such
@@ -1223,6 +1223,7 @@ HatoholError DBTablesConfig::addTargetServer(
 		}
 	} trx(this, monitoringServerInfo, armPluginInfo);
 	getDBAgent().runTransaction(trx);
+	AuthorizationCache::invalidate();
 	return trx.err;
 }
 
@@ -1302,6 +1303,7 @@ HatoholError DBTablesConfig::updateTargetServer(
 	   StringUtils::sprintf("id=%u", monitoringServerInfo.id);
 
 	getDBAgent().runTransaction(trx);
+	AuthorizationCache::invalidate();
 	return trx.err;
 }
 
@@ -1334,6 +1336,7 @@ HatoholError DBTablesConfig::deleteTargetServer(
 	                        serverId);
 	preprocForDeleteArmPluginInfo(serverId, trx.argArmPlugins.condition);
 	getDBAgent().runTransaction(trx);
+	AuthorizationCache::invalidate();
 	return HTERR_OK;
 }
 
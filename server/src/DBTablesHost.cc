@@ -1284,6 +1284,32 @@ bool DBTablesHost::isAccessible(
 	return false;
 }
 
+static void setServerHostDefCondition(DBAgent::SelectExArg &arg,
+                                      const HostsQueryOption &option)
+{
+	if (!option.isHostgroupUsed()) {
+		arg.condition = option.getCondition();
+		return;
+	}
+
+	// TODO: FIX This low level implementation is temporary
+	// We should make a framework to use a sub query
+	string matchCond = StringUtils::sprintf("%s=%s",
+	  tableProfileServerHostDef.getFullColumnName(
+	    IDX_HOST_SERVER_HOST_DEF_HOST_ID).c_str(),
+	  tableProfileHostgroupMember.getFullColumnName(
+	    IDX_HOSTGROUP_MEMBER_HOST_ID).c_str());
+
+	arg.tableField = tableProfileServerHostDef.name;
+	arg.condition = "EXISTS (SELECT * from ";
+	arg.condition += tableProfileHostgroupMember.name;
+	arg.condition += " WHERE (";
+	arg.condition += matchCond;
+	arg.condition += ") AND (";
+	arg.condition += option.getCondition();
+	arg.condition += "))";
+}
+
 HatoholError DBTablesHost::getServerHostDefs(
   ServerHostDefVect &svHostDefVect, const HostsQueryOption &option)
 {
@@ -1303,26 +1329,7 @@ HatoholError DBTablesHost::getServerHostDefs(
 	}
 
 	DBAgent::SelectExArg &arg = builder.build();
-	if (option.isHostgroupUsed()) {
-		// TODO: FIX This low level implementation is temporary
-		// We should make a framework to use a sub query
-		string matchCond = StringUtils::sprintf("%s=%s",
-		  tableProfileServerHostDef.getFullColumnName(
-		    IDX_HOST_SERVER_HOST_DEF_HOST_ID).c_str(),
-		  tableProfileHostgroupMember.getFullColumnName(
-		    IDX_HOSTGROUP_MEMBER_HOST_ID).c_str());
-
-		arg.tableField = tableProfileServerHostDef.name;
-		arg.condition = "EXISTS (SELECT * from ";
-		arg.condition += tableProfileHostgroupMember.name;
-		arg.condition += " WHERE (";
-		arg.condition += matchCond;
-		arg.condition += ") AND (";
-		arg.condition += option.getCondition();
-		arg.condition += "))";
-	} else {
-		arg.condition = option.getCondition();
-	}
+	setServerHostDefCondition(arg, option);
 	getDBAgent().runTransaction(arg);
 
 	// get the result
@@ -1344,6 +1351,35 @@ HatoholError DBTablesHost::getServerHostDefs(
 	return HTERR_OK;
 }
 
+HatoholError DBTablesHost::getNumberOfHostsEachServer(
+  map<ServerIdType, size_t> &numHostsMap, const HostsQueryOption &option)
+{
+	DBClientJoinBuilder builder(tableProfileServerHostDef);
+	builder.add(IDX_HOST_SERVER_HOST_DEF_SERVER_ID);
+
+	if (option.isHostgroupUsed()) {
+		builder.addTable(
+		  tableProfileHostgroupMember, DBClientJoinBuilder::INNER_JOIN,
+		  IDX_HOST_SERVER_HOST_DEF_HOST_ID,
+		  IDX_HOSTGROUP_MEMBER_HOST_ID);
+	}
+
+	DBAgent::SelectExArg &arg = builder.build();
+	arg.add("count(*)", SQL_COLUMN_TYPE_INT);
+	setServerHostDefCondition(arg, option);
+	arg.groupBy = tableProfileServerHostDef.getFullColumnName(
+	                IDX_HOST_SERVER_HOST_DEF_SERVER_ID);
+	getDBAgent().runTransaction(arg);
+
+	for (const auto &itemGrp : arg.dataTable->getItemGroupList()) {
+		ItemGroupStream itemGroupStream(itemGrp);
+		const ServerIdType serverId =
+		  itemGroupStream.read<ServerIdType>();
+		numHostsMap[serverId] = itemGroupStream.read<int>();
+	}
+	return HTERR_OK;
+}
+
 bool DBTablesHost::wasStoredHostsChanged(void)
 {
 	return m_impl->storedHostsChanged;
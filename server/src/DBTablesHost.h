@@ -397,6 +397,21 @@ public:
 	HatoholError getServerHostDefs(ServerHostDefVect &svHostDefVect,
 	                               const HostsQueryOption &option);
 
+	/**
+	 * Get the number of hosts of each server.
+	 *
+	 * @param numHostsMap
+	 * The numbers of hosts are added to this map with the keys of
+	 * server IDs. Servers without any matched hosts don't appear in it.
+	 *
+	 * @param option A option for the inquiry.
+	 *
+	 * @return An error status.
+	 */
+	HatoholError getNumberOfHostsEachServer(
+	  std::map<ServerIdType, size_t> &numHostsMap,
+	  const HostsQueryOption &option);
+
 	bool wasStoredHostsChanged(void);
 	size_t getNumberOfHosts(HostsQueryOption &option);
 
@@ -34,6 +34,12 @@ enum LastInfoType {
 	LAST_INFO_TRIGGER,
 	LAST_INFO_EVENT,
 	LAST_INFO_HOST_PARENT,
+	// Fingerprints of the last full syncs. They are used by Hatohol
+	// itself and aren't sent to plugins.
+	LAST_INFO_HOST_FINGERPRINT,
+	LAST_INFO_HOST_GROUP_FINGERPRINT,
+	LAST_INFO_HOST_GROUP_MEMBERSHIP_FINGERPRINT,
+	LAST_INFO_TRIGGER_FINGERPRINT,
 	NUM_LAST_INFO_TYPES,
 };
 
@@ -17,7 +17,10 @@
  * <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
+#include <cstdio>
 #include <memory>
+#include <functional>
 #include <Mutex.h>
 #include <SeparatorInjector.h>
 #include "UnifiedDataStore.h"
@@ -30,7 +33,9 @@
 #include "ItemGroupStream.h"
 #include "DBClientJoinBuilder.h"
 #include "DBTermCStringProvider.h"
+#include "EventChangeNotifier.h"
 #include "StatisticsCounter.h"
+#include "TriggerStateIndex.h"
 
 // TODO: rmeove the followin two include files!
 // This class should not be aware of it.
@@ -74,6 +79,11 @@ static StatisticsCounter *eventsCounters[] = {
 };
 static_assert(ARRAY_SIZE(eventsCounters) == DBTablesMonitoring::NUM_EVENTS_COUNTERS, "");
 
+// The numbers of the events whose trigger is found or not found in
+// mergeTriggerInfo()
+static atomic<uint64_t> numTriggerMergeHits(0);
+static atomic<uint64_t> numTriggerMergeMisses(0);
+
 void operator>>(ItemGroupStream &itemGroupStream, TriggerStatusType &rhs)
 {
 	rhs = itemGroupStream.read<int, TriggerStatusType>();
@@ -940,6 +950,65 @@ static const DBAgent::TableProfile tableProfileIncidentHistories =
 			    NUM_IDX_INCIDENT_HISTORIES,
 			    indexDefsIncidentHistories);
 
+// The index is shared by all DBTablesMonitoring instances and updated
+// after transactions that write the triggers table are committed.
+static TriggerStateIndex &getTriggerStateIndex(void)
+{
+	static TriggerStateIndex index;
+	return index;
+}
+
+static TriggerStateIndex::Loader makeTriggerStateLoader(DBAgent &dbAgent)
+{
+	return [&dbAgent](const ServerIdType &serverId,
+	                  TriggerInfoList &triggerInfoList) {
+		DBAgent::SelectExArg arg(tableProfileTriggers);
+		arg.add(IDX_TRIGGERS_ID);
+		arg.add(IDX_TRIGGERS_STATUS);
+		arg.add(IDX_TRIGGERS_SEVERITY);
+		arg.add(IDX_TRIGGERS_HOST_ID_IN_SERVER);
+		arg.add(IDX_TRIGGERS_VALIDITY);
+		DBTermCStringProvider rhs(*dbAgent.getDBTermCodec());
+		arg.condition = StringUtils::sprintf("%s=%s",
+		  COLUMN_DEF_TRIGGERS[IDX_TRIGGERS_SERVER_ID].columnName,
+		  rhs(serverId));
+		arg.useColumnarTable = true;
+		dbAgent.runTransaction(arg);
+
+		const ColumnarTable &table = *arg.columnarTable;
+		ColumnarTableStream stream(table, 0);
+		for (size_t row = 0; row < table.getNumberOfRows(); row++) {
+			stream.setRow(row);
+			TriggerInfo triggerInfo;
+			triggerInfo.serverId = serverId;
+			stream >> triggerInfo.id;
+			stream >> triggerInfo.status;
+			stream >> triggerInfo.severity;
+			stream >> triggerInfo.hostIdInServer;
+			stream >> triggerInfo.validity;
+			triggerInfoList.push_back(triggerInfo);
+		}
+	};
+}
+
+/**
+ * Get servers whose numbers can be answered by the trigger state index.
+ *
+ * @param forHosts
+ * true if the number of hosts is queried. Hosts are counted by
+ * host_id_in_server across servers. So only a single server is allowed.
+ */
+static bool getIndexedServerIds(ServerIdSet &serverIds,
+                                const TriggersQueryOption &option,
+                                const bool &forHosts = false)
+{
+	if (option.isTriggerAttributeFilterUsed())
+		return false;
+	if (forHosts && option.getTargetServerId() == ALL_SERVERS)
+		return false;
+	return option.getWholeServerIds(serverIds);
+}
+
 struct DBTablesMonitoring::Impl
 {
 	bool storedHostsChanged;
@@ -1013,6 +1082,9 @@ struct EventsQueryOption::Impl {
 	vector<string> groupByColumns;
 	list<string> hostnameList;
 	list<EventIdType> eventIds;
+	bool seekEnabled;
+	UnifiedEventIdType seekUnifiedId;
+	timespec seekTime;
 
 	Impl()
 	: limitOfUnifiedId(NO_LIMIT),
@@ -1025,7 +1097,10 @@ struct EventsQueryOption::Impl {
 	  beginTime({0, 0}),
 	  endTime({0, 0}),
 	  hostnameList({}),
-	  eventIds({})
+	  eventIds({}),
+	  seekEnabled(false),
+	  seekUnifiedId(0),
+	  seekTime({0, 0})
 	{
 	}
 };
@@ -1069,6 +1144,9 @@ string EventsQueryOption::getCondition(void) const
 			m_impl->limitOfUnifiedId);
 	}
 
+	if (m_impl->seekEnabled)
+		addCondition(condition, makeSeekCondition());
+
 	if (m_impl->type != EVENT_TYPE_ALL) {
 		if (!condition.empty())
 			condition += " AND ";
@@ -1274,6 +1352,79 @@ EventsQueryOption::SortType EventsQueryOption::getSortType(void) const
 	return m_impl->sortType;
 }
 
+void EventsQueryOption::setSeekPosition(const UnifiedEventIdType &unifiedId,
+                                        const timespec &time)
+{
+	m_impl->seekEnabled = true;
+	m_impl->seekUnifiedId = unifiedId;
+	m_impl->seekTime = time;
+}
+
+string EventsQueryOption::makeCursor(const EventInfo &eventInfo) const
+{
+	if (m_impl->sortType == SORT_TIME) {
+		return StringUtils::sprintf(
+		  "T%ld.%ld.%" FMT_UNIFIED_EVENT_ID,
+		  eventInfo.time.tv_sec, eventInfo.time.tv_nsec,
+		  eventInfo.unifiedId);
+	}
+	return StringUtils::sprintf("U%" FMT_UNIFIED_EVENT_ID,
+	                            eventInfo.unifiedId);
+}
+
+bool EventsQueryOption::setCursor(const string &cursor)
+{
+	UnifiedEventIdType unifiedId;
+	timespec time = {0, 0};
+	char extra;
+	int numParsed;
+	if (m_impl->sortType == SORT_TIME) {
+		numParsed = sscanf(cursor.c_str(),
+		                   "T%ld.%ld.%" FMT_UNIFIED_EVENT_ID "%c",
+		                   &time.tv_sec, &time.tv_nsec, &unifiedId,
+		                   &extra);
+		if (numParsed != 3)
+			return false;
+	} else {
+		numParsed = sscanf(cursor.c_str(),
+		                   "U%" FMT_UNIFIED_EVENT_ID "%c",
+		                   &unifiedId, &extra);
+		if (numParsed != 1)
+			return false;
+	}
+	setSeekPosition(unifiedId, time);
+	return true;
+}
+
+string EventsQueryOption::makeSeekCondition(void) const
+{
+	// Without a sort direction, the order is not defined. We regard it
+	// as the ascending order.
+	const char *op =
+	  (m_impl->sortDirection == SORT_DESCENDING) ? "<" : ">";
+	const string unifiedIdColumn = getColumnName(IDX_EVENTS_UNIFIED_ID);
+	if (m_impl->sortType != SORT_TIME) {
+		return StringUtils::sprintf(
+		  "%s%s%" FMT_UNIFIED_EVENT_ID,
+		  unifiedIdColumn.c_str(), op, m_impl->seekUnifiedId);
+	}
+
+	// Expanded instead of a row constructor such as (a,b,c)<(x,y,z)
+	// so that the index on (time_sec, time_ns, unified_id) is used with
+	// both MySQL and SQLite3.
+	const string secColumn = getColumnName(IDX_EVENTS_TIME_SEC);
+	const string nsColumn = getColumnName(IDX_EVENTS_TIME_NS);
+	const timespec &time = m_impl->seekTime;
+	return StringUtils::sprintf(
+	  "(%s%s%ld OR (%s=%ld AND (%s%s%ld OR "
+	  "(%s=%ld AND %s%s%" FMT_UNIFIED_EVENT_ID "))))",
+	  secColumn.c_str(), op, time.tv_sec,
+	  secColumn.c_str(), time.tv_sec,
+	  nsColumn.c_str(), op, time.tv_nsec,
+	  nsColumn.c_str(), time.tv_nsec,
+	  unifiedIdColumn.c_str(), op, m_impl->seekUnifiedId);
+}
+
 DataQueryOption::SortDirection EventsQueryOption::getSortDirection(void) const
 {
 	return m_impl->sortDirection;
@@ -1471,6 +1622,9 @@ struct TriggersQueryOption::Impl {
 	SortType sortType;
 	SortDirection sortDirection;
 	string triggerBrief;
+	bool seekEnabled;
+	ServerIdType seekServerId;
+	TriggerIdType seekTriggerId;
 
 	Impl()
 	: targetId(ALL_TRIGGERS),
@@ -1481,7 +1635,9 @@ struct TriggersQueryOption::Impl {
 	  endTime({0, 0}),
 	  hostnameList({}),
 	  sortType(SORT_ID),
-	  sortDirection(SORT_DONT_CARE)
+	  sortDirection(SORT_DONT_CARE),
+	  seekEnabled(false),
+	  seekServerId(ALL_SERVERS)
 	{
 	}
 	bool shouldExcludeSelfMonitoring() {
@@ -1521,6 +1677,11 @@ void TriggersQueryOption::setExcludeFlags(const ExcludeFlags &flg)
 	m_impl->excludeFlags = flg;
 }
 
+ExcludeFlags TriggersQueryOption::getExcludeFlags(void) const
+{
+	return m_impl->excludeFlags;
+}
+
 
 string TriggersQueryOption::getCondition(void) const
 {
@@ -1610,6 +1771,22 @@ string TriggersQueryOption::getCondition(void) const
 			COLUMN_DEF_TRIGGERS[IDX_TRIGGERS_BRIEF].columnName,
 			rhs(m_impl->triggerBrief)));
 	}
+
+	if (m_impl->seekEnabled && m_impl->seekServerId != ALL_SERVERS) {
+		// Expanded instead of a row constructor so that the unique
+		// index on (server_id, id) is used with both MySQL and SQLite3.
+		const string serverIdColumn =
+		  tableProfileTriggers.getFullColumnName(IDX_TRIGGERS_SERVER_ID);
+		DBTermCStringProvider rhs(*getDBTermCodec());
+		addCondition(condition, StringUtils::sprintf(
+			"(%s>%" FMT_SERVER_ID " OR "
+			"(%s=%" FMT_SERVER_ID " AND %s>%s))",
+			serverIdColumn.c_str(), m_impl->seekServerId,
+			serverIdColumn.c_str(), m_impl->seekServerId,
+			tableProfileTriggers.getFullColumnName(
+			  IDX_TRIGGERS_ID).c_str(),
+			rhs(m_impl->seekTriggerId)));
+	}
 	return condition;
 }
 
@@ -1747,6 +1924,76 @@ string TriggersQueryOption::makeHostnameListCondition(
 	return condition;
 }
 
+void TriggersQueryOption::setSeekPosition(const ServerIdType &serverId,
+                                          const TriggerIdType &triggerId)
+{
+	m_impl->seekEnabled = true;
+	m_impl->seekServerId = serverId;
+	m_impl->seekTriggerId = triggerId;
+	setSeekSortOrder();
+}
+
+string TriggersQueryOption::makeCursor(const TriggerInfo &triggerInfo) const
+{
+	// The trigger ID is the rest of the string. So it can contain ':'.
+	return StringUtils::sprintf("%" FMT_SERVER_ID ":%" FMT_TRIGGER_ID,
+	                            triggerInfo.serverId,
+	                            triggerInfo.id.c_str());
+}
+
+bool TriggersQueryOption::setCursor(const string &cursor)
+{
+	if (cursor.empty()) {
+		m_impl->seekEnabled = true;
+		m_impl->seekServerId = ALL_SERVERS;
+		m_impl->seekTriggerId.clear();
+		setSeekSortOrder();
+		return true;
+	}
+
+	ServerIdType serverId;
+	int idPosition = 0;
+	if (sscanf(cursor.c_str(), "%" FMT_SERVER_ID ":%n",
+	           &serverId, &idPosition) != 1 || idPosition == 0) {
+		return false;
+	}
+	if (serverId == ALL_SERVERS)
+		return false;
+	setSeekPosition(serverId, cursor.substr(idPosition));
+	return true;
+}
+
+void TriggersQueryOption::setSeekSortOrder(void)
+{
+	SortOrderVect sortOrderVect;
+	sortOrderVect.push_back(SortOrder(
+	  tableProfileTriggers.getFullColumnName(IDX_TRIGGERS_SERVER_ID),
+	  SORT_ASCENDING));
+	sortOrderVect.push_back(SortOrder(
+	  tableProfileTriggers.getFullColumnName(IDX_TRIGGERS_ID),
+	  SORT_ASCENDING));
+	setSortOrderVect(sortOrderVect);
+}
+
+bool TriggersQueryOption::isTriggerAttributeFilterUsed(void) const
+{
+	struct {
+		bool operator()(const timespec &ts)
+		{
+			return ts.tv_sec != 0 || ts.tv_nsec != 0;
+		}
+	} isTimeSet;
+
+	return m_impl->targetId != ALL_TRIGGERS ||
+	       m_impl->minSeverity != TRIGGER_SEVERITY_UNKNOWN ||
+	       m_impl->triggerStatus != TRIGGER_STATUS_ALL ||
+	       isTimeSet(m_impl->beginTime) ||
+	       isTimeSet(m_impl->endTime) ||
+	       !m_impl->hostnameList.empty() ||
+	       !m_impl->triggerBrief.empty() ||
+	       (m_impl->seekEnabled && m_impl->seekServerId != ALL_SERVERS);
+}
+
 //
 // ItemsQueryOption
 //
@@ -1763,10 +2010,14 @@ struct ItemsQueryOption::Impl {
 	ItemIdType targetId;
 	string itemCategoryName;
 	ExcludeFlags excludeFlags;
+	bool seekEnabled;
+	GenericIdType seekGlobalId;
 
 	Impl()
 	: targetId(ALL_ITEMS),
-	  excludeFlags(NO_EXCLUDE_HOST)
+	  excludeFlags(NO_EXCLUDE_HOST),
+	  seekEnabled(false),
+	  seekGlobalId(0)
 	{
 	}
 	bool shouldExcludeSelfMonitoring() {
@@ -1840,6 +2091,16 @@ string ItemsQueryOption::getCondition(void) const
 			rhs(m_impl->itemCategoryName));
 	}
 
+	if (m_impl->seekEnabled) {
+		addCondition(
+		  condition,
+		  StringUtils::sprintf(
+		    "%s>%" FMT_GEN_ID,
+		    tableProfileItems.getFullColumnName(
+		      IDX_ITEMS_GLOBAL_ID).c_str(),
+		    m_impl->seekGlobalId));
+	}
+
 	return condition;
 }
 
@@ -1868,6 +2129,21 @@ void ItemsQueryOption::setExcludeFlags(const ExcludeFlags &flg)
 	m_impl->excludeFlags = flg;
 }
 
+void ItemsQueryOption::setSeekPosition(const GenericIdType &globalId)
+{
+	m_impl->seekEnabled = true;
+	m_impl->seekGlobalId = globalId;
+	SortOrder order(
+	  tableProfileItems.getFullColumnName(IDX_ITEMS_GLOBAL_ID),
+	  SORT_ASCENDING);
+	setSortOrder(order);
+}
+
+bool ItemsQueryOption::hasSeekPosition(void) const
+{
+	return m_impl->seekEnabled;
+}
+
 //
 // IncidentsQueryOption
 //
@@ -2100,6 +2376,7 @@ string IncidentHistoriesQueryOption::getCondition(void) const
 void DBTablesMonitoring::reset(void)
 {
 	getSetupInfo().initialized = false;
+	getTriggerStateIndex().clear();
 }
 
 const DBTables::SetupInfo &DBTablesMonitoring::getConstSetupInfo(void)
@@ -2133,6 +2410,7 @@ void DBTablesMonitoring::addTriggerInfo(const TriggerInfo *triggerInfo)
 		}
 	} trx(triggerInfo);
 	getDBAgent().runTransaction(trx);
+	getTriggerStateIndex().update(*triggerInfo);
 }
 
 void DBTablesMonitoring::addTriggerInfoList(
@@ -2140,14 +2418,14 @@ void DBTablesMonitoring::addTriggerInfoList(
   DBAgent::TransactionHooks *hooks)
 {
 	struct : public SeqTransactionProc<TriggerInfo, TriggerInfoList> {
-		void foreach(DBAgent &dbag, const TriggerInfo &trig) override
+		void operator ()(DBAgent &dbAgent) override
 		{
-			DBTablesMonitoring &dbMon = get<DBTablesMonitoring>();
-			dbMon.addTriggerInfoWithoutTransaction(dbag, trig);
+			addTriggerInfoListWithoutTransaction(dbAgent, *seq);
 		}
 	} trx;
 	trx.init(this, &triggerInfoList);
 	getDBAgent().runTransaction(trx, hooks);
+	getTriggerStateIndex().update(triggerInfoList);
 }
 
 bool DBTablesMonitoring::getTriggerInfo(TriggerInfo &triggerInfo,
@@ -2250,13 +2528,7 @@ void DBTablesMonitoring::setTriggerInfoList(
 		void operator ()(DBAgent &dbAgent) override
 		{
 			_funcTopHalf(dbAgent);
-			runBaseFunctor(dbAgent);
-		}
-
-		void foreach(DBAgent &dbag, const TriggerInfo &trig) override
-		{
-			DBTablesMonitoring &dbMon = get<DBTablesMonitoring>();
-			dbMon.addTriggerInfoWithoutTransaction(dbag, trig);
+			addTriggerInfoListWithoutTransaction(dbAgent, *seq);
 		}
 	} trx;
 	trx._preproc = [&] (DBAgent &dbAgent) {
@@ -2271,6 +2543,7 @@ void DBTablesMonitoring::setTriggerInfoList(
 	trx._funcTopHalf = [&] (DBAgent &dbag) { dbag.deleteRows(deleteArg); };
 	trx.init(this, &triggerInfoList);
 	getDBAgent().runTransaction(trx);
+	getTriggerStateIndex().invalidate(serverId);
 }
 
 HatoholError DBTablesMonitoring::getTriggerBriefList(
@@ -2429,6 +2702,7 @@ HatoholError DBTablesMonitoring::deleteTriggerInfo(const TriggerIdList &idList,
 	} trx;
 	trx.arg.condition = makeConditionForDeleteTrigger(idList, serverId);
 	getDBAgent().runTransaction(trx);
+	getTriggerStateIndex().remove(serverId, idList);
 
 	// Check the result
 	if (trx.numAffectedRows != idList.size()) {
@@ -2543,6 +2817,7 @@ void DBTablesMonitoring::addEventInfo(EventInfo *eventInfo)
 	} trx(eventInfo);
 	getDBAgent().runTransaction(trx);
 	m_impl->addEventStatistics(trx.numAdded);
+	EventChangeNotifier::notify();
 }
 
 void DBTablesMonitoring::addEventInfoList(EventInfoList &eventInfoList,
@@ -2550,17 +2825,19 @@ void DBTablesMonitoring::addEventInfoList(EventInfoList &eventInfoList,
 {
 	struct : public MutableSeqTransactionProc<EventInfo, EventInfoList> {
 		uint64_t numAdded;
-		void foreach(DBAgent &dbag, EventInfo &eventInfo) override
+		void operator ()(DBAgent &dbAgent) override
 		{
-			DBTablesMonitoring &dbMon = get<DBTablesMonitoring>();
-			dbMon.addEventInfoWithoutTransaction(dbag, eventInfo);
-			numAdded++;
+			addEventInfoListWithoutTransaction(dbAgent, *seq);
+			numAdded = seq->size();
 		}
 	} trx;
 	trx.numAdded = 0;
 	trx.init(this, &eventInfoList);
 	getDBAgent().runTransaction(trx, hooks);
 	m_impl->addEventStatistics(trx.numAdded);
+	// Wake up the clients waiting for new events.
+	if (trx.numAdded > 0)
+		EventChangeNotifier::notify();
 }
 
 HatoholError DBTablesMonitoring::getEventInfoList(
@@ -2622,13 +2899,18 @@ HatoholError DBTablesMonitoring::getEventInfoList(
 	if (!arg.limit && arg.offset)
 		return HTERR_OFFSET_WITHOUT_LIMIT;
 
+	// The number of events can be huge.
+	arg.useColumnarTable = true;
 	getDBAgent().runTransaction(arg);
 
 	// check the result and copy
-	const ItemGroupList &grpList = arg.dataTable->getItemGroupList();
-	ItemGroupListConstIterator itemGrpItr = grpList.begin();
-	for (; itemGrpItr != grpList.end(); ++itemGrpItr) {
-		ItemGroupStream itemGroupStream(*itemGrpItr);
+	const ColumnarTable &table = *arg.columnarTable;
+	const size_t numRows = table.getNumberOfRows();
+	if (incidentInfoVect)
+		incidentInfoVect->reserve(incidentInfoVect->size() + numRows);
+	ColumnarTableStream itemGroupStream(table, 0);
+	for (size_t row = 0; row < numRows; row++) {
+		itemGroupStream.setRow(row);
 		eventInfoList.push_back(EventInfo());
 		EventInfo &eventInfo = eventInfoList.back();
 
@@ -2796,14 +3078,20 @@ void DBTablesMonitoring::addItemInfo(const ItemInfo *itemInfo)
 
 void DBTablesMonitoring::addItemInfoList(const ItemInfoList &itemInfoList)
 {
-	struct : public SeqTransactionProc<ItemInfo, ItemInfoList> {
-		void foreach(DBAgent &dbag, const ItemInfo &itemInfo) override
+	struct TrxProc : public DBAgent::TransactionProc {
+		const ItemInfoList &itemInfoList;
+
+		TrxProc(const ItemInfoList &_itemInfoList)
+		: itemInfoList(_itemInfoList)
 		{
-			DBTablesMonitoring &dbMon = get<DBTablesMonitoring>();
-			dbMon.addItemInfoWithoutTransaction(dbag, itemInfo);
 		}
-	} trx;
-	trx.init(this, &itemInfoList);
+
+		void operator ()(DBAgent &dbAgent) override
+		{
+			addItemInfoListWithoutTransaction(dbAgent,
+			                                  itemInfoList);
+		}
+	} trx(itemInfoList);
 	getDBAgent().runTransaction(trx);
 }
 
@@ -2874,7 +3162,8 @@ HatoholError DBTablesMonitoring::deleteItemInfo(const ItemIdList &idList,
 }
 
 static bool isItemChanged(
-  const ItemInfo item, map<ItemIdType, const ItemInfo *> currentItemMap)
+  const ItemInfo &item,
+  const map<ItemIdType, const ItemInfo *> &currentItemMap)
 {
 	auto itemItr = currentItemMap.find(item.id);
 	if (itemItr != currentItemMap.end()) {
@@ -2903,11 +3192,11 @@ static bool isItemChanged(
 	return false;
 }
 
-static LocalHostIdType getTargetHostId(const ItemInfoList itemInfoList)
+static LocalHostIdType getTargetHostId(const ItemInfoList &itemInfoList)
 {
-	auto firstItem = *begin(itemInfoList);
-	LocalHostIdType targetHostId = firstItem.hostIdInServer;
-	for (const auto item : itemInfoList) {
+	const LocalHostIdType &targetHostId =
+	  itemInfoList.begin()->hostIdInServer;
+	for (const auto &item : itemInfoList) {
 		if (item.hostIdInServer != targetHostId)
 			return ALL_LOCAL_HOSTS;
 	}
@@ -2939,21 +3228,17 @@ HatoholError DBTablesMonitoring::syncItems(const ItemInfoList &itemInfoList,
 
 	// Pick up items to be added
 	ItemInfoList addItems;
-	for (const auto item : itemInfoList) {
+	for (const auto &item : itemInfoList) {
 		if (!isItemChanged(item, currentItemMap) &&
 		    currentItemMap.erase(item.id) >= 1) {
 			continue;
 		}
-		addItems.push_back(move(item));
+		addItems.push_back(item);
 	}
 
 	ItemIdList invalidItemIdList;
-	map<ItemIdType, const ItemInfo *> invalidItemMap =
-		move(currentItemMap);
-	for (auto invalidItemPair : invalidItemMap) {
-		ItemInfo invalidItem = *invalidItemPair.second;
-		invalidItemIdList.push_back(invalidItem.id);
-	}
+	for (const auto &invalidItemPair : currentItemMap)
+		invalidItemIdList.push_back(invalidItemPair.first);
 	if (invalidItemIdList.size() > 0)
 		err = deleteItemInfo(invalidItemIdList, serverId);
 	if (addItems.size() > 0)
@@ -3034,6 +3319,9 @@ void DBTablesMonitoring::getItemInfoList(ItemInfoList &itemInfoList,
 		arg.condition += StringUtils::sprintf("%" FMT_GEN_ID, globalId);
 	}
 	arg.condition += ")";
+	// Keep the page in the order of the global ID.
+	if (option.hasSeekPosition())
+		arg.orderBy = option.getOrderBy();
 
 	getDBAgent().runTransaction(arg);
 
@@ -3199,6 +3487,13 @@ size_t DBTablesMonitoring::getNumberOfTriggers(
 size_t DBTablesMonitoring::getNumberOfBadTriggers(
   const TriggersQueryOption &option, TriggerSeverityType severity)
 {
+	ServerIdSet serverIds;
+	if (getIndexedServerIds(serverIds, option)) {
+		return getTriggerStateIndex().getNumberOfBadTriggers(
+		  serverIds, severity, option.getExcludeFlags(),
+		  makeTriggerStateLoader(getDBAgent()));
+	}
+
 	string additionalCondition;
 	const string statusProblemCond = StringUtils::sprintf("%s=%d",
 	  tableProfileTriggers.getFullColumnName(IDX_TRIGGERS_STATUS).c_str(),
@@ -3220,11 +3515,24 @@ size_t DBTablesMonitoring::getNumberOfBadTriggers(
 
 size_t DBTablesMonitoring::getNumberOfTriggers(const TriggersQueryOption &option)
 {
+	ServerIdSet serverIds;
+	if (getIndexedServerIds(serverIds, option)) {
+		return getTriggerStateIndex().getNumberOfTriggers(
+		  serverIds, option.getExcludeFlags(),
+		  makeTriggerStateLoader(getDBAgent()));
+	}
 	return getNumberOfTriggers(option, string());
 }
 
 size_t DBTablesMonitoring::getNumberOfHosts(const TriggersQueryOption &option)
 {
+	ServerIdSet serverIds;
+	if (getIndexedServerIds(serverIds, option, true)) {
+		return getTriggerStateIndex().getNumberOfHosts(
+		  serverIds, option.getExcludeFlags(),
+		  makeTriggerStateLoader(getDBAgent()));
+	}
+
 	// TODO: consider if we can use hosts table.
 	DBClientJoinBuilder builder(tableProfileTriggers, &option);
 	builder.addTable(
@@ -3258,6 +3566,13 @@ size_t DBTablesMonitoring::getNumberOfGoodHosts(const TriggersQueryOption &optio
 
 size_t DBTablesMonitoring::getNumberOfBadHosts(const TriggersQueryOption &option)
 {
+	ServerIdSet serverIds;
+	if (getIndexedServerIds(serverIds, option, true)) {
+		return getTriggerStateIndex().getNumberOfBadHosts(
+		  serverIds, option.getExcludeFlags(),
+		  makeTriggerStateLoader(getDBAgent()));
+	}
+
 	DBClientJoinBuilder builder(tableProfileTriggers, &option);
 	builder.addTable(
 	  tableProfileServerHostDef, DBClientJoinBuilder::LEFT_JOIN,
@@ -3286,6 +3601,189 @@ size_t DBTablesMonitoring::getNumberOfBadHosts(const TriggersQueryOption &option
 	return itemGroupStream.read<int>();
 }
 
+// A TriggersQueryOption which always joins the hostgroup member table
+// so that the results can be grouped by host groups.
+struct HostgroupJoinedTriggersQueryOption : public TriggersQueryOption {
+	HostgroupJoinedTriggersQueryOption(const TriggersQueryOption &src)
+	: TriggersQueryOption(src)
+	{
+	}
+
+	virtual bool isHostgroupUsed(void) const override
+	{
+		return true;
+	}
+};
+
+static void addServerHostDefTable(DBClientJoinBuilder &builder)
+{
+	builder.addTable(
+	  tableProfileServerHostDef, DBClientJoinBuilder::LEFT_JOIN,
+	  tableProfileTriggers, IDX_TRIGGERS_SERVER_ID,
+	                        IDX_HOST_SERVER_HOST_DEF_SERVER_ID,
+	  tableProfileTriggers, IDX_TRIGGERS_HOST_ID_IN_SERVER,
+	                        IDX_HOST_SERVER_HOST_DEF_HOST_ID_IN_SERVER);
+}
+
+void DBTablesMonitoring::getTriggerStatistics(
+  ServerTriggerStatisticsMap &statisticsMap, const TriggersQueryOption &option)
+{
+	HATOHOL_ASSERT(option.getTargetHostgroupId() == ALL_HOST_GROUPS,
+	               "Target host group: %" FMT_HOST_GROUP_ID,
+	               option.getTargetHostgroupId().c_str());
+
+	const string serverIdColumn =
+	  tableProfileTriggers.getFullColumnName(IDX_TRIGGERS_SERVER_ID);
+	const string severityColumn =
+	  tableProfileTriggers.getFullColumnName(IDX_TRIGGERS_SEVERITY);
+	const string triggerIdColumn =
+	  tableProfileTriggers.getFullColumnName(IDX_TRIGGERS_ID);
+	const string hostIdColumn =
+	  tableProfileTriggers.getFullColumnName(
+	    IDX_TRIGGERS_HOST_ID_IN_SERVER);
+	const string hostgroupIdColumn =
+	  tableProfileHostgroupMember.getFullColumnName(
+	    IDX_HOSTGROUP_MEMBER_GROUP_ID);
+	const string problemCond = StringUtils::sprintf("%s=%d",
+	  tableProfileTriggers.getFullColumnName(IDX_TRIGGERS_STATUS).c_str(),
+	  TRIGGER_STATUS_PROBLEM);
+	const string countBadHosts = StringUtils::sprintf(
+	  "count(distinct CASE WHEN %s THEN %s END)",
+	  problemCond.c_str(), hostIdColumn.c_str());
+
+	auto getSeverity = [](ColumnarTableStream &stream) {
+		const int severity = stream.read<int>();
+		HATOHOL_ASSERT(severity >= 0 && severity < NUM_TRIGGER_SEVERITY,
+		               "Invalid severity: %d", severity);
+		return severity;
+	};
+
+	// Triggers of each server and severity. Triggers are counted
+	// distinctly because the hostgroup member table might be joined
+	// depending on the privilege.
+	{
+		DBClientJoinBuilder builder(tableProfileTriggers, &option);
+		addServerHostDefTable(builder);
+		DBAgent::SelectExArg &arg = builder.build();
+		arg.add(serverIdColumn, SQL_COLUMN_TYPE_INT);
+		arg.add(severityColumn, SQL_COLUMN_TYPE_INT);
+		arg.add(StringUtils::sprintf("count(distinct %s)",
+		                             triggerIdColumn.c_str()),
+		        SQL_COLUMN_TYPE_INT);
+		arg.add(StringUtils::sprintf(
+		  "count(distinct CASE WHEN %s THEN %s END)",
+		  problemCond.c_str(), triggerIdColumn.c_str()),
+		  SQL_COLUMN_TYPE_INT);
+		arg.groupBy = serverIdColumn + "," + severityColumn;
+		arg.useColumnarTable = true;
+		getDBAgent().runTransaction(arg);
+
+		const ColumnarTable &table = *arg.columnarTable;
+		ColumnarTableStream stream(table, 0);
+		for (size_t row = 0; row < table.getNumberOfRows(); row++) {
+			stream.setRow(row);
+			ServerTriggerStatistics &serverStat =
+			  statisticsMap[stream.read<int>()];
+			const int severity = getSeverity(stream);
+			serverStat.numTriggers += stream.read<int>();
+			serverStat.hostgroups[ALL_HOST_GROUPS]
+			  .numBadTriggers[severity] = stream.read<int>();
+		}
+	}
+
+	// Hosts of each server
+	{
+		DBClientJoinBuilder builder(tableProfileTriggers, &option);
+		addServerHostDefTable(builder);
+		DBAgent::SelectExArg &arg = builder.build();
+		arg.add(serverIdColumn, SQL_COLUMN_TYPE_INT);
+		arg.add(StringUtils::sprintf("count(distinct %s)",
+		                             hostIdColumn.c_str()),
+		        SQL_COLUMN_TYPE_INT);
+		arg.add(countBadHosts, SQL_COLUMN_TYPE_INT);
+		arg.groupBy = serverIdColumn;
+		arg.useColumnarTable = true;
+		getDBAgent().runTransaction(arg);
+
+		const ColumnarTable &table = *arg.columnarTable;
+		ColumnarTableStream stream(table, 0);
+		for (size_t row = 0; row < table.getNumberOfRows(); row++) {
+			stream.setRow(row);
+			HostgroupTriggerStatistics &stat =
+			  statisticsMap[stream.read<int>()]
+			    .hostgroups[ALL_HOST_GROUPS];
+			stat.numHosts    = stream.read<int>();
+			stat.numBadHosts = stream.read<int>();
+		}
+	}
+
+	const HostgroupJoinedTriggersQueryOption hgrpOption(option);
+
+	// Bad triggers of each host group and severity
+	{
+		DBClientJoinBuilder builder(tableProfileTriggers, &hgrpOption);
+		addServerHostDefTable(builder);
+		DBAgent::SelectExArg &arg = builder.build();
+		arg.add(serverIdColumn, SQL_COLUMN_TYPE_INT);
+		arg.add(hostgroupIdColumn, SQL_COLUMN_TYPE_VARCHAR);
+		arg.add(severityColumn, SQL_COLUMN_TYPE_INT);
+		arg.add(StringUtils::sprintf("count(distinct %s)",
+		                             triggerIdColumn.c_str()),
+		        SQL_COLUMN_TYPE_INT);
+		if (arg.condition.empty()) {
+			arg.condition = problemCond;
+		} else {
+			arg.condition = StringUtils::sprintf(
+			  "(%s) AND %s", arg.condition.c_str(),
+			  problemCond.c_str());
+		}
+		arg.groupBy = serverIdColumn + "," + hostgroupIdColumn + "," +
+		              severityColumn;
+		arg.useColumnarTable = true;
+		getDBAgent().runTransaction(arg);
+
+		const ColumnarTable &table = *arg.columnarTable;
+		ColumnarTableStream stream(table, 0);
+		for (size_t row = 0; row < table.getNumberOfRows(); row++) {
+			stream.setRow(row);
+			ServerTriggerStatistics &serverStat =
+			  statisticsMap[stream.read<int>()];
+			HostgroupTriggerStatistics &stat =
+			  serverStat.hostgroups[stream.read<string>()];
+			const int severity = getSeverity(stream);
+			stat.numBadTriggers[severity] = stream.read<int>();
+		}
+	}
+
+	// Hosts of each host group
+	{
+		DBClientJoinBuilder builder(tableProfileTriggers, &hgrpOption);
+		addServerHostDefTable(builder);
+		DBAgent::SelectExArg &arg = builder.build();
+		arg.add(serverIdColumn, SQL_COLUMN_TYPE_INT);
+		arg.add(hostgroupIdColumn, SQL_COLUMN_TYPE_VARCHAR);
+		arg.add(StringUtils::sprintf("count(distinct %s)",
+		                             hostIdColumn.c_str()),
+		        SQL_COLUMN_TYPE_INT);
+		arg.add(countBadHosts, SQL_COLUMN_TYPE_INT);
+		arg.groupBy = serverIdColumn + "," + hostgroupIdColumn;
+		arg.useColumnarTable = true;
+		getDBAgent().runTransaction(arg);
+
+		const ColumnarTable &table = *arg.columnarTable;
+		ColumnarTableStream stream(table, 0);
+		for (size_t row = 0; row < table.getNumberOfRows(); row++) {
+			stream.setRow(row);
+			ServerTriggerStatistics &serverStat =
+			  statisticsMap[stream.read<int>()];
+			HostgroupTriggerStatistics &stat =
+			  serverStat.hostgroups[stream.read<string>()];
+			stat.numHosts    = stream.read<int>();
+			stat.numBadHosts = stream.read<int>();
+		}
+	}
+}
+
 size_t DBTablesMonitoring::getNumberOfItems(
   const ItemsQueryOption &option)
 {
@@ -3820,10 +4318,9 @@ DBTables::SetupInfo &DBTablesMonitoring::getSetupInfo(void)
 	return setupInfo;
 }
 
-void DBTablesMonitoring::addTriggerInfoWithoutTransaction(
-  DBAgent &dbAgent, const TriggerInfo &triggerInfo)
+static void setTriggerInsertArg(
+  DBAgent::InsertArg &arg, const TriggerInfo &triggerInfo)
 {
-	DBAgent::InsertArg arg(tableProfileTriggers);
 	arg.add(triggerInfo.serverId);
 	arg.add(triggerInfo.id);
 	arg.add(triggerInfo.status);
@@ -3837,15 +4334,32 @@ void DBTablesMonitoring::addTriggerInfoWithoutTransaction(
 	arg.add(triggerInfo.extendedInfo);
 	arg.add(triggerInfo.validity);
 	arg.upsertOnDuplicate = true;
+}
+
+void DBTablesMonitoring::addTriggerInfoWithoutTransaction(
+  DBAgent &dbAgent, const TriggerInfo &triggerInfo)
+{
+	DBAgent::InsertArg arg(tableProfileTriggers);
+	setTriggerInsertArg(arg, triggerInfo);
 	dbAgent.insert(arg);
 }
 
-void DBTablesMonitoring::addEventInfoWithoutTransaction(
-  DBAgent &dbAgent, EventInfo &eventInfo)
+void DBTablesMonitoring::addTriggerInfoListWithoutTransaction(
+  DBAgent &dbAgent, const TriggerInfoList &triggerInfoList)
 {
-	mergeTriggerInfo(dbAgent, eventInfo);
+	DBAgent::InsertBatchArg batchArg(tableProfileTriggers);
+	batchArg.upsertOnDuplicate = true;
+	for (const auto &triggerInfo : triggerInfoList) {
+		DBAgent::InsertArg arg(tableProfileTriggers);
+		setTriggerInsertArg(arg, triggerInfo);
+		batchArg.add(arg);
+	}
+	dbAgent.insertBatch(batchArg);
+}
 
-	DBAgent::InsertArg arg(tableProfileEvents);
+static void setEventInsertArg(
+  DBAgent::InsertArg &arg, const EventInfo &eventInfo)
+{
 	arg.add(AUTO_INCREMENT_VALUE_U64);
 	arg.add(eventInfo.serverId);
 	arg.add(eventInfo.id);
@@ -3861,10 +4375,71 @@ void DBTablesMonitoring::addEventInfoWithoutTransaction(
 	arg.add(eventInfo.brief);
 	arg.add(eventInfo.extendedInfo);
 	arg.upsertOnDuplicate = true;
+}
+
+void DBTablesMonitoring::addEventInfoWithoutTransaction(
+  DBAgent &dbAgent, EventInfo &eventInfo)
+{
+	mergeTriggerInfo(dbAgent, eventInfo);
+
+	DBAgent::InsertArg arg(tableProfileEvents);
+	setEventInsertArg(arg, eventInfo);
 	dbAgent.insert(arg);
 	eventInfo.unifiedId = dbAgent.getLastInsertId();
 }
 
+void DBTablesMonitoring::addEventInfoListWithoutTransaction(
+  DBAgent &dbAgent, EventInfoList &eventInfoList)
+{
+	mergeTriggerInfo(dbAgent, eventInfoList);
+
+	DBAgent::InsertBatchArg batchArg(tableProfileEvents);
+	batchArg.upsertOnDuplicate = true;
+	for (auto &eventInfo : eventInfoList) {
+		DBAgent::InsertArg arg(tableProfileEvents);
+		setEventInsertArg(arg, eventInfo);
+		batchArg.add(arg);
+	}
+	dbAgent.insertBatch(batchArg);
+
+	// The unified ID is always auto-incremented. So it's returned.
+	HATOHOL_ASSERT(batchArg.insertIds.size() == eventInfoList.size(),
+	               "insertIds: %zd, eventInfoList: %zd",
+	               batchArg.insertIds.size(), eventInfoList.size());
+	auto idItr = batchArg.insertIds.begin();
+	for (auto &eventInfo : eventInfoList)
+		eventInfo.unifiedId = *idItr++;
+}
+
+// Too long IN clause may exceed the limit of the query length.
+static const size_t MAX_IDS_PER_IN_CLAUSE = 1000;
+
+/**
+ * Call 'func' with comma-separated and quoted values of 'ids' that can be
+ * used in an IN clause. 'func' is called for every MAX_IDS_PER_IN_CLAUSE
+ * values.
+ */
+template <typename ID_SEQ_TYPE>
+static void forEachIdListChunk(
+  DBAgent &dbAgent, const ID_SEQ_TYPE &ids,
+  std::function<void(const string &idList)> func)
+{
+	auto idItr = ids.begin();
+	while (idItr != ids.end()) {
+		// The provider keeps all strings it returns until destroyed.
+		DBTermCStringProvider rhs(*dbAgent.getDBTermCodec());
+		string idList;
+		SeparatorInjector commaInjector(",");
+		for (size_t i = 0;
+		     i < MAX_IDS_PER_IN_CLAUSE && idItr != ids.end();
+		     i++, ++idItr) {
+			commaInjector(idList);
+			idList += rhs(*idItr);
+		}
+		func(idList);
+	}
+}
+
 void DBTablesMonitoring::addItemCategoryWithoutTransaction(
   DBAgent &dbAgent, const ItemCategory &category)
 {
@@ -3938,6 +4513,24 @@ static void calcDelta(
 	}
 }
 
+static void setItemInsertArg(
+  DBAgent::InsertArg &arg, const ItemInfo &itemInfo)
+{
+	arg.add(AUTO_INCREMENT_VALUE_U64);
+	arg.add(itemInfo.serverId);
+	arg.add(itemInfo.id);
+	arg.add(itemInfo.globalHostId);
+	arg.add(itemInfo.hostIdInServer);
+	arg.add(itemInfo.brief);
+	arg.add(itemInfo.lastValueTime.tv_sec);
+	arg.add(itemInfo.lastValueTime.tv_nsec);
+	arg.add(itemInfo.lastValue);
+	arg.add(itemInfo.prevValue);
+	arg.add(itemInfo.valueType);
+	arg.add(itemInfo.unit);
+	arg.upsertOnDuplicate = true;
+}
+
 void DBTablesMonitoring::addItemInfoWithoutTransaction(
   DBAgent &dbAgent, const ItemInfo &itemInfo)
 {
@@ -3964,23 +4557,11 @@ void DBTablesMonitoring::addItemInfoWithoutTransaction(
 	};
 
 	DBAgent::InsertArg arg(tableProfileItems);
-	arg.add(AUTO_INCREMENT_VALUE_U64);
-	arg.add(itemInfo.serverId);
-	arg.add(itemInfo.id);
-	arg.add(itemInfo.globalHostId);
-	arg.add(itemInfo.hostIdInServer);
-	arg.add(itemInfo.brief);
-	arg.add(itemInfo.lastValueTime.tv_sec);
-	arg.add(itemInfo.lastValueTime.tv_nsec);
-	arg.add(itemInfo.lastValue);
-	arg.add(itemInfo.prevValue);
-	arg.add(itemInfo.valueType);
-	arg.add(itemInfo.unit);
-	arg.upsertOnDuplicate = true;
+	setItemInsertArg(arg, itemInfo);
 	dbAgent.insert(arg);
 
 	ItemCategoryVect      newItemCategories;
-	vector<GenericIdType> delCatetegoryIds;
+	vector<GenericIdType> delCategoryIds;
 	if (dbAgent.lastUpsertDidInsert()) {
 		ItemCategory itemCategory;
 		itemCategory.id = AUTO_INCREMENT_VALUE_U64;
@@ -3996,16 +4577,153 @@ void DBTablesMonitoring::addItemInfoWithoutTransaction(
 		getItemCategoriesFromId(dbAgent, currCategories, globalItemId);
 		calcDelta(globalItemId,
 		          currCategories, itemInfo.categoryNames,
-		          newItemCategories, delCatetegoryIds);
+		          newItemCategories, delCategoryIds);
 	}
 
-	for (const auto &id: delCatetegoryIds)
+	for (const auto &id: delCategoryIds)
 		deleteItemCateoryWithoutTransaction(dbAgent, id);
 
 	for (const auto &category: newItemCategories)
 		addItemCategoryWithoutTransaction(dbAgent, category);
 }
 
+typedef map<ItemIdType, GenericIdType> GlobalItemIdMap;
+
+static void getGlobalItemIds(
+  DBAgent &dbAgent, const ServerIdType &serverId,
+  const set<ItemIdType> &itemIdSet, GlobalItemIdMap &globalItemIdMap)
+{
+	DBTermCStringProvider rhs(*dbAgent.getDBTermCodec());
+	const string serverCondition = StringUtils::sprintf("%s=%s",
+	  COLUMN_DEF_ITEMS[IDX_ITEMS_SERVER_ID].columnName, rhs(serverId));
+	forEachIdListChunk(dbAgent, itemIdSet, [&](const string &idList) {
+		DBAgent::SelectExArg arg(tableProfileItems);
+		arg.add(IDX_ITEMS_ID);
+		arg.add(IDX_ITEMS_GLOBAL_ID);
+		arg.condition = StringUtils::sprintf("%s AND %s IN (%s)",
+		  serverCondition.c_str(),
+		  COLUMN_DEF_ITEMS[IDX_ITEMS_ID].columnName, idList.c_str());
+		dbAgent.select(arg);
+
+		for (const auto &itemGrp: arg.dataTable->getItemGroupList()) {
+			ItemGroupStream itemGroupStream(itemGrp);
+			ItemIdType itemId;
+			GenericIdType globalItemId;
+			itemGroupStream >> itemId;
+			itemGroupStream >> globalItemId;
+			globalItemIdMap[itemId] = globalItemId;
+		}
+	});
+}
+
+static void getItemCategoriesFromIds(
+  DBAgent &dbAgent, const vector<GenericIdType> &globalItemIds,
+  map<GenericIdType, ItemCategoryVect> &categoriesMap)
+{
+	forEachIdListChunk(dbAgent, globalItemIds, [&](const string &idList) {
+		DBAgent::SelectExArg arg(tableProfileItemCategories);
+		arg.add(IDX_ITEM_CATEGORIES_ID);
+		arg.add(IDX_ITEM_CATEGORIES_GLOBAL_ITEM_ID);
+		arg.add(IDX_ITEM_CATEGORIES_NAME);
+		arg.condition = StringUtils::sprintf("%s IN (%s)",
+		  COLUMN_DEF_ITEM_CATEGORIES[
+		    IDX_ITEM_CATEGORIES_GLOBAL_ITEM_ID].columnName,
+		  idList.c_str());
+		dbAgent.select(arg);
+
+		for (const auto &itemGrp: arg.dataTable->getItemGroupList()) {
+			ItemGroupStream itemGroupStream(itemGrp);
+			ItemCategory itemCategory;
+			itemGroupStream >> itemCategory.id;
+			itemGroupStream >> itemCategory.globalItemId;
+			itemGroupStream >> itemCategory.name;
+			categoriesMap[itemCategory.globalItemId].push_back(
+			  itemCategory);
+		}
+	});
+}
+
+static void deleteItemCategoriesWithoutTransaction(
+  DBAgent &dbAgent, const vector<GenericIdType> &ids)
+{
+	forEachIdListChunk(dbAgent, ids, [&](const string &idList) {
+		DBAgent::DeleteArg arg(tableProfileItemCategories);
+		arg.condition = StringUtils::sprintf("%s IN (%s)",
+		  COLUMN_DEF_ITEM_CATEGORIES[IDX_ITEM_CATEGORIES_ID].columnName,
+		  idList.c_str());
+		dbAgent.deleteRows(arg);
+	});
+}
+
+void DBTablesMonitoring::addItemInfoListWithoutTransaction(
+  DBAgent &dbAgent, const ItemInfoList &itemInfoList)
+{
+	if (itemInfoList.empty())
+		return;
+
+	DBAgent::InsertBatchArg batchArg(tableProfileItems);
+	for (const auto &itemInfo : itemInfoList) {
+		DBAgent::InsertArg arg(tableProfileItems);
+		setItemInsertArg(arg, itemInfo);
+		batchArg.add(arg);
+	}
+	batchArg.upsertOnDuplicate = true;
+	dbAgent.insertBatch(batchArg);
+
+	// The global IDs of both the inserted and the updated items
+	map<ServerIdType, set<ItemIdType> > itemIdSetMap;
+	for (const auto &itemInfo : itemInfoList)
+		itemIdSetMap[itemInfo.serverId].insert(itemInfo.id);
+	map<ServerIdType, GlobalItemIdMap> globalItemIdMaps;
+	vector<GenericIdType> globalItemIds;
+	for (const auto &pair : itemIdSetMap) {
+		GlobalItemIdMap &globalItemIdMap = globalItemIdMaps[pair.first];
+		getGlobalItemIds(dbAgent, pair.first, pair.second,
+		                 globalItemIdMap);
+		for (const auto &idPair : globalItemIdMap)
+			globalItemIds.push_back(idPair.second);
+	}
+
+	map<GenericIdType, ItemCategoryVect> currCategoriesMap;
+	getItemCategoriesFromIds(dbAgent, globalItemIds, currCategoriesMap);
+
+	// The last one wins when the same item appears more than once
+	// like the upsert above.
+	ItemCategoryVect      newItemCategories;
+	vector<GenericIdType> delCategoryIds;
+	set<GenericIdType>    processedGlobalItemIds;
+	for (auto it = itemInfoList.rbegin(); it != itemInfoList.rend(); ++it) {
+		const ItemInfo &itemInfo = *it;
+		const GlobalItemIdMap &globalItemIdMap =
+		  globalItemIdMaps[itemInfo.serverId];
+		auto idItr = globalItemIdMap.find(itemInfo.id);
+		HATOHOL_ASSERT(idItr != globalItemIdMap.end(),
+		               "Not found: server: %" FMT_SERVER_ID
+		               ", item: %" FMT_ITEM_ID,
+		               itemInfo.serverId, itemInfo.id.c_str());
+		const GenericIdType &globalItemId = idItr->second;
+		if (!processedGlobalItemIds.insert(globalItemId).second)
+			continue;
+		calcDelta(globalItemId,
+		          currCategoriesMap[globalItemId], itemInfo.categoryNames,
+		          newItemCategories, delCategoryIds);
+	}
+
+	deleteItemCategoriesWithoutTransaction(dbAgent, delCategoryIds);
+
+	if (newItemCategories.empty())
+		return;
+	DBAgent::InsertBatchArg categoryBatchArg(tableProfileItemCategories);
+	for (const auto &category : newItemCategories) {
+		DBAgent::InsertArg arg(tableProfileItemCategories);
+		arg.add(category.id);
+		arg.add(category.globalItemId);
+		arg.add(category.name);
+		categoryBatchArg.add(arg);
+	}
+	dbAgent.insertBatch(categoryBatchArg);
+}
+
 void DBTablesMonitoring::addMonitoringServerStatusWithoutTransaction(
   DBAgent &dbAgent, const MonitoringServerStatus &serverStatus)
 {
@@ -4068,8 +4786,7 @@ static void substIfNeeded(T &lhs, const T &rhs, const T &initialValue)
 		lhs = rhs;
 }
 
-bool DBTablesMonitoring::mergeTriggerInfo(
-  DBAgent &dbAgent, EventInfo &eventInfo)
+static void mergeTriggerInfo(EventInfo &eventInfo, const TriggerInfo &trigInfo)
 {
 	struct {
 		void operator()(string &lhs, const string &rhs)
@@ -4090,37 +4807,123 @@ bool DBTablesMonitoring::mergeTriggerInfo(
 		}
 	} setIfNeeded;
 
-	// Get the corresponding trigger
-	TriggersQueryOption option(USER_ID_SYSTEM);
-	option.setTargetServerId(eventInfo.serverId);
-	option.setTargetId(eventInfo.triggerId);
-	DBAgent::SelectExArg arg(tableProfileTriggers);
+	setIfNeeded(eventInfo.severity,       trigInfo.severity);
+	setIfNeeded(eventInfo.globalHostId,   trigInfo.globalHostId);
+	setIfNeeded(eventInfo.hostIdInServer, trigInfo.hostIdInServer);
+	setIfNeeded(eventInfo.hostName,       trigInfo.hostName);
+	setIfNeeded(eventInfo.brief,          trigInfo.brief);
+	setIfNeeded(eventInfo.extendedInfo,   trigInfo.extendedInfo);
+}
+
+static void addTriggerColumnsForMerge(DBAgent::SelectExArg &arg)
+{
 	arg.add(IDX_TRIGGERS_SEVERITY);
 	arg.add(IDX_TRIGGERS_GLOBAL_HOST_ID);
 	arg.add(IDX_TRIGGERS_HOST_ID_IN_SERVER);
 	arg.add(IDX_TRIGGERS_HOSTNAME);
 	arg.add(IDX_TRIGGERS_BRIEF);
 	arg.add(IDX_TRIGGERS_EXTENDED_INFO);
-	arg.condition = option.getCondition();
-	dbAgent.select(arg);
+}
 
-	const ItemGroupList &grpList = arg.dataTable->getItemGroupList();
-	if (grpList.empty())
-		return false;
-	ItemGroupStream itemGroupStream(*grpList.begin());
-	TriggerInfo trigInfo;
+static void readTriggerColumnsForMerge(ItemGroupStream &itemGroupStream,
+                                       TriggerInfo &trigInfo)
+{
 	itemGroupStream >> trigInfo.severity;
 	itemGroupStream >> trigInfo.globalHostId;
 	itemGroupStream >> trigInfo.hostIdInServer;
 	itemGroupStream >> trigInfo.hostName;
 	itemGroupStream >> trigInfo.brief;
 	itemGroupStream >> trigInfo.extendedInfo;
+}
 
-	setIfNeeded(eventInfo.severity,       trigInfo.severity);
-	setIfNeeded(eventInfo.globalHostId,   trigInfo.globalHostId);
-	setIfNeeded(eventInfo.hostIdInServer, trigInfo.hostIdInServer);
-	setIfNeeded(eventInfo.hostName,       trigInfo.hostName);
-	setIfNeeded(eventInfo.brief,          trigInfo.brief);
-	setIfNeeded(eventInfo.extendedInfo,   trigInfo.extendedInfo);
+bool DBTablesMonitoring::mergeTriggerInfo(
+  DBAgent &dbAgent, EventInfo &eventInfo)
+{
+	// Get the corresponding trigger
+	TriggersQueryOption option(USER_ID_SYSTEM);
+	option.setTargetServerId(eventInfo.serverId);
+	option.setTargetId(eventInfo.triggerId);
+	DBAgent::SelectExArg arg(tableProfileTriggers);
+	addTriggerColumnsForMerge(arg);
+	arg.condition = option.getCondition();
+	dbAgent.select(arg);
+
+	const ItemGroupList &grpList = arg.dataTable->getItemGroupList();
+	if (grpList.empty()) {
+		numTriggerMergeMisses++;
+		return false;
+	}
+	ItemGroupStream itemGroupStream(*grpList.begin());
+	TriggerInfo trigInfo;
+	readTriggerColumnsForMerge(itemGroupStream, trigInfo);
+	::mergeTriggerInfo(eventInfo, trigInfo);
+	numTriggerMergeHits++;
 	return true;
 }
+
+void DBTablesMonitoring::mergeTriggerInfo(
+  DBAgent &dbAgent, EventInfoList &eventInfoList)
+{
+	typedef map<TriggerIdType, TriggerInfo> TriggerInfoMap;
+	map<ServerIdType, set<TriggerIdType> > triggerIdSetMap;
+	for (const auto &eventInfo : eventInfoList)
+		triggerIdSetMap[eventInfo.serverId].insert(eventInfo.triggerId);
+
+	map<ServerIdType, TriggerInfoMap> triggerInfoMaps;
+	for (const auto &pair : triggerIdSetMap) {
+		const ServerIdType &serverId = pair.first;
+		const set<TriggerIdType> &triggerIdSet = pair.second;
+		TriggerInfoMap &triggerInfoMap = triggerInfoMaps[serverId];
+
+		TriggersQueryOption option(USER_ID_SYSTEM);
+		option.setTargetServerId(serverId);
+		const string serverCondition = option.getCondition();
+		forEachIdListChunk(dbAgent, triggerIdSet,
+		                   [&](const string &idList) {
+			DBAgent::SelectExArg arg(tableProfileTriggers);
+			arg.add(IDX_TRIGGERS_ID);
+			addTriggerColumnsForMerge(arg);
+			arg.condition = StringUtils::sprintf("%s IN (%s)",
+			  tableProfileTriggers.getFullColumnName(
+			    IDX_TRIGGERS_ID).c_str(),
+			  idList.c_str());
+			if (!serverCondition.empty()) {
+				arg.condition = StringUtils::sprintf(
+				  "(%s) AND %s", serverCondition.c_str(),
+				  arg.condition.c_str());
+			}
+			dbAgent.select(arg);
+
+			const ItemGroupList &grpList =
+			  arg.dataTable->getItemGroupList();
+			for (const auto &itemGroup : grpList) {
+				ItemGroupStream itemGroupStream(itemGroup);
+				TriggerInfo trigInfo;
+				itemGroupStream >> trigInfo.id;
+				readTriggerColumnsForMerge(itemGroupStream,
+				                           trigInfo);
+				triggerInfoMap[trigInfo.id] = trigInfo;
+			}
+		});
+	}
+
+	uint64_t numHits = 0;
+	for (auto &eventInfo : eventInfoList) {
+		const TriggerInfoMap &triggerInfoMap =
+		  triggerInfoMaps[eventInfo.serverId];
+		auto it = triggerInfoMap.find(eventInfo.triggerId);
+		if (it == triggerInfoMap.end())
+			continue;
+		::mergeTriggerInfo(eventInfo, it->second);
+		numHits++;
+	}
+	numTriggerMergeHits += numHits;
+	numTriggerMergeMisses += eventInfoList.size() - numHits;
+}
+
+void DBTablesMonitoring::getTriggerMergeStatistics(
+  TriggerMergeStatistics &stat)
+{
+	stat.numHits = numTriggerMergeHits;
+	stat.numMisses = numTriggerMergeMisses;
+}
@@ -50,6 +50,39 @@ public:
 	void setSortType(const SortType &type, const SortDirection &direction);
 	SortType getSortType(void) const;
 	SortDirection getSortDirection(void) const;
+
+	/**
+	 * Select only events after the given one in the sort order.
+	 *
+	 * It's used for keyset pagination instead of setOffset(). The next
+	 * page is found with an index seek however deep it is.
+	 *
+	 * @param unifiedId The unified ID of the last event of the page.
+	 * @param time The time of the event. It's used only with SORT_TIME.
+	 */
+	void setSeekPosition(const UnifiedEventIdType &unifiedId,
+	                     const timespec &time = {0, 0});
+
+	/**
+	 * Make a cursor that represents the position of the event.
+	 *
+	 * The cursor is an opaque string for clients. It depends on the
+	 * sort type. So setSortType() has to be called before this method.
+	 *
+	 * @param eventInfo The last event of a page.
+	 * @return A cursor string.
+	 */
+	std::string makeCursor(const EventInfo &eventInfo) const;
+
+	/**
+	 * Set the seek position with a cursor made by makeCursor().
+	 *
+	 * @param cursor A cursor string.
+	 * @return
+	 * false if the cursor is malformed or made for another sort type.
+	 */
+	bool setCursor(const std::string &cursor);
+
 	void setGroupByColumns(const std::vector<std::string> &columns);
 	std::vector<std::string> getGroupByColumns(void) const;
 
@@ -88,6 +121,8 @@ public:
 	  const std::list<EventIdType> &eventIds) const;
 
 private:
+	std::string makeSeekCondition(void) const;
+
 	struct Impl;
 	std::unique_ptr<Impl> m_impl;
 };
@@ -114,6 +149,7 @@ public:
 	void setTriggerStatus(const TriggerStatusType &status);
 	TriggerStatusType getTriggerStatus(void) const;
 	void setExcludeFlags(const ExcludeFlags &flg);
+	ExcludeFlags getExcludeFlags(void) const;
 
 	void setBeginTime(const timespec &beginTime);
 	const timespec &getBeginTime(void);
@@ -131,7 +167,48 @@ public:
 	std::string makeHostnameListCondition(
 	  const std::list<std::string> &hostnameList) const;
 
+	/**
+	 * Select only triggers after the given one in the order of
+	 * (server ID, trigger ID) and sort them in that order.
+	 *
+	 * It's used for keyset pagination instead of setOffset(). The
+	 * unique index on (server_id, id) is used however deep the page is.
+	 *
+	 * @param serverId The server ID of the last trigger of the page.
+	 * @param triggerId The ID of the last trigger of the page.
+	 */
+	void setSeekPosition(const ServerIdType &serverId,
+	                     const TriggerIdType &triggerId);
+
+	/**
+	 * Make a cursor that represents the position of the trigger.
+	 *
+	 * @param triggerInfo The last trigger of a page.
+	 * @return An opaque cursor string for clients.
+	 */
+	std::string makeCursor(const TriggerInfo &triggerInfo) const;
+
+	/**
+	 * Set the seek position with a cursor made by makeCursor().
+	 *
+	 * @param cursor
+	 * A cursor string. An empty one means the first page.
+	 * @return false if the cursor is malformed.
+	 */
+	bool setCursor(const std::string &cursor);
+
+	/**
+	 * Check if triggers are narrowed down by their own attributes such
+	 * as the ID, the severity, the status, the time, host names and
+	 * the brief. Note that the exclude flags are not counted.
+	 *
+	 * @return true if any of such conditions is set.
+	 */
+	bool isTriggerAttributeFilterUsed(void) const;
+
 private:
+	void setSeekSortOrder(void);
+
 	struct Impl;
 	std::unique_ptr<Impl> m_impl;
 };
@@ -151,6 +228,24 @@ public:
 	const std::string &getTargetItemCategoryName(void);
 	void setExcludeFlags(const ExcludeFlags &flg);
 
+	/**
+	 * Select only items whose global ID is greater than the given one
+	 * and sort them by the global ID.
+	 *
+	 * It's used for keyset pagination instead of setOffset(). Pass 0 to
+	 * get the first page.
+	 *
+	 * @param globalId The largest global ID in the previous page.
+	 */
+	void setSeekPosition(const GenericIdType &globalId);
+
+	/**
+	 * Check if setSeekPosition() has been called.
+	 *
+	 * @return true if the items are paged by the global ID.
+	 */
+	bool hasSeekPosition(void) const;
+
 private:
 	struct Impl;
 	std::unique_ptr<Impl> m_impl;
@@ -224,9 +319,22 @@ public:
 	static const char *TABLE_NAME_INCIDENTS;
 	static const char *TABLE_NAME_INCIDENT_HISTORIES;
 
+	struct TriggerMergeStatistics {
+		uint64_t numHits;
+		uint64_t numMisses;
+	};
+
 	DBTablesMonitoring(DBAgent &dbAgent);
 	virtual ~DBTablesMonitoring();
 
+	/**
+	 * Get the numbers of the events whose trigger was found or not
+	 * found by mergeTriggerInfo() in this process.
+	 *
+	 * @param stat The statistics are stored in this variable.
+	 */
+	static void getTriggerMergeStatistics(TriggerMergeStatistics &stat);
+
 	void addTriggerInfo(const TriggerInfo *triggerInfo);
 	void addTriggerInfoList(const TriggerInfoList &triggerInfoList,
 	                        DBAgent::TransactionHooks *hooks = NULL);
@@ -334,6 +442,47 @@ public:
 	size_t getNumberOfHosts(const TriggersQueryOption &option);
 	size_t getNumberOfGoodHosts(const TriggersQueryOption &option);
 	size_t getNumberOfBadHosts(const TriggersQueryOption &option);
+
+	struct HostgroupTriggerStatistics {
+		size_t numBadTriggers[NUM_TRIGGER_SEVERITY];
+		size_t numHosts;
+		size_t numBadHosts;
+	};
+	typedef std::map<HostgroupIdType, HostgroupTriggerStatistics>
+	  HostgroupTriggerStatisticsMap;
+
+	struct ServerTriggerStatistics {
+		size_t numTriggers;
+		/**
+		 * Statistics of each host group. The statistics of the whole
+		 * server are stored with the key ALL_HOST_GROUPS.
+		 */
+		HostgroupTriggerStatisticsMap hostgroups;
+	};
+	typedef std::map<ServerIdType, ServerTriggerStatistics>
+	  ServerTriggerStatisticsMap;
+
+	/**
+	 * Get numbers of triggers and hosts grouped by servers, host groups
+	 * and severities at once.
+	 *
+	 * The result is equivalent to calling getNumberOfTriggers(),
+	 * getNumberOfBadTriggers(), getNumberOfHosts() and
+	 * getNumberOfBadHosts() for each combination of the target server
+	 * and the target host group. But it needs only a constant number of
+	 * queries regardless of the number of servers and host groups.
+	 *
+	 * @param statisticsMap
+	 * The obtained statistics are added to this map. Servers and
+	 * host groups without any matched triggers don't appear in the map.
+	 *
+	 * @param option
+	 * A query option to specify user ID (or privilege) and conditions.
+	 * The target host group in it should be ALL_HOST_GROUPS.
+	 */
+	void getTriggerStatistics(ServerTriggerStatisticsMap &statisticsMap,
+	                          const TriggersQueryOption &option);
+
 	size_t getNumberOfItems(const ItemsQueryOption &option);
 	HatoholError getNumberOfMonitoredItemsPerSecond(
 	  const DataQueryOption &option,
@@ -389,10 +538,26 @@ protected:
 
 	static void addTriggerInfoWithoutTransaction(
 	  DBAgent &dbAgent, const TriggerInfo &triggerInfo);
+	static void addTriggerInfoListWithoutTransaction(
+	  DBAgent &dbAgent, const TriggerInfoList &triggerInfoList);
 	static void addEventInfoWithoutTransaction(
 	  DBAgent &dbAgent, EventInfo &eventInfo);
+	static void addEventInfoListWithoutTransaction(
+	  DBAgent &dbAgent, EventInfoList &eventInfoList);
 	static void addItemInfoWithoutTransaction(
 	  DBAgent &dbAgent, const ItemInfo &itemInfo);
+
+	/**
+	 * Add or update items like addItemInfoWithoutTransaction().
+	 * The global item IDs and the current categories of all items are
+	 * read with a few queries and the categories are updated with
+	 * multi-row INSERT and DELETE statements.
+	 *
+	 * @param dbAgent A DBAgent instance.
+	 * @param itemInfoList A list of items to be added or updated.
+	 */
+	static void addItemInfoListWithoutTransaction(
+	  DBAgent &dbAgent, const ItemInfoList &itemInfoList);
 	static void addItemCategoryWithoutTransaction(
 	  DBAgent &dbAgent, const ItemCategory &category);
 	static void addMonitoringServerStatusWithoutTransaction(
@@ -418,6 +583,16 @@ protected:
 	 */
 	static bool mergeTriggerInfo(DBAgent &dbAgent, EventInfo &eventInfo);
 
+	/**
+	 * Merge the corresponding trigger information into each event like
+	 * the above method. The triggers are looked up with a few queries
+	 * for the whole list instead of one query per event.
+	 *
+	 * @param eventInfoList A list of EventInfo instances to be set.
+	 */
+	static void mergeTriggerInfo(DBAgent &dbAgent,
+	                             EventInfoList &eventInfoList);
+
 	size_t getNumberOfTriggers(const TriggersQueryOption &option,
 				   const std::string &additionalCondition);
 
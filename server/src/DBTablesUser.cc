@@ -20,6 +20,7 @@
 #include <stdint.h>
 #include "DBTablesUser.h"
 #include "DBTablesConfig.h"
+#include "AuthorizationCache.h"
 #include "ItemGroupStream.h"
 #include "DBHatohol.h"
 #include "DBTermCStringProvider.h"
@@ -496,6 +497,7 @@ void DBTablesUser::init(void)
 void DBTablesUser::reset(void)
 {
 	getSetupInfo().initialized = false;
+	AuthorizationCache::invalidate();
 }
 
 const DBTables::SetupInfo &DBTablesUser::getConstSetupInfo(void)
@@ -665,6 +667,7 @@ HatoholError DBTablesUser::updateUserInfo(
 		}
 	} trx(userInfo);
 	getDBAgent().runTransaction(trx);
+	AuthorizationCache::invalidate();
 	return trx.err;
 }
 
@@ -706,6 +709,7 @@ HatoholError DBTablesUser::updateUserInfoFlags(
 		}
 	} trx(oldUserFlag, updateUserFlag);
 	getDBAgent().runTransaction(trx);
+	AuthorizationCache::invalidate();
 	return trx.err;
 }
 
@@ -740,6 +744,7 @@ HatoholError DBTablesUser::deleteUserInfo(
 		}
 	} trx(userId);
 	getDBAgent().runTransaction(trx);
+	AuthorizationCache::invalidate();
 	return HTERR_OK;
 }
 
@@ -814,6 +819,7 @@ HatoholError DBTablesUser::addAccessInfo(AccessInfo &accessInfo,
 	arg.add(accessInfo.hostgroupId);
 
 	getDBAgent().runTransaction(arg, accessInfo.id);
+	AuthorizationCache::invalidate();
 	return HTERR_OK;
 }
 
@@ -828,6 +834,7 @@ HatoholError DBTablesUser::deleteAccessInfo(const AccessInfoIdType id,
 	arg.condition = StringUtils::sprintf("%s=%" FMT_ACCESS_INFO_ID,
 	                                     colId.columnName, id);
 	getDBAgent().runTransaction(arg);
+	AuthorizationCache::invalidate();
 	return HTERR_OK;
 }
 
@@ -20,31 +20,31 @@
 #include <cstdio>
 #include "DataQueryContext.h"
 #include "ThreadLocalDBCache.h"
+using namespace std;
 
 struct DataQueryContext::Impl {
-	OperationPrivilege   privilege;
-	ServerHostGrpSetMap *srvHostGrpSetMap;
-	ServerIdSet         *serverIdSet;
+	OperationPrivilege           privilege;
+	AuthorizationCache::EntryPtr authEntry;
 
 	Impl(const UserIdType &userId)
-	: privilege(userId),
-	  srvHostGrpSetMap(NULL),
-	  serverIdSet(NULL)
+	: privilege(userId)
 	{
 	}
 
 	virtual ~Impl()
 	{
-		clear();
 	}
 
 	void clear(void)
 	{
-		delete srvHostGrpSetMap;
-		srvHostGrpSetMap = NULL;
+		authEntry.reset();
+	}
 
-		delete serverIdSet;
-		serverIdSet = NULL;
+	AuthorizationCache::Entry &getAuthorizationEntry(void)
+	{
+		if (!authEntry)
+			authEntry = AuthorizationCache::get(privilege.getUserId());
+		return *authEntry;
 	}
 };
 
@@ -79,30 +79,28 @@ const OperationPrivilege &DataQueryContext::getOperationPrivilege(void) const
 
 const ServerHostGrpSetMap &DataQueryContext::getServerHostGrpSetMap(void)
 {
-	if (!m_impl->srvHostGrpSetMap) {
-		m_impl->srvHostGrpSetMap = new ServerHostGrpSetMap();
-		ThreadLocalDBCache cache;
-		DBTablesUser &dbUser = cache.getUser();
-		dbUser.getServerHostGrpSetMap(*m_impl->srvHostGrpSetMap,
-		                              m_impl->privilege.getUserId());
-	}
-	return *m_impl->srvHostGrpSetMap;
+	return m_impl->getAuthorizationEntry().getServerHostGrpSetMap();
 }
 
 bool DataQueryContext::isValidServer(const ServerIdType &serverId)
 {
 	const ServerIdSet &svIdSet = getValidServerIdSet();
-	return svIdSet.find(serverId) != m_impl->serverIdSet->end();
+	return svIdSet.find(serverId) != svIdSet.end();
 }
 
 const ServerIdSet &DataQueryContext::getValidServerIdSet(void)
 {
-	if (!m_impl->serverIdSet) {
-		m_impl->serverIdSet = new ServerIdSet();
+	auto loader = [&](ServerIdSet &serverIdSet) {
 		ThreadLocalDBCache cache;
 		DBTablesConfig &dbConfig = cache.getConfig();
-		dbConfig.getServerIdSet(*m_impl->serverIdSet, this);
-	}
-	return *m_impl->serverIdSet;
+		dbConfig.getServerIdSet(serverIdSet, this);
+	};
+	return m_impl->getAuthorizationEntry().getValidServerIdSet(
+	  m_impl->privilege.getFlags(), loader);
 }
 
+const string &DataQueryContext::getCachedCondition(
+  const string &key, AuthorizationCache::Entry::ConditionMaker maker)
+{
+	return m_impl->getAuthorizationEntry().getCondition(key, maker);
+}
@@ -22,6 +22,7 @@
 #include "UsedCountable.h"
 #include "UsedCountablePtr.h"
 #include "OperationPrivilege.h"
+#include "AuthorizationCache.h"
 
 /**
  * This class provides a function to share information for data query
@@ -38,6 +39,22 @@ public:
 	bool isValidServer(const ServerIdType &serverId);
 	const ServerIdSet &getValidServerIdSet(void);
 
+	/**
+	 * Get an SQL condition that depends only on the user's access list
+	 * and the valid servers. It's shared among the contexts of the user
+	 * until AuthorizationCache::invalidate() is called.
+	 *
+	 * @param key A key that identifies the condition.
+	 * @param maker
+	 * A function to make the condition. It's called only when the
+	 * condition for the key is not cached.
+	 *
+	 * @return The condition.
+	 */
+	const std::string &getCachedCondition(
+	  const std::string &key,
+	  AuthorizationCache::Entry::ConditionMaker maker);
+
 protected:
 	// To avoid an instance from being crated on a stack.
 	virtual ~DataQueryContext();
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <list>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <iterator>
+#include <unordered_map>
+#include <stdint.h>
+#include <glib.h>
+
+/**
+ * Reassembles messages divided by a sender such as a HAPI2 plugin.
+ *
+ * Each chunk belongs to a request ID and has a serial ID that starts
+ * from zero. Chunks are moved into the buffer and are concatenated only
+ * when take() is called. A request that isn't updated within the timeout
+ * is dropped. If the estimated size of the all buffered chunks exceeds
+ * the limit, the chunk is rejected and its request is dropped.
+ *
+ * @tparam T A std::list or a std::vector.
+ */
+template <typename T>
+class DividedMessageBuffer {
+public:
+	enum AppendResult {
+		APPENDED,
+		INVALID_SERIAL_ID,
+		TOO_LARGE,
+	};
+
+	/**
+	 * Constructor.
+	 *
+	 * @param maxBytes The maximum estimated size of buffered chunks.
+	 * @param timeoutMSec
+	 * A request that isn't updated within this period is dropped.
+	 */
+	DividedMessageBuffer(const size_t &maxBytes, const size_t &timeoutMSec)
+	: m_maxBytes(maxBytes),
+	  m_timeoutUSec(static_cast<gint64>(timeoutMSec) * 1000),
+	  m_numBytes(0)
+	{
+	}
+
+	DividedMessageBuffer(const DividedMessageBuffer &) = delete;
+	DividedMessageBuffer &operator=(const DividedMessageBuffer &) = delete;
+
+	/**
+	 * Append a chunk.
+	 *
+	 * @param requestId A request ID.
+	 * @param serialId A serial ID of the chunk.
+	 * @param chunk A chunk. It is moved into the buffer.
+	 * @param expectedSerialId
+	 * If this is not NULL, the expected serial ID is stored.
+	 *
+	 * @return
+	 * APPENDED on success. Otherwise the request is dropped and
+	 * INVALID_SERIAL_ID or TOO_LARGE is returned.
+	 */
+	AppendResult append(const std::string &requestId,
+	                    const int64_t &serialId, T &&chunk,
+	                    uint64_t *expectedSerialId = NULL)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		const gint64 now = g_get_monotonic_time();
+		expireWithoutLock(now);
+
+		auto it = m_requestMap.find(requestId);
+		const uint64_t expected =
+		  (it == m_requestMap.end()) ? 0 : it->second->chunks.size();
+		if (expectedSerialId)
+			*expectedSerialId = expected;
+		if (serialId < 0 ||
+		    static_cast<uint64_t>(serialId) != expected) {
+			dropWithoutLock(it);
+			return INVALID_SERIAL_ID;
+		}
+
+		const size_t numBytes = estimateBytes(chunk);
+		if (m_numBytes + numBytes > m_maxBytes) {
+			dropWithoutLock(it);
+			return TOO_LARGE;
+		}
+
+		// The list is kept in order of the last update time.
+		typename RequestList::iterator reqIt;
+		if (it == m_requestMap.end()) {
+			reqIt = m_requests.emplace(m_requests.end());
+			reqIt->requestId = requestId;
+			reqIt->numBytes = 0;
+			m_requestMap[requestId] = reqIt;
+		} else {
+			reqIt = it->second;
+			m_requests.splice(m_requests.end(), m_requests, reqIt);
+		}
+		reqIt->chunks.push_back(std::move(chunk));
+		reqIt->numBytes += numBytes;
+		reqIt->lastUpdateTime = now;
+		m_numBytes += numBytes;
+		return APPENDED;
+	}
+
+	/**
+	 * Concatenate the chunks of the request and remove it.
+	 *
+	 * @param requestId A request ID.
+	 * @param message The chunks are appended to this object.
+	 *
+	 * @return true if the request is found. Otherwise false.
+	 */
+	bool take(const std::string &requestId, T &message)
+	{
+		std::vector<T> chunks;
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			auto it = m_requestMap.find(requestId);
+			if (it == m_requestMap.end())
+				return false;
+			chunks.swap(it->second->chunks);
+			dropWithoutLock(it);
+		}
+		if (message.empty() && chunks.size() == 1) {
+			message = std::move(chunks.front());
+			return true;
+		}
+		size_t numElements = message.size();
+		for (auto &chunk : chunks)
+			numElements += chunk.size();
+		reserve(message, numElements);
+		for (auto &chunk : chunks)
+			concat(message, chunk);
+		return true;
+	}
+
+	/**
+	 * Remove the request.
+	 *
+	 * @param requestId A request ID.
+	 *
+	 * @return true if the request is found. Otherwise false.
+	 */
+	bool erase(const std::string &requestId)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		auto it = m_requestMap.find(requestId);
+		if (it == m_requestMap.end())
+			return false;
+		dropWithoutLock(it);
+		return true;
+	}
+
+	/**
+	 * Drop requests that aren't updated within the timeout. This is
+	 * also called by append().
+	 *
+	 * @param now The current time got with g_get_monotonic_time().
+	 *
+	 * @return The number of the dropped requests.
+	 */
+	size_t expire(const gint64 &now)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		return expireWithoutLock(now);
+	}
+
+	/**
+	 * Change the timeout. It's also applied to the buffered requests.
+	 *
+	 * @param timeoutMSec
+	 * A request that isn't updated within this period is dropped.
+	 */
+	void setTimeout(const size_t &timeoutMSec)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_timeoutUSec = static_cast<gint64>(timeoutMSec) * 1000;
+	}
+
+	size_t getNumberOfRequests(void)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		return m_requestMap.size();
+	}
+
+	size_t getNumberOfBufferedBytes(void)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		return m_numBytes;
+	}
+
+	/**
+	 * Estimate the memory size of the chunk. The heap memory owned by
+	 * each element such as strings is not counted.
+	 */
+	static size_t estimateBytes(const T &chunk)
+	{
+		return chunk.size() * sizeof(typename T::value_type);
+	}
+
+private:
+	struct Request {
+		std::string    requestId;
+		std::vector<T> chunks;
+		size_t         numBytes;
+		gint64         lastUpdateTime;
+	};
+	typedef std::list<Request> RequestList;
+	typedef std::unordered_map<std::string,
+	                           typename RequestList::iterator> RequestMap;
+
+	std::mutex   m_lock;
+	const size_t m_maxBytes;
+	gint64 m_timeoutUSec;
+	size_t       m_numBytes;
+	RequestList  m_requests;
+	RequestMap   m_requestMap;
+
+	void dropWithoutLock(typename RequestMap::iterator it)
+	{
+		if (it == m_requestMap.end())
+			return;
+		typename RequestList::iterator reqIt = it->second;
+		m_numBytes -= reqIt->numBytes;
+		m_requestMap.erase(it);
+		m_requests.erase(reqIt);
+	}
+
+	size_t expireWithoutLock(const gint64 &now)
+	{
+		size_t numExpired = 0;
+		while (!m_requests.empty()) {
+			Request &req = m_requests.front();
+			if (now - req.lastUpdateTime <= m_timeoutUSec)
+				break;
+			dropWithoutLock(m_requestMap.find(req.requestId));
+			numExpired++;
+		}
+		return numExpired;
+	}
+
+	template <typename E, typename A>
+	static void reserve(std::list<E, A> &, const size_t &)
+	{
+	}
+
+	template <typename E, typename A>
+	static void reserve(std::vector<E, A> &message, const size_t &size)
+	{
+		message.reserve(size);
+	}
+
+	template <typename E, typename A>
+	static void concat(std::list<E, A> &message, std::list<E, A> &chunk)
+	{
+		message.splice(message.end(), chunk);
+	}
+
+	template <typename E, typename A>
+	static void concat(std::vector<E, A> &message,
+	                   std::vector<E, A> &chunk)
+	{
+		message.insert(message.end(),
+		               std::make_move_iterator(chunk.begin()),
+		               std::make_move_iterator(chunk.end()));
+	}
+};
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <string>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * Calculates a hash of the fields of an element with FNV-1a.
+ *
+ * The fields are added with operator<<. The type of the element given to
+ * the constructor separates the hashes of different kinds of elements.
+ */
+struct ElementHasher {
+	static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+	static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+	uint64_t value;
+
+	ElementHasher(const int &elementType)
+	: value(FNV_OFFSET_BASIS)
+	{
+		addBytes(&elementType, sizeof(elementType));
+	}
+
+	void addBytes(const void *data, const size_t &size)
+	{
+		const uint8_t *bytes = static_cast<const uint8_t *>(data);
+		for (size_t i = 0; i < size; i++) {
+			value ^= bytes[i];
+			value *= FNV_PRIME;
+		}
+	}
+
+	ElementHasher &operator<<(const std::string &str)
+	{
+		// The length separates adjacent strings.
+		const uint64_t length = str.size();
+		addBytes(&length, sizeof(length));
+		addBytes(str.data(), str.size());
+		return *this;
+	}
+
+	ElementHasher &operator<<(const uint64_t &num)
+	{
+		addBytes(&num, sizeof(num));
+		return *this;
+	}
+
+	ElementHasher &operator<<(const int &num)
+	{
+		return *this << static_cast<uint64_t>(num);
+	}
+
+	ElementHasher &operator<<(const timespec &ts)
+	{
+		return *this << static_cast<uint64_t>(ts.tv_sec)
+		             << static_cast<uint64_t>(ts.tv_nsec);
+	}
+};
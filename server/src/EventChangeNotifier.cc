@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <map>
+#include <mutex>
+#include "EventChangeNotifier.h"
+
+using namespace std;
+
+typedef map<EventChangeNotifier::WaiterId, EventChangeNotifier::Callback>
+  WaiterMap;
+
+struct EventChangeNotifier::Impl {
+	static mutex    lock;
+	static uint64_t generation;
+	static WaiterId lastWaiterId;
+	static WaiterMap waiterMap;
+};
+
+mutex     EventChangeNotifier::Impl::lock;
+uint64_t  EventChangeNotifier::Impl::generation = 0;
+EventChangeNotifier::WaiterId EventChangeNotifier::Impl::lastWaiterId = 0;
+WaiterMap EventChangeNotifier::Impl::waiterMap;
+
+// ---------------------------------------------------------------------------
+// Public methods
+// ---------------------------------------------------------------------------
+void EventChangeNotifier::reset(void)
+{
+	lock_guard<mutex> lock(Impl::lock);
+	Impl::waiterMap.clear();
+}
+
+uint64_t EventChangeNotifier::getGeneration(void)
+{
+	lock_guard<mutex> lock(Impl::lock);
+	return Impl::generation;
+}
+
+void EventChangeNotifier::notify(void)
+{
+	WaiterMap waiterMap;
+	{
+		lock_guard<mutex> lock(Impl::lock);
+		Impl::generation++;
+		waiterMap.swap(Impl::waiterMap);
+	}
+	// Callbacks are called without the lock so that they can add
+	// waiters again.
+	for (auto &waiter : waiterMap)
+		waiter.second();
+}
+
+bool EventChangeNotifier::addWaiter(const uint64_t &generation,
+                                    Callback callback, WaiterId &id)
+{
+	lock_guard<mutex> lock(Impl::lock);
+	if (generation != Impl::generation)
+		return false;
+	// IDs are never reused. So a stale ID doesn't remove another waiter.
+	id = ++Impl::lastWaiterId;
+	Impl::waiterMap.emplace(id, callback);
+	return true;
+}
+
+bool EventChangeNotifier::removeWaiter(const WaiterId &id)
+{
+	lock_guard<mutex> lock(Impl::lock);
+	return Impl::waiterMap.erase(id) > 0;
+}
+
+size_t EventChangeNotifier::getNumberOfWaiters(void)
+{
+	lock_guard<mutex> lock(Impl::lock);
+	return Impl::waiterMap.size();
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#include <functional>
+#include <stdint.h>
+
+/**
+ * Tells waiters that events have been added.
+ *
+ * A waiter gets the generation with getGeneration() before it looks up
+ * events. If nothing is found, it passes the generation to addWaiter().
+ * So events added between the look-up and addWaiter() are never missed.
+ *
+ * Each callback is called only once, in the thread that calls notify().
+ * It should return quickly because it blocks the ingest of events.
+ */
+class EventChangeNotifier {
+public:
+	typedef std::function<void (void)> Callback;
+	typedef uint64_t WaiterId;
+
+	static void reset(void);
+
+	/**
+	 * Get the generation, which is incremented by notify().
+	 *
+	 * @return The current generation.
+	 */
+	static uint64_t getGeneration(void);
+
+	/**
+	 * Increment the generation and call all callbacks. The waiters are
+	 * removed before the callbacks are called.
+	 */
+	static void notify(void);
+
+	/**
+	 * Add a waiter.
+	 *
+	 * @param generation A generation got with getGeneration().
+	 * @param callback A function called by notify().
+	 * @param id The ID of the added waiter is stored in this variable.
+	 *
+	 * @return
+	 * true if the waiter is added. false if the generation has already
+	 * been changed. In that case, the callback is not called.
+	 */
+	static bool addWaiter(const uint64_t &generation,
+	                      Callback callback, WaiterId &id);
+
+	/**
+	 * Remove a waiter.
+	 *
+	 * @param id An ID got with addWaiter().
+	 *
+	 * @return
+	 * true if the waiter is removed. false if the waiter has already
+	 * been removed or notify() has taken it.
+	 */
+	static bool removeWaiter(const WaiterId &id);
+
+	static size_t getNumberOfWaiters(void);
+
+private:
+	struct Impl;
+};
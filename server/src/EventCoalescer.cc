@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <Logger.h>
+#include "EventCoalescer.h"
+
+using namespace std;
+using namespace mlpl;
+
+const size_t EventCoalescer::DEFAULT_MAX_BATCH_SIZE = 100;
+const size_t EventCoalescer::DEFAULT_FLUSH_INTERVAL_MSEC = 100;
+
+struct Counters {
+	atomic<uint64_t> numFlushes;
+	atomic<uint64_t> numEvents;
+	atomic<size_t>   maxBatchSize;
+	atomic<uint64_t> totalFlushLatencyUSec;
+	atomic<uint64_t> maxFlushLatencyUSec;
+
+	Counters(void)
+	: numFlushes(0),
+	  numEvents(0),
+	  maxBatchSize(0),
+	  totalFlushLatencyUSec(0),
+	  maxFlushLatencyUSec(0)
+	{
+	}
+
+	template <typename T>
+	static void updateMax(atomic<T> &max, const T &value)
+	{
+		T curr = max;
+		while (value > curr && !max.compare_exchange_weak(curr, value))
+			;
+	}
+
+	void add(const size_t &batchSize, const uint64_t &latencyUSec)
+	{
+		numFlushes++;
+		numEvents += batchSize;
+		updateMax(maxBatchSize, batchSize);
+		totalFlushLatencyUSec += latencyUSec;
+		updateMax(maxFlushLatencyUSec, latencyUSec);
+	}
+
+	void get(EventCoalescer::Statistics &stat) const
+	{
+		stat.numFlushes = numFlushes;
+		stat.numEvents = numEvents;
+		stat.maxBatchSize = maxBatchSize;
+		stat.totalFlushLatencyUSec = totalFlushLatencyUSec;
+		stat.maxFlushLatencyUSec = maxFlushLatencyUSec;
+	}
+};
+
+static Counters globalCounters;
+
+struct EventCoalescer::Impl {
+	const FlushFunc flushFunc;
+	const size_t    maxBatchSize;
+	const size_t    flushIntervalMSec;
+
+	// Protects the current batch.
+	mutex              lock;
+	condition_variable cond;
+	EventInfoList      batch;
+	// The time when the first event of the current batch was added.
+	gint64             firstAddedTime;
+
+	// Flushes are serialized with this lock to keep the order.
+	mutex              flushLock;
+	Counters           counters;
+
+	Impl(FlushFunc _flushFunc, const size_t &_maxBatchSize,
+	     const size_t &_flushIntervalMSec)
+	: flushFunc(_flushFunc),
+	  maxBatchSize(_maxBatchSize ? _maxBatchSize : DEFAULT_MAX_BATCH_SIZE),
+	  flushIntervalMSec(_flushIntervalMSec ? _flushIntervalMSec :
+	                    DEFAULT_FLUSH_INTERVAL_MSEC),
+	  firstAddedTime(0)
+	{
+	}
+
+	gint64 getDeadline(void) const
+	{
+		return firstAddedTime + flushIntervalMSec * 1000;
+	}
+
+	// This method must be called with flushLock taken.
+	void flushWithoutLock(void)
+	{
+		EventInfoList eventList;
+		gint64 addedTime;
+		{
+			lock_guard<mutex> batchLock(lock);
+			eventList.swap(batch);
+			addedTime = firstAddedTime;
+		}
+		if (eventList.empty())
+			return;
+
+		const size_t batchSize = eventList.size();
+		try {
+			flushFunc(eventList);
+		} catch (const exception &e) {
+			MLPL_ERR("Failed to flush %zd event(s): %s\n",
+			         batchSize, e.what());
+		}
+		const gint64 latency = g_get_monotonic_time() - addedTime;
+		counters.add(batchSize, latency);
+		globalCounters.add(batchSize, latency);
+	}
+
+	void flush(void)
+	{
+		lock_guard<mutex> lock(flushLock);
+		flushWithoutLock();
+	}
+};
+
+// ---------------------------------------------------------------------------
+// Public methods
+// ---------------------------------------------------------------------------
+EventCoalescer::EventCoalescer(FlushFunc flushFunc,
+                               const size_t &maxBatchSize,
+                               const size_t &flushIntervalMSec)
+: m_impl(new Impl(flushFunc, maxBatchSize, flushIntervalMSec))
+{
+}
+
+EventCoalescer::~EventCoalescer()
+{
+	if (isStarted())
+		exitSync();
+	m_impl->flush();
+}
+
+void EventCoalescer::exitSync(void)
+{
+	requestExit();
+	{
+		lock_guard<mutex> lock(m_impl->lock);
+		m_impl->cond.notify_all();
+	}
+	HatoholThreadBase::exitSync();
+}
+
+void EventCoalescer::add(const EventInfo &eventInfo)
+{
+	bool full = false;
+	{
+		lock_guard<mutex> lock(m_impl->lock);
+		if (m_impl->batch.empty()) {
+			m_impl->firstAddedTime = g_get_monotonic_time();
+			m_impl->cond.notify_all();
+		}
+		m_impl->batch.push_back(eventInfo);
+		full = (m_impl->batch.size() >= m_impl->maxBatchSize);
+	}
+	if (full)
+		flush();
+}
+
+void EventCoalescer::flush(void)
+{
+	m_impl->flush();
+}
+
+size_t EventCoalescer::getMaxBatchSize(void) const
+{
+	return m_impl->maxBatchSize;
+}
+
+size_t EventCoalescer::getFlushIntervalMSec(void) const
+{
+	return m_impl->flushIntervalMSec;
+}
+
+void EventCoalescer::getStatistics(Statistics &stat) const
+{
+	m_impl->counters.get(stat);
+}
+
+void EventCoalescer::getGlobalStatistics(Statistics &stat)
+{
+	globalCounters.get(stat);
+}
+
+// ---------------------------------------------------------------------------
+// Protected methods
+// ---------------------------------------------------------------------------
+gpointer EventCoalescer::mainThread(HatoholThreadArg *arg)
+{
+	while (!isExitRequested()) {
+		{
+			unique_lock<mutex> lock(m_impl->lock);
+			// exitSync() notifies with the lock after requesting
+			// the exit. So this check never misses it.
+			if (isExitRequested())
+				break;
+			if (m_impl->batch.empty()) {
+				m_impl->cond.wait(lock);
+				continue;
+			}
+			const gint64 deadline = m_impl->getDeadline();
+			const gint64 now = g_get_monotonic_time();
+			if (now < deadline) {
+				m_impl->cond.wait_for(
+				  lock, chrono::microseconds(deadline - now));
+				continue;
+			}
+		}
+		flush();
+	}
+	return NULL;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include "HatoholThreadBase.h"
+#include "Monitoring.h"
+
+/**
+ * Groups events into batches so that many events are stored with one call.
+ *
+ * A batch is flushed when it has the maximum number of events or when its
+ * first event has waited for the flush interval. A full batch is flushed
+ * in the thread that calls add(). The other batches are flushed in
+ * the background thread of this class. Batches are always flushed one by
+ * one in the added order.
+ */
+class EventCoalescer : public HatoholThreadBase {
+public:
+	typedef std::function<void (EventInfoList &)> FlushFunc;
+
+	static const size_t DEFAULT_MAX_BATCH_SIZE;
+	static const size_t DEFAULT_FLUSH_INTERVAL_MSEC;
+
+	struct Statistics {
+		uint64_t numFlushes;
+		uint64_t numEvents;
+		size_t   maxBatchSize;
+		// The latency is the time from the addition of the first event
+		// in a batch to the completion of the flush.
+		uint64_t totalFlushLatencyUSec;
+		uint64_t maxFlushLatencyUSec;
+	};
+
+	/**
+	 * Constructor.
+	 *
+	 * @param flushFunc A function called with each batch.
+	 * @param maxBatchSize
+	 * The maximum number of events in a batch. If it is 0,
+	 * DEFAULT_MAX_BATCH_SIZE is used.
+	 * @param flushIntervalMSec
+	 * The maximum time that an event waits before it is flushed. If it is
+	 * 0, DEFAULT_FLUSH_INTERVAL_MSEC is used.
+	 */
+	EventCoalescer(FlushFunc flushFunc, const size_t &maxBatchSize = 0,
+	               const size_t &flushIntervalMSec = 0);
+
+	/**
+	 * Destructor. The remaining events are flushed.
+	 */
+	virtual ~EventCoalescer();
+
+	virtual void exitSync(void) override;
+
+	void add(const EventInfo &eventInfo);
+
+	/**
+	 * Flush the current batch immediately.
+	 */
+	void flush(void);
+
+	size_t getMaxBatchSize(void) const;
+	size_t getFlushIntervalMSec(void) const;
+	void getStatistics(Statistics &stat) const;
+
+	/**
+	 * Get the statistics summed up for all instances in this process.
+	 *
+	 * @param stat The statistics are stored in this variable.
+	 */
+	static void getGlobalStatistics(Statistics &stat);
+
+protected:
+	gpointer mainThread(HatoholThreadArg *arg) override;
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
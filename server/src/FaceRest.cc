@@ -21,12 +21,13 @@
 #endif // HAVE_CONFIG_H
 
 #include <cstring>
-#include <queue>
+#include <atomic>
 #include <Logger.h>
 #include <Reaper.h>
 #include <Mutex.h>
 #include <SmartTime.h>
 #include <AtomicValue.h>
+#include <LockFreeQueue.h>
 #include <errno.h>
 #include <uuid/uuid.h>
 #include <semaphore.h>
@@ -57,9 +58,14 @@ using namespace mlpl;
 int FaceRest::API_VERSION = 4;
 const char *FaceRest::SESSION_ID_HEADER_NAME = "X-Hatohol-Session";
 const int FaceRest::DEFAULT_NUM_WORKERS = 4;
+const int FaceRest::DEFAULT_MAX_NUM_WORKERS = 16;
 
 static const guint DEFAULT_PORT = 33194;
 
+// When the queue is full, the job is handled in the main thread of FaceRest.
+// It throttles the new requests until the workers catch up.
+static const size_t JOB_QUEUE_CAPACITY = 1024;
+
 const char *FaceRest::pathForTest   = "/test";
 const char *FaceRest::pathForLogin  = "/login";
 const char *FaceRest::pathForLogout = "/logout";
@@ -106,13 +112,27 @@ struct FaceRest::Impl {
 	set<string>         handlerPathSet;
 
 	// for async mode
+	struct QueuedJob {
+		ResourceHandler *handler;
+		SmartTime        queuedTime;
+	};
+
 	bool             asyncMode;
 	size_t           numPreLoadWorkers;
+	size_t           maxNumWorkers;
+	// Only the thread of FaceRest::mainThread() touches 'workers'.
 	set<Worker *>    workers;
-	queue<ResourceHandler *> restJobQueue;
-	Mutex            restJobLock;
+	LockFreeQueue<QueuedJob> restJobQueue;
 	sem_t            waitJobSemaphore;
 
+	// statistics
+	atomic<size_t>   numWorkers;
+	atomic<size_t>   numIdleWorkers;
+	atomic<uint64_t> numProcessedJobs;
+	atomic<uint64_t> numOverflowedJobs;
+	atomic<uint64_t> totalWaitTimeUSec;
+	atomic<uint64_t> maxWaitTimeUSec;
+
 	Impl(FaceRestParam *_param)
 	: port(DEFAULT_PORT),
 	  soupServer(NULL),
@@ -120,7 +140,15 @@ struct FaceRest::Impl {
 	  param(_param),
 	  quitRequest(false),
 	  asyncMode(true),
-	  numPreLoadWorkers(DEFAULT_NUM_WORKERS)
+	  numPreLoadWorkers(DEFAULT_NUM_WORKERS),
+	  maxNumWorkers(DEFAULT_MAX_NUM_WORKERS),
+	  restJobQueue(JOB_QUEUE_CAPACITY),
+	  numWorkers(0),
+	  numIdleWorkers(0),
+	  numProcessedJobs(0),
+	  numOverflowedJobs(0),
+	  totalWaitTimeUSec(0),
+	  maxWaitTimeUSec(0)
 	{
 		gMainCtx = g_main_context_new();
 		sem_init(&waitJobSemaphore, 0, 0);
@@ -132,33 +160,54 @@ struct FaceRest::Impl {
 		sem_destroy(&waitJobSemaphore);
 	}
 
-	void pushJob(ResourceHandler *job)
+	bool pushJob(ResourceHandler *job)
 	{
-		restJobLock.lock();
-		restJobQueue.push(job);
+		QueuedJob queuedJob = {
+		  job, SmartTime(SmartTime::INIT_CURR_TIME)
+		};
+		if (!restJobQueue.tryPush(queuedJob)) {
+			numOverflowedJobs++;
+			return false;
+		}
 		if (sem_post(&waitJobSemaphore) == -1)
 			MLPL_ERR("Failed to call sem_post: %d\n",
 				 errno);
-		restJobLock.unlock();
+		return true;
 	}
 
 	bool waitJob(void)
 	{
+		numIdleWorkers++;
 		if (sem_wait(&waitJobSemaphore) == -1)
 			MLPL_ERR("Failed to call sem_wait: %d\n", errno);
+		numIdleWorkers--;
 		return !quitRequest.get();
 	}
 
 	ResourceHandler *popJob(void)
 	{
-		ResourceHandler *job = NULL;
-		restJobLock.lock();
-		if (!restJobQueue.empty()) {
-			job = restJobQueue.front();
-			restJobQueue.pop();
+		QueuedJob queuedJob;
+		if (!restJobQueue.tryPop(queuedJob))
+			return NULL;
+
+		SmartTime waitTime(SmartTime::INIT_CURR_TIME);
+		waitTime -= queuedJob.queuedTime;
+		const uint64_t waitTimeUSec =
+		  static_cast<uint64_t>(waitTime.getAsMSec() * 1000);
+		numProcessedJobs++;
+		totalWaitTimeUSec += waitTimeUSec;
+		uint64_t currMax = maxWaitTimeUSec;
+		while (waitTimeUSec > currMax) {
+			if (maxWaitTimeUSec.compare_exchange_weak(
+			      currMax, waitTimeUSec))
+				break;
 		}
-		restJobLock.unlock();
-		return job;
+		return queuedJob.handler;
+	}
+
+	bool isBusy(void) const
+	{
+		return restJobQueue.size() > numIdleWorkers;
 	}
 
 	void addHandler(const char *path, ResourceHandlerFactory *factory)
@@ -184,6 +233,9 @@ struct FaceRest::Impl {
 	  (SoupServer *server, SoupMessage *msg, const char *path,
 	   GHashTable *query, SoupClientContext *client, gpointer user_data);
 
+	// This method has to be called in the FaceRest thread.
+	static void dispatchJob(ResourceHandler *job);
+
 	static bool isTestPath(const string &path)
 	{
 		size_t len = strlen(pathForTest);
@@ -215,10 +267,15 @@ protected:
 	{
 		ResourceHandler *job;
 		MLPL_INFO("start face-rest worker\n");
+
+		// Open the DB connection of this worker in advance. It is
+		// cached for the thread and reused by all jobs of the worker.
+		ThreadLocalDBCache cache;
+		cache.getDBHatohol();
+
 		while ((job = waitNextJob())) {
 			job->handleInTryBlock();
-			job->unpauseResponse();
-			job->unref();
+			job->finishHandling();
 		}
 		MLPL_INFO("exited face-rest worker\n");
 		return NULL;
@@ -269,9 +326,14 @@ FaceRest::FaceRest(FaceRestParam *param)
 	if (num > 0) {
 		setNumberOfPreLoadWorkers(num);
 	}
-
-	MLPL_INFO("started face-rest, port: %d, workers: %zu\n",
-		  m_impl->port, m_impl->numPreLoadWorkers);
+	int maxNum =
+	  ConfigManager::getInstance()->getFaceRestMaxNumWorkers();
+	if (maxNum > 0)
+		setMaxNumberOfWorkers(maxNum);
+
+	MLPL_INFO("started face-rest, port: %d, workers: %zu, max: %zu\n",
+		  m_impl->port, m_impl->numPreLoadWorkers,
+		  getMaxNumberOfWorkers());
 }
 
 FaceRest::~FaceRest()
@@ -310,6 +372,27 @@ void FaceRest::setNumberOfPreLoadWorkers(size_t num)
 	m_impl->numPreLoadWorkers = num;
 }
 
+void FaceRest::setMaxNumberOfWorkers(size_t num)
+{
+	m_impl->maxNumWorkers = num;
+}
+
+size_t FaceRest::getMaxNumberOfWorkers(void) const
+{
+	return max(m_impl->maxNumWorkers, m_impl->numPreLoadWorkers);
+}
+
+void FaceRest::getWorkerStatistics(WorkerStatistics &stat) const
+{
+	stat.numWorkers        = m_impl->numWorkers;
+	stat.numIdleWorkers    = m_impl->numIdleWorkers;
+	stat.queueDepth        = m_impl->restJobQueue.size();
+	stat.numProcessedJobs  = m_impl->numProcessedJobs;
+	stat.numOverflowedJobs = m_impl->numOverflowedJobs;
+	stat.totalWaitTimeUSec = m_impl->totalWaitTimeUSec;
+	stat.maxWaitTimeUSec   = m_impl->maxWaitTimeUSec;
+}
+
 void FaceRest::addResourceHandlerFactory(const char *path,
 					 ResourceHandlerFactory *factory)
 {
@@ -348,11 +431,27 @@ bool FaceRest::isAsyncMode(void)
 
 void FaceRest::startWorkers(void)
 {
-	for (size_t i = 0; i < m_impl->numPreLoadWorkers; i++) {
-		Worker *worker = new Worker(this);
-		worker->start();
-		m_impl->workers.insert(worker);
-	}
+	for (size_t i = 0; i < m_impl->numPreLoadWorkers; i++)
+		addWorker();
+}
+
+void FaceRest::addWorker(void)
+{
+	Worker *worker = new Worker(this);
+	worker->start();
+	m_impl->workers.insert(worker);
+	m_impl->numWorkers = m_impl->workers.size();
+}
+
+void FaceRest::addWorkerIfBusy(void)
+{
+	if (m_impl->workers.size() >= getMaxNumberOfWorkers())
+		return;
+	if (!m_impl->isBusy())
+		return;
+	addWorker();
+	MLPL_INFO("added a face-rest worker: %zu\n",
+	          m_impl->workers.size());
 }
 
 void FaceRest::stopWorkers(void)
@@ -369,6 +468,7 @@ void FaceRest::stopWorkers(void)
 		delete worker;
 	}
 	workers.clear();
+	m_impl->numWorkers = 0;
 }
 
 gpointer FaceRest::mainThread(HatoholThreadArg *arg)
@@ -479,7 +579,6 @@ void FaceRest::Impl::queueRestJob
 
 	ResourceHandlerFactory *factory
 	  = static_cast<ResourceHandlerFactory *>(user_data);
-	FaceRest *face = factory->m_faceRest;
 	ResourceHandler *job = factory->createHandler();
 	bool succeeded = job->setRequest(msg, path, query, client);
 	if (!succeeded) {
@@ -488,13 +587,17 @@ void FaceRest::Impl::queueRestJob
 	}
 
 	job->pauseResponse();
+	dispatchJob(job);
+}
 
-	if (face->isAsyncMode()) {
-		face->m_impl->pushJob(job);
+void FaceRest::Impl::dispatchJob(ResourceHandler *job)
+{
+	FaceRest *face = job->m_faceRest;
+	if (face->isAsyncMode() && face->m_impl->pushJob(job)) {
+		face->addWorkerIfBusy();
 	} else {
 		job->handleInTryBlock();
-		job->unpauseResponse();
-		job->unref();
+		job->finishHandling();
 	}
 }
 
@@ -666,6 +769,24 @@ void FaceRest::ResourceHandler::handleInTryBlock(void)
 	}
 }
 
+void FaceRest::ResourceHandler::finishHandling(void)
+{
+	unpauseResponse();
+	// The job may be handled by another worker after the function is
+	// called. So it's taken out in advance.
+	function<void(void)> handOffFunc;
+	handOffFunc.swap(m_handOffFunc);
+	if (handOffFunc)
+		handOffFunc();
+	unref();
+}
+
+void FaceRest::ResourceHandler::setHandOffFunc(
+  const function<void(void)> &func)
+{
+	m_handOffFunc = func;
+}
+
 SoupServer *FaceRest::ResourceHandler::getSoupServer(void)
 {
 	return m_faceRest ? m_faceRest->getSoupServer() : NULL;
@@ -814,6 +935,20 @@ bool FaceRest::ResourceHandler::unpauseResponse(bool force)
 	return true;
 }
 
+gboolean FaceRest::ResourceHandler::idleRehandle(gpointer data)
+{
+	ResourceHandler *job = static_cast<ResourceHandler *>(data);
+	Impl::dispatchJob(job);
+	return FALSE;
+}
+
+void FaceRest::ResourceHandler::rehandle(void)
+{
+	// The job is dispatched in the FaceRest thread since only the thread
+	// can add workers.
+	soup_add_completion(getGMainContext(), idleRehandle, this);
+}
+
 bool FaceRest::ResourceHandler::httpMethodIs(const char *method)
 {
 	if (!m_message)
@@ -856,14 +991,32 @@ void FaceRest::ResourceHandler::replyError(const HatoholErrorCode &errorCode,
 	replyError(hatoholError, statusCode);
 }
 
-static string wrapForJSONP(const string &jsonBody,
+static void deleteString(gpointer data)
+{
+	delete static_cast<string *>(data);
+}
+
+static void appendJSONBody(SoupMessageBody *body, JSONBuilder &agent,
 			   const string &callbackName)
 {
-	string jsonp = callbackName;
-	jsonp += "(";
-	jsonp += jsonBody;
-	jsonp += ")";
-	return jsonp;
+	const bool isJSONP = !callbackName.empty();
+	if (isJSONP) {
+		const string prefix = callbackName + "(";
+		soup_message_body_append(body, SOUP_MEMORY_COPY,
+		                         prefix.c_str(), prefix.size());
+	}
+
+	// The buffer of the builder is handed over to libsoup without a copy.
+	string *response = new string();
+	agent.takeGenerated(*response);
+	SoupBuffer *buffer =
+	  soup_buffer_new_with_owner(response->data(), response->size(),
+	                             response, deleteString);
+	soup_message_body_append_buffer(body, buffer);
+	soup_buffer_free(buffer);
+
+	if (isJSONP)
+		soup_message_body_append(body, SOUP_MEMORY_STATIC, ")", 1);
 }
 
 void FaceRest::ResourceHandler::replyError(const HatoholError &hatoholError,
@@ -888,13 +1041,9 @@ void FaceRest::ResourceHandler::replyError(const HatoholError &hatoholError,
 	agent.startObject();
 	addHatoholError(agent, hatoholError);
 	agent.endObject();
-	string response = agent.generate();
-	if (!m_jsonpCallbackName.empty())
-		response = wrapForJSONP(response, m_jsonpCallbackName);
 	soup_message_headers_set_content_type(m_message->response_headers,
 	                                      MIME_JSON, NULL);
-	soup_message_body_append(m_message->response_body, SOUP_MEMORY_COPY,
-	                         response.c_str(), response.size());
+	appendJSONBody(m_message->response_body, agent, m_jsonpCallbackName);
 	soup_message_set_status(m_message, statusCode);
 
 	m_replyIsPrepared = true;
@@ -909,13 +1058,9 @@ void FaceRest::ResourceHandler::replyHttpStatus(const guint &statusCode)
 void FaceRest::ResourceHandler::replyJSONData(JSONBuilder &agent,
 					      const guint &statusCode)
 {
-	string response = agent.generate();
-	if (!m_jsonpCallbackName.empty())
-		response = wrapForJSONP(response, m_jsonpCallbackName);
 	soup_message_headers_set_content_type(m_message->response_headers,
 	                                      m_mimeType, NULL);
-	soup_message_body_append(m_message->response_body, SOUP_MEMORY_COPY,
-	                         response.c_str(), response.size());
+	appendJSONBody(m_message->response_body, agent, m_jsonpCallbackName);
 	soup_message_set_status(m_message, statusCode);
 
 	m_replyIsPrepared = true;
@@ -47,6 +47,20 @@ public:
 	static int API_VERSION;
 	static const char *SESSION_ID_HEADER_NAME;
 	static const int DEFAULT_NUM_WORKERS;
+	static const int DEFAULT_MAX_NUM_WORKERS;
+
+	struct WorkerStatistics {
+		size_t   numWorkers;
+		size_t   numIdleWorkers;
+		size_t   queueDepth;
+		uint64_t numProcessedJobs;
+		// The number of jobs handled in the main thread because the
+		// job queue was full.
+		uint64_t numOverflowedJobs;
+		// The time that jobs waited in the queue.
+		uint64_t totalWaitTimeUSec;
+		uint64_t maxWaitTimeUSec;
+	};
 
 	static void init(void);
 
@@ -55,6 +69,27 @@ public:
 	virtual void waitExit(void) override;
 	virtual void setNumberOfPreLoadWorkers(size_t num);
 
+	/**
+	 * Set the maximum number of workers.
+	 *
+	 * Workers are added up to this number while queued jobs are more
+	 * than idle workers. If it is smaller than the number of the
+	 * pre-load workers, the latter is used as the maximum.
+	 *
+	 * @param num The maximum number of workers.
+	 */
+	void setMaxNumberOfWorkers(size_t num);
+	size_t getMaxNumberOfWorkers(void) const;
+
+	/**
+	 * Get the statistics of the workers and the job queue.
+	 *
+	 * This method can be called from any thread.
+	 *
+	 * @param stat The statistics is stored in this variable.
+	 */
+	void getWorkerStatistics(WorkerStatistics &stat) const;
+
 	void addResourceHandlerFactory(const char *path,
 				       ResourceHandlerFactory *factory);
 
@@ -68,6 +103,8 @@ protected:
 	bool isAsyncMode(void);
 	void startWorkers(void);
 	void stopWorkers(void);
+	void addWorker(void);
+	void addWorkerIfBusy(void);
 
 	// generic sub routines
 	SoupServer   *getSoupServer(void);
@@ -18,6 +18,7 @@
  */
 
 #pragma once
+#include <functional>
 #include "FaceRest.h"
 #include <StringUtils.h>
 #include <UsedCountable.h>
@@ -49,11 +50,41 @@ public:
 	virtual void handle(void) = 0;
 	void handleInTryBlock(void);
 
+	/**
+	 * Unpause the response, run the hand-off function and release the
+	 * reference of the caller. A worker calls it after handleInTryBlock().
+	 */
+	void finishHandling(void);
+
 	SoupServer *getSoupServer(void);
 	GMainContext *getGMainContext(void);
 	void pauseResponse(void);
 	bool unpauseResponse(bool force = false);
 
+	/**
+	 * Queue the paused job again so that handle() is called again.
+	 *
+	 * It's used by a handler that waits for something without
+	 * occupying a worker. This method can be called from any thread.
+	 * The reference of the job owned by the caller is taken over.
+	 * A handler must not call it directly since the job may be handled
+	 * by another worker before the current one finishes it. Use
+	 * setHandOffFunc() instead.
+	 */
+	void rehandle(void);
+
+	/**
+	 * Set a function that is called after the current worker finishes
+	 * the job.
+	 *
+	 * A handler uses it to pass the job to something that rehandles it.
+	 * After the function is called, the worker doesn't touch the job
+	 * except for releasing its reference.
+	 *
+	 * @param func A function to be called only once.
+	 */
+	void setHandOffFunc(const std::function<void(void)> &func);
+
 	bool httpMethodIs(const char *method);
 	std::string getResourceName(int nest = 0);
 	std::string getResourceIdString(int nest = 0);
@@ -65,6 +96,7 @@ public:
 			const std::string &optionMessage = "",
 			const guint &statusCode = SOUP_STATUS_OK);
 	void replyHttpStatus(const guint &statusCode);
+	// The output of the agent is moved to the response body.
 	void replyJSONData(JSONBuilder &agent, const guint &statusCode = SOUP_STATUS_OK);
 	void addServersMap(JSONBuilder &agent,
 			   TriggerBriefMaps *triggerMaps = NULL,
@@ -98,6 +130,9 @@ public:
 	DataQueryContextPtr m_dataQueryContextPtr;
 
 protected:
+	std::function<void(void)> m_handOffFunc;
+
+	static gboolean idleRehandle(gpointer data);
 	bool parseRequest(void);
 	std::string getJSONPCallbackName(void);
 	bool parseFormatType(void);
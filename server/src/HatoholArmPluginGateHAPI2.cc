@@ -28,6 +28,9 @@
 #include <libsoup/soup.h>
 #include <Reaper.h>
 #include "SelfMonitor.h"
+#include "DividedMessageBuffer.h"
+#include "SyncFingerprint.h"
+#include "RecentEventFilter.h"
 #include <mutex>
 
 using namespace std;
@@ -107,6 +110,11 @@ static void updateSelfMonitor(SelfMonitorPtr monitor, const bool &hasError)
 	monitor->update(hasError ? TRIGGER_STATUS_PROBLEM : TRIGGER_STATUS_OK);
 }
 
+static const int PROCEDURE_TIMEOUT_MSEC = 90 * 1000;
+// The limit of the estimated size of buffered divided messages
+// for each procedure.
+static const size_t MAX_DIVIDED_MESSAGE_BYTES = 256 * 1024 * 1024;
+
 struct HatoholArmPluginGateHAPI2::Impl
 {
 	struct DividableProcedureCallContext
@@ -133,19 +141,26 @@ struct HatoholArmPluginGateHAPI2::Impl
 	map<string, Closure0 *> m_fetchClosureMap;
 	map<string, DividableProcedureCallContextPtr> m_dividableProcedureCallContextMap;
 	map<string, Closure1<HistoryInfoVect> *> m_fetchHistoryClosureMap;
-	multimap<RequestId, pair<SerialId, ItemInfoList>> m_ItemInfoListSequentialIdMapRequestIdMultiMap;
-	multimap<RequestId, pair<SerialId, HistoryInfoVect>> m_HistoryInfoVectSequentialIdMapRequestIdMultiMap;
-	multimap<RequestId, pair<SerialId, ServerHostDefVect>> m_HostInfoVectSequentialIdMapRequestIdMultiMap;
-	multimap<RequestId, pair<SerialId, HostgroupVect>> m_HostgroupVectSequentialIdMapRequestIdMultiMap;
-	multimap<RequestId, pair<SerialId, HostgroupMemberVect>> m_HostgroupMembershipVectSequentialIdMapRequestIdMultiMap;
-	multimap<RequestId, pair<SerialId, TriggerInfoList>> m_TriggerInfoListSequentialIdMapRequestIdMultiMap;
-	multimap<RequestId, pair<SerialId, EventInfoList>> m_EventInfoListSequentialIdMapRequestIdMultiMap;
-	multimap<RequestId, pair<SerialId, VMInfoVect>> m_VMInfoVectSequentialIdMapRequestIdMultiMap;
+	DividedMessageBuffer<ItemInfoList> m_itemInfoListBuffer;
+	DividedMessageBuffer<HistoryInfoVect> m_historyInfoVectBuffer;
+	DividedMessageBuffer<ServerHostDefVect> m_hostInfoVectBuffer;
+	DividedMessageBuffer<HostgroupVect> m_hostgroupVectBuffer;
+	DividedMessageBuffer<HostgroupMemberVect> m_hostgroupMembershipVectBuffer;
+	DividedMessageBuffer<TriggerInfoList> m_triggerInfoListBuffer;
+	DividedMessageBuffer<EventInfoList> m_eventInfoListBuffer;
+	DividedMessageBuffer<VMInfoVect> m_vmInfoVectBuffer;
+	guint m_dividedRequestTimeoutMSec;
 	SelfMonitorPtr monitorPluginInternal;
 	SelfMonitorPtr monitorParseError;
 	SelfMonitorPtr monitorGateInternal;
 	SelfMonitorPtr monitorBrokerConn;
 	SelfMonitorPtr monitorHAP2Conn;
+	// Fingerprints of the last full syncs keyed by LastInfoType.
+	// An empty string means that it is unknown.
+	mutex m_syncFingerprintMutex;
+	map<LastInfoType, string> m_syncFingerprintMap;
+	RecentEventFilter m_recentEventFilter;
+	once_flag m_recentEventFilterLoaded;
 
 	Impl(const MonitoringServerInfo &_serverInfo,
 	     HatoholArmPluginGateHAPI2 &hapi2)
@@ -154,6 +169,15 @@ struct HatoholArmPluginGateHAPI2::Impl
 	  m_armFake(m_serverInfo),
 	  m_armStatus(),
 	  hostInfoCache(&_serverInfo.id),
+	  m_itemInfoListBuffer(MAX_DIVIDED_MESSAGE_BYTES, PROCEDURE_TIMEOUT_MSEC),
+	  m_historyInfoVectBuffer(MAX_DIVIDED_MESSAGE_BYTES, PROCEDURE_TIMEOUT_MSEC),
+	  m_hostInfoVectBuffer(MAX_DIVIDED_MESSAGE_BYTES, PROCEDURE_TIMEOUT_MSEC),
+	  m_hostgroupVectBuffer(MAX_DIVIDED_MESSAGE_BYTES, PROCEDURE_TIMEOUT_MSEC),
+	  m_hostgroupMembershipVectBuffer(MAX_DIVIDED_MESSAGE_BYTES, PROCEDURE_TIMEOUT_MSEC),
+	  m_triggerInfoListBuffer(MAX_DIVIDED_MESSAGE_BYTES, PROCEDURE_TIMEOUT_MSEC),
+	  m_eventInfoListBuffer(MAX_DIVIDED_MESSAGE_BYTES, PROCEDURE_TIMEOUT_MSEC),
+	  m_vmInfoVectBuffer(MAX_DIVIDED_MESSAGE_BYTES, PROCEDURE_TIMEOUT_MSEC),
+	  m_dividedRequestTimeoutMSec(PROCEDURE_TIMEOUT_MSEC),
 	  monitorPluginInternal(new SelfMonitor(
 	    _serverInfo.id, STATELESS_MONITOR,
 	    HatoholError::getMessage(HTERR_HAP_INTERNAL_ERROR),
@@ -501,14 +525,12 @@ struct HatoholArmPluginGateHAPI2::Impl
 		if (requestId.empty())
 			return;
 
-		constexpr int PROCEDURE_TIMEOUT_MSEC = 90 * 1000;
-
 		DividableProcedureCallContext *context = new DividableProcedureCallContext();
 		context->m_impl = this;
 		context->m_callback = callback;
 		context->m_producerId = requestId;
 		context->m_timeoutId =
-		  Utils::setGLibTimer(PROCEDURE_TIMEOUT_MSEC,
+		  Utils::setGLibTimer(m_dividedRequestTimeoutMSec,
 				      onDividableProcedureTimeout,
 				      context);
 
@@ -662,335 +684,80 @@ struct HatoholArmPluginGateHAPI2::Impl
 		}
 	};
 
-	struct DividedPutItemsProcedureCallback : public DividableProcedureCallback {
-		Impl &m_impl;
-		const string m_requestId;
-		DividedPutItemsProcedureCallback(Impl &impl,
-						 const string &requestId)
-		: m_impl(impl), m_requestId(requestId)
-		{
-		}
-
-		void flush(void)
-		{
-			bool found = m_impl.runDivideInfoCallback(m_requestId);
-			if (!found) {
-				MLPL_WARN("Ran callback with unknown requestId: %s\n",
-					  m_requestId.c_str());
-			}
-		}
-
-		void sweepInvalidRequestIdMultimap(void)
-		{
-			auto range =
-			  m_impl.m_ItemInfoListSequentialIdMapRequestIdMultiMap
-				.equal_range(m_requestId);
-			m_impl.m_ItemInfoListSequentialIdMapRequestIdMultiMap
-			  .erase(range.first, range.second);
-		}
-
-		virtual void onGotResponse() override
-		{
-			// TODO
-			return;
-		}
-
-		virtual void onTimeout(void) override
-		{
-			flush();
-			MLPL_WARN("Divided putItems precedure has been timed out.\n");
-			sweepInvalidRequestIdMultimap();
-		}
-	};
-
-	struct DividedPutHistoryProcedureCallback : public DividableProcedureCallback {
-		Impl &m_impl;
-		const string m_requestId;
-		DividedPutHistoryProcedureCallback(Impl &impl,
-						   const string &requestId)
-		: m_impl(impl), m_requestId(requestId)
-		{
-		}
-
-		void flush(void)
-		{
-			bool found = m_impl.runDivideInfoCallback(m_requestId);
-			if (!found) {
-				MLPL_WARN("Ran callback with unknown requestId: %s\n",
-					  m_requestId.c_str());
-			}
-		}
-
-		void sweepInvalidRequestIdMultimap(void)
-		{
-			auto range =
-			  m_impl.m_HistoryInfoVectSequentialIdMapRequestIdMultiMap
-				.equal_range(m_requestId);
-			m_impl.m_HistoryInfoVectSequentialIdMapRequestIdMultiMap
-			  .erase(range.first, range.second);
-		}
-
-		virtual void onGotResponse() override
-		{
-			// TODO
-			return;
-		}
-
-		virtual void onTimeout(void) override
-		{
-			flush();
-			MLPL_WARN("Divided putHistory precedure has been timed out.\n");
-			sweepInvalidRequestIdMultimap();
-		}
-	};
-
-	struct DividedPutHostsProcedureCallback : public DividableProcedureCallback {
-		Impl &m_impl;
-		const string m_requestId;
-		DividedPutHostsProcedureCallback(Impl &impl,
-						 const string &requestId)
-		: m_impl(impl), m_requestId(requestId)
-		{
-		}
-
-		void flush(void)
-		{
-			bool found = m_impl.runDivideInfoCallback(m_requestId);
-			if (!found) {
-				MLPL_WARN("Ran callback with unknown requestId: %s\n",
-					  m_requestId.c_str());
-			}
-		}
-
-		void sweepInvalidRequestIdMultimapPair(void)
-		{
-			auto range =
-			  m_impl.m_HostInfoVectSequentialIdMapRequestIdMultiMap
-				.equal_range(m_requestId);
-			m_impl.m_HostInfoVectSequentialIdMapRequestIdMultiMap
-			  .erase(range.first, range.second);
-		}
-
-		virtual void onGotResponse() override
-		{
-			// TODO
-			return;
-		}
-
-		virtual void onTimeout(void) override
-		{
-			flush();
-			MLPL_WARN("Divided putHosts precedure has been timed out.\n");
-			sweepInvalidRequestIdMultimapPair();
-		}
-	};
-
-	struct DividedPutHostGroupsProcedureCallback : public DividableProcedureCallback {
-		Impl &m_impl;
-		const string m_requestId;
-		const string m_methodName;
-		DividedPutHostGroupsProcedureCallback(Impl &impl,
-						      const string &requestId)
-		: m_impl(impl), m_requestId(requestId)
-		{
-		}
-
-		void flush(void)
-		{
-			bool found = m_impl.runDivideInfoCallback(m_requestId);
-			if (!found) {
-				MLPL_WARN("Ran callback with unknown requestId: %s\n",
-					  m_requestId.c_str());
-			}
-		}
-
-		void sweepInvalidRequestIdMultimapPair(void)
-		{
-			auto range =
-			  m_impl.m_HostgroupVectSequentialIdMapRequestIdMultiMap
-				.equal_range(m_requestId);
-			m_impl.m_HostgroupVectSequentialIdMapRequestIdMultiMap
-			  .erase(range.first, range.second);
-		}
-
-		virtual void onGotResponse() override
-		{
-			// TODO
-			return;
-		}
-
-		virtual void onTimeout(void) override
-		{
-			flush();
-			MLPL_WARN("Divided putHostGroups precedure has been timed out.\n");
-			sweepInvalidRequestIdMultimapPair();
-		}
-	};
-
-	struct DividedPutHostGroupMembershipProcedureCallback : public DividableProcedureCallback {
+	template <typename T>
+	struct DividedPutProcedureCallback : public DividableProcedureCallback {
 		Impl &m_impl;
+		DividedMessageBuffer<T> &m_buffer;
 		const string m_requestId;
 		const string m_methodName;
-		DividedPutHostGroupMembershipProcedureCallback(Impl &impl,
-							       const string &requestId)
-		: m_impl(impl), m_requestId(requestId)
+		DividedPutProcedureCallback(Impl &impl,
+					    DividedMessageBuffer<T> &buffer,
+					    const string &requestId,
+					    const string &methodName)
+		: m_impl(impl), m_buffer(buffer), m_requestId(requestId),
+		  m_methodName(methodName)
 		{
 		}
 
-		void flush(void)
-		{
-			bool found = m_impl.runDivideInfoCallback(m_requestId);
-			if (!found) {
-				MLPL_WARN("Ran callback with unknown requestId: %s\n",
-					  m_requestId.c_str());
-			}
-		}
-
-		void sweepInvalidRequestIdMultimapPair(void)
-		{
-			auto range =
-			  m_impl.m_HostgroupMembershipVectSequentialIdMapRequestIdMultiMap
-				.equal_range(m_requestId);
-			m_impl.m_HostgroupMembershipVectSequentialIdMapRequestIdMultiMap
-			  .erase(range.first, range.second);
-		}
-
 		virtual void onGotResponse() override
 		{
 			// TODO
 			return;
 		}
 
+		// This is called from onDividableProcedureTimeout() that holds
+		// m_dividableProcedureMapMutex and removes the context. So
+		// runDivideInfoCallback() must not be called here.
 		virtual void onTimeout(void) override
 		{
-			flush();
-			MLPL_WARN("Divided putHostGroupMembership precedure has been timed out.\n");
-			sweepInvalidRequestIdMultimapPair();
+			MLPL_WARN("Divided %s precedure has been timed out.\n",
+				  m_methodName.c_str());
+			m_buffer.erase(m_requestId);
 		}
 	};
 
-	struct DividedPutTriggersProcedureCallback : public DividableProcedureCallback {
-		Impl &m_impl;
-		const string m_requestId;
-		DividedPutTriggersProcedureCallback(Impl &impl,
-						    const string &requestId)
-		: m_impl(impl), m_requestId(requestId)
-		{
-		}
-
-		void flush(void)
-		{
-			bool found = m_impl.runDivideInfoCallback(m_requestId);
-			if (!found) {
-				MLPL_WARN("Ran callback with unknown requestId: %s\n",
-					  m_requestId.c_str());
-			}
-		}
-
-		void sweepInvalidRequestIdMultimapPair(void)
-		{
-			auto range =
-			  m_impl.m_TriggerInfoListSequentialIdMapRequestIdMultiMap
-				.equal_range(m_requestId);
-			m_impl.m_TriggerInfoListSequentialIdMapRequestIdMultiMap
-			  .erase(range.first, range.second);
-		}
-
-		virtual void onGotResponse() override
-		{
-			// TODO
-			return;
-		}
-
-		virtual void onTimeout(void) override
-		{
-			flush();
-			MLPL_WARN("Divided putTriggers precedure has been timed out.\n");
-			sweepInvalidRequestIdMultimapPair();
-		}
-	};
-
-	struct DividedPutEventsProcedureCallback : public DividableProcedureCallback {
-		Impl &m_impl;
-		const string m_requestId;
-		DividedPutEventsProcedureCallback(Impl &impl,
-						  const string &requestId)
-		: m_impl(impl), m_requestId(requestId)
-		{
-		}
-
-		void flush(void)
-		{
-			bool found = m_impl.runDivideInfoCallback(m_requestId);
-			if (!found) {
-				MLPL_WARN("Ran callback with unknown requestId: %s\n",
-					  m_requestId.c_str());
-			}
-		}
-
-		void sweepInvalidRequestIdMultimapPair(void)
-		{
-			auto range =
-			  m_impl.m_EventInfoListSequentialIdMapRequestIdMultiMap
-				.equal_range(m_requestId);
-			m_impl.m_EventInfoListSequentialIdMapRequestIdMultiMap
-			  .erase(range.first, range.second);
-		}
-
-		virtual void onGotResponse() override
-		{
-			// TODO
-			return;
-		}
-
-		virtual void onTimeout(void) override
-		{
-			flush();
-			MLPL_WARN("Divided putEvents precedure has been timed out.\n");
-			sweepInvalidRequestIdMultimapPair();
-		}
-	};
-
-	struct DividedPutHostParentsProcedureCallback : public DividableProcedureCallback {
-		Impl &m_impl;
-		const string m_requestId;
-		DividedPutHostParentsProcedureCallback(Impl &impl,
-						       const string &requestId)
-		: m_impl(impl), m_requestId(requestId)
-		{
-		}
-
-		void flush(void)
-		{
-			bool found = m_impl.runDivideInfoCallback(m_requestId);
-			if (!found) {
-				MLPL_WARN("Ran callback with unknown requestId: %s\n",
-					  m_requestId.c_str());
-			}
-		}
-
-		void sweepInvalidRequestIdMultimapPair(void)
-		{
-			auto range =
-			  m_impl.m_VMInfoVectSequentialIdMapRequestIdMultiMap
-				.equal_range(m_requestId);
-			m_impl.m_VMInfoVectSequentialIdMapRequestIdMultiMap
-			  .erase(range.first, range.second);
-		}
-
-		virtual void onGotResponse() override
-		{
-			// TODO
-			return;
+	/**
+	 * Append a divided message to the buffer and manage the timer of
+	 * the request.
+	 *
+	 * @return
+	 * true on success. Otherwise false is returned and the request is
+	 * dropped. The reason is added to errObj.
+	 */
+	template <typename T>
+	bool appendDividedMessage(DividedMessageBuffer<T> &buffer,
+				  const string &methodName,
+				  const DivideInfo &divideInfo, T &chunk,
+				  JSONRPCError &errObj)
+	{
+		uint64_t expectedSerialId = 0;
+		switch (buffer.append(divideInfo.requestId, divideInfo.serialId,
+				      std::move(chunk), &expectedSerialId)) {
+		case DividedMessageBuffer<T>::INVALID_SERIAL_ID:
+			errObj.addError("Invalid serialId. expected: %" PRIu64
+					" actual: %" PRId64 "\n",
+					expectedSerialId,
+					divideInfo.serialId);
+			return false;
+		case DividedMessageBuffer<T>::TOO_LARGE:
+			errObj.addError("Too large divided message. "
+					"requestId: %s\n",
+					divideInfo.requestId.c_str());
+			return false;
+		default:
+			break;
 		}
 
-		virtual void onTimeout(void) override
-		{
-			flush();
-			MLPL_WARN("Divided putHostParents precedure has been timed out.\n");
-			sweepInvalidRequestIdMultimapPair();
+		if (divideInfo.serialId != 0)
+			runDivideInfoCallback(divideInfo.requestId);
+		if (!divideInfo.isLast) {
+			auto callback =
+			  make_shared<DividedPutProcedureCallback<T>>
+			    (*this, buffer, divideInfo.requestId, methodName);
+			queueDivideInfoCallback(divideInfo.requestId, callback);
 		}
-	};
+		return true;
+	}
 
 	const string &getPluginControlScriptPath()
 	{
@@ -1222,6 +989,63 @@ struct HatoholArmPluginGateHAPI2::Impl
 		dbLastInfo.upsertLastInfo(lastInfo, privilege, useTransaction);
 	}
 
+	string getSyncFingerprint(const LastInfoType &type)
+	{
+		lock_guard<mutex> lock(m_syncFingerprintMutex);
+		auto it = m_syncFingerprintMap.find(type);
+		if (it != m_syncFingerprintMap.end())
+			return it->second;
+
+		ThreadLocalDBCache cache;
+		LastInfoQueryOption option(USER_ID_SYSTEM);
+		option.setLastInfoType(type);
+		option.setTargetServerId(m_serverInfo.id);
+		LastInfoDefList lastInfoList;
+		cache.getLastInfo().getLastInfoList(lastInfoList, option);
+		const string fingerprint =
+		  lastInfoList.empty() ? "" : lastInfoList.begin()->value;
+		m_syncFingerprintMap[type] = fingerprint;
+		return fingerprint;
+	}
+
+	void setSyncFingerprint(const LastInfoType &type,
+	                        const string &fingerprint)
+	{
+		{
+			lock_guard<mutex> lock(m_syncFingerprintMutex);
+			m_syncFingerprintMap[type] = fingerprint;
+		}
+		upsertLastInfo(fingerprint, type);
+	}
+
+	RecentEventFilter &getRecentEventFilter(void)
+	{
+		// The events stored before the gate starts are loaded when
+		// the first events come. Then the ones resent by the plugin
+		// after a restart of Hatohol are also dropped.
+		call_once(m_recentEventFilterLoaded, [this]() {
+			EventsQueryOption option(USER_ID_SYSTEM);
+			option.setTargetServerId(m_serverInfo.id);
+			option.setSortType(EventsQueryOption::SORT_UNIFIED_ID,
+			                   DataQueryOption::SORT_DESCENDING);
+			option.setMaximumNumber(
+			  m_recentEventFilter.getCapacity());
+			EventInfoList eventInfoList;
+			UnifiedDataStore::getInstance()->getEventList(
+			  eventInfoList, option);
+			// The older events should be forgotten first.
+			eventInfoList.reverse();
+			m_recentEventFilter.rememberStored(eventInfoList);
+		});
+		return m_recentEventFilter;
+	}
+
+	void clearSyncFingerprint(const LastInfoType &type)
+	{
+		if (!getSyncFingerprint(type).empty())
+			setSyncFingerprint(type, "");
+	}
+
 	struct UpsertLastInfoHook : public DBAgent::TransactionHooks {
 		Impl &impl;
 		const LastInfoType type;
@@ -1244,6 +1068,45 @@ struct HatoholArmPluginGateHAPI2::Impl
 			return lastInfo.empty() ? NULL : this;
 		}
 	};
+
+	/**
+	 * Run a full sync unless the elements are the same as the ones
+	 * of the last full sync.
+	 *
+	 * @param elements Elements sent by the plugin.
+	 * @param fingerprintType A type to save the fingerprint.
+	 * @param lastInfoUpserter
+	 * A hook passed to the sync. The last info is saved by this method
+	 * if the sync is skipped.
+	 * @param sync A functor that runs the sync and returns HatoholError.
+	 */
+	template <typename T, typename SyncFunc>
+	void syncIfChanged(const T &elements,
+	                   const LastInfoType &fingerprintType,
+	                   const UpsertLastInfoHook &lastInfoUpserter,
+	                   SyncFunc sync)
+	{
+		SyncFingerprint fingerprint;
+		fingerprint.addAll(elements);
+		const string value = fingerprint.toString();
+		if (value == getSyncFingerprint(fingerprintType)) {
+			MLPL_DBG("Skip an unchanged full sync: "
+			         "server: %" FMT_SERVER_ID ", type: %d, "
+			         "elements: %zd\n", m_serverInfo.id,
+			         fingerprintType,
+			         fingerprint.getNumberOfElements());
+			if (!lastInfoUpserter.lastInfo.empty())
+				upsertLastInfo(lastInfoUpserter.lastInfo,
+				               lastInfoUpserter.type);
+			return;
+		}
+
+		// The old fingerprint is cleared before the sync. Otherwise
+		// a sync that fails halfway might be skipped next time.
+		clearSyncFingerprint(fingerprintType);
+		if (sync() == HTERR_OK)
+			setSyncFingerprint(fingerprintType, value);
+	}
 };
 
 // ---------------------------------------------------------------------------
@@ -1303,6 +1166,11 @@ HatoholArmPluginGateHAPI2::HatoholArmPluginGateHAPI2(
 	  (ProcedureHandler)
 	    &HatoholArmPluginGateHAPI2::procedureHandlerPutArmInfo);
 
+	registerStreamingArray(HAPI2_PUT_ITEMS, "items");
+	registerStreamingArray(HAPI2_PUT_HISTORY, "samples");
+	registerStreamingArray(HAPI2_PUT_TRIGGERS, "triggers");
+	registerStreamingArray(HAPI2_PUT_EVENTS, "events");
+
 	if (autoStart)
 		start();
 }
@@ -1326,6 +1194,21 @@ bool HatoholArmPluginGateHAPI2::isEstablished(void)
 	return m_impl->isEstablished();
 }
 
+void HatoholArmPluginGateHAPI2::setDividedRequestTimeout(
+  const guint &timeoutMSec)
+{
+	m_impl->m_dividedRequestTimeoutMSec = timeoutMSec;
+	// The buffers drop requests by themselves too.
+	m_impl->m_itemInfoListBuffer.setTimeout(timeoutMSec);
+	m_impl->m_historyInfoVectBuffer.setTimeout(timeoutMSec);
+	m_impl->m_hostInfoVectBuffer.setTimeout(timeoutMSec);
+	m_impl->m_hostgroupVectBuffer.setTimeout(timeoutMSec);
+	m_impl->m_hostgroupMembershipVectBuffer.setTimeout(timeoutMSec);
+	m_impl->m_triggerInfoListBuffer.setTimeout(timeoutMSec);
+	m_impl->m_eventInfoListBuffer.setTimeout(timeoutMSec);
+	m_impl->m_vmInfoVectBuffer.setTimeout(timeoutMSec);
+}
+
 bool HatoholArmPluginGateHAPI2::parseTimeStamp(
   const string &timeStampString, timespec &timeStamp, const bool allowEmpty)
 {
@@ -1670,7 +1553,8 @@ static bool parseDivideInfo(JSONParser &parser, DivideInfo &divideInfo,
 	return true;
 }
 
-static bool parseItemParams(JSONParser &parser, ItemInfoList &itemInfoList,
+static bool parseItemParams(HatoholArmPluginInterfaceHAPI2 &hapi2,
+			    JSONParser &parser, ItemInfoList &itemInfoList,
 			    const MonitoringServerInfo &serverInfo,
 			    const HostInfoCache &hostInfoCache,
 			    JSONRPCError &errObj)
@@ -1686,7 +1570,7 @@ static bool parseItemParams(JSONParser &parser, ItemInfoList &itemInfoList,
 	 * is assigned.
 	 * @return true if successful. Otherwise false.
 	 */
-	auto getItemGroupName = [&](vector<string> &names) {
+	auto getItemGroupName = [&](JSONParser &parser, vector<string> &names) {
 		CHECK_MANDATORY_ARRAY_EXISTENCE("itemGroupName", errObj);
 		parser.startObject("itemGroupName");
 		size_t num = parser.countElements();
@@ -1701,17 +1585,9 @@ static bool parseItemParams(JSONParser &parser, ItemInfoList &itemInfoList,
 	};
 
 	CHECK_MANDATORY_ARRAY_EXISTENCE("items", errObj);
-	parser.startObject("items");
-	size_t num = parser.countElements();
-
-	for (size_t i = 0; i < num; i++) {
-		if (!parser.startElement(i)) {
-			MLPL_ERR("Failed to parse item contents.\n");
-			errObj.addError("Failed to parse item array object.");
-			parser.endObject(); // items
-			return false;
-		}
 
+	bool succeeded = true;
+	auto parseItem = [&](JSONParser &parser) {
 		ItemInfo itemInfo;
 		itemInfo.id = AUTO_INCREMENT_VALUE;
 		itemInfo.serverId = serverInfo.id;
@@ -1720,10 +1596,11 @@ static bool parseItemParams(JSONParser &parser, ItemInfoList &itemInfoList,
 		PARSE_AS_MANDATORY("brief", itemInfo.brief, errObj);
 		parseTimeStamp(parser, "lastValueTime", itemInfo.lastValueTime, errObj);
 		PARSE_AS_MANDATORY("lastValue", itemInfo.lastValue, errObj);
-		if (!getItemGroupName(itemInfo.categoryNames))
+		if (!getItemGroupName(parser, itemInfo.categoryNames)) {
+			succeeded = false;
 			return false;
+		}
 		PARSE_AS_MANDATORY("unit", itemInfo.unit, errObj);
-		parser.endElement();
 		HostInfoCache::Element cacheElem;
 		const bool found =
 			hostInfoCache.getName(itemInfo.hostIdInServer, cacheElem);
@@ -1738,9 +1615,14 @@ static bool parseItemParams(JSONParser &parser, ItemInfoList &itemInfoList,
 		itemInfo.valueType = ITEM_INFO_VALUE_TYPE_UNKNOWN;
 		itemInfo.delay = 0;
 		itemInfoList.push_back(itemInfo);
+		return true;
+	};
+	if (!hapi2.forEachElement(parser, "items", parseItem) && succeeded) {
+		MLPL_ERR("Failed to parse item contents.\n");
+		errObj.addError("Failed to parse item array object.");
+		return false;
 	}
-	parser.endObject(); // items
-	return true;
+	return succeeded;
 };
 
 string HatoholArmPluginGateHAPI2::procedureHandlerPutItems(JSONParser &parser)
@@ -1752,7 +1634,6 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutItems(JSONParser &parser)
 	string fetchId;
 	DivideInfo divideInfo;
 	bool divided = false;
-	pair<SerialId, ItemInfoList> itemInfoListSequentialIdPair;
 	CHECK_MANDATORY_PARAMS_EXISTENCE("params", errObj);
 	parser.startObject("params");
 
@@ -1767,17 +1648,10 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutItems(JSONParser &parser)
 		return builder.generate();
 	};
 
-	auto sweepInvalidItemInfoListSequentialIdPair = [&](){
-		auto range =
-		  m_impl->m_ItemInfoListSequentialIdMapRequestIdMultiMap
-		    .equal_range(divideInfo.requestId);
-		m_impl->m_ItemInfoListSequentialIdMapRequestIdMultiMap
-		  .erase(range.first, range.second);
-	};
-
 	const MonitoringServerInfo &serverInfo = m_impl->m_serverInfo;
 	const HostInfoCache &hostInfoCache = m_impl->hostInfoCache;
-	parseItemParams(parser, itemList, serverInfo, hostInfoCache, errObj);
+	parseItemParams(*this, parser, itemList, serverInfo, hostInfoCache,
+	                errObj);
 	if (parser.isMember("fetchId")) {
 		parser.read("fetchId", fetchId);
 	}
@@ -1786,31 +1660,9 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutItems(JSONParser &parser)
 		divided = parseDivideInfo(parser, divideInfo, errObj);
 		parser.endObject(); // divideInfo
 
-		itemInfoListSequentialIdPair = make_pair(divideInfo.serialId, itemList);
-		m_impl->m_ItemInfoListSequentialIdMapRequestIdMultiMap.emplace(
-		  divideInfo.requestId, itemInfoListSequentialIdPair);
-
-		const uint64_t sequenceId =
-		  m_impl->m_ItemInfoListSequentialIdMapRequestIdMultiMap.count(divideInfo.requestId);
-		const uint64_t serialId = static_cast<uint64_t>(divideInfo.serialId) + 1;
-		if (serialId == sequenceId) {
-			if (sequenceId != 1)
-				m_impl->runDivideInfoCallback(divideInfo.requestId);
-
-			if (!divideInfo.isLast) {
-				auto callback =
-				  make_shared<Impl::DividedPutEventsProcedureCallback>
-					  (*m_impl, divideInfo.requestId);
-				m_impl->queueDivideInfoCallback(divideInfo.requestId, callback);
-			}
-		}
-		if (serialId != sequenceId) {
-			errObj.addError("Invalid serialId. expected: %" PRIu64
-					" actual: %" PRId64 "\n",
-					sequenceId,
-					divideInfo.serialId);
-
-			sweepInvalidItemInfoListSequentialIdPair();
+		if (!m_impl->appendDividedMessage(
+		       m_impl->m_itemInfoListBuffer, "putItems",
+		       divideInfo, itemList, errObj)) {
 			return HatoholArmPluginInterfaceHAPI2::buildErrorResponse(
 			  JSON_RPC_INVALID_PARAMS, "Invalid method parameter(s).",
 			  &errObj.getErrors(), &parser);
@@ -1833,13 +1685,8 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutItems(JSONParser &parser)
 	}
 
 	if (divided) {
-		for (auto &elemMultiMap : m_impl->m_ItemInfoListSequentialIdMapRequestIdMultiMap) {
-			if (divideInfo.requestId != elemMultiMap.first)
-				continue;
-
-			collectedItemList.splice(collectedItemList.end(), elemMultiMap.second.second);
-		}
-		sweepInvalidItemInfoListSequentialIdPair();
+		m_impl->m_itemInfoListBuffer.take(
+		  divideInfo.requestId, collectedItemList);
 	}
 
 	if (divided) {
@@ -1857,34 +1704,30 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutItems(JSONParser &parser)
 	return jsonResponse(result);
 }
 
-static bool parseHistoryParams(JSONParser &parser, HistoryInfoVect &historyInfoVect,
+static bool parseHistoryParams(HatoholArmPluginInterfaceHAPI2 &hapi2,
+			       JSONParser &parser, HistoryInfoVect &historyInfoVect,
 			       const MonitoringServerInfo &serverInfo,
 			       JSONRPCError &errObj)
 {
 	ItemIdType itemId = "";
 	PARSE_AS_MANDATORY("itemId", itemId, errObj);
 	CHECK_MANDATORY_ARRAY_EXISTENCE("samples", errObj);
-	parser.startObject("samples");
-	size_t num = parser.countElements();
-
-	for (size_t j = 0; j < num; j++) {
-		if (!parser.startElement(j)) {
-			MLPL_ERR("Failed to parse samples contents.\n");
-			errObj.addError("Failed to parse samples array object.");
-			parser.endObject(); // samples
-			return false;
-		}
 
+	auto parseSample = [&](JSONParser &parser) {
 		HistoryInfo historyInfo;
 		historyInfo.itemId = itemId;
 		historyInfo.serverId = serverInfo.id;
 		PARSE_AS_MANDATORY("value", historyInfo.value, errObj);
 		parseTimeStamp(parser, "time", historyInfo.clock, errObj);
-		parser.endElement();
 
 		historyInfoVect.push_back(historyInfo);
+		return true;
+	};
+	if (!hapi2.forEachElement(parser, "samples", parseSample)) {
+		MLPL_ERR("Failed to parse samples contents.\n");
+		errObj.addError("Failed to parse samples array object.");
+		return false;
 	}
-	parser.endObject(); // samples
 	return true;
 };
 
@@ -1897,7 +1740,6 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHistory(
 	string fetchId;
 	bool divided = false;
 	DivideInfo divideInfo;
-	pair<SerialId, HistoryInfoVect> historyInfoVectSequentialIdPair;
 	CHECK_MANDATORY_PARAMS_EXISTENCE("params", errObj);
 	parser.startObject("params");
 
@@ -1912,16 +1754,8 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHistory(
 		return builder.generate();
 	};
 
-	auto sweepInvalidHistoryInfoVectSequentialIdPair = [&](){
-		auto range =
-		  m_impl->m_HistoryInfoVectSequentialIdMapRequestIdMultiMap
-		    .equal_range(divideInfo.requestId);
-		m_impl->m_HistoryInfoVectSequentialIdMapRequestIdMultiMap
-		  .erase(range.first, range.second);
-	};
-
 	const MonitoringServerInfo &serverInfo = m_impl->m_serverInfo;
-	parseHistoryParams(parser, historyInfoVect,
+	parseHistoryParams(*this, parser, historyInfoVect,
 			   serverInfo, errObj);
 	if (parser.isMember("fetchId")) {
 		parser.read("fetchId", fetchId);
@@ -1931,31 +1765,9 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHistory(
 		divided = parseDivideInfo(parser, divideInfo, errObj);
 		parser.endObject(); // divideInfo
 
-		historyInfoVectSequentialIdPair = make_pair(divideInfo.serialId,
-		                                            historyInfoVect);
-		m_impl->m_HistoryInfoVectSequentialIdMapRequestIdMultiMap.emplace(
-		  divideInfo.requestId, historyInfoVectSequentialIdPair);
-
-		const uint64_t sequenceId =
-		  m_impl->m_HistoryInfoVectSequentialIdMapRequestIdMultiMap.count(divideInfo.requestId);
-		const uint64_t serialId = static_cast<uint64_t>(divideInfo.serialId) + 1;
-		if (serialId == sequenceId) {
-			if (sequenceId != 1)
-				m_impl->runDivideInfoCallback(divideInfo.requestId);
-
-			if (!divideInfo.isLast) {
-				auto callback =
-				  make_shared<Impl::DividedPutEventsProcedureCallback>
-					  (*m_impl, divideInfo.requestId);
-				m_impl->queueDivideInfoCallback(divideInfo.requestId, callback);
-			}
-		}
-		if (serialId != sequenceId) {
-			errObj.addError("Invalid serialId. expected: %" PRIu64
-					" actual: %" PRId64 "\n",
-					sequenceId,
-					divideInfo.serialId);
-			sweepInvalidHistoryInfoVectSequentialIdPair();
+		if (!m_impl->appendDividedMessage(
+		       m_impl->m_historyInfoVectBuffer, "putHistory",
+		       divideInfo, historyInfoVect, errObj)) {
 			return HatoholArmPluginInterfaceHAPI2::buildErrorResponse(
 			  JSON_RPC_INVALID_PARAMS, "Invalid method parameter(s).",
 			  &errObj.getErrors(), &parser);
@@ -1980,16 +1792,8 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHistory(
 	}
 
 	if (divided) {
-		for (auto &elemMultiMap : m_impl->m_HistoryInfoVectSequentialIdMapRequestIdMultiMap) {
-			if (divideInfo.requestId != elemMultiMap.first)
-				continue;
-
-			collectedHistoryInfoVect.insert(collectedHistoryInfoVect.end(),
-							elemMultiMap.second.second.begin(),
-							elemMultiMap.second.second.end());
-		}
-
-		sweepInvalidHistoryInfoVectSequentialIdPair();
+		m_impl->m_historyInfoVectBuffer.take(
+		  divideInfo.requestId, collectedHistoryInfoVect);
 	}
 
 	if (!fetchId.empty()) {
@@ -2058,7 +1862,6 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHosts(
 	JSONRPCError errObj;
 	DivideInfo divideInfo;
 	bool divided = false;
-	pair<SerialId, ServerHostDefVect> hostInfoVectSequentialIdPair;
 	Impl::UpsertLastInfoHook lastInfoUpserter(*m_impl, LAST_INFO_HOST);
 	CHECK_MANDATORY_PARAMS_EXISTENCE("params", errObj);
 	parser.startObject("params");
@@ -2074,14 +1877,6 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHosts(
 		return builder.generate();
 	};
 
-	auto sweepInvalidHostInfoVectSequentialIdPair = [&](){
-		auto range =
-		  m_impl->m_HostInfoVectSequentialIdMapRequestIdMultiMap
-		    .equal_range(divideInfo.requestId);
-		m_impl->m_HostInfoVectSequentialIdMapRequestIdMultiMap
-		  .erase(range.first, range.second);
-	};
-
 	const MonitoringServerInfo &serverInfo = m_impl->m_serverInfo;
 	parseHostsParams(parser, hostInfoVect, serverInfo, errObj);
 
@@ -2095,32 +1890,9 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHosts(
 		divided = parseDivideInfo(parser, divideInfo, errObj);
 		parser.endObject(); // divideInfo
 
-		hostInfoVectSequentialIdPair = make_pair(divideInfo.serialId,
-		                                         hostInfoVect);
-		m_impl->m_HostInfoVectSequentialIdMapRequestIdMultiMap.emplace(
-		  divideInfo.requestId, hostInfoVectSequentialIdPair);
-
-		const uint64_t sequenceId =
-		  m_impl->m_HostInfoVectSequentialIdMapRequestIdMultiMap.count(divideInfo.requestId);
-		const uint64_t serialId = static_cast<uint64_t>(divideInfo.serialId) + 1;
-		if (serialId == sequenceId) {
-			if (sequenceId != 1)
-				m_impl->runDivideInfoCallback(divideInfo.requestId);
-
-			if (!divideInfo.isLast) {
-				auto callback =
-				  make_shared<Impl::DividedPutEventsProcedureCallback>
-					  (*m_impl, divideInfo.requestId);
-				m_impl->queueDivideInfoCallback(divideInfo.requestId, callback);
-			}
-		}
-		if (serialId != sequenceId) {
-			errObj.addError("Invalid serialId. expected: %" PRIu64
-					" actual: %" PRId64 "\n",
-					sequenceId,
-					divideInfo.serialId);
-
-			sweepInvalidHostInfoVectSequentialIdPair();
+		if (!m_impl->appendDividedMessage(
+		       m_impl->m_hostInfoVectBuffer, "putHosts",
+		       divideInfo, hostInfoVect, errObj)) {
 			return HatoholArmPluginInterfaceHAPI2::buildErrorResponse(
 			  JSON_RPC_INVALID_PARAMS, "Invalid method parameter(s).",
 			  &errObj.getErrors(), &parser);
@@ -2142,24 +1914,23 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHosts(
 	}
 
 	if (divided) {
-		for (auto &elemMultiMap : m_impl->m_HostInfoVectSequentialIdMapRequestIdMultiMap) {
-			if (divideInfo.requestId != elemMultiMap.first)
-				continue;
-
-			collectedHostInfoVect.insert(collectedHostInfoVect.end(),
-						     elemMultiMap.second.second.begin(),
-						     elemMultiMap.second.second.end());
-		}
-
-		sweepInvalidHostInfoVectSequentialIdPair();
+		m_impl->m_hostInfoVectBuffer.take(
+		  divideInfo.requestId, collectedHostInfoVect);
 	}
 
 	auto updateHostsInfo = [&](ServerHostDefVect &hostInfoVect){
 		// TODO: reflect error in response
 		if (checkInvalidHosts) {
-			dataStore->syncHosts(hostInfoVect, serverInfo.id,
-					     m_impl->hostInfoCache, lastInfoUpserter);
+			m_impl->syncIfChanged(
+			  hostInfoVect, LAST_INFO_HOST_FINGERPRINT,
+			  lastInfoUpserter, [&]() {
+				return dataStore->syncHosts(
+				  hostInfoVect, serverInfo.id,
+				  m_impl->hostInfoCache, lastInfoUpserter);
+			});
 		} else {
+			m_impl->clearSyncFingerprint(
+			  LAST_INFO_HOST_FINGERPRINT);
 			HostHostIdMap hostsMap;
 			dataStore->upsertHosts(hostInfoVect, &hostsMap,
 					       lastInfoUpserter);
@@ -2216,7 +1987,6 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHostGroups(
 	JSONRPCError errObj;
 	bool divided = false;
 	DivideInfo divideInfo;
-	pair<SerialId, HostgroupVect> hostgroupVectSequentialIdPair;
 	Impl::UpsertLastInfoHook lastInfoUpserter(*m_impl, LAST_INFO_HOST_GROUP);
 	CHECK_MANDATORY_PARAMS_EXISTENCE("params", errObj);
 	parser.startObject("params");
@@ -2232,14 +2002,6 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHostGroups(
 		return builder.generate();
 	};
 
-	auto sweepInvalidHostgroupVectSequentialIdPair = [&](){
-		auto range =
-		  m_impl->m_HostgroupVectSequentialIdMapRequestIdMultiMap
-		    .equal_range(divideInfo.requestId);
-		m_impl->m_HostgroupVectSequentialIdMapRequestIdMultiMap
-		  .erase(range.first, range.second);
-	};
-
 	const MonitoringServerInfo &serverInfo = m_impl->m_serverInfo;
 	parseHostGroupsParams(parser, hostgroupVect, serverInfo, errObj);
 	string updateType;
@@ -2252,32 +2014,9 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHostGroups(
 		divided = parseDivideInfo(parser, divideInfo, errObj);
 		parser.endObject(); // divideInfo
 
-		hostgroupVectSequentialIdPair = make_pair(divideInfo.serialId,
-		                                          hostgroupVect);
-		m_impl->m_HostgroupVectSequentialIdMapRequestIdMultiMap.emplace(
-		  divideInfo.requestId, hostgroupVectSequentialIdPair);
-
-		const uint64_t sequenceId =
-		  m_impl->m_HostgroupVectSequentialIdMapRequestIdMultiMap.count(divideInfo.requestId);
-		const uint64_t serialId = static_cast<uint64_t>(divideInfo.serialId) + 1;
-		if (serialId == sequenceId) {
-			if (sequenceId != 1)
-				m_impl->runDivideInfoCallback(divideInfo.requestId);
-
-			if (!divideInfo.isLast) {
-				auto callback =
-				  make_shared<Impl::DividedPutEventsProcedureCallback>
-					  (*m_impl, divideInfo.requestId);
-				m_impl->queueDivideInfoCallback(divideInfo.requestId, callback);
-			}
-		}
-		if (serialId != sequenceId) {
-			errObj.addError("Invalid serialId. expected: %" PRIu64
-					" actual: %" PRId64 "\n",
-					sequenceId,
-					divideInfo.serialId);
-
-			sweepInvalidHostgroupVectSequentialIdPair();
+		if (!m_impl->appendDividedMessage(
+		       m_impl->m_hostgroupVectBuffer, "putHostGroups",
+		       divideInfo, hostgroupVect, errObj)) {
 			return HatoholArmPluginInterfaceHAPI2::buildErrorResponse(
 			  JSON_RPC_INVALID_PARAMS, "Invalid method parameter(s).",
 			  &errObj.getErrors(), &parser);
@@ -2299,24 +2038,23 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHostGroups(
 	}
 
 	if (divided) {
-		for (auto &elemMultiMap : m_impl->m_HostgroupVectSequentialIdMapRequestIdMultiMap) {
-			if (divideInfo.requestId != elemMultiMap.first)
-				continue;
-
-			collectedHostgroupVect.insert(collectedHostgroupVect.end(),
-						      elemMultiMap.second.second.begin(),
-						      elemMultiMap.second.second.end());
-		}
-
-		sweepInvalidHostgroupVectSequentialIdPair();
+		m_impl->m_hostgroupVectBuffer.take(
+		  divideInfo.requestId, collectedHostgroupVect);
 	}
 
 	auto updateHostGroupsInfo = [&](HostgroupVect &hostgroupVect){
 		// TODO: reflect error in response
 		if (checkInvalidHostGroups) {
-			dataStore->syncHostgroups(hostgroupVect, serverInfo.id,
-						  lastInfoUpserter);
+			m_impl->syncIfChanged(
+			  hostgroupVect, LAST_INFO_HOST_GROUP_FINGERPRINT,
+			  lastInfoUpserter, [&]() {
+				return dataStore->syncHostgroups(
+				  hostgroupVect, serverInfo.id,
+				  lastInfoUpserter);
+			});
 		} else {
+			m_impl->clearSyncFingerprint(
+			  LAST_INFO_HOST_GROUP_FINGERPRINT);
 			dataStore->upsertHostgroups(hostgroupVect, lastInfoUpserter);
 		}
 	};
@@ -2392,7 +2130,6 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHostGroupMembership(
 	JSONRPCError errObj;
 	bool divided = false;
 	DivideInfo divideInfo;
-	pair<SerialId, HostgroupMemberVect> hostgroupMembershipVectSequentialIdPair;
 	Impl::UpsertLastInfoHook
 	 lastInfoUpserter(*m_impl, LAST_INFO_HOST_GROUP_MEMBERSHIP);
 	CHECK_MANDATORY_PARAMS_EXISTENCE("params", errObj);
@@ -2409,14 +2146,6 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHostGroupMembership(
 		return builder.generate();
 	};
 
-	auto sweepInvalidHostgroupMembershipVectSequentialIdPair = [&](){
-		auto range =
-		  m_impl->m_HostgroupMembershipVectSequentialIdMapRequestIdMultiMap
-		    .equal_range(divideInfo.requestId);
-		m_impl->m_HostgroupMembershipVectSequentialIdMapRequestIdMultiMap
-		  .erase(range.first, range.second);
-	};
-
 	const MonitoringServerInfo &serverInfo = m_impl->m_serverInfo;
 	const HostInfoCache &hostInfoCache = m_impl->hostInfoCache;
 	parseHostGroupMembershipParams(parser,
@@ -2434,32 +2163,9 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHostGroupMembership(
 		divided = parseDivideInfo(parser, divideInfo, errObj);
 		parser.endObject(); // divideInfo
 
-		hostgroupMembershipVectSequentialIdPair =
-		  make_pair(divideInfo.serialId, hostgroupMembershipVect);
-		m_impl->m_HostgroupMembershipVectSequentialIdMapRequestIdMultiMap.emplace(
-		  divideInfo.requestId, hostgroupMembershipVectSequentialIdPair);
-
-		const uint64_t sequenceId =
-		  m_impl->m_HostgroupMembershipVectSequentialIdMapRequestIdMultiMap.count(divideInfo.requestId);
-		const uint64_t serialId = static_cast<uint64_t>(divideInfo.serialId) + 1;
-		if (serialId == sequenceId) {
-			if (sequenceId != 1)
-				m_impl->runDivideInfoCallback(divideInfo.requestId);
-
-			if (!divideInfo.isLast) {
-				auto callback =
-				  make_shared<Impl::DividedPutEventsProcedureCallback>
-					  (*m_impl, divideInfo.requestId);
-				m_impl->queueDivideInfoCallback(divideInfo.requestId, callback);
-			}
-		}
-		if (serialId != sequenceId) {
-			errObj.addError("Invalid serialId. expected: %" PRIu64
-					" actual: %" PRId64 "\n",
-					sequenceId,
-					divideInfo.serialId);
-
-			sweepInvalidHostgroupMembershipVectSequentialIdPair();
+		if (!m_impl->appendDividedMessage(
+		       m_impl->m_hostgroupMembershipVectBuffer, "putHostGroupMembership",
+		       divideInfo, hostgroupMembershipVect, errObj)) {
 			return HatoholArmPluginInterfaceHAPI2::buildErrorResponse(
 			  JSON_RPC_INVALID_PARAMS, "Invalid method parameter(s).",
 			  &errObj.getErrors(), &parser);
@@ -2481,27 +2187,25 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHostGroupMembership(
 	}
 
 	if (divided) {
-		for (auto &elemMultiMap : m_impl->m_HostgroupMembershipVectSequentialIdMapRequestIdMultiMap) {
-			if (divideInfo.requestId != elemMultiMap.first)
-				continue;
-
-			collectedHostgroupMembershipVect.insert(
-			  collectedHostgroupMembershipVect.end(),
-			  elemMultiMap.second.second.begin(),
-			  elemMultiMap.second.second.end());
-		}
-
-		sweepInvalidHostgroupMembershipVectSequentialIdPair();
+		m_impl->m_hostgroupMembershipVectBuffer.take(
+		  divideInfo.requestId, collectedHostgroupMembershipVect);
 	}
 
 	auto updateHostGroupMembershipInfo =
 	  [&](HostgroupMemberVect &hostgroupMembershipVect) {
 		// TODO: reflect error in response
 		if (checkInvalidHostGroupMembership) {
-			dataStore->syncHostgroupMembers(hostgroupMembershipVect,
-							serverInfo.id,
-							lastInfoUpserter);
+			m_impl->syncIfChanged(
+			  hostgroupMembershipVect,
+			  LAST_INFO_HOST_GROUP_MEMBERSHIP_FINGERPRINT,
+			  lastInfoUpserter, [&]() {
+				return dataStore->syncHostgroupMembers(
+				  hostgroupMembershipVect, serverInfo.id,
+				  lastInfoUpserter);
+			});
 		} else {
+			m_impl->clearSyncFingerprint(
+			  LAST_INFO_HOST_GROUP_MEMBERSHIP_FINGERPRINT);
 			dataStore->upsertHostgroupMembers(hostgroupMembershipVect,
 							  lastInfoUpserter);
 		}
@@ -2593,23 +2297,15 @@ static HostIdType getHostInfoCacheWithAdhocRegistration(
 	return cacheElem.hostId;
 }
 
-static bool parseTriggersParams(JSONParser &parser, TriggerInfoList &triggerInfoList,
+static bool parseTriggersParams(HatoholArmPluginInterfaceHAPI2 &hapi2,
+				JSONParser &parser, TriggerInfoList &triggerInfoList,
 				const MonitoringServerInfo &serverInfo,
 				HostInfoCache &hostInfoCache,
 				JSONRPCError &errObj)
 {
 	CHECK_MANDATORY_ARRAY_EXISTENCE("triggers", errObj);
-	parser.startObject("triggers");
-	size_t num = parser.countElements();
-
-	for (size_t i = 0; i < num; i++) {
-		if (!parser.startElement(i)) {
-			MLPL_ERR("Failed to parse triggers contents.\n");
-			errObj.addError("Failed to parse triggers array object.");
-			parser.endObject(); // triggers
-			return false;
-		}
 
+	auto parseTrigger = [&](JSONParser &parser) {
 		TriggerInfo triggerInfo;
 		triggerInfo.id = AUTO_INCREMENT_VALUE;
 		PARSE_AS_MANDATORY("triggerId",   triggerInfo.id, errObj);
@@ -2621,7 +2317,6 @@ static bool parseTriggersParams(JSONParser &parser, TriggerInfoList &triggerInfo
 		PARSE_AS_MANDATORY("hostName",     triggerInfo.hostName, errObj);
 		PARSE_AS_MANDATORY("brief",        triggerInfo.brief, errObj);
 		PARSE_AS_MANDATORY("extendedInfo", triggerInfo.extendedInfo, errObj);
-		parser.endElement();
 
 		triggerInfo.validity = TRIGGER_VALID;
 
@@ -2630,8 +2325,13 @@ static bool parseTriggersParams(JSONParser &parser, TriggerInfoList &triggerInfo
 		      hostInfoCache, serverInfo.id,
 		      triggerInfo.hostIdInServer, triggerInfo.hostName);
 		triggerInfoList.push_back(triggerInfo);
+		return true;
+	};
+	if (!hapi2.forEachElement(parser, "triggers", parseTrigger)) {
+		MLPL_ERR("Failed to parse triggers contents.\n");
+		errObj.addError("Failed to parse triggers array object.");
+		return false;
 	}
-	parser.endObject(); // triggers
 	return true;
 };
 
@@ -2645,7 +2345,6 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutTriggers(
 	JSONRPCError errObj;
 	DivideInfo divideInfo;
 	bool divided = false;
-	pair<SerialId, TriggerInfoList> triggerInfoListSequentialIdPair;
 	Impl::UpsertLastInfoHook lastInfoUpserter(*m_impl, LAST_INFO_TRIGGER);
 	CHECK_MANDATORY_PARAMS_EXISTENCE("params", errObj);
 	parser.startObject("params");
@@ -2661,16 +2360,8 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutTriggers(
 		return builder.generate();
 	};
 
-	auto sweepInvalidTriggerInfoListSequentialIdPair = [&](){
-		auto range =
-		  m_impl->m_TriggerInfoListSequentialIdMapRequestIdMultiMap
-		    .equal_range(divideInfo.requestId);
-		m_impl->m_TriggerInfoListSequentialIdMapRequestIdMultiMap
-		  .erase(range.first, range.second);
-	};
-
 	const MonitoringServerInfo &serverInfo = m_impl->m_serverInfo;
-	parseTriggersParams(parser, triggerInfoList,
+	parseTriggersParams(*this, parser, triggerInfoList,
 	                    serverInfo, m_impl->hostInfoCache, errObj);
 
 	string updateType;
@@ -2687,32 +2378,9 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutTriggers(
 		divided = parseDivideInfo(parser, divideInfo, errObj);
 		parser.endObject(); // divideInfo
 
-		triggerInfoListSequentialIdPair = make_pair(divideInfo.serialId,
-							    triggerInfoList);
-		m_impl->m_TriggerInfoListSequentialIdMapRequestIdMultiMap.emplace(
-		  divideInfo.requestId, triggerInfoListSequentialIdPair);
-
-		const uint64_t sequenceId =
-		  m_impl->m_TriggerInfoListSequentialIdMapRequestIdMultiMap.count(divideInfo.requestId);
-		const uint64_t serialId = static_cast<uint64_t>(divideInfo.serialId) + 1;
-		if (serialId == sequenceId) {
-			if (sequenceId != 1)
-				m_impl->runDivideInfoCallback(divideInfo.requestId);
-
-			if (!divideInfo.isLast) {
-				auto callback =
-				  make_shared<Impl::DividedPutEventsProcedureCallback>
-					  (*m_impl, divideInfo.requestId);
-				m_impl->queueDivideInfoCallback(divideInfo.requestId, callback);
-			}
-		}
-		if (serialId != sequenceId) {
-			errObj.addError("Invalid serialId. expected: %" PRIu64
-					" actual: %" PRId64 "\n",
-					sequenceId,
-					divideInfo.serialId);
-
-			sweepInvalidTriggerInfoListSequentialIdPair();
+		if (!m_impl->appendDividedMessage(
+		       m_impl->m_triggerInfoListBuffer, "putTriggers",
+		       divideInfo, triggerInfoList, errObj)) {
 			return HatoholArmPluginInterfaceHAPI2::buildErrorResponse(
 			  JSON_RPC_INVALID_PARAMS, "Invalid method parameter(s).",
 			  &errObj.getErrors(), &parser);
@@ -2734,23 +2402,23 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutTriggers(
 	}
 
 	if (divided) {
-		for (auto &elemMultiMap : m_impl->m_TriggerInfoListSequentialIdMapRequestIdMultiMap) {
-			if (divideInfo.requestId != elemMultiMap.first)
-				continue;
-
-			collectedTriggerInfoList.splice(collectedTriggerInfoList.end(),
-							elemMultiMap.second.second);
-		}
-
-		sweepInvalidTriggerInfoListSequentialIdPair();
+		m_impl->m_triggerInfoListBuffer.take(
+		  divideInfo.requestId, collectedTriggerInfoList);
 	}
 
 	auto updateTriggers = [&](TriggerInfoList &triggerInfoList) {
 		// TODO: reflect error in response
 		if (checkInvalidTriggers) {
-			dataStore->syncTriggers(triggerInfoList, serverInfo.id,
-						lastInfoUpserter);
+			m_impl->syncIfChanged(
+			  triggerInfoList, LAST_INFO_TRIGGER_FINGERPRINT,
+			  lastInfoUpserter, [&]() {
+				return dataStore->syncTriggers(
+				  triggerInfoList, serverInfo.id,
+				  lastInfoUpserter);
+			});
 		} else {
+			m_impl->clearSyncFingerprint(
+			  LAST_INFO_TRIGGER_FINGERPRINT);
 			dataStore->addTriggers(triggerInfoList, lastInfoUpserter);
 		}
 	};
@@ -2791,35 +2459,21 @@ static bool parseEventType(JSONParser &parser, EventInfo &eventInfo,
 	return true;
 };
 
-static bool parseEventsParams(JSONParser &parser, EventInfoList &eventInfoList,
+static bool parseEventsParams(HatoholArmPluginInterfaceHAPI2 &hapi2,
+			      JSONParser &parser, EventInfoList &eventInfoList,
 			      const MonitoringServerInfo &serverInfo,
 			      HostInfoCache &hostInfoCache,
 			      JSONRPCError &errObj)
 {
 	CHECK_MANDATORY_ARRAY_EXISTENCE("events", errObj);
-	parser.startObject("events");
-	size_t num = parser.countElements();
 	constexpr const size_t numLimit = 1000;
 
-	if (num > numLimit) {
-		string errorMessage =
-		  StringUtils::sprintf(
-		    "Event Object is too large. "
-		    "Object size limit(%zd) exceeded.\n",
-		    numLimit);
-		MLPL_ERR("%s", errorMessage.c_str());
-		errObj.addError("%s", errorMessage.c_str());
-		parser.endObject(); // events
-		return false;
-	}
-
-	for (size_t i = 0; i < num; i++) {
-		if (!parser.startElement(i)) {
-			MLPL_ERR("Failed to parse events contents.\n");
-			errObj.addError("Failed to parse events array object.");
-			parser.endObject(); // events
+	// The number of the events isn't known in advance when they are
+	// streamed. So the limit is checked while they are parsed.
+	size_t num = 0;
+	auto parseEvent = [&](JSONParser &parser) {
+		if (++num > numLimit)
 			return false;
-		}
 
 		EventInfo eventInfo;
 		eventInfo.unifiedId = AUTO_INCREMENT_VALUE;
@@ -2839,16 +2493,31 @@ static bool parseEventsParams(JSONParser &parser, EventInfoList &eventInfoList,
 		parser.read("hostName",     eventInfo.hostName);
 		PARSE_AS_MANDATORY("brief", eventInfo.brief, errObj);
 		parser.read("extendedInfo", eventInfo.extendedInfo);
-		parser.endElement();
 
 		eventInfo.globalHostId =
 		  getHostInfoCacheWithAdhocRegistration(
 		    hostInfoCache, serverInfo.id,
 		    eventInfo.hostIdInServer, eventInfo.hostName);
 		eventInfoList.push_back(eventInfo);
+		return true;
+	};
+	if (hapi2.forEachElement(parser, "events", parseEvent))
+		return true;
+
+	if (num > numLimit) {
+		string errorMessage =
+		  StringUtils::sprintf(
+		    "Event Object is too large. "
+		    "Object size limit(%zd) exceeded.\n",
+		    numLimit);
+		MLPL_ERR("%s", errorMessage.c_str());
+		errObj.addError("%s", errorMessage.c_str());
+		eventInfoList.clear();
+	} else {
+		MLPL_ERR("Failed to parse events contents.\n");
+		errObj.addError("Failed to parse events array object.");
 	}
-	parser.endObject(); // events
-	return true;
+	return false;
 };
 
 string HatoholArmPluginGateHAPI2::procedureHandlerPutEvents(
@@ -2861,7 +2530,6 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutEvents(
 	string fetchId;
 	DivideInfo divideInfo;
 	bool divided = false;
-	pair<SerialId, EventInfoList> eventInfoListSequentialIdPair;
 	Impl::UpsertLastInfoHook lastInfoUpserter(*m_impl, LAST_INFO_EVENT);
 	bool mayMoreFlag = false;
 	CHECK_MANDATORY_PARAMS_EXISTENCE("params", errObj);
@@ -2878,16 +2546,8 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutEvents(
 		return builder.generate();
 	};
 
-	auto sweepInvalidEventInfoListSequentialIdPair = [&](){
-		auto range =
-		  m_impl->m_EventInfoListSequentialIdMapRequestIdMultiMap
-		    .equal_range(divideInfo.requestId);
-		m_impl->m_EventInfoListSequentialIdMapRequestIdMultiMap
-		  .erase(range.first, range.second);
-	};
-
 	const MonitoringServerInfo &serverInfo = m_impl->m_serverInfo;
-	parseEventsParams(parser, eventInfoList, serverInfo,
+	parseEventsParams(*this, parser, eventInfoList, serverInfo,
 	                  m_impl->hostInfoCache, errObj);
 
 	if (parser.isMember("fetchId")) {
@@ -2906,32 +2566,9 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutEvents(
 		divided = parseDivideInfo(parser, divideInfo, errObj);
 		parser.endObject(); // divideInfo
 
-		eventInfoListSequentialIdPair = make_pair(divideInfo.serialId,
-							  eventInfoList);
-		m_impl->m_EventInfoListSequentialIdMapRequestIdMultiMap.emplace(
-		  divideInfo.requestId, eventInfoListSequentialIdPair);
-
-		const uint64_t sequenceId =
-		  m_impl->m_EventInfoListSequentialIdMapRequestIdMultiMap.count(divideInfo.requestId);
-		const uint64_t serialId = static_cast<uint64_t>(divideInfo.serialId) + 1;
-		if (serialId == sequenceId) {
-			if (sequenceId != 1)
-				m_impl->runDivideInfoCallback(divideInfo.requestId);
-
-			if (!divideInfo.isLast) {
-				auto callback =
-				  make_shared<Impl::DividedPutEventsProcedureCallback>
-					  (*m_impl, divideInfo.requestId);
-				m_impl->queueDivideInfoCallback(divideInfo.requestId, callback);
-			}
-		}
-		if (serialId != sequenceId) {
-			errObj.addError("Invalid serialId. expected: %" PRIu64
-					" actual: %" PRId64 "\n",
-					sequenceId,
-					divideInfo.serialId);
-
-			sweepInvalidEventInfoListSequentialIdPair();
+		if (!m_impl->appendDividedMessage(
+		       m_impl->m_eventInfoListBuffer, "putEvents",
+		       divideInfo, eventInfoList, errObj)) {
 			return HatoholArmPluginInterfaceHAPI2::buildErrorResponse(
 			  JSON_RPC_INVALID_PARAMS, "Invalid method parameter(s).",
 			  &errObj.getErrors(), &parser);
@@ -2953,21 +2590,24 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutEvents(
 	}
 
 	if (divided) {
-		for (auto &elemMultiMap : m_impl->m_EventInfoListSequentialIdMapRequestIdMultiMap) {
-			if (divideInfo.requestId != elemMultiMap.first)
-				continue;
-
-			collectedEventInfoList.splice(collectedEventInfoList.end(),
-							elemMultiMap.second.second);
-		}
-
-		sweepInvalidEventInfoListSequentialIdPair();
-	}
-
-	if (divided) {
-		dataStore->addEventList(collectedEventInfoList, lastInfoUpserter);
-	} else {
-		dataStore->addEventList(eventInfoList, lastInfoUpserter);
+		m_impl->m_eventInfoListBuffer.take(
+		  divideInfo.requestId, collectedEventInfoList);
+	}
+
+	// Events resent by the plugin are dropped before any DB access.
+	EventInfoList &newEventInfoList =
+	  divided ? collectedEventInfoList : eventInfoList;
+	// The keys are got before the events are merged with their triggers
+	// in addEventList().
+	RecentEventFilter &recentEventFilter = m_impl->getRecentEventFilter();
+	RecentEventFilter::EventKeyVect passedEventKeys;
+	recentEventFilter.filter(newEventInfoList, passedEventKeys);
+	if (!newEventInfoList.empty()) {
+		dataStore->addEventList(newEventInfoList, lastInfoUpserter);
+		recentEventFilter.remember(passedEventKeys);
+	} else if (!lastInfoUpserter.lastInfo.empty()) {
+		m_impl->upsertLastInfo(lastInfoUpserter.lastInfo,
+		                       LAST_INFO_EVENT);
 	}
 
 	if (!mayMoreFlag)
@@ -3021,7 +2661,6 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHostParents(
 	JSONRPCError errObj;
 	DivideInfo divideInfo;
 	bool divided = false;
-	pair<SerialId, VMInfoVect> vmInfoVectSequentialIdPair;
 	Impl::UpsertLastInfoHook lastInfoUpserter(*m_impl,
 	                                          LAST_INFO_HOST_PARENT);
 	CHECK_MANDATORY_PARAMS_EXISTENCE("params", errObj);
@@ -3040,14 +2679,6 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHostParents(
 		return builder.generate();
 	};
 
-	auto sweepInvalidVMInfoVectSequentialIdPair = [&](){
-		auto range =
-		  m_impl->m_VMInfoVectSequentialIdMapRequestIdMultiMap
-		    .equal_range(divideInfo.requestId);
-		m_impl->m_VMInfoVectSequentialIdMapRequestIdMultiMap
-		  .erase(range.first, range.second);
-	};
-
 	string updateType;
 	bool checkInvalidHostParents = parseUpdateType(parser, updateType, errObj);
 	MLPL_BUG("Take into account the result: checkInvalidHostParents: %d.",
@@ -3060,32 +2691,9 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHostParents(
 		divided = parseDivideInfo(parser, divideInfo, errObj);
 		parser.endObject(); // divideInfo
 
-		vmInfoVectSequentialIdPair = make_pair(divideInfo.serialId,
-						       vmInfoVect);
-		m_impl->m_VMInfoVectSequentialIdMapRequestIdMultiMap.emplace(
-		  divideInfo.requestId, vmInfoVectSequentialIdPair);
-
-		const uint64_t sequenceId =
-		  m_impl->m_VMInfoVectSequentialIdMapRequestIdMultiMap.count(divideInfo.requestId);
-		const uint64_t serialId = static_cast<uint64_t>(divideInfo.serialId) + 1;
-		if (serialId == sequenceId) {
-			if (sequenceId != 1)
-				m_impl->runDivideInfoCallback(divideInfo.requestId);
-
-			if (!divideInfo.isLast) {
-				auto callback =
-					make_shared<Impl::DividedPutHostParentsProcedureCallback>
-					(*m_impl, divideInfo.requestId);
-				m_impl->queueDivideInfoCallback(divideInfo.requestId, callback);
-			}
-		}
-		if (serialId != sequenceId) {
-			errObj.addError("Invalid serialId. expected: %" PRIu64
-					" actual: %" PRId64 "\n",
-					sequenceId,
-					divideInfo.serialId);
-
-			sweepInvalidVMInfoVectSequentialIdPair();
+		if (!m_impl->appendDividedMessage(
+		       m_impl->m_vmInfoVectBuffer, "putHostParents",
+		       divideInfo, vmInfoVect, errObj)) {
 			return HatoholArmPluginInterfaceHAPI2::buildErrorResponse(
 			  JSON_RPC_INVALID_PARAMS, "Invalid method parameter(s).",
 			  &errObj.getErrors(), &parser);
@@ -3107,17 +2715,8 @@ string HatoholArmPluginGateHAPI2::procedureHandlerPutHostParents(
 	}
 
 	if (divided) {
-		for (auto &elemMultiMap : m_impl->m_VMInfoVectSequentialIdMapRequestIdMultiMap) {
-			if (divideInfo.requestId != elemMultiMap.first)
-				continue;
-
-			collectedVMInfoVect.insert(
-			  collectedVMInfoVect.end(),
-			  elemMultiMap.second.second.begin(),
-			  elemMultiMap.second.second.end());
-		}
-
-		sweepInvalidVMInfoVectSequentialIdPair();
+		m_impl->m_vmInfoVectBuffer.take(
+		  divideInfo.requestId, collectedVMInfoVect);
 	}
 
 	if (divided) {
@@ -51,6 +51,17 @@ public:
 	virtual void stop(void) override;
 	bool isEstablished(void);
 
+	/**
+	 * Set the time-out of a divided put* request.
+	 *
+	 * The chunks of a request are dropped if the next one doesn't arrive
+	 * within this time. The default is 90 seconds. It's applied to
+	 * requests that receive a chunk after this call.
+	 *
+	 * @param timeoutMSec A time-out in milliseconds.
+	 */
+	void setDividedRequestTimeout(const guint &timeoutMSec);
+
 	virtual bool isFetchItemsSupported(void) override;
 	virtual bool startOnDemandFetchItems(
 	  const LocalHostIdVector &hostIds = {},
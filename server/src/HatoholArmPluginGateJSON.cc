@@ -23,12 +23,14 @@
 
 #include "HatoholArmPluginGateJSON.h"
 #include "ThreadLocalDBCache.h"
+#include "ConfigManager.h"
 #include "UnifiedDataStore.h"
 #include "ArmFake.h"
 #include "AMQPConsumer.h"
 #include "AMQPConnectionInfo.h"
 #include "AMQPMessageHandler.h"
 #include "GateJSONEventMessage.h"
+#include "EventCoalescer.h"
 
 using namespace std;
 using namespace mlpl;
@@ -38,9 +40,14 @@ class AMQPJSONMessageHandler : public AMQPMessageHandler
 public:
 	AMQPJSONMessageHandler(const MonitoringServerInfo &serverInfo)
 	: m_serverInfo(serverInfo),
-	  m_hosts()
+	  m_hosts(),
+	  m_coalescer(
+	    flushEvents,
+	    ConfigManager::getInstance()->getJSONGateBatchSize(),
+	    ConfigManager::getInstance()->getJSONGateBatchIntervalMSec())
 	{
 		initializeHosts();
+		m_coalescer.start();
 	}
 
 	bool handle(AMQPConsumer &consumer, const AMQPMessage &message) override
@@ -67,6 +74,12 @@ public:
 private:
 	MonitoringServerInfo m_serverInfo;
 	map<string, HostIdType> m_hosts;
+	EventCoalescer m_coalescer;
+
+	static void flushEvents(EventInfoList &eventInfoList)
+	{
+		UnifiedDataStore::getInstance()->addEventList(eventInfoList);
+	}
 
 	void initializeHosts()
 	{
@@ -103,7 +116,6 @@ private:
 
 	void processEventMessage(GateJSONEventMessage &message)
 	{
-		EventInfoList eventInfoList;
 		EventInfo eventInfo;
 		initEventInfo(eventInfo);
 		eventInfo.serverId = m_serverInfo.id;
@@ -115,8 +127,7 @@ private:
 		eventInfo.globalHostId = findOrCreateHostID(eventInfo.hostName);
 		eventInfo.hostIdInServer = eventInfo.hostName;
 		eventInfo.brief = message.getContent();
-		eventInfoList.push_back(eventInfo);
-		UnifiedDataStore::getInstance()->addEventList(eventInfoList);
+		m_coalescer.add(eventInfo);
 	}
 
 	HostIdType findOrCreateHostID(const string &hostName)
@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <glib.h>
+#include <Logger.h>
+#include "HistoryFetchWorker.h"
+
+using namespace std;
+using namespace mlpl;
+
+const time_t HistoryFetchWorker::SETTLING_TIME_SEC = 60;
+// The same as the time-out of a procedure of HAPI2
+const size_t HistoryFetchWorker::DEFAULT_FETCH_TIMEOUT_MSEC = 90 * 1000;
+
+typedef tuple<ServerIdType, LocalHostIdType, ItemIdType, time_t, time_t>
+  HistoryFetchKey;
+typedef list<Closure1<HistoryInfoVect> *> HistoryClosureList;
+
+struct HistoryFetch {
+	HistoryClosureList closures;
+	// It distinguishes the fetches with the same key.
+	uint64_t           serial;
+	guint              timerId;
+};
+
+static void callHistoryClosure(Closure1<HistoryInfoVect> *closure,
+                               const HistoryInfoVect &historyInfoVect)
+{
+	(*closure)(historyInfoVect);
+	delete closure;
+}
+
+// Add the fetched samples in the range that aren't in the sorted vector.
+static void mergeFetchedHistory(HistoryInfoVect &historyInfoVect,
+                                const HistoryInfoVect &fetchedVect,
+                                const time_t &beginTime,
+                                const time_t &endTime)
+{
+	auto isEarlier = [](const HistoryInfo &lhs, const HistoryInfo &rhs) {
+		if (lhs.clock.tv_sec != rhs.clock.tv_sec)
+			return lhs.clock.tv_sec < rhs.clock.tv_sec;
+		return lhs.clock.tv_nsec < rhs.clock.tv_nsec;
+	};
+
+	const size_t numStored = historyInfoVect.size();
+	for (auto &historyInfo : fetchedVect) {
+		if (historyInfo.clock.tv_sec < beginTime ||
+		    historyInfo.clock.tv_sec > endTime)
+			continue;
+		auto end = historyInfoVect.begin() + numStored;
+		auto it = lower_bound(historyInfoVect.begin(), end,
+		                      historyInfo, isEarlier);
+		if (it != end && !isEarlier(historyInfo, *it))
+			continue;
+		historyInfoVect.push_back(historyInfo);
+	}
+	if (historyInfoVect.size() == numStored)
+		return;
+	auto middle = historyInfoVect.begin() + numStored;
+	stable_sort(middle, historyInfoVect.end(), isEarlier);
+	inplace_merge(historyInfoVect.begin(), middle, historyInfoVect.end(),
+	              isEarlier);
+}
+
+struct HistoryFetchWorker::Impl
+{
+	struct FetchedClosure : public Closure1<HistoryInfoVect>
+	{
+		Impl            *impl;
+		HistoryFetchKey  key;
+		uint64_t         serial;
+		time_t           fetchBeginTime;
+		time_t           fetchEndTime;
+		time_t           requestTime;
+
+		FetchedClosure(Impl *_impl, const HistoryFetchKey &_key,
+		               const uint64_t &_serial,
+		               const time_t &_fetchBeginTime,
+		               const time_t &_fetchEndTime)
+		: impl(_impl),
+		  key(_key),
+		  serial(_serial),
+		  fetchBeginTime(_fetchBeginTime),
+		  fetchEndTime(_fetchEndTime),
+		  requestTime(time(NULL))
+		{
+		}
+
+		virtual void operator()(const HistoryInfoVect &historyInfoVect)
+		  override
+		{
+			impl->onFetched(*this, historyInfoVect);
+		}
+	};
+
+	struct TimeoutContext
+	{
+		Impl            *impl;
+		HistoryFetchKey  key;
+		uint64_t         serial;
+	};
+
+	mutable std::mutex                 lock;
+	map<HistoryFetchKey, HistoryFetch> fetchMap;
+	size_t                             fetchTimeoutMSec;
+	uint64_t                           lastSerial;
+	HistoryStore                       historyStore;
+	Statistics                         statistics;
+
+	Impl(void)
+	: fetchTimeoutMSec(DEFAULT_FETCH_TIMEOUT_MSEC),
+	  lastSerial(0),
+	  statistics()
+	{
+	}
+
+	static gboolean onFetchTimeout(gpointer data)
+	{
+		TimeoutContext *context = static_cast<TimeoutContext *>(data);
+		Impl *impl = context->impl;
+		HistoryClosureList closures;
+		{
+			lock_guard<std::mutex> guard(impl->lock);
+			auto it = impl->fetchMap.find(context->key);
+			if (it == impl->fetchMap.end() ||
+			    it->second.serial != context->serial)
+				return G_SOURCE_REMOVE;
+			closures.swap(it->second.closures);
+			impl->fetchMap.erase(it);
+			impl->statistics.numTimedOutFetches++;
+		}
+		MLPL_WARN("A history fetch has been timed out: server: %"
+		          FMT_SERVER_ID ", item: %" FMT_ITEM_ID "\n",
+		          get<0>(context->key), get<2>(context->key).c_str());
+		const HistoryInfoVect emptyVect;
+		for (auto closure : closures)
+			callHistoryClosure(closure, emptyVect);
+		return G_SOURCE_REMOVE;
+	}
+
+	static void destroyTimeoutContext(gpointer data)
+	{
+		delete static_cast<TimeoutContext *>(data);
+	}
+
+	// Called with the lock held.
+	guint addTimer(const HistoryFetchKey &key, const uint64_t &serial)
+	{
+		TimeoutContext *context = new TimeoutContext();
+		context->impl = this;
+		context->key = key;
+		context->serial = serial;
+		GSource *source = g_timeout_source_new(fetchTimeoutMSec);
+		g_source_set_callback(source, onFetchTimeout, context,
+		                      destroyTimeoutContext);
+		const guint timerId = g_source_attach(source, NULL);
+		g_source_unref(source);
+		return timerId;
+	}
+
+	void onFetched(const FetchedClosure &fetched,
+	               const HistoryInfoVect &fetchedVect)
+	{
+		const ServerIdType serverId = get<0>(fetched.key);
+		const ItemIdType &itemId = get<2>(fetched.key);
+		const time_t beginTime = get<3>(fetched.key);
+		const time_t endTime = get<4>(fetched.key);
+
+		// An empty result may be caused by an error. It's fetched
+		// again next time.
+		if (!fetchedVect.empty()) {
+			const time_t settledTime =
+			  fetched.requestTime - SETTLING_TIME_SEC;
+			historyStore.add(serverId, itemId, fetchedVect,
+			                 fetched.fetchBeginTime,
+			                 min(fetched.fetchEndTime, settledTime));
+		}
+
+		// The store may have dropped some of the samples to keep
+		// its size.
+		HistoryInfoVect historyInfoVect;
+		historyStore.get(historyInfoVect, serverId, itemId,
+		                 beginTime, endTime);
+		mergeFetchedHistory(historyInfoVect, fetchedVect,
+		                    beginTime, endTime);
+
+		HistoryClosureList closures;
+		guint timerId;
+		{
+			lock_guard<std::mutex> guard(lock);
+			auto it = fetchMap.find(fetched.key);
+			// The fetch has already been timed out.
+			if (it == fetchMap.end() ||
+			    it->second.serial != fetched.serial)
+				return;
+			closures.swap(it->second.closures);
+			timerId = it->second.timerId;
+			fetchMap.erase(it);
+		}
+		g_source_remove(timerId);
+		for (auto closure : closures)
+			callHistoryClosure(closure, historyInfoVect);
+	}
+};
+
+// ---------------------------------------------------------------------------
+// Public methods
+// ---------------------------------------------------------------------------
+HistoryFetchWorker::HistoryFetchWorker(void)
+: m_impl(new Impl())
+{
+}
+
+HistoryFetchWorker::~HistoryFetchWorker()
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	for (auto &pair : m_impl->fetchMap) {
+		g_source_remove(pair.second.timerId);
+		for (auto closure : pair.second.closures)
+			delete closure;
+	}
+}
+
+void HistoryFetchWorker::start(shared_ptr<DataStore> dataStore,
+                               const ItemInfo &itemInfo,
+                               const time_t &beginTime,
+                               const time_t &endTime,
+                               Closure1<HistoryInfoVect> *closure)
+{
+	const HistoryFetchKey key(itemInfo.serverId, itemInfo.hostIdInServer,
+	                          itemInfo.id, beginTime, endTime);
+	HistoryStore &historyStore = m_impl->historyStore;
+	time_t fetchBeginTime, fetchEndTime;
+	uint64_t serial = 0;
+	const bool fetchIsNeeded =
+	  historyStore.getMissingRange(itemInfo.serverId, itemInfo.id,
+	                               beginTime, endTime,
+	                               fetchBeginTime, fetchEndTime);
+	{
+		lock_guard<std::mutex> guard(m_impl->lock);
+		m_impl->statistics.numRequests++;
+		if (!fetchIsNeeded) {
+			m_impl->statistics.numStoreHits++;
+		} else {
+			auto it = m_impl->fetchMap.find(key);
+			if (it != m_impl->fetchMap.end()) {
+				it->second.closures.push_back(closure);
+				m_impl->statistics.numCoalescedRequests++;
+				return;
+			}
+			HistoryFetch &fetch = m_impl->fetchMap[key];
+			fetch.closures.push_back(closure);
+			serial = ++m_impl->lastSerial;
+			fetch.serial = serial;
+			// The timer is set before the fetch starts since the
+			// closure may be called in startOnDemandFetchHistory().
+			fetch.timerId = m_impl->addTimer(key, serial);
+		}
+	}
+
+	if (!fetchIsNeeded) {
+		HistoryInfoVect historyInfoVect;
+		historyStore.get(historyInfoVect, itemInfo.serverId,
+		                 itemInfo.id, beginTime, endTime);
+		callHistoryClosure(closure, historyInfoVect);
+		return;
+	}
+
+	// The closure may be called in this call.
+	Closure1<HistoryInfoVect> *fetchedClosure =
+	  new Impl::FetchedClosure(m_impl.get(), key, serial,
+	                           fetchBeginTime, fetchEndTime);
+	dataStore->startOnDemandFetchHistory(itemInfo,
+	                                     fetchBeginTime, fetchEndTime,
+	                                     fetchedClosure);
+}
+
+void HistoryFetchWorker::setFetchTimeout(const size_t &msec)
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	m_impl->fetchTimeoutMSec = msec;
+}
+
+size_t HistoryFetchWorker::getFetchTimeout(void) const
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	return m_impl->fetchTimeoutMSec;
+}
+
+void HistoryFetchWorker::getStatistics(Statistics &stat) const
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	stat = m_impl->statistics;
+}
+
+HistoryStore &HistoryFetchWorker::getHistoryStore(void)
+{
+	return m_impl->historyStore;
+}
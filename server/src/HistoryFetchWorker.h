@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <memory>
+#include <stdint.h>
+#include "Closure.h"
+#include "DataStore.h"
+#include "HistoryStore.h"
+
+/**
+ * Fetches history through an in-memory store.
+ *
+ * The fetched samples are kept in a HistoryStore. A request is answered
+ * from the store when its whole range has been fetched. Otherwise only
+ * the missing part of the range is fetched from the data store.
+ *
+ * A request for the same item and the same time range as a running fetch
+ * waits for that fetch and gets its result.
+ *
+ * A fetch that doesn't complete within the fetch time-out is given up and
+ * its requests get an empty result. The time-out is handled in the default
+ * GLib main context.
+ */
+class HistoryFetchWorker
+{
+public:
+	/**
+	 * The latest seconds of a fetched range aren't marked as fetched in
+	 * the store, because their samples may still arrive at the monitoring
+	 * server.
+	 */
+	static const time_t SETTLING_TIME_SEC;
+	static const size_t DEFAULT_FETCH_TIMEOUT_MSEC;
+
+	struct Statistics {
+		uint64_t numRequests;
+		// The number of the requests that waited for a running fetch.
+		uint64_t numCoalescedRequests;
+		// The number of the requests answered only from the store.
+		uint64_t numStoreHits;
+		uint64_t numTimedOutFetches;
+	};
+
+	HistoryFetchWorker(void);
+	virtual ~HistoryFetchWorker();
+
+	/**
+	 * Fetch history of an item.
+	 *
+	 * @param dataStore A data store of the server that has the item.
+	 * @param itemInfo A target item.
+	 * @param beginTime The beginning of the time range.
+	 * @param endTime The end of the time range.
+	 * @param closure
+	 * A closure called with the fetched history. It is deleted after
+	 * the call.
+	 */
+	void start(std::shared_ptr<DataStore> dataStore,
+	           const ItemInfo &itemInfo,
+	           const time_t &beginTime, const time_t &endTime,
+	           Closure1<HistoryInfoVect> *closure);
+
+	/**
+	 * Set the time-out of a fetch. It's applied to the fetches started
+	 * after this call.
+	 *
+	 * @param msec A time-out in milliseconds.
+	 */
+	void setFetchTimeout(const size_t &msec);
+	size_t getFetchTimeout(void) const;
+
+	void getStatistics(Statistics &stat) const;
+	HistoryStore &getHistoryStore(void);
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
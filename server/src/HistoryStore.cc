@@ -0,0 +1,533 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+#include "HistoryStore.h"
+
+using namespace std;
+
+const size_t HistoryStore::DEFAULT_MAX_ITEMS = 256;
+const size_t HistoryStore::DEFAULT_MAX_SAMPLES_PER_ITEM = 20000;
+
+static const int64_t NSEC_PER_SEC = 1000000000;
+static const uint8_t SAME_BITS_HEADER = 0xff;
+static const size_t MAX_SAMPLES_PER_BLOCK = 128;
+
+static bool isEarlier(const timespec &lhs, const timespec &rhs)
+{
+	if (lhs.tv_sec != rhs.tv_sec)
+		return lhs.tv_sec < rhs.tv_sec;
+	return lhs.tv_nsec < rhs.tv_nsec;
+}
+
+static bool isSameTime(const timespec &lhs, const timespec &rhs)
+{
+	return lhs.tv_sec == rhs.tv_sec && lhs.tv_nsec == rhs.tv_nsec;
+}
+
+static void writeVarint(vector<uint8_t> &data, uint64_t value)
+{
+	while (value >= 0x80) {
+		data.push_back((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	data.push_back(value);
+}
+
+static uint64_t readVarint(const vector<uint8_t> &data, size_t &pos)
+{
+	uint64_t value = 0;
+	for (int shift = 0; pos < data.size(); shift += 7) {
+		const uint8_t byte = data[pos++];
+		value |= (uint64_t)(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+			break;
+	}
+	return value;
+}
+
+static uint64_t encodeZigzag(const int64_t &value)
+{
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t decodeZigzag(const uint64_t &value)
+{
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static string formatNumber(const double &number)
+{
+	// The shortest form that is converted back to the same number.
+	char buf[32];
+	for (int precision = 1; precision <= 17; precision++) {
+		snprintf(buf, sizeof(buf), "%.*g", precision, number);
+		if (strtod(buf, NULL) == number)
+			break;
+	}
+	return buf;
+}
+
+// A value is stored as a number only when it can be restored exactly.
+static bool parseNumber(const string &value, double &number)
+{
+	if (value.empty())
+		return false;
+	char *end = NULL;
+	number = strtod(value.c_str(), &end);
+	if (*end != '\0' || !std::isfinite(number))
+		return false;
+	return formatNumber(number) == value;
+}
+
+struct HistoryBlock {
+	vector<uint8_t> data;
+	size_t          numSamples;
+	bool            numeric;
+	timespec        firstClock;
+	timespec        lastClock;
+
+	// The states to encode the next sample
+	int64_t         prevNSec;
+	int64_t         prevDelta;
+	uint64_t        prevBits;
+	string          prevValue;
+
+	HistoryBlock(void)
+	: numSamples(0),
+	  numeric(false),
+	  firstClock({0, 0}),
+	  lastClock({0, 0}),
+	  prevNSec(0),
+	  prevDelta(0),
+	  prevBits(0)
+	{
+	}
+
+	bool append(const HistoryInfo &historyInfo)
+	{
+		if (numSamples >= MAX_SAMPLES_PER_BLOCK)
+			return false;
+		// A block of strings also takes numbers as strings.
+		double number = 0;
+		const bool isNumber = parseNumber(historyInfo.value, number);
+		if (numSamples == 0)
+			numeric = isNumber;
+		else if (numeric && !isNumber)
+			return false;
+
+		appendTime(historyInfo.clock);
+		if (numeric)
+			appendNumber(number);
+		else
+			appendString(historyInfo.value);
+
+		if (numSamples == 0)
+			firstClock = historyInfo.clock;
+		lastClock = historyInfo.clock;
+		numSamples++;
+		return true;
+	}
+
+	void decode(HistoryInfoVect &historyInfoVect,
+	            const ServerIdType &serverId, const ItemIdType &itemId,
+	            const time_t &beginTime, const time_t &endTime) const
+	{
+		size_t pos = 0;
+		int64_t nsec = 0, delta = 0;
+		uint64_t bits = 0;
+		string value;
+		for (size_t i = 0; i < numSamples; i++) {
+			const int64_t diff = decodeZigzag(readVarint(data, pos));
+			if (i == 0) {
+				nsec = diff;
+			} else {
+				delta = (i == 1) ? diff : delta + diff;
+				nsec += delta;
+			}
+
+			if (numeric) {
+				bits ^= readXORedBits(pos);
+				double number;
+				memcpy(&number, &bits, sizeof(number));
+				value = formatNumber(number);
+			} else {
+				const uint64_t length = readVarint(data, pos);
+				if (length > 0) {
+					value.assign(
+					  (const char *)&data[pos], length - 1);
+					pos += length - 1;
+				}
+			}
+
+			const time_t sec = nsec / NSEC_PER_SEC;
+			if (sec < beginTime || sec > endTime)
+				continue;
+			HistoryInfo historyInfo;
+			historyInfo.serverId = serverId;
+			historyInfo.itemId = itemId;
+			historyInfo.value = value;
+			historyInfo.clock.tv_sec = sec;
+			historyInfo.clock.tv_nsec = nsec % NSEC_PER_SEC;
+			historyInfoVect.push_back(historyInfo);
+		}
+	}
+
+private:
+	void appendTime(const timespec &clock)
+	{
+		const int64_t nsec = clock.tv_sec * NSEC_PER_SEC + clock.tv_nsec;
+		if (numSamples == 0) {
+			writeVarint(data, encodeZigzag(nsec));
+		} else {
+			const int64_t delta = nsec - prevNSec;
+			if (numSamples == 1)
+				writeVarint(data, encodeZigzag(delta));
+			else
+				writeVarint(data, encodeZigzag(delta - prevDelta));
+			prevDelta = delta;
+		}
+		prevNSec = nsec;
+	}
+
+	// The XOR of the bits is written as a header byte that has the
+	// numbers of the leading and the trailing zero bytes, followed by
+	// the bytes between them.
+	void appendNumber(const double &number)
+	{
+		uint64_t bits;
+		memcpy(&bits, &number, sizeof(bits));
+		const uint64_t xored = bits ^ prevBits;
+		prevBits = bits;
+		if (xored == 0) {
+			data.push_back(SAME_BITS_HEADER);
+			return;
+		}
+		const int leading = __builtin_clzll(xored) / 8;
+		const int trailing = __builtin_ctzll(xored) / 8;
+		data.push_back((leading << 4) | trailing);
+		for (int i = 7 - leading; i >= trailing; i--)
+			data.push_back((xored >> (8 * i)) & 0xff);
+	}
+
+	uint64_t readXORedBits(size_t &pos) const
+	{
+		const uint8_t header = data[pos++];
+		if (header == SAME_BITS_HEADER)
+			return 0;
+		const int leading = header >> 4;
+		const int trailing = header & 0x0f;
+		uint64_t xored = 0;
+		for (int i = 7 - leading; i >= trailing; i--)
+			xored = (xored << 8) | data[pos++];
+		return xored << (8 * trailing);
+	}
+
+	void appendString(const string &value)
+	{
+		if (numSamples > 0 && value == prevValue) {
+			writeVarint(data, 0);
+			return;
+		}
+		writeVarint(data, value.size() + 1);
+		data.insert(data.end(), value.begin(), value.end());
+		prevValue = value;
+	}
+};
+
+typedef pair<ServerIdType, ItemIdType> HistorySeriesKey;
+
+struct HistorySeries {
+	deque<HistoryBlock>               blocks;
+	// The first and the last seconds of the fetched ranges. The ranges
+	// are neither overlapped nor adjacent.
+	map<time_t, time_t>               fetchedRanges;
+	size_t                            numSamples;
+	list<HistorySeriesKey>::iterator  lruIterator;
+
+	HistorySeries(void)
+	: numSamples(0)
+	{
+	}
+
+	bool getMissingRange(const time_t &beginTime, const time_t &endTime,
+	                     time_t &missingBeginTime,
+	                     time_t &missingEndTime) const
+	{
+		missingBeginTime = beginTime;
+		auto it = fetchedRanges.upper_bound(beginTime);
+		if (it != fetchedRanges.begin()) {
+			--it;
+			if (it->second >= beginTime)
+				missingBeginTime = it->second + 1;
+		}
+		if (missingBeginTime > endTime)
+			return false;
+
+		missingEndTime = endTime;
+		it = fetchedRanges.upper_bound(endTime);
+		if (it != fetchedRanges.begin()) {
+			--it;
+			if (it->second >= endTime)
+				missingEndTime = it->first - 1;
+		}
+		return true;
+	}
+
+	void get(HistoryInfoVect &historyInfoVect, const HistorySeriesKey &key,
+	         const time_t &beginTime, const time_t &endTime) const
+	{
+		for (auto &block : blocks) {
+			if (block.lastClock.tv_sec < beginTime)
+				continue;
+			if (block.firstClock.tv_sec > endTime)
+				break;
+			block.decode(historyInfoVect, key.first, key.second,
+			             beginTime, endTime);
+		}
+	}
+
+	void add(const HistorySeriesKey &key, HistoryInfoVect &sortedVect)
+	{
+		if (sortedVect.empty())
+			return;
+		if (blocks.empty() ||
+		    isEarlier(blocks.back().lastClock,
+		              sortedVect.front().clock)) {
+			for (auto &historyInfo : sortedVect)
+				append(historyInfo);
+			return;
+		}
+
+		// Merge them in time order. A new sample replaces the stored
+		// one with the same time.
+		HistoryInfoVect storedVect;
+		get(storedVect, key, numeric_limits<time_t>::min(),
+		    numeric_limits<time_t>::max());
+		blocks.clear();
+		numSamples = 0;
+		auto stored = storedVect.begin();
+		for (auto &historyInfo : sortedVect) {
+			for (; stored != storedVect.end(); ++stored) {
+				if (!isEarlier(stored->clock, historyInfo.clock))
+					break;
+				append(*stored);
+			}
+			if (stored != storedVect.end() &&
+			    isSameTime(stored->clock, historyInfo.clock))
+				++stored;
+			append(historyInfo);
+		}
+		for (; stored != storedVect.end(); ++stored)
+			append(*stored);
+	}
+
+	void markFetched(time_t beginTime, time_t endTime)
+	{
+		auto it = fetchedRanges.upper_bound(beginTime);
+		if (it != fetchedRanges.begin()) {
+			auto prev = it;
+			--prev;
+			if (prev->second >= beginTime - 1) {
+				beginTime = prev->first;
+				endTime = max(endTime, prev->second);
+				fetchedRanges.erase(prev);
+			}
+		}
+		while (it != fetchedRanges.end() && it->first <= endTime + 1) {
+			endTime = max(endTime, it->second);
+			fetchedRanges.erase(it++);
+		}
+		fetchedRanges[beginTime] = endTime;
+	}
+
+	void trim(const size_t &maxSamples)
+	{
+		bool trimmed = false;
+		while (numSamples > maxSamples && blocks.size() > 1) {
+			numSamples -= blocks.front().numSamples;
+			blocks.pop_front();
+			trimmed = true;
+		}
+		if (!trimmed)
+			return;
+
+		// Samples in the same second as the first remaining one may
+		// have been dropped.
+		const time_t keptTime = blocks.front().firstClock.tv_sec + 1;
+		auto it = fetchedRanges.begin();
+		while (it != fetchedRanges.end() && it->first < keptTime) {
+			const time_t endTime = it->second;
+			fetchedRanges.erase(it++);
+			if (endTime >= keptTime)
+				fetchedRanges[keptTime] = endTime;
+		}
+	}
+
+	size_t getNumBytes(void) const
+	{
+		size_t numBytes = 0;
+		for (auto &block : blocks)
+			numBytes += block.data.size();
+		return numBytes;
+	}
+
+private:
+	void append(const HistoryInfo &historyInfo)
+	{
+		if (blocks.empty() || !blocks.back().append(historyInfo)) {
+			blocks.emplace_back();
+			blocks.back().append(historyInfo);
+		}
+		numSamples++;
+	}
+};
+
+struct HistoryStore::Impl
+{
+	const size_t                           maxItems;
+	const size_t                           maxSamplesPerItem;
+	mutable std::mutex                     lock;
+	map<HistorySeriesKey, HistorySeries>   seriesMap;
+	// The most recently used one is at the front.
+	list<HistorySeriesKey>                 lruList;
+
+	Impl(const size_t &_maxItems, const size_t &_maxSamplesPerItem)
+	: maxItems(_maxItems),
+	  maxSamplesPerItem(max(_maxSamplesPerItem, MAX_SAMPLES_PER_BLOCK))
+	{
+	}
+
+	HistorySeries *find(const HistorySeriesKey &key)
+	{
+		auto it = seriesMap.find(key);
+		if (it == seriesMap.end())
+			return NULL;
+		HistorySeries &series = it->second;
+		lruList.splice(lruList.begin(), lruList, series.lruIterator);
+		return &series;
+	}
+
+	HistorySeries &acquire(const HistorySeriesKey &key)
+	{
+		HistorySeries *found = find(key);
+		if (found)
+			return *found;
+
+		while (!lruList.empty() && seriesMap.size() >= maxItems) {
+			seriesMap.erase(lruList.back());
+			lruList.pop_back();
+		}
+		HistorySeries &series = seriesMap[key];
+		lruList.push_front(key);
+		series.lruIterator = lruList.begin();
+		return series;
+	}
+};
+
+// ---------------------------------------------------------------------------
+// Public methods
+// ---------------------------------------------------------------------------
+HistoryStore::HistoryStore(const size_t &maxItems,
+                           const size_t &maxSamplesPerItem)
+: m_impl(new Impl(maxItems, maxSamplesPerItem))
+{
+}
+
+HistoryStore::~HistoryStore()
+{
+}
+
+bool HistoryStore::getMissingRange(
+  const ServerIdType &serverId, const ItemIdType &itemId,
+  const time_t &beginTime, const time_t &endTime,
+  time_t &missingBeginTime, time_t &missingEndTime)
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	HistorySeries *series = m_impl->find(HistorySeriesKey(serverId, itemId));
+	if (!series) {
+		missingBeginTime = beginTime;
+		missingEndTime = endTime;
+		return beginTime <= endTime;
+	}
+	return series->getMissingRange(beginTime, endTime,
+	                               missingBeginTime, missingEndTime);
+}
+
+void HistoryStore::get(HistoryInfoVect &historyInfoVect,
+                       const ServerIdType &serverId, const ItemIdType &itemId,
+                       const time_t &beginTime, const time_t &endTime)
+{
+	const HistorySeriesKey key(serverId, itemId);
+	lock_guard<std::mutex> guard(m_impl->lock);
+	HistorySeries *series = m_impl->find(key);
+	if (series)
+		series->get(historyInfoVect, key, beginTime, endTime);
+}
+
+void HistoryStore::add(const ServerIdType &serverId, const ItemIdType &itemId,
+                       const HistoryInfoVect &historyInfoVect,
+                       const time_t &fetchedBeginTime,
+                       const time_t &fetchedEndTime)
+{
+	HistoryInfoVect sortedVect(historyInfoVect);
+	stable_sort(sortedVect.begin(), sortedVect.end(),
+	  [](const HistoryInfo &lhs, const HistoryInfo &rhs) {
+		return isEarlier(lhs.clock, rhs.clock);
+	});
+	// Keep the last one of the samples with the same time.
+	size_t numSamples = 0;
+	for (size_t i = 0; i < sortedVect.size(); i++) {
+		if (i + 1 < sortedVect.size() &&
+		    isSameTime(sortedVect[i].clock, sortedVect[i + 1].clock))
+			continue;
+		sortedVect[numSamples++] = sortedVect[i];
+	}
+	sortedVect.resize(numSamples);
+
+	const HistorySeriesKey key(serverId, itemId);
+	lock_guard<std::mutex> guard(m_impl->lock);
+	HistorySeries &series = m_impl->acquire(key);
+	series.add(key, sortedVect);
+	if (fetchedBeginTime <= fetchedEndTime)
+		series.markFetched(fetchedBeginTime, fetchedEndTime);
+	series.trim(m_impl->maxSamplesPerItem);
+}
+
+void HistoryStore::getStatistics(Statistics &stat) const
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	stat.numItems = m_impl->seriesMap.size();
+	stat.numSamples = 0;
+	stat.numBytes = 0;
+	for (auto &pair : m_impl->seriesMap) {
+		stat.numSamples += pair.second.numSamples;
+		stat.numBytes += pair.second.getNumBytes();
+	}
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <memory>
+#include <stdint.h>
+#include "Monitoring.h"
+
+/**
+ * Keeps fetched history of items in memory.
+ *
+ * The samples of an item are stored in compressed blocks in time order.
+ * A timestamp is encoded as the delta of the delta from the previous one.
+ * A numeric value is encoded as the XOR with the previous one. The other
+ * values are stored as they are unless they equal the previous one.
+ *
+ * The store also remembers the time ranges that have been fetched for
+ * each item, so that only the missing range has to be fetched again.
+ * The oldest blocks of an item are dropped when it has too many samples,
+ * and the least recently used item is dropped when there are too many
+ * items.
+ */
+class HistoryStore {
+public:
+	static const size_t DEFAULT_MAX_ITEMS;
+	static const size_t DEFAULT_MAX_SAMPLES_PER_ITEM;
+
+	struct Statistics {
+		size_t numItems;
+		size_t numSamples;
+		size_t numBytes;
+	};
+
+	HistoryStore(const size_t &maxItems = DEFAULT_MAX_ITEMS,
+	             const size_t &maxSamplesPerItem =
+	               DEFAULT_MAX_SAMPLES_PER_ITEM);
+	virtual ~HistoryStore();
+
+	/**
+	 * Get the smallest range that covers all of the seconds in a range
+	 * that haven't been fetched.
+	 *
+	 * @param serverId A server ID of the item.
+	 * @param itemId An item ID.
+	 * @param beginTime The first second of the range.
+	 * @param endTime The last second of the range.
+	 * @param missingBeginTime The first missing second is stored.
+	 * @param missingEndTime The last missing second is stored.
+	 *
+	 * @return true if there is a missing second. Otherwise false.
+	 */
+	bool getMissingRange(const ServerIdType &serverId,
+	                     const ItemIdType &itemId,
+	                     const time_t &beginTime, const time_t &endTime,
+	                     time_t &missingBeginTime, time_t &missingEndTime);
+
+	/**
+	 * Get the stored samples in a range.
+	 *
+	 * @param historyInfoVect The samples are appended in time order.
+	 * @param serverId A server ID of the item.
+	 * @param itemId An item ID.
+	 * @param beginTime The first second of the range.
+	 * @param endTime The last second of the range.
+	 */
+	void get(HistoryInfoVect &historyInfoVect,
+	         const ServerIdType &serverId, const ItemIdType &itemId,
+	         const time_t &beginTime, const time_t &endTime);
+
+	/**
+	 * Store fetched samples.
+	 *
+	 * A stored sample with the same time as a new one is replaced.
+	 *
+	 * @param serverId A server ID of the item.
+	 * @param itemId An item ID.
+	 * @param historyInfoVect Fetched samples.
+	 * @param fetchedBeginTime The first second that has been fetched.
+	 * @param fetchedEndTime
+	 * The last second that has been fetched. If it is smaller than
+	 * fetchedBeginTime, no range is marked as fetched.
+	 */
+	void add(const ServerIdType &serverId, const ItemIdType &itemId,
+	         const HistoryInfoVect &historyInfoVect,
+	         const time_t &fetchedBeginTime,
+	         const time_t &fetchedEndTime);
+
+	void getStatistics(Statistics &stat) const;
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
@@ -149,14 +149,14 @@ string HostResourceQueryOption::getCondition(void) const
 	// Select only alive servers
 	if (getExcludeDefunctServers()) {
 		string validServersCondition(
-		  makeConditionServer(getValidServerIdSet(),
-				      getServerIdColumnName()));
+		  makeCachedConditionValidServers());
 		addCondition(condition, validServersCondition);
 	}
 
 	// Select only allowed servers and hostgroups
 	if (!has(OPPRVLG_GET_ALL_SERVER)) {
-		string allowedHostsCondition(makeConditionAllowedHosts());
+		string allowedHostsCondition(
+		  makeCachedConditionAllowedHosts());
 
 		if (DBHatohol::isAlwaysFalseCondition(allowedHostsCondition))
 			return allowedHostsCondition;
@@ -367,6 +367,59 @@ string HostResourceQueryOption::getHostIdColumnName(void) const
 	                           m_impl->synapse.hostIdColumnIdx);
 }
 
+bool HostResourceQueryOption::getWholeServerIds(ServerIdSet &serverIds) const
+{
+	if (m_impl->targetHostId != ALL_LOCAL_HOSTS ||
+	    m_impl->targetHostgroupId != ALL_HOST_GROUPS ||
+	    !m_impl->selectedServerIdSet.empty() ||
+	    !m_impl->excludedServerIdSet.empty() ||
+	    !m_impl->selectedServerHostgroupSetMap.empty() ||
+	    !m_impl->excludedServerHostgroupSetMap.empty() ||
+	    !m_impl->selectedServerHostSetMap.empty() ||
+	    !m_impl->excludedServerHostSetMap.empty()) {
+		return false;
+	}
+
+	// We cannot know all servers without the valid server list.
+	if (!getExcludeDefunctServers())
+		return false;
+
+	// Returns false if only a part of the host groups is allowed.
+	auto isWholeServerAllowed = [&](const ServerIdType &serverId,
+	                                bool &allowed) {
+		allowed = true;
+		if (has(OPPRVLG_GET_ALL_SERVER))
+			return true;
+		const ServerHostGrpSetMap &allowedServersAndHostgroups =
+		  getAllowedServersAndHostgroups();
+		auto endIt = allowedServersAndHostgroups.end();
+		if (allowedServersAndHostgroups.find(ALL_SERVERS) != endIt)
+			return true;
+		auto it = allowedServersAndHostgroups.find(serverId);
+		if (it == endIt) {
+			allowed = false;
+			return true;
+		}
+		const HostgroupIdSet &hostgroupIds = it->second;
+		return hostgroupIds.find(ALL_HOST_GROUPS) != hostgroupIds.end();
+	};
+
+	ServerIdSet wholeServerIds;
+	for (const auto &serverId : getValidServerIdSet()) {
+		if (m_impl->targetServerId != ALL_SERVERS &&
+		    m_impl->targetServerId != serverId) {
+			continue;
+		}
+		bool allowed;
+		if (!isWholeServerAllowed(serverId, allowed))
+			return false;
+		if (allowed)
+			wholeServerIds.insert(serverId);
+	}
+	serverIds.insert(wholeServerIds.begin(), wholeServerIds.end());
+	return true;
+}
+
 bool HostResourceQueryOption::isAllowedServer(
   const ServerIdType &targetServerId) const
 {
@@ -563,6 +616,41 @@ string HostResourceQueryOption::makeConditionAllowedHosts(void) const
 	return StringUtils::sprintf("(%s)", condition.c_str());
 }
 
+string HostResourceQueryOption::makeCachedConditionValidServers(void) const
+{
+	auto maker = [&] {
+		return makeConditionServer(getValidServerIdSet(),
+		                           getServerIdColumnName());
+	};
+	if (m_impl->validServerIdSet)
+		return maker();
+
+	// The valid servers depend on the privilege flags.
+	const string key = StringUtils::sprintf(
+	  "validServers:%" PRIu64 ":%s",
+	  getDataQueryContext().getOperationPrivilege().getFlags(),
+	  getServerIdColumnName().c_str());
+	return getDataQueryContext().getCachedCondition(key, maker);
+}
+
+string HostResourceQueryOption::makeCachedConditionAllowedHosts(void) const
+{
+	auto maker = [&] {
+		return makeConditionAllowedHosts();
+	};
+	// Don't share the condition when it depends on the targets or
+	// the allowed hosts given for a test.
+	if (m_impl->allowedServersAndHostgroups ||
+	    m_impl->targetServerId != ALL_SERVERS ||
+	    m_impl->targetHostgroupId != ALL_HOST_GROUPS)
+		return maker();
+
+	const string key = StringUtils::sprintf(
+	  "allowedHosts:%s:%s", getServerIdColumnName().c_str(),
+	  getHostgroupIdColumnName().c_str());
+	return getDataQueryContext().getCachedCondition(key, maker);
+}
+
 string HostResourceQueryOption::makeConditionSelectedServers(void) const
 {
 	if (m_impl->selectedServerIdSet.empty())
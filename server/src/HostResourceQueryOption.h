@@ -196,6 +196,22 @@ public:
 
 	std::string getJoinClause(void) const;
 
+	/**
+	 * Get servers whose records are entirely selected by this option.
+	 *
+	 * @param serverIds
+	 * IDs of valid servers that are the target and accessible are
+	 * added to this set.
+	 *
+	 * @return
+	 * true if the records are narrowed down only by servers. In this
+	 * case, the records of the servers in serverIds are selected.
+	 * false if the option has other conditions such as a target host
+	 * group, a target host, host filters or a privilege to access a
+	 * part of host groups.
+	 */
+	bool getWholeServerIds(ServerIdSet &serverIds) const;
+
 protected:
 	std::string getServerIdColumnName(void) const;
 	std::string getHostgroupIdColumnName(void) const;
@@ -206,6 +222,15 @@ protected:
 
 	std::string makeConditionTargetIds(void) const;
 	std::string makeConditionAllowedHosts(void) const;
+
+	/**
+	 * Same as makeConditionServer() with the valid servers or
+	 * makeConditionAllowedHosts(). The result is shared among the queries
+	 * of the user with AuthorizationCache when it doesn't depend on the
+	 * targets of this option.
+	 */
+	std::string makeCachedConditionValidServers(void) const;
+	std::string makeCachedConditionAllowedHosts(void) const;
 	std::string makeConditionServer(
 	  const ServerIdSet &serverIdSet,
 	  const std::string &serverIdColumnName) const;
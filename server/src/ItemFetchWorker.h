@@ -18,31 +18,24 @@
  */
 
 #pragma once
-#include <deque>
-#include <memory>
-#include "Params.h"
-#include "Closure.h"
-#include "DataStore.h"
+#include "OnDemandFetchWorker.h"
 #include "DBTablesMonitoring.h"
 
-class ItemFetchWorker
+class ItemFetchWorker : public OnDemandFetchWorker
 {
 public:
+	static const time_t DEFAULT_CACHE_TTL_SEC;
+
 	ItemFetchWorker(void);
 	virtual ~ItemFetchWorker();
 
+	using OnDemandFetchWorker::start;
 	bool start(const ItemsQueryOption &option,
 	           Closure0 *closure = NULL);
-	bool updateIsNeeded(void);
-	void waitCompletion(void);
 
 protected:
-	void updatedCallback(Closure0 *closure);
-	bool runFetcher(const LocalHostIdVector hostIds,
-	                std::shared_ptr<DataStore> dataStore);
-
-private:
-	struct Impl;
-	std::unique_ptr<Impl> m_impl;
+	virtual bool isFetchSupported(DataStore &dataStore) override;
+	virtual bool startFetch(DataStore &dataStore,
+	                        const LocalHostIdVector &hostIds,
+	                        Closure0 *closure) override;
 };
-
@@ -0,0 +1,431 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <deque>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <glib.h>
+#include <Logger.h>
+#include "HatoholException.h"
+#include "OnDemandFetchWorker.h"
+
+using namespace std;
+using namespace mlpl;
+
+const size_t OnDemandFetchWorker::DEFAULT_MAX_RUNNING_FETCHERS = 8;
+// The same as the time-out of a procedure of HAPI2
+const size_t OnDemandFetchWorker::DEFAULT_FETCH_TIMEOUT_MSEC = 90 * 1000;
+
+typedef pair<ServerIdType, LocalHostIdType> FetchKey;
+
+struct FetchRequest {
+	Closure0 *closure;
+	// One is added while start() is running so that the closure isn't
+	// called before all of the fetches for the request are known.
+	size_t    numWaitingFetches;
+};
+typedef shared_ptr<FetchRequest> FetchRequestPtr;
+
+struct Fetch {
+	shared_ptr<DataStore>  dataStore;
+	list<FetchRequestPtr>  requests;
+	// It distinguishes the fetches with the same key. 0 means that the
+	// fetch is queued.
+	uint64_t               serial;
+	guint                  timerId;
+};
+typedef shared_ptr<Fetch> FetchPtr;
+
+struct OnDemandFetchWorker::Impl
+{
+	struct FetchedClosure : public Closure0
+	{
+		Impl     *impl;
+		FetchKey  key;
+		uint64_t  serial;
+
+		FetchedClosure(Impl *_impl, const FetchKey &_key,
+		               const uint64_t &_serial)
+		: impl(_impl),
+		  key(_key),
+		  serial(_serial)
+		{
+		}
+
+		virtual void operator()(void) override
+		{
+			impl->onFetched(key, serial, true);
+		}
+	};
+
+	struct TimeoutContext
+	{
+		Impl     *impl;
+		FetchKey  key;
+		uint64_t  serial;
+	};
+
+	OnDemandFetchWorker    *worker;
+	mutable std::mutex      lock;
+	size_t                  maxRunningFetchers;
+	time_t                  cacheTTLSec;
+	size_t                  fetchTimeoutMSec;
+	uint64_t                lastSerial;
+	// Running or queued fetches
+	map<FetchKey, FetchPtr> fetchMap;
+	deque<FetchKey>         fetchQueue;
+	size_t                  numRunningFetches;
+	// The monotonic time in usec until which a completed fetch is reused
+	map<FetchKey, gint64>   expirationTimeMap;
+	Statistics              statistics;
+
+	Impl(OnDemandFetchWorker *_worker, const time_t &_cacheTTLSec)
+	: worker(_worker),
+	  maxRunningFetchers(DEFAULT_MAX_RUNNING_FETCHERS),
+	  cacheTTLSec(_cacheTTLSec),
+	  fetchTimeoutMSec(DEFAULT_FETCH_TIMEOUT_MSEC),
+	  lastSerial(0),
+	  numRunningFetches(0),
+	  statistics()
+	{
+	}
+
+	bool isCached(const FetchKey &key, const gint64 &now)
+	{
+		auto it = expirationTimeMap.find(key);
+		if (it == expirationTimeMap.end())
+			return false;
+		return now < it->second;
+	}
+
+	FetchPtr findFetch(const FetchKey &key)
+	{
+		auto it = fetchMap.find(key);
+		if (it == fetchMap.end())
+			return nullptr;
+		return it->second;
+	}
+
+	// Called with the lock held. Returns true if the fetch should be
+	// started by the caller.
+	bool addRequest(shared_ptr<DataStore> dataStore,
+	                const LocalHostIdType &hostId,
+	                FetchRequestPtr request)
+	{
+		const ServerIdType serverId =
+		  dataStore->getMonitoringServerInfo().id;
+		const FetchKey key(serverId, hostId);
+		const FetchKey allHostsKey(serverId, ALL_LOCAL_HOSTS);
+		const gint64 now = g_get_monotonic_time();
+
+		if (isCached(key, now) || isCached(allHostsKey, now)) {
+			statistics.numCacheHits++;
+			return false;
+		}
+
+		FetchPtr fetch = findFetch(key);
+		if (!fetch)
+			fetch = findFetch(allHostsKey);
+		if (fetch) {
+			fetch->requests.push_back(request);
+			request->numWaitingFetches++;
+			statistics.numCoalescedRequests++;
+			return false;
+		}
+
+		fetch = make_shared<Fetch>();
+		fetch->dataStore = dataStore;
+		fetch->serial = 0;
+		fetch->timerId = 0;
+		fetch->requests.push_back(request);
+		request->numWaitingFetches++;
+		fetchMap[key] = fetch;
+		if (numRunningFetches >= maxRunningFetchers) {
+			fetchQueue.push_back(key);
+			return false;
+		}
+		numRunningFetches++;
+		return true;
+	}
+
+	static gboolean onFetchTimeout(gpointer data)
+	{
+		TimeoutContext *context = static_cast<TimeoutContext *>(data);
+		Impl *impl = context->impl;
+		{
+			lock_guard<std::mutex> guard(impl->lock);
+			FetchPtr fetch = impl->findFetch(context->key);
+			if (!fetch || fetch->serial != context->serial)
+				return G_SOURCE_REMOVE;
+			// This source is removed by returning G_SOURCE_REMOVE.
+			fetch->timerId = 0;
+			impl->statistics.numTimedOutFetches++;
+		}
+		MLPL_WARN("A fetch has been timed out: server: %" FMT_SERVER_ID
+		          ", host: %" FMT_LOCAL_HOST_ID "\n",
+		          context->key.first, context->key.second.c_str());
+		impl->onFetched(context->key, context->serial, true);
+		return G_SOURCE_REMOVE;
+	}
+
+	static void destroyTimeoutContext(gpointer data)
+	{
+		delete static_cast<TimeoutContext *>(data);
+	}
+
+	// Called with the lock held.
+	guint addTimer(const FetchKey &key, const uint64_t &serial)
+	{
+		TimeoutContext *context = new TimeoutContext();
+		context->impl = this;
+		context->key = key;
+		context->serial = serial;
+		GSource *source = g_timeout_source_new(fetchTimeoutMSec);
+		g_source_set_callback(source, onFetchTimeout, context,
+		                      destroyTimeoutContext);
+		const guint timerId = g_source_attach(source, NULL);
+		g_source_unref(source);
+		return timerId;
+	}
+
+	void runFetch(const FetchKey &key)
+	{
+		shared_ptr<DataStore> dataStore;
+		uint64_t serial;
+		{
+			lock_guard<std::mutex> guard(lock);
+			FetchPtr fetch = fetchMap[key];
+			dataStore = fetch->dataStore;
+			serial = ++lastSerial;
+			fetch->serial = serial;
+			// The timer is set before the fetch starts since the
+			// closure may be called in startFetch().
+			fetch->timerId = addTimer(key, serial);
+			statistics.numStartedFetches++;
+		}
+
+		LocalHostIdVector hostIds;
+		if (key.second != ALL_LOCAL_HOSTS)
+			hostIds.push_back(key.second);
+		Closure0 *closure = new FetchedClosure(this, key, serial);
+		if (!worker->startFetch(*dataStore, hostIds, closure)) {
+			MLPL_DBG("Failed to start a fetch: server: %"
+			         FMT_SERVER_ID ", host: %" FMT_LOCAL_HOST_ID
+			         "\n", key.first, key.second.c_str());
+			delete closure;
+			onFetched(key, serial, false);
+		}
+	}
+
+	void release(FetchRequestPtr request)
+	{
+		if (request->closure)
+			(*request->closure)();
+		delete request->closure;
+	}
+
+	void removeExpiredTimes(const gint64 &now)
+	{
+		auto it = expirationTimeMap.begin();
+		while (it != expirationTimeMap.end()) {
+			if (it->second <= now)
+				expirationTimeMap.erase(it++);
+			else
+				++it;
+		}
+	}
+
+	void onFetched(const FetchKey &key, const uint64_t &serial,
+	               const bool &started)
+	{
+		list<FetchRequestPtr> completedRequests;
+		FetchKey nextKey;
+		bool hasNext = false;
+		guint timerId = 0;
+		{
+			lock_guard<std::mutex> guard(lock);
+			auto it = fetchMap.find(key);
+			// The fetch has already been timed out.
+			if (it == fetchMap.end() || it->second->serial != serial)
+				return;
+			FetchPtr fetch = it->second;
+			fetchMap.erase(it);
+			timerId = fetch->timerId;
+
+			// A failed fetch is also reused not to flood a server
+			// that doesn't respond.
+			if (started && cacheTTLSec > 0) {
+				const gint64 now = g_get_monotonic_time();
+				removeExpiredTimes(now);
+				expirationTimeMap[key] =
+				  now + cacheTTLSec * G_USEC_PER_SEC;
+			}
+
+			for (auto request : fetch->requests) {
+				if (--request->numWaitingFetches == 0)
+					completedRequests.push_back(request);
+			}
+
+			numRunningFetches--;
+			if (!fetchQueue.empty()) {
+				nextKey = fetchQueue.front();
+				fetchQueue.pop_front();
+				numRunningFetches++;
+				hasNext = true;
+			}
+		}
+
+		if (timerId)
+			g_source_remove(timerId);
+		for (auto request : completedRequests)
+			release(request);
+		if (hasNext)
+			runFetch(nextKey);
+	}
+};
+
+// ---------------------------------------------------------------------------
+// Public methods
+// ---------------------------------------------------------------------------
+OnDemandFetchWorker::OnDemandFetchWorker(const time_t &cacheTTLSec)
+: m_impl(new Impl(this, cacheTTLSec))
+{
+}
+
+OnDemandFetchWorker::~OnDemandFetchWorker()
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	for (auto &pair : m_impl->fetchMap) {
+		if (pair.second->timerId)
+			g_source_remove(pair.second->timerId);
+	}
+}
+
+bool OnDemandFetchWorker::start(const DataStoreVector &dataStores,
+                                const ServerIdType &targetServerId,
+                                const LocalHostIdType &targetHostId,
+                                Closure0 *closure)
+{
+	FetchRequestPtr request = make_shared<FetchRequest>();
+	request->closure = closure;
+	request->numWaitingFetches = 1;
+
+	list<FetchKey> keysToRun;
+	{
+		lock_guard<std::mutex> guard(m_impl->lock);
+		m_impl->statistics.numRequests++;
+		for (auto dataStore : dataStores) {
+			const ServerIdType serverId =
+			  dataStore->getMonitoringServerInfo().id;
+			if (targetServerId != ALL_SERVERS &&
+			    targetServerId != serverId)
+				continue;
+			if (!isFetchSupported(*dataStore))
+				continue;
+			if (m_impl->addRequest(dataStore, targetHostId,
+			                       request)) {
+				keysToRun.push_back(
+				  FetchKey(serverId, targetHostId));
+			}
+		}
+	}
+
+	for (auto &key : keysToRun)
+		m_impl->runFetch(key);
+
+	lock_guard<std::mutex> guard(m_impl->lock);
+	return --request->numWaitingFetches > 0;
+}
+
+void OnDemandFetchWorker::startAndWait(const DataStoreVector &dataStores,
+                                       const ServerIdType &targetServerId,
+                                       const LocalHostIdType &targetHostId)
+{
+	struct FetchedClosure : public Closure0
+	{
+		promise<void> fetched;
+
+		virtual void operator()(void) override
+		{
+			fetched.set_value();
+		}
+	};
+
+	FetchedClosure *closure = new FetchedClosure();
+	future<void> fetched = closure->fetched.get_future();
+	if (!start(dataStores, targetServerId, targetHostId, closure)) {
+		delete closure;
+		return;
+	}
+	fetched.wait();
+}
+
+void OnDemandFetchWorker::setMaxRunningFetchers(const size_t &num)
+{
+	HATOHOL_ASSERT(num > 0, "The number of fetchers must be positive.");
+	lock_guard<std::mutex> guard(m_impl->lock);
+	m_impl->maxRunningFetchers = num;
+}
+
+size_t OnDemandFetchWorker::getMaxRunningFetchers(void) const
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	return m_impl->maxRunningFetchers;
+}
+
+void OnDemandFetchWorker::setCacheTTL(const time_t &sec)
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	m_impl->cacheTTLSec = sec;
+	m_impl->expirationTimeMap.clear();
+}
+
+time_t OnDemandFetchWorker::getCacheTTL(void) const
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	return m_impl->cacheTTLSec;
+}
+
+void OnDemandFetchWorker::setFetchTimeout(const size_t &msec)
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	m_impl->fetchTimeoutMSec = msec;
+}
+
+size_t OnDemandFetchWorker::getFetchTimeout(void) const
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	return m_impl->fetchTimeoutMSec;
+}
+
+void OnDemandFetchWorker::getStatistics(Statistics &stat) const
+{
+	lock_guard<std::mutex> guard(m_impl->lock);
+	stat = m_impl->statistics;
+}
+
+// ---------------------------------------------------------------------------
+// Protected methods
+// ---------------------------------------------------------------------------
+bool OnDemandFetchWorker::isFetchSupported(DataStore &dataStore)
+{
+	return true;
+}
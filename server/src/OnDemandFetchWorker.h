@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <memory>
+#include <stdint.h>
+#include "Params.h"
+#include "Closure.h"
+#include "DataStore.h"
+
+/**
+ * A base class of the workers that fetch data from monitoring servers on
+ * demand.
+ *
+ * A fetch is made for each pair of a monitoring server and a host.
+ * A request for a pair whose fetch is running or queued waits for that
+ * fetch instead of starting another one. A request for a pair whose fetch
+ * has completed within the cache TTL returns without fetching. A fetch for
+ * all hosts of a server also satisfies the requests for each of them.
+ *
+ * The number of the fetches that run at the same time is limited. The
+ * other fetches are queued and started when a running one completes.
+ *
+ * A running fetch that doesn't complete within the fetch time-out is
+ * regarded as completed. The time-out is handled in the default GLib main
+ * context. A completion after that is ignored.
+ */
+class OnDemandFetchWorker
+{
+public:
+	static const size_t DEFAULT_MAX_RUNNING_FETCHERS;
+	static const size_t DEFAULT_FETCH_TIMEOUT_MSEC;
+
+	struct Statistics {
+		uint64_t numRequests;
+		// The number of the requests to a data store answered by
+		// a completed fetch within the cache TTL.
+		uint64_t numCacheHits;
+		// The number of the requests to a data store that waited for
+		// a running or queued fetch.
+		uint64_t numCoalescedRequests;
+		uint64_t numStartedFetches;
+		uint64_t numTimedOutFetches;
+	};
+
+	/**
+	 * Constructor.
+	 *
+	 * @param cacheTTLSec
+	 * The time in seconds for which a completed fetch is reused.
+	 * If it is 0, the completed fetches are not reused.
+	 */
+	OnDemandFetchWorker(const time_t &cacheTTLSec);
+	virtual ~OnDemandFetchWorker();
+
+	/**
+	 * Start fetches for the data stores if needed.
+	 *
+	 * @param dataStores Candidates of the data stores to be fetched.
+	 * @param targetServerId A target server ID or ALL_SERVERS.
+	 * @param targetHostId A target host ID or ALL_LOCAL_HOSTS.
+	 * @param closure
+	 * A closure called when all of the fetches for this request have
+	 * completed. It is deleted after the call. It can be NULL.
+	 *
+	 * @return
+	 * true if the closure will be called. Otherwise, false is returned
+	 * and the caller has to delete the closure.
+	 */
+	bool start(const DataStoreVector &dataStores,
+	           const ServerIdType &targetServerId,
+	           const LocalHostIdType &targetHostId,
+	           Closure0 *closure = NULL);
+
+	/**
+	 * Start fetches as start() and wait for their completion.
+	 *
+	 * @param dataStores Candidates of the data stores to be fetched.
+	 * @param targetServerId A target server ID or ALL_SERVERS.
+	 * @param targetHostId A target host ID or ALL_LOCAL_HOSTS.
+	 */
+	void startAndWait(const DataStoreVector &dataStores,
+	                  const ServerIdType &targetServerId,
+	                  const LocalHostIdType &targetHostId);
+
+	void setMaxRunningFetchers(const size_t &num);
+	size_t getMaxRunningFetchers(void) const;
+	void setCacheTTL(const time_t &sec);
+	time_t getCacheTTL(void) const;
+
+	/**
+	 * Set the time-out of a fetch. It's applied to the fetches started
+	 * after this call.
+	 *
+	 * @param msec A time-out in milliseconds.
+	 */
+	void setFetchTimeout(const size_t &msec);
+	size_t getFetchTimeout(void) const;
+	void getStatistics(Statistics &stat) const;
+
+protected:
+	virtual bool isFetchSupported(DataStore &dataStore);
+
+	/**
+	 * Start a fetch with the data store.
+	 *
+	 * @param dataStore A data store to be fetched.
+	 * @param hostIds Target host IDs. It is empty for all hosts.
+	 * @param closure
+	 * A closure that has to be called and deleted by the data store when
+	 * the fetch completes.
+	 *
+	 * @return
+	 * true if the fetch has been started. Otherwise, false is returned
+	 * and the closure is deleted by this class.
+	 */
+	virtual bool startFetch(DataStore &dataStore,
+	                        const LocalHostIdVector &hostIds,
+	                        Closure0 *closure) = 0;
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
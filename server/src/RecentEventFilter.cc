@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "RecentEventFilter.h"
+#include "ElementHasher.h"
+
+using namespace std;
+
+const size_t RecentEventFilter::DEFAULT_CAPACITY = 10000;
+
+// The Bloom filter has about this number of bits for each event.
+// With 4 hash functions, the false positive rate is less than 2%.
+static const size_t BLOOM_BITS_PER_EVENT = 10;
+static const size_t BLOOM_NUM_HASHES = 4;
+
+static atomic<uint64_t> globalNumPassedEvents(0);
+static atomic<uint64_t> globalNumDroppedEvents(0);
+
+enum {
+	HASH_CONTENT,
+	HASH_UNMERGED_CONTENT,
+};
+
+struct RecentEventFilter::Impl {
+	struct RememberedEvent {
+		uint64_t contentHash;
+		// true if the hash is calculated by calcUnmergedContentHash()
+		// from an event read from the DB.
+		bool     stored;
+	};
+
+	const size_t capacity;
+
+	mutable mutex lock;
+	// The content of each remembered event keyed by its ID.
+	unordered_map<EventIdType, RememberedEvent> rememberedEventMap;
+	// The IDs in the remembered order.
+	deque<EventIdType> eventIdQueue;
+
+	// Forgotten events can't be removed from the Bloom filter.
+	// It is rebuilt after the capacity of events are forgotten.
+	vector<uint64_t> bloomBits;
+	uint64_t         bloomMask;
+	size_t           numForgottenSinceRebuild;
+
+	uint64_t numPassedEvents;
+	uint64_t numDroppedEvents;
+
+	Impl(const size_t &_capacity)
+	: capacity(_capacity > 0 ? _capacity : DEFAULT_CAPACITY),
+	  bloomMask(0),
+	  numForgottenSinceRebuild(0),
+	  numPassedEvents(0),
+	  numDroppedEvents(0)
+	{
+		size_t numBits = 64;
+		while (numBits < capacity * BLOOM_BITS_PER_EVENT)
+			numBits <<= 1;
+		bloomBits.resize(numBits / 64, 0);
+		bloomMask = numBits - 1;
+		rememberedEventMap.reserve(capacity);
+	}
+
+	static void addUnmergedContent(ElementHasher &hasher,
+	                               const EventInfo &eventInfo)
+	{
+		// unifiedId and globalHostId are assigned by Hatohol.
+		hasher << eventInfo.serverId
+		       << eventInfo.id
+		       << eventInfo.time
+		       << static_cast<int>(eventInfo.type)
+		       << eventInfo.triggerId
+		       << static_cast<int>(eventInfo.status);
+	}
+
+	static uint64_t calcContentHash(const EventInfo &eventInfo)
+	{
+		ElementHasher hasher(HASH_CONTENT);
+		addUnmergedContent(hasher, eventInfo);
+		hasher << static_cast<int>(eventInfo.severity)
+		       << eventInfo.hostIdInServer
+		       << eventInfo.hostName
+		       << eventInfo.brief
+		       << eventInfo.extendedInfo;
+		return hasher.value;
+	}
+
+	// The members that aren't filled with the ones of the trigger when
+	// the event is stored.
+	static uint64_t calcUnmergedContentHash(const EventInfo &eventInfo)
+	{
+		ElementHasher hasher(HASH_UNMERGED_CONTENT);
+		addUnmergedContent(hasher, eventInfo);
+		return hasher.value;
+	}
+
+	template <typename F>
+	void forEachBloomBit(const EventIdType &eventId, F func)
+	{
+		// Double hashing makes the hash functions from two values.
+		const uint64_t h1 = hash<EventIdType>()(eventId);
+		const uint64_t h2 = (h1 * 0x9e3779b97f4a7c15ULL) | 1;
+		for (size_t i = 0; i < BLOOM_NUM_HASHES; i++) {
+			const uint64_t bit = (h1 + i * h2) & bloomMask;
+			func(bloomBits[bit / 64], (uint64_t)1 << (bit % 64));
+		}
+	}
+
+	bool mayContain(const EventIdType &eventId)
+	{
+		bool found = true;
+		forEachBloomBit(eventId, [&](uint64_t &word, const uint64_t &bit) {
+			if (!(word & bit))
+				found = false;
+		});
+		return found;
+	}
+
+	void addToBloomFilter(const EventIdType &eventId)
+	{
+		forEachBloomBit(eventId, [](uint64_t &word, const uint64_t &bit) {
+			word |= bit;
+		});
+	}
+
+	void rebuildBloomFilter(void)
+	{
+		fill(bloomBits.begin(), bloomBits.end(), 0);
+		for (auto &pair : rememberedEventMap)
+			addToBloomFilter(pair.first);
+		numForgottenSinceRebuild = 0;
+	}
+
+	bool isKnown(const EventInfo &eventInfo, const uint64_t &contentHash)
+	{
+		if (!mayContain(eventInfo.id))
+			return false;
+		auto it = rememberedEventMap.find(eventInfo.id);
+		if (it == rememberedEventMap.end())
+			return false;
+		const RememberedEvent &remembered = it->second;
+		if (remembered.stored) {
+			return remembered.contentHash ==
+			       calcUnmergedContentHash(eventInfo);
+		}
+		return remembered.contentHash == contentHash;
+	}
+
+	void remember(const EventIdType &eventId, const uint64_t &contentHash,
+	              const bool &stored = false)
+	{
+		const RememberedEvent remembered = {contentHash, stored};
+		auto result = rememberedEventMap.emplace(eventId, remembered);
+		if (!result.second) {
+			// The content has been updated.
+			result.first->second = remembered;
+			return;
+		}
+		eventIdQueue.push_back(eventId);
+		addToBloomFilter(eventId);
+
+		while (eventIdQueue.size() > capacity) {
+			rememberedEventMap.erase(eventIdQueue.front());
+			eventIdQueue.pop_front();
+			numForgottenSinceRebuild++;
+		}
+		if (numForgottenSinceRebuild >= capacity)
+			rebuildBloomFilter();
+	}
+};
+
+// ---------------------------------------------------------------------------
+// Public methods
+// ---------------------------------------------------------------------------
+RecentEventFilter::RecentEventFilter(const size_t &capacity)
+: m_impl(new Impl(capacity))
+{
+}
+
+RecentEventFilter::~RecentEventFilter()
+{
+}
+
+size_t RecentEventFilter::filter(EventInfoList &eventInfoList,
+                                 EventKeyVect &passedEventKeys)
+{
+	// The duplicates in the list are found with this map.
+	unordered_map<EventIdType, uint64_t> contentHashMapInList;
+	size_t numDropped = 0;
+	passedEventKeys.clear();
+
+	lock_guard<mutex> lock(m_impl->lock);
+	auto it = eventInfoList.begin();
+	while (it != eventInfoList.end()) {
+		const EventInfo &eventInfo = *it;
+		// Events without ID such as the ones of self monitoring
+		// can't be distinguished.
+		if (eventInfo.id.empty()) {
+			++it;
+			continue;
+		}
+		const uint64_t contentHash = Impl::calcContentHash(eventInfo);
+		auto result =
+		  contentHashMapInList.emplace(eventInfo.id, contentHash);
+		const bool duplicatedInList =
+		  !result.second && result.first->second == contentHash;
+		result.first->second = contentHash;
+		if (duplicatedInList ||
+		    m_impl->isKnown(eventInfo, contentHash)) {
+			it = eventInfoList.erase(it);
+			numDropped++;
+		} else {
+			passedEventKeys.push_back({eventInfo.id, contentHash});
+			++it;
+		}
+	}
+
+	const size_t numPassed = eventInfoList.size();
+	m_impl->numPassedEvents += numPassed;
+	m_impl->numDroppedEvents += numDropped;
+	globalNumPassedEvents += numPassed;
+	globalNumDroppedEvents += numDropped;
+	return numDropped;
+}
+
+size_t RecentEventFilter::filter(EventInfoList &eventInfoList)
+{
+	EventKeyVect passedEventKeys;
+	return filter(eventInfoList, passedEventKeys);
+}
+
+void RecentEventFilter::remember(const EventKeyVect &passedEventKeys)
+{
+	lock_guard<mutex> lock(m_impl->lock);
+	for (auto &eventKey : passedEventKeys)
+		m_impl->remember(eventKey.eventId, eventKey.contentHash);
+}
+
+void RecentEventFilter::remember(const EventInfoList &eventInfoList)
+{
+	lock_guard<mutex> lock(m_impl->lock);
+	for (auto &eventInfo : eventInfoList) {
+		if (eventInfo.id.empty())
+			continue;
+		m_impl->remember(eventInfo.id,
+		                 Impl::calcContentHash(eventInfo));
+	}
+}
+
+void RecentEventFilter::rememberStored(
+  const EventInfoList &storedEventInfoList)
+{
+	lock_guard<mutex> lock(m_impl->lock);
+	for (auto &eventInfo : storedEventInfoList) {
+		if (eventInfo.id.empty())
+			continue;
+		m_impl->remember(eventInfo.id,
+		                 Impl::calcUnmergedContentHash(eventInfo),
+		                 true);
+	}
+}
+
+size_t RecentEventFilter::getCapacity(void) const
+{
+	return m_impl->capacity;
+}
+
+size_t RecentEventFilter::getNumberOfEvents(void) const
+{
+	lock_guard<mutex> lock(m_impl->lock);
+	return m_impl->rememberedEventMap.size();
+}
+
+void RecentEventFilter::getStatistics(Statistics &stat) const
+{
+	lock_guard<mutex> lock(m_impl->lock);
+	stat.numPassedEvents = m_impl->numPassedEvents;
+	stat.numDroppedEvents = m_impl->numDroppedEvents;
+}
+
+void RecentEventFilter::getGlobalStatistics(Statistics &stat)
+{
+	stat.numPassedEvents = globalNumPassedEvents;
+	stat.numDroppedEvents = globalNumDroppedEvents;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <memory>
+#include <vector>
+#include <stdint.h>
+#include "Monitoring.h"
+
+/**
+ * Drops events that have already been stored recently.
+ *
+ * A plugin resends an overlapping range of events when it reconnects.
+ * This class remembers the IDs and the contents of the recently stored
+ * events of a monitoring server. An event with the same ID and the same
+ * content is dropped before it is stored again. An event whose content
+ * differs isn't dropped because it updates the stored one.
+ *
+ * A Bloom filter is checked first so that most new events are passed
+ * without looking up the exact set. The number of the remembered events
+ * is limited by the capacity. The oldest ones are forgotten first.
+ */
+class RecentEventFilter {
+public:
+	static const size_t DEFAULT_CAPACITY;
+
+	struct Statistics {
+		uint64_t numPassedEvents;
+		uint64_t numDroppedEvents;
+	};
+
+	struct EventKey {
+		EventIdType eventId;
+		uint64_t    contentHash;
+	};
+	typedef std::vector<EventKey> EventKeyVect;
+
+	RecentEventFilter(const size_t &capacity = DEFAULT_CAPACITY);
+	virtual ~RecentEventFilter();
+
+	/**
+	 * Remove known events from the list. The duplicates in the list
+	 * are also removed.
+	 *
+	 * @param eventInfoList A list of events to be stored.
+	 * @param passedEventKeys
+	 * The keys of the passed events are stored in this variable. They
+	 * are calculated before the events are changed by storing them.
+	 *
+	 * @return The number of the removed events.
+	 */
+	size_t filter(EventInfoList &eventInfoList,
+	              EventKeyVect &passedEventKeys);
+	size_t filter(EventInfoList &eventInfoList);
+
+	/**
+	 * Remember events. This should be called after the events are
+	 * stored successfully.
+	 *
+	 * @param passedEventKeys The keys got by filter().
+	 */
+	void remember(const EventKeyVect &passedEventKeys);
+
+	/**
+	 * Remember events with the content sent by the plugin.
+	 *
+	 * @param eventInfoList A list of events.
+	 */
+	void remember(const EventInfoList &eventInfoList);
+
+	/**
+	 * Remember events read from the DB.
+	 *
+	 * The empty members of a stored event may have been filled with the
+	 * ones of its trigger. So only the other members are compared with
+	 * the events to be filtered.
+	 *
+	 * @param storedEventInfoList A list of the stored events.
+	 */
+	void rememberStored(const EventInfoList &storedEventInfoList);
+
+	size_t getCapacity(void) const;
+	size_t getNumberOfEvents(void) const;
+	void getStatistics(Statistics &stat) const;
+
+	/**
+	 * Get the statistics summed up for all instances in this process.
+	 *
+	 * @param stat The statistics are stored in this variable.
+	 */
+	static void getGlobalStatistics(Statistics &stat);
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
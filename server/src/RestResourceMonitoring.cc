@@ -20,6 +20,8 @@
 #include "RestResourceMonitoring.h"
 #include "RestResourceUtils.h"
 #include "UnifiedDataStore.h"
+#include <algorithm>
+#include <cstdio>
 #include <memory>
 #include <string.h>
 
@@ -33,11 +35,15 @@ const char *RestResourceMonitoring::pathForOverview  = "/overview";
 const char *RestResourceMonitoring::pathForHost      = "/host";
 const char *RestResourceMonitoring::pathForTrigger   = "/trigger";
 const char *RestResourceMonitoring::pathForEvent     = "/event";
+const char *RestResourceMonitoring::pathForEventChanges = "/event/changes";
 const char *RestResourceMonitoring::pathForItem      = "/item";
 const char *RestResourceMonitoring::pathForHistory   = "/history";
 const char *RestResourceMonitoring::pathForHostgroup = "/hostgroup";
 const char *RestResourceMonitoring::pathForTriggerBriefs = "/trigger/briefs";
 
+const time_t RestResourceMonitoring::DEFAULT_EVENT_CHANGES_TIMEOUT_SEC = 30;
+const time_t RestResourceMonitoring::MAX_EVENT_CHANGES_TIMEOUT_SEC = 300;
+
 void RestResourceMonitoring::registerFactories(FaceRest *faceRest)
 {
 	faceRest->addResourceHandlerFactory(
@@ -60,6 +66,10 @@ void RestResourceMonitoring::registerFactories(FaceRest *faceRest)
 	  pathForEvent,
 	  new RestResourceMonitoringFactory(
 	    faceRest, &RestResourceMonitoring::handlerGetEvent));
+	faceRest->addResourceHandlerFactory(
+	  pathForEventChanges,
+	  new RestResourceMonitoringFactory(
+	    faceRest, &RestResourceMonitoring::handlerGetEventChanges));
 	faceRest->addResourceHandlerFactory(
 	  pathForItem,
 	  new RestResourceMonitoringFactory(
@@ -75,7 +85,8 @@ void RestResourceMonitoring::registerFactories(FaceRest *faceRest)
 }
 
 RestResourceMonitoring::RestResourceMonitoring(FaceRest *faceRest, HandlerFunc handler)
-: RestResourceMemberHandler(faceRest, static_cast<RestMemberHandler>(handler))
+: RestResourceMemberHandler(faceRest, static_cast<RestMemberHandler>(handler)),
+  m_eventChangesTimedOut(false)
 {
 }
 
@@ -113,41 +124,72 @@ static HatoholError parseItemParameter(ItemsQueryOption &option,
 	return HatoholError(HTERR_OK);
 }
 
+// The items are always paged by the global ID. An absent or empty cursor
+// means the first page.
+static HatoholError parseItemCursorParameter(ItemsQueryOption &option,
+                                             GHashTable *query)
+{
+	const gchar *cursor = query ? static_cast<const gchar*>(
+	  g_hash_table_lookup(query, "cursor")) : NULL;
+	GenericIdType globalId = 0;
+	char extra;
+	if (cursor && *cursor &&
+	    sscanf(cursor, "%" FMT_GEN_ID "%c", &globalId, &extra) != 1) {
+		string message = StringUtils::sprintf("cursor: %s", cursor);
+		return HatoholError(HTERR_INVALID_PARAMETER, message);
+	}
+	option.setSeekPosition(globalId);
+	return HatoholError(HTERR_OK);
+}
+
+struct OverviewStatistics {
+	map<ServerIdType, size_t> numHostsMap;
+	DBTablesMonitoring::ServerTriggerStatisticsMap triggerStatisticsMap;
+};
+
+static HatoholError getOverviewStatistics(FaceRest::ResourceHandler *job,
+                                          OverviewStatistics &statistics)
+{
+	UnifiedDataStore *dataStore = UnifiedDataStore::getInstance();
+
+	HostsQueryOption hostsQueryOption(job->m_dataQueryContextPtr);
+	hostsQueryOption.setStatusSet({HOST_STAT_NORMAL});
+	HatoholError err = dataStore->getNumberOfHostsEachServer(
+	  statistics.numHostsMap, hostsQueryOption);
+	if (err != HTERR_OK)
+		return err;
+
+	TriggersQueryOption triggersQueryOption(job->m_dataQueryContextPtr);
+	triggersQueryOption.setExcludeFlags(EXCLUDE_INVALID_HOST|EXCLUDE_SELF_MONITORING);
+	dataStore->getTriggerStatistics(statistics.triggerStatisticsMap,
+	                                triggersQueryOption);
+	return HTERR_OK;
+}
+
 static HatoholError addOverviewEachServer(FaceRest::ResourceHandler *job,
 					  JSONBuilder &agent,
 					  MonitoringServerInfo &svInfo,
+					  OverviewStatistics &statistics,
 					  bool &serverIsGoodStatus)
 {
 	HatoholError err;
-	UnifiedDataStore *dataStore = UnifiedDataStore::getInstance();
 	agent.add("serverId", svInfo.id);
 	agent.add("serverHostName", svInfo.hostName);
 	agent.add("serverIpAddr", svInfo.ipAddress);
 	agent.add("serverNickname", svInfo.nickname);
 
-	// TODO: This implementeation is not effective.
-	//       We should add a function only to get the number of list.
-	ServerHostDefVect svHostDefs;
-	HostsQueryOption option(job->m_dataQueryContextPtr);
-	option.setTargetServerId(svInfo.id);
-	option.setStatusSet({HOST_STAT_NORMAL});
-	err = dataStore->getServerHostDefs(svHostDefs, option);
-	if (err != HTERR_OK)
-		return err;
-	agent.add("numberOfHosts", svHostDefs.size());
-
-	TriggerInfoList triggerInfoList;
-	TriggersQueryOption triggersQueryOption(job->m_dataQueryContextPtr);
-	triggersQueryOption.setTargetServerId(svInfo.id);
-	triggersQueryOption.setExcludeFlags(EXCLUDE_INVALID_HOST|EXCLUDE_SELF_MONITORING);
-	agent.add("numberOfTriggers",
-		  dataStore->getNumberOfTriggers(triggersQueryOption));
-	const size_t numBadHosts =
-	  dataStore->getNumberOfBadHosts(triggersQueryOption);
-	agent.add("numberOfBadHosts", numBadHosts);
-	serverIsGoodStatus = (numBadHosts == 0);
-	size_t numBadTriggers = dataStore->getNumberOfBadTriggers(
-				  triggersQueryOption, TRIGGER_SEVERITY_ALL);
+	agent.add("numberOfHosts", statistics.numHostsMap[svInfo.id]);
+
+	DBTablesMonitoring::ServerTriggerStatistics &serverStat =
+	  statistics.triggerStatisticsMap[svInfo.id];
+	const DBTablesMonitoring::HostgroupTriggerStatistics &allHostgroupsStat =
+	  serverStat.hostgroups[ALL_HOST_GROUPS];
+	agent.add("numberOfTriggers", serverStat.numTriggers);
+	agent.add("numberOfBadHosts", allHostgroupsStat.numBadHosts);
+	serverIsGoodStatus = (allHostgroupsStat.numBadHosts == 0);
+	size_t numBadTriggers = 0;
+	for (const auto &num : allHostgroupsStat.numBadTriggers)
+		numBadTriggers += num;
 	agent.add("numberOfBadTriggers", numBadTriggers);
 
 	// TODO: These elements should be fixed
@@ -176,19 +218,15 @@ static HatoholError addOverviewEachServer(FaceRest::ResourceHandler *job,
 	HostgroupVectConstIterator hostgrpItr = hostgroups.begin();
 	for (; hostgrpItr != hostgroups.end(); ++ hostgrpItr) {
 		const HostgroupIdType &hostgroupId = hostgrpItr->idInServer;
+		const DBTablesMonitoring::HostgroupTriggerStatistics &stat =
+		  serverStat.hostgroups[hostgroupId];
 		for (int severity = 0;
 		     severity < NUM_TRIGGER_SEVERITY; severity++) {
-			TriggersQueryOption option(job->m_dataQueryContextPtr);
-			option.setExcludeFlags(EXCLUDE_INVALID_HOST|EXCLUDE_SELF_MONITORING);
-			option.setTargetServerId(svInfo.id);
-			option.setTargetHostgroupId(hostgroupId);
 			agent.startObject();
 			agent.add("hostgroupId", hostgroupId);
 			agent.add("severity", severity);
-			agent.add(
-			  "numberOfTriggers",
-			  dataStore->getNumberOfBadTriggers
-			    (option, (TriggerSeverityType)severity));
+			agent.add("numberOfTriggers",
+			          stat.numBadTriggers[severity]);
 			agent.endObject();
 		}
 	}
@@ -199,16 +237,16 @@ static HatoholError addOverviewEachServer(FaceRest::ResourceHandler *job,
 	hostgrpItr = hostgroups.begin();
 	for (; hostgrpItr != hostgroups.end(); ++ hostgrpItr) {
 		const HostgroupIdType &hostgroupId = hostgrpItr->idInServer;
-		TriggersQueryOption option(job->m_dataQueryContextPtr);
-		option.setExcludeFlags(EXCLUDE_INVALID_HOST|EXCLUDE_SELF_MONITORING);
-		option.setTargetServerId(svInfo.id);
-		option.setTargetHostgroupId(hostgroupId);
-		size_t numBadHosts = dataStore->getNumberOfBadHosts(option);
+		const DBTablesMonitoring::HostgroupTriggerStatistics &stat =
+		  serverStat.hostgroups[hostgroupId];
+		HATOHOL_ASSERT(stat.numHosts >= stat.numBadHosts,
+		               "numHosts: %zd, numBadHosts: %zd",
+		               stat.numHosts, stat.numBadHosts);
 		agent.startObject();
 		agent.add("hostgroupId", hostgroupId);
 		agent.add("numberOfGoodHosts",
-		          dataStore->getNumberOfGoodHosts(option));
-		agent.add("numberOfBadHosts", numBadHosts);
+		          stat.numHosts - stat.numBadHosts);
+		agent.add("numberOfBadHosts", stat.numBadHosts);
 		agent.endObject();
 	}
 	agent.endArray();
@@ -222,6 +260,14 @@ static HatoholError addOverview(FaceRest::ResourceHandler *job, JSONBuilder &age
 	MonitoringServerInfoList monitoringServers;
 	ServerQueryOption option(job->m_dataQueryContextPtr);
 	dataStore->getTargetServers(monitoringServers, option);
+
+	// The statistics of all servers are obtained at once instead of
+	// issuing queries for each server, host group and severity.
+	OverviewStatistics statistics;
+	HatoholError err = getOverviewStatistics(job, statistics);
+	if (err != HTERR_OK)
+		return err;
+
 	MonitoringServerInfoListIterator it = monitoringServers.begin();
 	agent.add("numberOfServers", monitoringServers.size());
 	agent.startArray("serverStatus");
@@ -229,7 +275,8 @@ static HatoholError addOverview(FaceRest::ResourceHandler *job, JSONBuilder &age
 	for (; it != monitoringServers.end(); ++it) {
 		bool serverIsGoodStatus = false;
 		agent.startObject();
-		HatoholError err = addOverviewEachServer(job, agent, *it, serverIsGoodStatus);
+		err = addOverviewEachServer(job, agent, *it, statistics,
+		                            serverIsGoodStatus);
 		if (err != HTERR_OK)
 			return err;
 		agent.endObject();
@@ -346,6 +393,17 @@ void RestResourceMonitoring::handlerGetTrigger(void)
 	UnifiedDataStore *dataStore = UnifiedDataStore::getInstance();
 	RestResourceUtils::parseHostgroupNameParameter(option, m_query,
 						       m_dataQueryContextPtr);
+	// The total number doesn't depend on the page.
+	const TriggersQueryOption countOption(option);
+	// The triggers are always paged by (server ID, trigger ID). An absent
+	// or empty cursor means the first page.
+	const gchar *cursor = m_query ? static_cast<const gchar*>(
+	  g_hash_table_lookup(m_query, "cursor")) : NULL;
+	if (!option.setCursor(cursor ? cursor : "")) {
+		string message = StringUtils::sprintf("cursor: %s", cursor);
+		replyError(HatoholError(HTERR_INVALID_PARAMETER, message));
+		return;
+	}
 	dataStore->getTriggerList(triggerList, option);
 
 	JSONBuilder agent;
@@ -370,7 +428,10 @@ void RestResourceMonitoring::handlerGetTrigger(void)
 	agent.endArray();
 	agent.add("numberOfTriggers", triggerList.size());
 	agent.add("totalNumberOfTriggers",
-		  dataStore->getNumberOfTriggers(option));
+		  dataStore->getNumberOfTriggers(countOption));
+	// Pass it as "cursor" to get the next page.
+	if (!triggerList.empty())
+		agent.add("nextCursor", option.makeCursor(triggerList.back()));
 	addServersMap(agent, NULL, false);
 	agent.endObject();
 
@@ -413,6 +474,33 @@ static void addIncident(FaceRest::ResourceHandler *job, JSONBuilder &agent,
 	agent.endObject();
 }
 
+static void addEvents(FaceRest::ResourceHandler *job, JSONBuilder &agent,
+                      const EventInfoList &eventList,
+                      const IncidentInfoVect *incidentVect)
+{
+	agent.startArray("events");
+	EventInfoListConstIterator it = eventList.begin();
+	for (size_t i = 0; it != eventList.end(); ++i, ++it) {
+		const EventInfo &eventInfo = *it;
+		agent.startObject();
+		agent.add("unifiedId", eventInfo.unifiedId);
+		agent.add("serverId",  eventInfo.serverId);
+		agent.add("time",      eventInfo.time.tv_sec);
+		agent.add("type",      eventInfo.type);
+		agent.add("triggerId", eventInfo.triggerId);
+		agent.add("eventId",   eventInfo.id);
+		agent.add("status",    eventInfo.status);
+		agent.add("severity",  eventInfo.severity);
+		agent.add("hostId",    eventInfo.hostIdInServer);
+		agent.add("brief",     eventInfo.brief);
+		agent.add("extendedInfo", eventInfo.extendedInfo);
+		if (incidentVect)
+			addIncident(job, agent, (*incidentVect)[i]);
+		agent.endObject();
+	}
+	agent.endArray();
+}
+
 void RestResourceMonitoring::handlerGetEvent(void)
 {
 	UnifiedDataStore *dataStore = UnifiedDataStore::getInstance();
@@ -463,28 +551,12 @@ void RestResourceMonitoring::handlerGetEvent(void)
 		agent.addTrue("haveIncident");
 	else
 		agent.addFalse("haveIncident");
-	agent.startArray("events");
-	EventInfoListIterator it = eventList.begin();
-	for (size_t i = 0; it != eventList.end(); ++i, ++it) {
-		EventInfo &eventInfo = *it;
-		agent.startObject();
-		agent.add("unifiedId", eventInfo.unifiedId);
-		agent.add("serverId",  eventInfo.serverId);
-		agent.add("time",      eventInfo.time.tv_sec);
-		agent.add("type",      eventInfo.type);
-		agent.add("triggerId", eventInfo.triggerId);
-		agent.add("eventId",   eventInfo.id);
-		agent.add("status",    eventInfo.status);
-		agent.add("severity",  eventInfo.severity);
-		agent.add("hostId",    eventInfo.hostIdInServer);
-		agent.add("brief",     eventInfo.brief);
-		agent.add("extendedInfo", eventInfo.extendedInfo);
-		if (addIncidents)
-			addIncident(this, agent, incidentVect[i]);
-		agent.endObject();
-	}
-	agent.endArray();
+	addEvents(this, agent, eventList,
+	          addIncidents ? &incidentVect : NULL);
 	agent.add("numberOfEvents", eventList.size());
+	// Pass it as "cursor" to get the next page.
+	if (!eventList.empty())
+		agent.add("nextCursor", option.makeCursor(eventList.back()));
 	addServersMap(agent, NULL, false);
 	addIncidentTrackersMap(agent);
 	agent.endObject();
@@ -492,6 +564,166 @@ void RestResourceMonitoring::handlerGetEvent(void)
 	replyJSONData(agent);
 }
 
+struct EventChangesTimeout {
+	RestResourceMonitoring       *job;
+	EventChangeNotifier::WaiterId waiterId;
+};
+
+// The job is touched only when the waiter is removed here. Otherwise
+// EventChangeNotifier has already rehandled it and it may be freed.
+static gboolean eventChangesTimedOut(gpointer data)
+{
+	EventChangesTimeout *timeout = static_cast<EventChangesTimeout *>(data);
+	if (EventChangeNotifier::removeWaiter(timeout->waiterId)) {
+		timeout->job->m_eventChangesTimedOut = true;
+		timeout->job->rehandle();
+	}
+	return FALSE;
+}
+
+static void destroyEventChangesTimeout(gpointer data)
+{
+	EventChangesTimeout *timeout = static_cast<EventChangesTimeout *>(data);
+	// The main context was destroyed before the time-out.
+	if (EventChangeNotifier::removeWaiter(timeout->waiterId))
+		timeout->job->unref();
+	delete timeout;
+}
+
+bool RestResourceMonitoring::waitEventChanges(const uint64_t &generation)
+{
+	SmartTime remaining(m_eventChangesDeadline);
+	const SmartTime now(SmartTime::INIT_CURR_TIME);
+	if (now >= remaining)
+		return false;
+	remaining -= now;
+	const guint timeoutMSec = static_cast<guint>(remaining.getAsMSec()) + 1;
+
+	// The reference is released after the job is rehandled by either
+	// EventChangeNotifier or the time-out. The waiter is registered
+	// after this worker finishes the job. Otherwise the job could be
+	// handled by two workers at the same time.
+	ref();
+	RestResourceMonitoring *job = this;
+	setHandOffFunc([job, generation, timeoutMSec] {
+		job->addEventChangesWaiter(generation, timeoutMSec);
+	});
+	return true;
+}
+
+void RestResourceMonitoring::addEventChangesWaiter(const uint64_t &generation,
+                                                   const guint &timeoutMSec)
+{
+	// The job can be rehandled by another worker as soon as the waiter
+	// is added. So its members are read in advance.
+	GMainContext *context = getGMainContext();
+	EventChangesTimeout *timeout = new EventChangesTimeout();
+	timeout->job = this;
+	RestResourceMonitoring *job = this;
+	if (!EventChangeNotifier::addWaiter(generation,
+	                                    [job] { job->rehandle(); },
+	                                    timeout->waiterId)) {
+		// Events have been added after they were looked up.
+		delete timeout;
+		rehandle();
+		return;
+	}
+
+	GSource *source = g_timeout_source_new(timeoutMSec);
+	g_source_set_callback(source, eventChangesTimedOut, timeout,
+	                      destroyEventChangesTimeout);
+	g_source_attach(source, context);
+	g_source_unref(source);
+}
+
+void RestResourceMonitoring::handlerGetEventChanges(void)
+{
+	EventsQueryOption option(m_dataQueryContextPtr);
+	bool isCountOnly = false;
+	HatoholError err =
+	  RestResourceUtils::parseEventParameter(option, m_query, isCountOnly);
+	if (err != HTERR_OK) {
+		replyError(err);
+		return;
+	}
+	RestResourceUtils::parseHostgroupNameParameter(option, m_query,
+						       m_dataQueryContextPtr);
+
+	UnifiedEventIdType lastUnifiedId = 0;
+	err = getParam<UnifiedEventIdType>(m_query, "lastUnifiedEventId",
+	                                   "%" FMT_UNIFIED_EVENT_ID,
+	                                   lastUnifiedId);
+	if (err != HTERR_OK) {
+		replyError(err);
+		return;
+	}
+
+	time_t timeoutSec = DEFAULT_EVENT_CHANGES_TIMEOUT_SEC;
+	err = getParam<time_t>(m_query, "timeout", "%ld", timeoutSec);
+	if (err != HTERR_OK && err != HTERR_NOT_FOUND_PARAMETER) {
+		replyError(err);
+		return;
+	}
+	if (timeoutSec < 0 || timeoutSec > MAX_EVENT_CHANGES_TIMEOUT_SEC) {
+		REPLY_ERROR(this, HTERR_INVALID_PARAMETER,
+		            "timeout: %ld", timeoutSec);
+		return;
+	}
+
+	// This handler is called again when events are added or the
+	// timeout expires. The deadline is fixed at the first call.
+	if (!m_eventChangesDeadline.hasValidTime()) {
+		const timespec timeout = {timeoutSec, 0};
+		m_eventChangesDeadline.setCurrTime();
+		m_eventChangesDeadline += timeout;
+	}
+
+	option.setSortType(EventsQueryOption::SORT_UNIFIED_ID,
+	                   DataQueryOption::SORT_ASCENDING);
+	option.setSeekPosition(lastUnifiedId);
+
+	// The generation has to be got before the look-up so as not to miss
+	// events added during it.
+	const uint64_t generation = EventChangeNotifier::getGeneration();
+	UnifiedDataStore *dataStore = UnifiedDataStore::getInstance();
+	EventInfoList eventList;
+	bool addIncidents = dataStore->isIncidentSenderActionEnabled();
+	IncidentInfoVect incidentVect;
+	err = dataStore->getEventList(eventList, option,
+	                              addIncidents ? &incidentVect : NULL);
+	if (err != HTERR_OK) {
+		replyError(err);
+		return;
+	}
+
+	// Added events may not match the conditions. In that case, the job
+	// waits again until the deadline.
+	if (eventList.empty() && !m_eventChangesTimedOut &&
+	    waitEventChanges(generation))
+		return;
+
+	JSONBuilder agent;
+	agent.startObject();
+	addHatoholError(agent, HatoholError(HTERR_OK));
+	agent.add("lastUnifiedEventId",
+	          eventList.empty() ? lastUnifiedId :
+	                              eventList.back().unifiedId);
+	if (addIncidents)
+		agent.addTrue("haveIncident");
+	else
+		agent.addFalse("haveIncident");
+	addEvents(this, agent, eventList,
+	          addIncidents ? &incidentVect : NULL);
+	agent.add("numberOfEvents", eventList.size());
+	if (!eventList.empty()) {
+		addServersMap(agent, NULL, false);
+		addIncidentTrackersMap(agent);
+	}
+	agent.endObject();
+
+	replyJSONData(agent);
+}
+
 // TODO: Add a macro or template to simplify the definition
 struct GetItemClosure : ClosureTemplate0<RestResourceMonitoring>
 {
@@ -519,6 +751,13 @@ void RestResourceMonitoring::replyGetItem(void)
 		replyError(err);
 		return;
 	}
+	// The total number doesn't depend on the page.
+	const ItemsQueryOption countOption(option);
+	err = parseItemCursorParameter(option, m_query);
+	if (err != HTERR_OK) {
+		replyError(err);
+		return;
+	}
 
 	ItemInfoList itemList;
 	UnifiedDataStore *dataStore = UnifiedDataStore::getInstance();
@@ -560,7 +799,16 @@ void RestResourceMonitoring::replyGetItem(void)
 	}
 	agent.endArray();
 	agent.add("numberOfItems", itemList.size());
-	agent.add("totalNumberOfItems", dataStore->getNumberOfItems(option));
+	agent.add("totalNumberOfItems",
+	          dataStore->getNumberOfItems(countOption));
+	// Pass it as "cursor" to get the next page.
+	if (!itemList.empty()) {
+		GenericIdType lastGlobalId = 0;
+		for (const auto &itemInfo : itemList)
+			lastGlobalId = max(lastGlobalId, itemInfo.globalId);
+		agent.add("nextCursor",
+		          StringUtils::sprintf("%" FMT_GEN_ID, lastGlobalId));
+	}
 	addServersMap(agent, NULL, false);
 	agent.endObject();
 
@@ -713,8 +961,8 @@ void RestResourceMonitoring::handlerGetHistory(void)
 	    this, &RestResourceMonitoring::historyFetchedCallback,
 	    unifiedDataStore->getDataStore(serverId));
 	if (closure->m_dataStore) {
-		closure->m_dataStore->startOnDemandFetchHistory(
-		  itemInfo, beginTime, endTime, closure);
+		unifiedDataStore->fetchHistoryAsync(
+		  closure, closure->m_dataStore, itemInfo, beginTime, endTime);
 	} else {
 		HistoryInfoVect historyInfoVect;
 		(*closure)(historyInfoVect);
@@ -19,6 +19,7 @@
 
 #pragma once
 #include "FaceRestPrivate.h"
+#include "EventChangeNotifier.h"
 
 struct RestResourceMonitoring : public RestResourceMemberHandler
 {
@@ -33,6 +34,10 @@ struct RestResourceMonitoring : public RestResourceMemberHandler
 	void handlerGetHost(void);
 	void handlerGetTrigger(void);
 	void handlerGetEvent(void);
+	void handlerGetEventChanges(void);
+	bool waitEventChanges(const uint64_t &generation);
+	void addEventChangesWaiter(const uint64_t &generation,
+	                           const guint &timeoutMSec);
 	void handlerGetHostgroup(void);
 	void handlerGetItem(void);
 	void replyGetItem(void);
@@ -53,9 +58,17 @@ struct RestResourceMonitoring : public RestResourceMemberHandler
 	static const char *pathForHost;
 	static const char *pathForTrigger;
 	static const char *pathForEvent;
+	static const char *pathForEventChanges;
 	static const char *pathForItem;
 	static const char *pathForHistory;
 	static const char *pathForHostgroup;
 	static const char *pathForTriggerBriefs;
+
+	static const time_t DEFAULT_EVENT_CHANGES_TIMEOUT_SEC;
+	static const time_t MAX_EVENT_CHANGES_TIMEOUT_SEC;
+
+	// for handlerGetEventChanges()
+	mlpl::SmartTime m_eventChangesDeadline;
+	bool            m_eventChangesTimedOut;
 };
 
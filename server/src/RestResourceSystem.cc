@@ -19,6 +19,8 @@
 
 #include "RestResourceSystem.h"
 #include "UnifiedDataStore.h"
+#include "EventCoalescer.h"
+#include "RecentEventFilter.h"
 
 typedef FaceRestResourceHandlerSimpleFactoryTemplate<RestResourceSystem>
   RestResourceSystemFactory;
@@ -80,6 +82,53 @@ void RestResourceSystem::handlerSystemInfo(void)
 	}
 	reply.endArray(); // eventRates
 
+	FaceRest::WorkerStatistics workerStat;
+	m_faceRest->getWorkerStatistics(workerStat);
+	reply.startObject("faceRestWorkers");
+	reply.add("numWorkers", workerStat.numWorkers);
+	reply.add("numIdleWorkers", workerStat.numIdleWorkers);
+	reply.add("queueDepth", workerStat.queueDepth);
+	reply.add("numProcessedJobs", workerStat.numProcessedJobs);
+	reply.add("numOverflowedJobs", workerStat.numOverflowedJobs);
+	reply.add("totalWaitTimeUSec", workerStat.totalWaitTimeUSec);
+	reply.add("maxWaitTimeUSec", workerStat.maxWaitTimeUSec);
+	reply.endObject(); // faceRestWorkers
+
+	ActionEvaluator::Statistics evaluatorStat;
+	UnifiedDataStore::getInstance()->getActionEvaluatorStatistics(
+	  evaluatorStat);
+	reply.startObject("actionEvaluator");
+	reply.add("numWorkers", evaluatorStat.numWorkers);
+	reply.add("queueDepth", evaluatorStat.queueDepth);
+	reply.add("numQueuedEvents", evaluatorStat.numQueuedEvents);
+	reply.add("numEvaluatedEvents", evaluatorStat.numEvaluatedEvents);
+	reply.add("numQueueFullWaits", evaluatorStat.numQueueFullWaits);
+	reply.endObject(); // actionEvaluator
+
+	EventCoalescer::Statistics batchStat;
+	EventCoalescer::getGlobalStatistics(batchStat);
+	reply.startObject("jsonGateEventBatches");
+	reply.add("numFlushes", batchStat.numFlushes);
+	reply.add("numEvents", batchStat.numEvents);
+	reply.add("maxBatchSize", batchStat.maxBatchSize);
+	reply.add("totalFlushLatencyUSec", batchStat.totalFlushLatencyUSec);
+	reply.add("maxFlushLatencyUSec", batchStat.maxFlushLatencyUSec);
+	reply.endObject(); // jsonGateEventBatches
+
+	RecentEventFilter::Statistics filterStat;
+	RecentEventFilter::getGlobalStatistics(filterStat);
+	reply.startObject("recentEventFilter");
+	reply.add("numPassedEvents", filterStat.numPassedEvents);
+	reply.add("numDroppedEvents", filterStat.numDroppedEvents);
+	reply.endObject(); // recentEventFilter
+
+	DBTablesMonitoring::TriggerMergeStatistics mergeStat;
+	DBTablesMonitoring::getTriggerMergeStatistics(mergeStat);
+	reply.startObject("eventTriggerMerge");
+	reply.add("numHits", mergeStat.numHits);
+	reply.add("numMisses", mergeStat.numMisses);
+	reply.endObject(); // eventTriggerMerge
+
 	addHatoholError(reply, HatoholError(HTERR_OK));
 	reply.endObject();
 	replyJSONData(reply);
@@ -359,6 +359,14 @@ HatoholError RestResourceUtils::parseEventParameter(
 
 	option.setSortType(sortType, sortDirection);
 
+	// cursor for keyset pagination
+	const char *cursor =
+	  static_cast<const char *>(g_hash_table_lookup(query, "cursor"));
+	if (cursor && *cursor && !option.setCursor(cursor)) {
+		string message = StringUtils::sprintf("cursor: %s", cursor);
+		return HatoholError(HTERR_INVALID_PARAMETER, message);
+	}
+
 	// limit of unifiedId
 	uint64_t limitOfUnifiedId = 0;
 	err = getParam<uint64_t>(query, "limitOfUnifiedId", "%" PRIu64,
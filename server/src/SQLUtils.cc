@@ -71,21 +71,7 @@ ItemDataPtr SQLUtils::createFromString(const char *str, SQLColumnType type)
 			break;
 		}
 
-		struct tm tm;
-		memset(&tm, 0, sizeof(tm));
-		int numVal = sscanf(str,
-		                    "%04d-%02d-%02d %02d:%02d:%02d",
-		                    &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
-		                    &tm.tm_hour, &tm.tm_min, &tm.tm_sec);
-		static const int EXPECT_NUM_VAL = 6;
-		if (numVal != EXPECT_NUM_VAL) {
-			MLPL_WARN(
-			  "Probably, parse of the time failed: %d, %s\n",
-			  numVal, str);
-		}
-		tm.tm_year -= 1900;
-		tm.tm_mon--; // tm_mon is counted from 0 in POSIX time APIs.
-		time_t time = mktime(&tm);
+		const time_t time = parseDatetime(str);
 		itemData = new ItemInt((int)time);
 		break;
 	}
@@ -95,3 +81,22 @@ ItemDataPtr SQLUtils::createFromString(const char *str, SQLColumnType type)
 	}
 	return ItemDataPtr(itemData, false);
 }
+
+time_t SQLUtils::parseDatetime(const char *str)
+{
+	struct tm tm;
+	memset(&tm, 0, sizeof(tm));
+	int numVal = sscanf(str,
+	                    "%04d-%02d-%02d %02d:%02d:%02d",
+	                    &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+	                    &tm.tm_hour, &tm.tm_min, &tm.tm_sec);
+	static const int EXPECT_NUM_VAL = 6;
+	if (numVal != EXPECT_NUM_VAL) {
+		MLPL_WARN(
+		  "Probably, parse of the time failed: %d, %s\n",
+		  numVal, str);
+	}
+	tm.tm_year -= 1900;
+	tm.tm_mon--; // tm_mon is counted from 0 in POSIX time APIs.
+	return mktime(&tm);
+}
@@ -18,6 +18,7 @@
  */
 
 #pragma once
+#include <ctime>
 #include "ItemDataPtr.h"
 #include "SQLProcessorTypes.h"
 
@@ -25,5 +26,14 @@ class SQLUtils {
 public:
 	static ItemDataPtr createFromString(const char *str,
 	                                    SQLColumnType type);
+
+	/**
+	 * Parse a DATETIME string such as '2014-02-03 12:34:56'.
+	 *
+	 * @param str A string in the local time.
+	 *
+	 * @return A time_t value.
+	 */
+	static time_t parseDatetime(const char *str);
 };
 
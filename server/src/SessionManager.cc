@@ -18,26 +18,45 @@
  */
 
 #include <cstdio>
+#include <cerrno>
+#include <ctime>
 #include <map>
+#include <mutex>
+#include <functional>
 #include <uuid/uuid.h>
 #include "Logger.h"
 #include "SessionManager.h"
 #include <Mutex.h>
 #include "ReadWriteLock.h"
 #include "HatoholException.h"
-#include "Reaper.h"
 using namespace std;
 using namespace mlpl;
 
+static const int64_t NSEC_PER_SEC = 1000 * 1000 * 1000;
+
+static int64_t getCurrTimeNSec(void)
+{
+	timespec ts;
+	if (clock_gettime(CLOCK_REALTIME, &ts) == -1) {
+		MLPL_ERR("Failed to call clock_gettime: errno: %d\n", errno);
+		return 0;
+	}
+	return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
 // ---------------------------------------------------------------------------
 // Session
 // ---------------------------------------------------------------------------
 Session::Session(void)
 : userId(INVALID_USER_ID),
   loginTime(SmartTime::INIT_CURR_TIME),
-  lastAccessTime(SmartTime::INIT_CURR_TIME),
-  timerId(INVALID_EVENT_ID),
-  sessionMgr(NULL)
+  timeout(0),
+  sessionMgr(NULL),
+  expiryTick(0),
+  wheelLevel(0),
+  wheelSlot(0),
+  m_lastAccessTimeNSec(getCurrTimeNSec()),
+  m_timerScheduled(false)
 {
 }
 
@@ -45,15 +64,30 @@ Session::~Session()
 {
 }
 
+SmartTime Session::getLastAccessTime(void) const
+{
+	const int64_t nsec = m_lastAccessTimeNSec;
+	timespec ts;
+	ts.tv_sec = nsec / NSEC_PER_SEC;
+	ts.tv_nsec = nsec % NSEC_PER_SEC;
+	return SmartTime(ts);
+}
+
+void Session::updateLastAccessTime(void)
+{
+	m_lastAccessTimeNSec.store(getCurrTimeNSec(),
+	                           std::memory_order_relaxed);
+}
+
+bool Session::isTimerScheduled(void) const
+{
+	return m_timerScheduled;
+}
+
 void Session::cancelTimer(void)
 {
-	if (timerId != INVALID_EVENT_ID) {
-		Utils::removeGSourceIfNeeded(timerId);
-		timerId = INVALID_EVENT_ID;
-		const int usedCount = getUsedCount();
-		HATOHOL_ASSERT(usedCount >= 2, "Used count: %d\n", usedCount);
-		unref();
-	}
+	if (sessionMgr)
+		sessionMgr->cancelTimer(this);
 }
 
 // ---------------------------------------------------------------------------
@@ -68,40 +102,249 @@ const size_t SessionManager::DEFAULT_TIMEOUT = -1;
 const size_t SessionManager::NO_TIMEOUT = 0;
 const char * SessionManager::ENV_NAME_TIMEOUT = "HATOHOL_SESSION_TIMEOUT";
 
+static const size_t NUM_SHARDS = 16;
+
+// The expiry wheel is a hierarchical timing wheel driven by a single GLib
+// timer. With a tick of 1 sec, the levels cover 64 sec, about 68 min,
+// about 73 hours, and about 194 days, respectively. A longer timeout is
+// clamped and the session is put back when the slot is reached.
+static const guint    TICK_MSEC = 1000;
+static const int64_t  TICK_NSEC = TICK_MSEC * 1000 * 1000;
+static const size_t   WHEEL_BITS = 6;
+static const size_t   WHEEL_SLOTS = 1 << WHEEL_BITS;
+static const uint64_t WHEEL_MASK = WHEEL_SLOTS - 1;
+static const size_t   WHEEL_LEVELS = 4;
+static const uint64_t MAX_WHEEL_TICKS =
+  (static_cast<uint64_t>(1) << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+
 struct SessionManager::Impl {
 	static Mutex           initLock;
 	static SessionManager *instance;
 	static size_t defaultTimeout;
 
-	ReadWriteLock rwlock;
-	SessionIdMap  sessionIdMap;
+	struct Shard {
+		ReadWriteLock rwlock;
+		SessionIdMap  sessionIdMap;
+	};
+	Shard shards[NUM_SHARDS];
+
+	mutex        snapshotLock;
+	SessionIdMap sessionIdMapSnapshot;
+
+	// The following members are protected by wheelLock.
+	typedef list<Session *> WheelSlot;
+	mutex     wheelLock;
+	WheelSlot wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+	uint64_t  currTick;
+	size_t    numScheduled;
+	gint64    baseTime;
+	guint     tickId;
+	bool      stopping;
+
+	Impl(void)
+	: currTick(0),
+	  numScheduled(0),
+	  baseTime(g_get_monotonic_time()),
+	  tickId(INVALID_EVENT_ID),
+	  stopping(false)
+	{
+	}
 
 	virtual ~Impl()
 	{
 		clearAllSessions();
+
+		wheelLock.lock();
+		stopping = true;
+		const guint id = tickId;
+		tickId = INVALID_EVENT_ID;
+		wheelLock.unlock();
+		Utils::removeEventSourceIfNeeded(id);
+	}
+
+	Shard &getShard(const string &sessionId)
+	{
+		return shards[hash<string>()(sessionId) % NUM_SHARDS];
 	}
 
 	void clearAllSessions(void)
 	{
-		rwlock.writeLock();
-		while (!sessionIdMap.empty()) {
-			SessionIdMapIterator it = sessionIdMap.begin();
-			Session *session = it->second;
-			rwlock.unlock();
-			Utils::executeOnGLibEventLoop<Session>(
-			  deleteSession, session);
-			rwlock.writeLock();
-			sessionIdMap.erase(it);
+		for (size_t i = 0; i < NUM_SHARDS; i++) {
+			SessionIdMap sessionIdMap;
+			shards[i].rwlock.writeLock();
+			sessionIdMap.swap(shards[i].sessionIdMap);
+			shards[i].rwlock.unlock();
+
+			for (auto &pair : sessionIdMap) {
+				Session *session = pair.second;
+				session->cancelTimer();
+				session->unref();
+			}
+		}
+	}
+
+	/**
+	 * Remove the session from the shard only if it is still registered.
+	 * The reference held by the shard is also released.
+	 */
+	bool removeFromShard(Session *session)
+	{
+		Shard &shard = getShard(session->id);
+		bool found = false;
+		shard.rwlock.writeLock();
+		SessionIdMapIterator it = shard.sessionIdMap.find(session->id);
+		if (it != shard.sessionIdMap.end() && it->second == session) {
+			shard.sessionIdMap.erase(it);
+			found = true;
+		}
+		shard.rwlock.unlock();
+		if (found)
+			session->unref();
+		return found;
+	}
+
+	uint64_t getElapsedTicks(void)
+	{
+		const gint64 elapsed = g_get_monotonic_time() - baseTime;
+		return elapsed / (TICK_MSEC * 1000);
+	}
+
+	static uint64_t calcTicks(const int64_t &nsec)
+	{
+		return (nsec + TICK_NSEC - 1) / TICK_NSEC;
+	}
+
+	// This method must be called with wheelLock taken.
+	void addToWheel(Session *session, uint64_t expiryTick)
+	{
+		uint64_t delta = 0;
+		if (expiryTick > currTick)
+			delta = expiryTick - currTick;
+		if (delta > MAX_WHEEL_TICKS) {
+			delta = MAX_WHEEL_TICKS;
+			expiryTick = currTick + delta;
+		}
+		session->expiryTick = expiryTick;
+
+		size_t level = 0;
+		while (level < WHEEL_LEVELS - 1 &&
+		       delta >= (static_cast<uint64_t>(1) <<
+		                 (WHEEL_BITS * (level + 1)))) {
+			level++;
+		}
+		const uint64_t tick = delta ? expiryTick : currTick;
+		const size_t slot = (tick >> (WHEEL_BITS * level)) & WHEEL_MASK;
+		WheelSlot &wheelSlot = wheel[level][slot];
+		session->wheelLevel = level;
+		session->wheelSlot = slot;
+		session->wheelPosition =
+		  wheelSlot.insert(wheelSlot.end(), session);
+	}
+
+	// This method must be called with wheelLock taken.
+	void removeFromWheel(Session *session)
+	{
+		WheelSlot &wheelSlot =
+		  wheel[session->wheelLevel][session->wheelSlot];
+		wheelSlot.erase(session->wheelPosition);
+	}
+
+	void schedule(Session *session)
+	{
+		session->ref();
+		lock_guard<mutex> lock(wheelLock);
+		if (numScheduled == 0) {
+			// All slots are empty. So we can skip the idle ticks.
+			currTick = getElapsedTicks();
 		}
-		rwlock.unlock();
+		const int64_t timeoutNSec = session->timeout * NSEC_PER_SEC;
+		addToWheel(session, currTick + calcTicks(timeoutNSec));
+		session->m_timerScheduled = true;
+		numScheduled++;
+		if (tickId == INVALID_EVENT_ID && !stopping)
+			tickId = g_timeout_add(TICK_MSEC, tickCb, this);
 	}
 
-	static void deleteSession(Session *session)
+	void cancel(Session *session)
 	{
-		// This method is called on the GLib's event loop.
-		// So we can call cancelTimer w/o lock.
-		session->cancelTimer();
-		session->unref();
+		wheelLock.lock();
+		const bool scheduled = session->m_timerScheduled;
+		if (scheduled) {
+			removeFromWheel(session);
+			session->m_timerScheduled = false;
+			numScheduled--;
+		}
+		wheelLock.unlock();
+		if (scheduled)
+			session->unref();
+	}
+
+	// This method must be called with wheelLock taken.
+	void cascade(const size_t &level, const size_t &slot)
+	{
+		WheelSlot sessions;
+		sessions.swap(wheel[level][slot]);
+		for (auto session : sessions)
+			addToWheel(session, session->expiryTick);
+	}
+
+	// This method must be called with wheelLock taken.
+	void advanceOneTick(WheelSlot &dueSessions)
+	{
+		const size_t index = currTick & WHEEL_MASK;
+		if (index == 0) {
+			for (size_t level = 1; level < WHEEL_LEVELS; level++) {
+				const size_t slot =
+				  (currTick >> (WHEEL_BITS * level)) &
+				  WHEEL_MASK;
+				cascade(level, slot);
+				if (slot)
+					break;
+			}
+		}
+		dueSessions.splice(dueSessions.end(), wheel[0][index]);
+		currTick++;
+	}
+
+	gboolean expireSessions(void)
+	{
+		WheelSlot expiredSessions;
+		wheelLock.lock();
+		WheelSlot dueSessions;
+		const uint64_t targetTick = getElapsedTicks();
+		while (numScheduled > 0 && currTick <= targetTick)
+			advanceOneTick(dueSessions);
+
+		// The last access time is updated without the lock of the
+		// wheel. So it is checked here and the session that has been
+		// accessed is put back to the wheel.
+		const int64_t now = getCurrTimeNSec();
+		for (auto session : dueSessions) {
+			const int64_t expiry =
+			  session->m_lastAccessTimeNSec +
+			  session->timeout * NSEC_PER_SEC;
+			if (expiry > now) {
+				addToWheel(session,
+				           currTick + calcTicks(expiry - now));
+				continue;
+			}
+			session->m_timerScheduled = false;
+			numScheduled--;
+			expiredSessions.push_back(session);
+		}
+
+		gboolean ret = G_SOURCE_CONTINUE;
+		if (numScheduled == 0 && !stopping) {
+			tickId = INVALID_EVENT_ID;
+			ret = G_SOURCE_REMOVE;
+		}
+		wheelLock.unlock();
+
+		for (auto session : expiredSessions) {
+			removeFromShard(session);
+			session->unref();
+		}
+		return ret;
 	}
 };
 
@@ -153,27 +396,38 @@ string SessionManager::create(const UserIdType &userId, const size_t &timeout)
 		session->timeout =  m_impl->defaultTimeout;
 	else
 		session->timeout = timeout;
-	updateTimer(session);
+
+	// The reference count of the new instance is taken by the shard.
+	Impl::Shard &shard = m_impl->getShard(session->id);
+	shard.rwlock.writeLock();
+	shard.sessionIdMap[session->id] = session;
+	shard.rwlock.unlock();
+
+	if (session->timeout)
+		m_impl->schedule(session);
 	return session->id;
 }
 
 SessionPtr SessionManager::getSession(const string &sessionId)
 {
 	Session *session = NULL;
-	m_impl->rwlock.readLock();
-	SessionIdMapIterator it = m_impl->sessionIdMap.find(sessionId);
-	if (it != m_impl->sessionIdMap.end())
+	Impl::Shard &shard = m_impl->getShard(sessionId);
+	shard.rwlock.readLock();
+	SessionIdMapIterator it = shard.sessionIdMap.find(sessionId);
+	if (it != shard.sessionIdMap.end())
 		session = it->second;
 
 	// Making sessionPtr inside the lock is important. It icrements the
-	// used counter. Even if timerCb() is called back on an other thread
+	// used counter. Even if the session is expired on an other thread
 	// soon after the following rwlock.unlock(), the instance itself
 	// is not deleted.
 	SessionPtr sessionPtr(session);
-	m_impl->rwlock.unlock();
+	shard.rwlock.unlock();
 
+	// The expiry wheel checks the last access time when the slot of
+	// the session is reached. So we don't need to touch the wheel here.
 	if (session)
-		updateTimer(session);
+		session->updateLastAccessTime();
 
 	return sessionPtr;
 }
@@ -181,13 +435,14 @@ SessionPtr SessionManager::getSession(const string &sessionId)
 bool SessionManager::remove(const string &sessionId)
 {
 	Session *session = NULL;
-	m_impl->rwlock.writeLock();
-	SessionIdMapIterator it = m_impl->sessionIdMap.find(sessionId);
-	if (it != m_impl->sessionIdMap.end()) {
+	Impl::Shard &shard = m_impl->getShard(sessionId);
+	shard.rwlock.writeLock();
+	SessionIdMapIterator it = shard.sessionIdMap.find(sessionId);
+	if (it != shard.sessionIdMap.end()) {
 		session = it->second;
-		m_impl->sessionIdMap.erase(it);
+		shard.sessionIdMap.erase(it);
 	}
-	m_impl->rwlock.unlock();
+	shard.rwlock.unlock();
 	if (!session)
 		return false;
 	session->cancelTimer();
@@ -197,13 +452,22 @@ bool SessionManager::remove(const string &sessionId)
 
 const SessionIdMap &SessionManager::getSessionIdMap(void)
 {
-	m_impl->rwlock.readLock();
-	return m_impl->sessionIdMap;
+	m_impl->snapshotLock.lock();
+	for (size_t i = 0; i < NUM_SHARDS; i++) {
+		Impl::Shard &shard = m_impl->shards[i];
+		shard.rwlock.readLock();
+		m_impl->sessionIdMapSnapshot.insert(
+		  shard.sessionIdMap.begin(), shard.sessionIdMap.end());
+	}
+	return m_impl->sessionIdMapSnapshot;
 }
 
 void SessionManager::releaseSessionIdMap(void)
 {
-	m_impl->rwlock.unlock();
+	m_impl->sessionIdMapSnapshot.clear();
+	for (size_t i = 0; i < NUM_SHARDS; i++)
+		m_impl->shards[i].rwlock.unlock();
+	m_impl->snapshotLock.unlock();
 }
 
 const size_t SessionManager::getDefaultTimeout(void)
@@ -234,48 +498,13 @@ string SessionManager::generateSessionId(void)
 	return sessionId;
 }
 
-void SessionManager::updateTimer(Session *session)
+gboolean SessionManager::tickCb(gpointer data)
 {
-	session->lock.lock();
-	Impl *impl = session->sessionMgr->m_impl.get();
-	session->cancelTimer();
-
-	if (session->timeout) {
-		session->timerId = g_timeout_add(session->timeout * 1000,
-		                                 timerCb, session);
-		session->ref();
-	}
-	session->lastAccessTime.setCurrTime();
-	session->lock.unlock();
-
-	// If timerCb() is called just before here on on an another thread,
-	// the session registered above is removed from sessionIdMap.
-	// So we have to insert session into sessionIdMap every time.
-	impl->rwlock.writeLock();
-	impl->sessionIdMap[session->id] = session;
-	impl->rwlock.unlock();
-};
+	Impl *impl = static_cast<Impl *>(data);
+	return impl->expireSessions();
+}
 
-gboolean SessionManager::timerCb(gpointer data)
+void SessionManager::cancelTimer(Session *session)
 {
-	Session *session = static_cast<Session *>(data);
-	Reaper<UsedCountable> sessionUnref(session, UsedCountable::unref);
-	session->lock.lock();
-	session->timerId = INVALID_EVENT_ID;
-	SessionManager *sessionMgr = session->sessionMgr;
-	if (!sessionMgr) {
-		MLPL_BUG("Session Manager: NULL, %s\n", session->id.c_str());
-		session->lock.unlock();
-		return G_SOURCE_REMOVE;
-	}
-
-	// Make a copy, because session may be deleted in the follwoing
-	// remove(). However, it is used only when the remove() fails, 
-	// which is a rare event. So this is a kind of wasted way.
-	string sessionId = session->id;
-	session->lock.unlock();
-
-	if (!sessionMgr->remove(session->id))
-		MLPL_BUG("Failed to remove session: %s\n", sessionId.c_str());
-	return G_SOURCE_REMOVE;
+	m_impl->cancel(session);
 }
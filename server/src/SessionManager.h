@@ -21,34 +21,65 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <list>
+#include <atomic>
 #include "Params.h"
 #include "SmartTime.h"
 #include "UsedCountablePtr.h"
 #include "UsedCountable.h"
-#include "Mutex.h"
 
 class SessionManager;
 struct Session : public UsedCountable {
 	UserIdType userId;
 	std::string id;
 	mlpl::SmartTime loginTime;
-	mlpl::SmartTime lastAccessTime;
 	size_t timeout;
-	guint timerId;
-	mlpl::Mutex lock;
 	SessionManager *sessionMgr;
 
+	// Bookkeeping of the expiry wheel in SessionManager. They are
+	// accessed only with the lock of the wheel taken.
+	uint64_t expiryTick;
+	size_t   wheelLevel;
+	size_t   wheelSlot;
+	std::list<Session *>::iterator wheelPosition;
+
 	// constructor
 	Session(void);
 
 	/**
-	 * Cancel the timer. This method is suppose to be called with
-	 * lock taken.
+	 * Get the last time when the session was obtained by
+	 * SessionManager::getSession().
+	 *
+	 * @return The last access time.
+	 */
+	mlpl::SmartTime getLastAccessTime(void) const;
+
+	/**
+	 * Set the current time as the last access time. This method doesn't
+	 * take any lock.
+	 */
+	void updateLastAccessTime(void);
+
+	/**
+	 * Check if the session is scheduled to be expired.
+	 *
+	 * @return true if the timer is scheduled. Otherwise false.
+	 */
+	bool isTimerScheduled(void) const;
+
+	/**
+	 * Cancel the timer. After this method is called, the session is
+	 * never timed out.
 	 */
 	void cancelTimer(void);
 
 protected:
 	virtual ~Session(); // makes delete impossible. Use unref().
+
+private:
+	friend class SessionManager;
+	std::atomic<int64_t> m_lastAccessTimeNSec;
+	std::atomic<bool>    m_timerScheduled;
 };
 
 // Key: session ID, value: user ID
@@ -107,6 +138,8 @@ public:
 	/**
 	 * Get a reference of the seesion ID map.
 	 *
+	 * The sessions are stored in several shards. The returned map is
+	 * a snapshot merged from all of them.
 	 * After the returned map is used, the caller must call
 	 * releaseSessionIdMap(). Until it is called, some operations
 	 * of this class are blocked.
@@ -123,10 +156,11 @@ protected:
 	virtual ~SessionManager();
 
 	static std::string generateSessionId(void);
-	static void updateTimer(Session *session);
-	static gboolean timerCb(gpointer data);
+	static gboolean tickCb(gpointer data);
+	void cancelTimer(Session *session);
 
 private:
+	friend struct Session;
 	struct Impl;
 	std::unique_ptr<Impl> m_impl;
 };
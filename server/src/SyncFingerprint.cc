@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <inttypes.h>
+#include <StringUtils.h>
+#include "ElementHasher.h"
+#include "SyncFingerprint.h"
+
+using namespace std;
+using namespace mlpl;
+
+// The hashes of elements are summed up. This mixes the bits so that
+// the sum of similar elements doesn't cancel out.
+static uint64_t mix(uint64_t x)
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+enum {
+	ELEMENT_HOST,
+	ELEMENT_HOSTGROUP,
+	ELEMENT_HOSTGROUP_MEMBER,
+	ELEMENT_TRIGGER,
+};
+
+// ---------------------------------------------------------------------------
+// Public methods
+// ---------------------------------------------------------------------------
+SyncFingerprint::SyncFingerprint(void)
+: m_sum(0),
+  m_numElements(0)
+{
+}
+
+void SyncFingerprint::add(const ServerHostDef &svHostDef)
+{
+	ElementHasher hasher(ELEMENT_HOST);
+	hasher << svHostDef.serverId
+	       << svHostDef.hostIdInServer
+	       << svHostDef.name
+	       << static_cast<int>(svHostDef.status);
+	addElement(hasher.value);
+}
+
+void SyncFingerprint::add(const Hostgroup &hostgroup)
+{
+	ElementHasher hasher(ELEMENT_HOSTGROUP);
+	hasher << hostgroup.serverId
+	       << hostgroup.idInServer
+	       << hostgroup.name;
+	addElement(hasher.value);
+}
+
+void SyncFingerprint::add(const HostgroupMember &hostgroupMember)
+{
+	ElementHasher hasher(ELEMENT_HOSTGROUP_MEMBER);
+	hasher << hostgroupMember.serverId
+	       << hostgroupMember.hostIdInServer
+	       << hostgroupMember.hostgroupIdInServer
+	       << hostgroupMember.hostId;
+	addElement(hasher.value);
+}
+
+void SyncFingerprint::add(const TriggerInfo &triggerInfo)
+{
+	ElementHasher hasher(ELEMENT_TRIGGER);
+	hasher << triggerInfo.serverId
+	       << triggerInfo.id
+	       << static_cast<int>(triggerInfo.status)
+	       << static_cast<int>(triggerInfo.severity)
+	       << triggerInfo.lastChangeTime
+	       << triggerInfo.globalHostId
+	       << triggerInfo.hostIdInServer
+	       << triggerInfo.hostName
+	       << triggerInfo.brief
+	       << triggerInfo.extendedInfo
+	       << static_cast<int>(triggerInfo.validity);
+	addElement(hasher.value);
+}
+
+size_t SyncFingerprint::getNumberOfElements(void) const
+{
+	return m_numElements;
+}
+
+uint64_t SyncFingerprint::getValue(void) const
+{
+	return mix(m_sum ^ mix(m_numElements));
+}
+
+string SyncFingerprint::toString(void) const
+{
+	return StringUtils::sprintf("%016" PRIx64, getValue());
+}
+
+// ---------------------------------------------------------------------------
+// Private methods
+// ---------------------------------------------------------------------------
+void SyncFingerprint::addElement(const uint64_t &elementHash)
+{
+	m_sum += mix(elementHash);
+	m_numElements++;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <string>
+#include <stdint.h>
+#include "Monitoring.h"
+#include "DBTablesHost.h"
+
+/**
+ * Calculates a fingerprint of a set of hosts, host groups, host group
+ * members or triggers sent by a monitoring server.
+ *
+ * The fingerprint doesn't depend on the order of the elements. So two
+ * full syncs with the same content have the same fingerprint even if
+ * the plugin sends them in a different order or in different chunks.
+ */
+class SyncFingerprint {
+public:
+	SyncFingerprint(void);
+
+	void add(const ServerHostDef &svHostDef);
+	void add(const Hostgroup &hostgroup);
+	void add(const HostgroupMember &hostgroupMember);
+	void add(const TriggerInfo &triggerInfo);
+
+	template <typename T>
+	void addAll(const T &elements)
+	{
+		for (auto &element : elements)
+			add(element);
+	}
+
+	size_t getNumberOfElements(void) const;
+	uint64_t getValue(void) const;
+
+	/**
+	 * Get the fingerprint as a fixed-length hexadecimal string. It is
+	 * stored in the last_info table.
+	 */
+	std::string toString(void) const;
+
+private:
+	uint64_t m_sum;
+	size_t   m_numElements;
+
+	void addElement(const uint64_t &elementHash);
+};
@@ -18,30 +18,23 @@
  */
 
 #pragma once
-#include <deque>
-#include <memory>
-#include "Params.h"
-#include "Closure.h"
-#include "DataStore.h"
+#include "OnDemandFetchWorker.h"
 #include "DBTablesMonitoring.h"
 
-class TriggerFetchWorker
+class TriggerFetchWorker : public OnDemandFetchWorker
 {
 public:
+	static const time_t DEFAULT_CACHE_TTL_SEC;
+
 	TriggerFetchWorker(void);
 	virtual ~TriggerFetchWorker();
 
-	bool start(const TriggersQueryOption option,
+	using OnDemandFetchWorker::start;
+	bool start(const TriggersQueryOption &option,
 	           Closure0 *closure = NULL);
-	bool updateIsNeeded(void);
-	void waitCompletion(void);
 
 protected:
-	void updatedCallback(Closure0 *closure);
-	bool runFetcher(const LocalHostIdVector targetHostIds, std::shared_ptr<DataStore> dataStore);
-
-private:
-	struct Impl;
-	std::unique_ptr<Impl> m_impl;
+	virtual bool startFetch(DataStore &dataStore,
+	                        const LocalHostIdVector &hostIds,
+	                        Closure0 *closure) override;
 };
-
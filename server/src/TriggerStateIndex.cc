@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 2014 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <mutex>
+#include <map>
+#include <unordered_map>
+#include "TriggerStateIndex.h"
+
+using namespace std;
+
+// Triggers are classified by the validity to apply ExcludeFlags.
+enum ValidityClass {
+	VALIDITY_CLASS_INVALID,
+	VALIDITY_CLASS_SELF_MONITORING,
+	VALIDITY_CLASS_OTHERS,
+	NUM_VALIDITY_CLASSES,
+};
+
+// All combinations of EXCLUDE_SELF_MONITORING and EXCLUDE_INVALID_HOST
+static const size_t NUM_EXCLUDE_PATTERNS = 4;
+
+static ValidityClass getValidityClass(const TriggerValidity &validity)
+{
+	switch (validity) {
+	case TRIGGER_INVALID:
+		return VALIDITY_CLASS_INVALID;
+	case TRIGGER_VALID_SELF_MONITORING:
+		return VALIDITY_CLASS_SELF_MONITORING;
+	default:
+		break;
+	}
+	return VALIDITY_CLASS_OTHERS;
+}
+
+static bool isIncluded(const ValidityClass &validityClass,
+                       const ExcludeFlags &excludeFlags)
+{
+	if (validityClass == VALIDITY_CLASS_INVALID)
+		return !(excludeFlags & EXCLUDE_INVALID_HOST);
+	if (validityClass == VALIDITY_CLASS_SELF_MONITORING)
+		return !(excludeFlags & EXCLUDE_SELF_MONITORING);
+	return true;
+}
+
+static bool isValidSeverity(const TriggerSeverityType &severity)
+{
+	return severity >= 0 && severity < NUM_TRIGGER_SEVERITY;
+}
+
+struct TriggerState {
+	LocalHostIdType     hostIdInServer;
+	TriggerSeverityType severity;
+	TriggerStatusType   status;
+	ValidityClass       validityClass;
+
+	TriggerState(const TriggerInfo &triggerInfo)
+	: hostIdInServer(triggerInfo.hostIdInServer),
+	  severity(triggerInfo.severity),
+	  status(triggerInfo.status),
+	  validityClass(getValidityClass(triggerInfo.validity))
+	{
+	}
+};
+
+struct HostState {
+	size_t numTriggers[NUM_VALIDITY_CLASSES];
+	size_t numBadTriggers[NUM_VALIDITY_CLASSES];
+
+	static bool hasAny(const size_t (&counters)[NUM_VALIDITY_CLASSES],
+	                   const ExcludeFlags &excludeFlags)
+	{
+		for (size_t i = 0; i < NUM_VALIDITY_CLASSES; i++) {
+			const ValidityClass validityClass =
+			  static_cast<ValidityClass>(i);
+			if (!isIncluded(validityClass, excludeFlags))
+				continue;
+			if (counters[i] > 0)
+				return true;
+		}
+		return false;
+	}
+};
+
+struct ServerState {
+	unordered_map<TriggerIdType, TriggerState> triggers;
+	map<LocalHostIdType, HostState>            hosts;
+	size_t numTriggers[NUM_VALIDITY_CLASSES];
+	size_t numBadTriggers[NUM_VALIDITY_CLASSES];
+	size_t numBadTriggersBySeverity
+	         [NUM_VALIDITY_CLASSES][NUM_TRIGGER_SEVERITY];
+	size_t numHosts[NUM_EXCLUDE_PATTERNS];
+	size_t numBadHosts[NUM_EXCLUDE_PATTERNS];
+
+	ServerState(void)
+	: numTriggers(),
+	  numBadTriggers(),
+	  numBadTriggersBySeverity(),
+	  numHosts(),
+	  numBadHosts()
+	{
+	}
+
+	void count(const TriggerState &trigger, const bool &add)
+	{
+		const size_t vc = trigger.validityClass;
+		const bool isBadTrigger =
+		  (trigger.status == TRIGGER_STATUS_PROBLEM);
+		countUp(numTriggers[vc], add);
+		if (isBadTrigger) {
+			countUp(numBadTriggers[vc], add);
+			if (isValidSeverity(trigger.severity)) {
+				countUp(numBadTriggersBySeverity
+				          [vc][trigger.severity],
+				        add);
+			}
+		}
+
+		// Update the number of hosts that have the (bad) triggers
+		// for each exclude pattern.
+		HostState &host = hosts[trigger.hostIdInServer];
+		bool hadTriggers[NUM_EXCLUDE_PATTERNS];
+		bool wasBad[NUM_EXCLUDE_PATTERNS];
+		for (size_t flags = 0; flags < NUM_EXCLUDE_PATTERNS; flags++) {
+			hadTriggers[flags] =
+			  HostState::hasAny(host.numTriggers, flags);
+			wasBad[flags] =
+			  HostState::hasAny(host.numBadTriggers, flags);
+		}
+		countUp(host.numTriggers[vc], add);
+		if (isBadTrigger)
+			countUp(host.numBadTriggers[vc], add);
+		for (size_t flags = 0; flags < NUM_EXCLUDE_PATTERNS; flags++) {
+			const bool hasTriggers =
+			  HostState::hasAny(host.numTriggers, flags);
+			const bool isBad =
+			  HostState::hasAny(host.numBadTriggers, flags);
+			if (hasTriggers != hadTriggers[flags])
+				countUp(numHosts[flags], hasTriggers);
+			if (isBad != wasBad[flags])
+				countUp(numBadHosts[flags], isBad);
+		}
+		if (!HostState::hasAny(host.numTriggers, NO_EXCLUDE_HOST))
+			hosts.erase(trigger.hostIdInServer);
+	}
+
+	static void countUp(size_t &counter, const bool &add)
+	{
+		if (add)
+			counter++;
+		else
+			counter--;
+	}
+
+	void update(const TriggerInfo &triggerInfo)
+	{
+		auto it = triggers.find(triggerInfo.id);
+		if (it != triggers.end()) {
+			count(it->second, false);
+			triggers.erase(it);
+		}
+		auto ret = triggers.emplace(triggerInfo.id,
+		                            TriggerState(triggerInfo));
+		count(ret.first->second, true);
+	}
+
+	void remove(const TriggerIdType &triggerId)
+	{
+		auto it = triggers.find(triggerId);
+		if (it == triggers.end())
+			return;
+		count(it->second, false);
+		triggers.erase(it);
+	}
+};
+
+struct TriggerStateIndex::Impl {
+	mutex                         lock;
+	map<ServerIdType, ServerState> servers;
+
+	ServerState &getServerState(const ServerIdType &serverId,
+	                            const Loader &loader)
+	{
+		auto it = servers.find(serverId);
+		if (it != servers.end())
+			return it->second;
+
+		// The lock is held during the load so that updates by other
+		// threads are applied after that.
+		TriggerInfoList triggerInfoList;
+		loader(serverId, triggerInfoList);
+		ServerState &serverState = servers[serverId];
+		for (const auto &triggerInfo : triggerInfoList)
+			serverState.update(triggerInfo);
+		return serverState;
+	}
+
+	template <typename T>
+	size_t sum(const ServerIdSet &serverIds, const Loader &loader, T func)
+	{
+		size_t num = 0;
+		lock_guard<mutex> guard(lock);
+		for (const auto &serverId : serverIds)
+			num += func(getServerState(serverId, loader));
+		return num;
+	}
+
+	static size_t sumByValidity(
+	  const size_t (&counters)[NUM_VALIDITY_CLASSES],
+	  const ExcludeFlags &excludeFlags)
+	{
+		size_t num = 0;
+		for (size_t i = 0; i < NUM_VALIDITY_CLASSES; i++) {
+			const ValidityClass validityClass =
+			  static_cast<ValidityClass>(i);
+			if (isIncluded(validityClass, excludeFlags))
+				num += counters[i];
+		}
+		return num;
+	}
+};
+
+// ---------------------------------------------------------------------------
+// Public methods
+// ---------------------------------------------------------------------------
+TriggerStateIndex::TriggerStateIndex(void)
+: m_impl(new Impl())
+{
+}
+
+TriggerStateIndex::~TriggerStateIndex()
+{
+}
+
+void TriggerStateIndex::clear(void)
+{
+	lock_guard<mutex> guard(m_impl->lock);
+	m_impl->servers.clear();
+}
+
+void TriggerStateIndex::invalidate(const ServerIdType &serverId)
+{
+	lock_guard<mutex> guard(m_impl->lock);
+	m_impl->servers.erase(serverId);
+}
+
+void TriggerStateIndex::update(const TriggerInfoList &triggerInfoList)
+{
+	lock_guard<mutex> guard(m_impl->lock);
+	for (const auto &triggerInfo : triggerInfoList) {
+		auto it = m_impl->servers.find(triggerInfo.serverId);
+		if (it == m_impl->servers.end())
+			continue;
+		it->second.update(triggerInfo);
+	}
+}
+
+void TriggerStateIndex::update(const TriggerInfo &triggerInfo)
+{
+	lock_guard<mutex> guard(m_impl->lock);
+	auto it = m_impl->servers.find(triggerInfo.serverId);
+	if (it == m_impl->servers.end())
+		return;
+	it->second.update(triggerInfo);
+}
+
+void TriggerStateIndex::remove(const ServerIdType &serverId,
+                               const TriggerIdList &idList)
+{
+	lock_guard<mutex> guard(m_impl->lock);
+	auto it = m_impl->servers.find(serverId);
+	if (it == m_impl->servers.end())
+		return;
+	for (const auto &triggerId : idList)
+		it->second.remove(triggerId);
+}
+
+size_t TriggerStateIndex::getNumberOfTriggers(
+  const ServerIdSet &serverIds, const ExcludeFlags &excludeFlags,
+  const Loader &loader)
+{
+	return m_impl->sum(serverIds, loader, [&](ServerState &serverState) {
+		return Impl::sumByValidity(serverState.numTriggers,
+		                           excludeFlags);
+	});
+}
+
+size_t TriggerStateIndex::getNumberOfBadTriggers(
+  const ServerIdSet &serverIds, const TriggerSeverityType &severity,
+  const ExcludeFlags &excludeFlags, const Loader &loader)
+{
+	return m_impl->sum(serverIds, loader, [&](ServerState &serverState) {
+		if (severity == TRIGGER_SEVERITY_ALL) {
+			return Impl::sumByValidity(serverState.numBadTriggers,
+			                           excludeFlags);
+		}
+		if (!isValidSeverity(severity))
+			return (size_t)0;
+		size_t num = 0;
+		for (size_t i = 0; i < NUM_VALIDITY_CLASSES; i++) {
+			const ValidityClass validityClass =
+			  static_cast<ValidityClass>(i);
+			if (!isIncluded(validityClass, excludeFlags))
+				continue;
+			num += serverState.numBadTriggersBySeverity[i][severity];
+		}
+		return num;
+	});
+}
+
+size_t TriggerStateIndex::getNumberOfHosts(
+  const ServerIdSet &serverIds, const ExcludeFlags &excludeFlags,
+  const Loader &loader)
+{
+	const size_t pattern =
+	  excludeFlags & (EXCLUDE_SELF_MONITORING | EXCLUDE_INVALID_HOST);
+	return m_impl->sum(serverIds, loader, [&](ServerState &serverState) {
+		return serverState.numHosts[pattern];
+	});
+}
+
+size_t TriggerStateIndex::getNumberOfBadHosts(
+  const ServerIdSet &serverIds, const ExcludeFlags &excludeFlags,
+  const Loader &loader)
+{
+	const size_t pattern =
+	  excludeFlags & (EXCLUDE_SELF_MONITORING | EXCLUDE_INVALID_HOST);
+	return m_impl->sum(serverIds, loader, [&](ServerState &serverState) {
+		return serverState.numBadHosts[pattern];
+	});
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2014 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <memory>
+#include <functional>
+#include "Params.h"
+#include "Monitoring.h"
+
+/**
+ * An in-memory index of the trigger states that answers the number of
+ * triggers and bad hosts of each server without scanning the triggers
+ * table.
+ *
+ * Triggers of a server are loaded by the given loader when the server is
+ * queried at the first time. After that, the index is updated by the
+ * callers that write the triggers table. The update methods ignore
+ * servers that have not been loaded. So they can be called without
+ * knowing if the server is loaded.
+ *
+ * All methods are thread safe.
+ */
+class TriggerStateIndex {
+public:
+	typedef std::function<void (const ServerIdType &serverId,
+	                            TriggerInfoList &triggerInfoList)> Loader;
+
+	TriggerStateIndex(void);
+	virtual ~TriggerStateIndex();
+
+	/**
+	 * Forget all servers.
+	 */
+	void clear(void);
+
+	/**
+	 * Forget a server. Its triggers will be loaded again on demand.
+	 *
+	 * @param serverId A server ID.
+	 */
+	void invalidate(const ServerIdType &serverId);
+
+	/**
+	 * Add or update triggers. The server of each trigger should be
+	 * written in the triggers table in advance.
+	 *
+	 * @param triggerInfoList Triggers to be updated.
+	 */
+	void update(const TriggerInfoList &triggerInfoList);
+	void update(const TriggerInfo &triggerInfo);
+
+	/**
+	 * Remove triggers.
+	 *
+	 * @param serverId A server ID of the triggers.
+	 * @param idList   IDs of the triggers to be removed.
+	 */
+	void remove(const ServerIdType &serverId, const TriggerIdList &idList);
+
+	size_t getNumberOfTriggers(const ServerIdSet &serverIds,
+	                           const ExcludeFlags &excludeFlags,
+	                           const Loader &loader);
+
+	/**
+	 * Get the number of triggers whose status is TRIGGER_STATUS_PROBLEM.
+	 *
+	 * @param severity
+	 * A target severity. TRIGGER_SEVERITY_ALL means all severities.
+	 */
+	size_t getNumberOfBadTriggers(const ServerIdSet &serverIds,
+	                              const TriggerSeverityType &severity,
+	                              const ExcludeFlags &excludeFlags,
+	                              const Loader &loader);
+
+	/**
+	 * Get the number of hosts that have one or more triggers.
+	 */
+	size_t getNumberOfHosts(const ServerIdSet &serverIds,
+	                        const ExcludeFlags &excludeFlags,
+	                        const Loader &loader);
+
+	/**
+	 * Get the number of hosts that have one or more triggers whose
+	 * status is TRIGGER_STATUS_PROBLEM.
+	 */
+	size_t getNumberOfBadHosts(const ServerIdSet &serverIds,
+	                           const ExcludeFlags &excludeFlags,
+	                           const Loader &loader);
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
@@ -25,10 +25,11 @@
 #include "DBTablesAction.h"
 #include "DBTablesConfig.h"
 #include "DataStoreManager.h"
-#include "ActionManager.h"
+#include "ConfigManager.h"
 #include "ThreadLocalDBCache.h"
 #include "ItemFetchWorker.h"
 #include "TriggerFetchWorker.h"
+#include "HistoryFetchWorker.h"
 #include "DataStoreFactory.h"
 #include "ArmIncidentTracker.h"
 #include "IncidentSenderManager.h"
@@ -82,6 +83,8 @@ struct UnifiedDataStore::Impl
 
 	ItemFetchWorker          itemFetchWorker;
 	TriggerFetchWorker       triggerFetchWorker;
+	HistoryFetchWorker       historyFetchWorker;
+	ActionEvaluator          actionEvaluator;
 
 	Impl()
 	: isStarted(false)
@@ -293,10 +296,29 @@ struct UnifiedDataStore::Impl
 		}
 	}
 
+	void setupFetchWorkers(void)
+	{
+		ConfigManager *confMgr = ConfigManager::getInstance();
+		const int numFetchers =
+		  confMgr->getOnDemandFetchMaxRunningFetchers();
+		if (numFetchers > 0) {
+			itemFetchWorker.setMaxRunningFetchers(numFetchers);
+			triggerFetchWorker.setMaxRunningFetchers(numFetchers);
+		}
+		const int cacheTTLSec = confMgr->getOnDemandFetchCacheTTLSec();
+		if (cacheTTLSec >= 0) {
+			itemFetchWorker.setCacheTTL(cacheTTLSec);
+			triggerFetchWorker.setCacheTTL(cacheTTLSec);
+		}
+	}
+
 	void start(const bool &autoRun)
 	{
+		setupFetchWorkers();
 		startAllDataStores(autoRun);
 		startAllArmIncidentTrackers(autoRun);
+		actionEvaluator.start(
+		  ConfigManager::getInstance()->getActionNumWorkers());
 		isStarted = true;
 	}
 
@@ -304,6 +326,8 @@ struct UnifiedDataStore::Impl
 	{
 		stopAllDataStores();
 		stopAllArmIncidentTrackers();
+		// After the data stores that add events are stopped
+		actionEvaluator.stop();
 		isStarted = false;
 	}
 
@@ -394,14 +418,8 @@ void UnifiedDataStore::stop(void)
 
 void UnifiedDataStore::fetchItems(const ServerIdType &targetServerId)
 {
-	if (!m_impl->itemFetchWorker.updateIsNeeded())
-		return;
-
-	bool started = m_impl->itemFetchWorker.start(targetServerId, NULL);
-	if (!started)
-		return;
-
-	m_impl->itemFetchWorker.waitCompletion();
+	m_impl->itemFetchWorker.startAndWait(getDataStoreVector(),
+	                                     targetServerId, ALL_LOCAL_HOSTS);
 }
 
 void UnifiedDataStore::getTriggerList(TriggerInfoList &triggerList,
@@ -457,20 +475,23 @@ void UnifiedDataStore::getItemCategoryNames(
 bool UnifiedDataStore::fetchItemsAsync(Closure0 *closure,
                                        const ItemsQueryOption &option)
 {
-	if (!m_impl->itemFetchWorker.updateIsNeeded())
-		return false;
-
 	return m_impl->itemFetchWorker.start(option, closure);
 }
 
 bool UnifiedDataStore::fetchTriggerAsync(Closure0 *closure,
 					 const TriggersQueryOption &option)
 {
-	const ServerIdType targetServerId = option.getTargetServerId();
-	if (!m_impl->triggerFetchWorker.updateIsNeeded())
-		return false;
+	return m_impl->triggerFetchWorker.start(option, closure);
+}
 
-	return m_impl->triggerFetchWorker.start(targetServerId, closure);
+void UnifiedDataStore::fetchHistoryAsync(Closure1<HistoryInfoVect> *closure,
+					 shared_ptr<DataStore> dataStore,
+					 const ItemInfo &itemInfo,
+					 const time_t &beginTime,
+					 const time_t &endTime)
+{
+	m_impl->historyFetchWorker.start(dataStore, itemInfo,
+	                                 beginTime, endTime, closure);
 }
 
 HatoholError UnifiedDataStore::getActionList(
@@ -517,6 +538,13 @@ HatoholError UnifiedDataStore::getServerHostDefs(
 	return cache.getHost().getServerHostDefs(svHostDefVect, option);
 }
 
+HatoholError UnifiedDataStore::getNumberOfHostsEachServer(
+  map<ServerIdType, size_t> &numHostsMap, const HostsQueryOption &option)
+{
+	ThreadLocalDBCache cache;
+	return cache.getHost().getNumberOfHostsEachServer(numHostsMap, option);
+}
+
 HatoholError UnifiedDataStore::getHostgroups(
   HostgroupVect &hostgroups, const HostgroupsQueryOption &option)
 {
@@ -655,6 +683,14 @@ size_t UnifiedDataStore::getNumberOfBadHosts(const TriggersQueryOption &option)
 	return cache.getMonitoring().getNumberOfBadHosts(option);
 }
 
+void UnifiedDataStore::getTriggerStatistics(
+  DBTablesMonitoring::ServerTriggerStatisticsMap &statisticsMap,
+  const TriggersQueryOption &option)
+{
+	ThreadLocalDBCache cache;
+	cache.getMonitoring().getTriggerStatistics(statisticsMap, option);
+}
+
 size_t UnifiedDataStore::getNumberOfItems(const ItemsQueryOption &option,
 					  bool fetchItemsSynchronously)
 {
@@ -707,9 +743,8 @@ void UnifiedDataStore::addEventList(EventInfoList &eventList,
                                     DBAgent::TransactionHooks *hooks)
 {
 	ThreadLocalDBCache cache;
-	ActionManager actionManager;
 	cache.getMonitoring().addEventInfoList(eventList, hooks);
-	actionManager.checkEvents(eventList);
+	m_impl->actionEvaluator.evaluate(eventList);
 }
 
 void UnifiedDataStore::addItemList(const ItemInfoList &itemList)
@@ -1142,6 +1177,12 @@ void UnifiedDataStore::getCustomIncidentStatusesCache(
 	m_impl->getCustomIncidentStatusMap(customIncidentStatusMap);
 }
 
+void UnifiedDataStore::getActionEvaluatorStatistics(
+  ActionEvaluator::Statistics &stat) const
+{
+	m_impl->actionEvaluator.getStatistics(stat);
+}
+
 void UnifiedDataStore::startArmIncidentTrackerIfNeeded(
   const IncidentTrackerIdType &trackerId)
 {
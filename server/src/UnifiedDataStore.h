@@ -27,6 +27,7 @@
 #include "Closure.h"
 #include "DataStore.h"
 #include "HostInfoCache.h"
+#include "ActionEvaluator.h"
 
 struct ServerConnStatus {
 	ServerIdType serverId;
@@ -58,6 +59,7 @@ public:
 
 	/**
 	 * Add events in the Hatohol DB and executes action if needed.
+	 * After start() is called, actions are evaluated asynchronously.
 	 *
 	 * @param eventList A list of EventInfo.
 	 * @param hooks     Transaction hook functions.
@@ -105,22 +107,30 @@ public:
 	bool fetchTriggerAsync(Closure0 *closure,
 			       const TriggersQueryOption &option);
 
-	/*
-	 *  We don't provide a function to get history.
-	 *  Please get a DataStore by getDataStore() and use
-	 *  DataStore::startOnDemandFetchHistory() directly.
+	/**
+	 * Fetch history of an item. The identical requests that are made
+	 * while a fetch is running share its result.
+	 *
+	 * @param closure
+	 * A closure called with the fetched history. It is deleted after
+	 * the call.
+	 * @param dataStore A data store of the server that has the item.
+	 * @param itemInfo A target item.
+	 * @param beginTime The beginning of the time range.
+	 * @param endTime The end of the time range.
 	 */
-	/*
 	void fetchHistoryAsync(Closure1<HistoryInfoVect> *closure,
-			       const ServerIdType &targetServerId,
-			       const ItemIdType &itemId,
+			       std::shared_ptr<DataStore> dataStore,
+			       const ItemInfo &itemInfo,
 			       const time_t &beginTime,
 			       const time_t &endTime);
-	*/
 
 	// Host and Hostgroup
 	HatoholError getServerHostDefs(ServerHostDefVect &svHostDefVect,
 	                               const HostsQueryOption &option);
+	HatoholError getNumberOfHostsEachServer(
+	  std::map<ServerIdType, size_t> &numHostsMap,
+	  const HostsQueryOption &option);
 
 	HatoholError getHostgroups(HostgroupVect &hostgroups,
 	                           const HostgroupsQueryOption &option);
@@ -211,6 +221,9 @@ public:
 	                          DBAgent::TransactionHooks *hooks = NULL);
 	size_t getNumberOfGoodHosts(const TriggersQueryOption &option);
 	size_t getNumberOfBadHosts(const TriggersQueryOption &option);
+	void getTriggerStatistics(
+	  DBTablesMonitoring::ServerTriggerStatisticsMap &statisticsMap,
+	  const TriggersQueryOption &option);
 	size_t getNumberOfItems(const ItemsQueryOption &option,
 				bool fetchItemsSynchronously = false);
 	HatoholError getNumberOfMonitoredItemsPerSecond(const DataQueryOption &option,
@@ -356,6 +369,9 @@ public:
 	void getCustomIncidentStatusesCache(
 	  std::map<std::string, CustomIncidentStatus> &customIncidentStatusMap);
 
+	void getActionEvaluatorStatistics(
+	  ActionEvaluator::Statistics &stat) const;
+
 protected:
 	void fetchItems(const ServerIdType &targetServerId = ALL_SERVERS);
 
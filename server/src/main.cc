@@ -236,6 +236,10 @@ int mainRoutine(int argc, char *argv[])
 	}
 	hatoholInitChildProcessManager();
 
+	// The background thread of the logger doesn't survive daemon().
+	if (confMgr->isAsyncLogEnabled())
+		Logger::enableAsyncOutput();
+
 	// setup signal handlers for exit
 	setupGizmoForExit(&ctx);
 	setupSignalHandlerForExit(SIGTERM);
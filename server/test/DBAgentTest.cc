@@ -156,6 +156,34 @@ const DBAgent::TableProfile tableProfileTestAutoInc(
   NUM_IDX_TEST_TABLE_AUTO_INC
 );
 
+// table for batch insert test with auto increment IDs
+static const ColumnDef COLUMN_DEF_TEST_AUTO_INC_NO_UNIQ[] = {
+{
+	"id",                              // columnName
+	SQL_COLUMN_TYPE_BIGUINT,           // type
+	20,                                // columnLength
+	0,                                 // decFracLength
+	false,                             // canBeNull
+	SQL_KEY_PRI,                       // keyType
+	SQL_COLUMN_FLAG_AUTO_INC,          // flags
+	NULL,                              // defaultValue
+},{
+	"name",                            // columnName
+	SQL_COLUMN_TYPE_VARCHAR,           // type
+	255,                               // columnLength
+	0,                                 // decFracLength
+	false,                             // canBeNull
+	SQL_KEY_NONE,                      // keyType
+	0,                                 // flags
+	NULL,                              // defaultValue
+}
+};
+
+static const DBAgent::TableProfile tableProfileTestAutoIncNoUniq(
+  "test_table_auto_inc_no_uniq", COLUMN_DEF_TEST_AUTO_INC_NO_UNIQ,
+  ARRAY_SIZE(COLUMN_DEF_TEST_AUTO_INC_NO_UNIQ)
+);
+
 static ItemDataNullFlagType calcNullFlag(set<size_t> *nullIndexes, size_t idx)
 {
 	if (!nullIndexes)
@@ -457,6 +485,44 @@ void dbAgentTestInsertUint64
 	checkInsert(dbAgent, checker, param);
 }
 
+void dbAgentTestInsertConvertedByColumnType(DBAgent &dbAgent,
+                                            DBAgentChecker &checker)
+{
+	// create table
+	dbAgentTestCreateTable(dbAgent, checker);
+
+	// An int for the BIGUINT column and a double with more fractional
+	// digits than the column are stored in the same way with and
+	// without a prepared statement.
+	for (int id = 1; id <= 2; id++) {
+		dbAgent.setPreparedStatementEnabled(id == 1);
+		DBAgent::InsertArg arg(tableProfileTest);
+		arg.row->addNewItem(id);
+		arg.row->addNewItem(14);
+		arg.row->addNewItem("rei");
+		arg.row->addNewItem(158.26);
+		arg.row->addNewItem(CURR_DATETIME);
+		dbAgent.insert(arg);
+	}
+
+	DBAgent::SelectExArg arg(tableProfileTest);
+	arg.add(IDX_TEST_TABLE_ID);
+	arg.add(IDX_TEST_TABLE_HEIGHT);
+	arg.orderBy = COLUMN_DEF_TEST[IDX_TEST_TABLE_ID].columnName;
+	dbAgent.select(arg);
+
+	const ItemGroupList &itemList = arg.dataTable->getItemGroupList();
+	cppcut_assert_equal((size_t)2, itemList.size());
+	uint64_t id = 0;
+	for (auto itemGroup : itemList) {
+		ItemGroupStream itemGroupStream(itemGroup);
+		double height;
+		cppcut_assert_equal(++id, itemGroupStream.read<uint64_t>());
+		itemGroupStream >> height;
+		cppcut_assert_equal(158.3, height);
+	}
+}
+
 void dbAgentTestInsertNull(DBAgent &dbAgent, DBAgentChecker &checker)
 {
 	// create table
@@ -529,6 +595,91 @@ void dbAgentTestUpsertWithPrimaryKeyAutoInc(
 	checkInsert(dbAgent, checker, param);
 }
 
+void dbAgentTestInsertBatch(DBAgent &dbAgent, DBAgentChecker &checker)
+{
+	dbAgentTestCreateTable(dbAgent, checker);
+
+	DBAgent::InsertBatchArg batchArg(tableProfileTest);
+	batchArg.maxRowsPerStatement = 2; // To split statements
+	for (size_t i = 0; i < NUM_TEST_DATA; i++) {
+		DBAgent::InsertArg arg(tableProfileTest);
+		arg.add(ID[i]);
+		arg.add(AGE[i]);
+		arg.add(NAME[i]);
+		arg.add(HEIGHT[i]);
+		arg.add(CURR_DATETIME);
+		batchArg.add(arg);
+	}
+	dbAgent.insertBatch(batchArg);
+	cppcut_assert_equal(true, batchArg.insertIds.empty());
+
+	for (size_t i = 0; i < NUM_TEST_DATA; i++) {
+		checker.assertExistingRecord(
+		  dbAgent, ID[i], AGE[i], NAME[i], HEIGHT[i], CURR_DATETIME,
+		  NUM_COLUMNS_TEST, COLUMN_DEF_TEST);
+	}
+}
+
+void dbAgentTestInsertBatchUpsert(DBAgent &dbAgent, DBAgentChecker &checker)
+{
+	dbAgentTestInsertBatch(dbAgent, checker);
+
+	const int newAge = 99;
+	DBAgent::InsertBatchArg batchArg(tableProfileTest);
+	batchArg.upsertOnDuplicate = true;
+	for (size_t i = 0; i < NUM_TEST_DATA; i++) {
+		DBAgent::InsertArg arg(tableProfileTest);
+		arg.add(ID[i]);
+		arg.add(newAge);
+		arg.add(NAME[i]);
+		arg.add(HEIGHT[i]);
+		arg.add(CURR_DATETIME);
+		batchArg.add(arg);
+	}
+	dbAgent.insertBatch(batchArg);
+
+	for (size_t i = 0; i < NUM_TEST_DATA; i++) {
+		checker.assertExistingRecord(
+		  dbAgent, ID[i], newAge, NAME[i], HEIGHT[i], CURR_DATETIME,
+		  NUM_COLUMNS_TEST, COLUMN_DEF_TEST);
+	}
+}
+
+void dbAgentTestInsertBatchAutoIncrement(
+  DBAgent &dbAgent, DBAgentChecker &checker)
+{
+	const char *names[] = {"taro", "jiro", "saburo", "shiro", "goro"};
+	const size_t numNames = ARRAY_SIZE(names);
+	dbAgent.createTable(tableProfileTestAutoIncNoUniq);
+
+	DBAgent::InsertBatchArg batchArg(tableProfileTestAutoIncNoUniq);
+	batchArg.maxRowsPerStatement = 2; // To split statements
+	batchArg.upsertOnDuplicate = true;
+	for (size_t i = 0; i < numNames; i++) {
+		DBAgent::InsertArg arg(tableProfileTestAutoIncNoUniq);
+		arg.add(AUTO_INCREMENT_VALUE_U64);
+		arg.add(names[i]);
+		batchArg.add(arg);
+	}
+	cppcut_assert_equal(true, batchArg.isInsertIdAssignable());
+	dbAgent.insertBatch(batchArg);
+
+	string expect;
+	cppcut_assert_equal(numNames, batchArg.insertIds.size());
+	for (size_t i = 0; i < numNames; i++) {
+		const uint64_t expectedId = i + 1;
+		cppcut_assert_equal(expectedId, batchArg.insertIds[i]);
+		if (i > 0)
+			expect += "\n";
+		expect += StringUtils::sprintf("%" PRIu64 "|%s",
+		                               expectedId, names[i]);
+	}
+	const string statement = StringUtils::sprintf(
+	  "SELECT * FROM %s ORDER BY id ASC",
+	  tableProfileTestAutoIncNoUniq.name);
+	assertDBContent(&dbAgent, statement, expect);
+}
+
 void dbAgentTestUpdate(DBAgent &dbAgent, DBAgentChecker &checker)
 {
 	// create table and insert a row
@@ -716,6 +867,40 @@ void dbAgentTestSelectExWithCondAllColumns(DBAgent &dbAgent)
 	assertItemData(double,   itemGroup, HEIGHT[targetRow], idx);
 }
 
+void dbAgentTestSelectExColumnar(DBAgent &dbAgent)
+{
+	map<uint64_t, size_t> testDataIdIndexMap;
+	DBAgentChecker::createTable(dbAgent);
+	DBAgentChecker::makeTestData(dbAgent, testDataIdIndexMap);
+
+	DBAgent::SelectExArg arg(tableProfileTest);
+	arg.add(IDX_TEST_TABLE_ID);
+	arg.add(IDX_TEST_TABLE_AGE);
+	arg.add(IDX_TEST_TABLE_NAME);
+	arg.add(IDX_TEST_TABLE_HEIGHT);
+	arg.useColumnarTable = true;
+	dbAgent.select(arg);
+
+	// check the result
+	const ColumnarTable &table = *arg.columnarTable;
+	cppcut_assert_equal(NUM_TEST_DATA, table.getNumberOfRows());
+	cppcut_assert_equal((size_t)4, table.getNumberOfColumns());
+	for (size_t row = 0; row < table.getNumberOfRows(); row++) {
+		ColumnarTableStream stream(table, row);
+		const uint64_t id = stream.read<uint64_t>();
+		map<uint64_t, size_t>::iterator itrId =
+		  testDataIdIndexMap.find(id);
+		cppcut_assert_equal(false, itrId == testDataIdIndexMap.end(),
+		                    cut_message("id: 0x%" PRIx64, id));
+		const size_t srcDataIdx = itrId->second;
+		cppcut_assert_equal(AGE[srcDataIdx], stream.read<int>());
+		cppcut_assert_equal(string(NAME[srcDataIdx]),
+		                    stream.read<string>());
+		cppcut_assert_equal(HEIGHT[srcDataIdx], stream.read<double>());
+		testDataIdIndexMap.erase(itrId);
+	}
+}
+
 void dbAgentTestSelectHeightOrder
   (DBAgent &dbAgent, size_t limit, size_t offset, size_t forceExpectedRows)
 {
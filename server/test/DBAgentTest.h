@@ -104,10 +104,16 @@ void dbAgentTestFixupSameNameIndexes(DBAgent &dbAgent, DBAgentChecker &checker);
 void dbAgentTestInsert(DBAgent &dbAgent, DBAgentChecker &checker);
 void dbAgentTestInsertUint64
   (DBAgent &dbAgent, DBAgentChecker &checker, uint64_t id);
+void dbAgentTestInsertConvertedByColumnType(DBAgent &dbAgent,
+                                            DBAgentChecker &checker);
 void dbAgentTestInsertNull(DBAgent &dbAgent, DBAgentChecker &checker);
 void dbAgentTestUpsert(DBAgent &dbAgent, DBAgentChecker &checker);
 void dbAgentTestUpsertWithPrimaryKeyAutoInc(
   DBAgent &dbAgent, DBAgentChecker &checker);
+void dbAgentTestInsertBatch(DBAgent &dbAgent, DBAgentChecker &checker);
+void dbAgentTestInsertBatchUpsert(DBAgent &dbAgent, DBAgentChecker &checker);
+void dbAgentTestInsertBatchAutoIncrement(
+  DBAgent &dbAgent, DBAgentChecker &checker);
 void dbAgentTestUpdate(DBAgent &dbAgent, DBAgentChecker &checker);
 void dbAgentTestUpdateBigUint(DBAgent &dbAgent, DBAgentChecker &checker);
 void dbAgentTestUpdateCondition(DBAgent &dbAgent, DBAgentChecker &checker);
@@ -115,6 +121,7 @@ void dbAgentTestSelect(DBAgent &dbAgent);
 void dbAgentTestSelectEx(DBAgent &dbAgent);
 void dbAgentTestSelectExWithCond(DBAgent &dbAgent);
 void dbAgentTestSelectExWithCondAllColumns(DBAgent &dbAgent);
+void dbAgentTestSelectExColumnar(DBAgent &dbAgent);
 void dbAgentTestSelectHeightOrder
  (DBAgent &dbAgent, size_t limit = 0, size_t offset = 0,
   size_t forceExpectedRows = (size_t)-1);
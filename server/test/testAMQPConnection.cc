@@ -117,6 +117,59 @@ namespace testAMQPConnection {
 		cppcut_assert_equal(false, connection->publish(message));
 	}
 
+	void test_ackWithoutConnection(void)
+	{
+		AMQPMessage message;
+		connection = getConnection();
+		cppcut_assert_equal(false, connection->ack(message));
+	}
+
+	void test_consumeBatch(void)
+	{
+		AMQPJSONMessage message;
+		AMQPPublisher publisher(getConnectionInfo());
+		for (int i = 0; i < 3; i++) {
+			message.body = StringUtils::sprintf("{\"id\":%d}", i);
+			publisher.setMessage(message);
+			cppcut_assert_equal(true, publisher.publish());
+		}
+
+		connection = getConnection();
+		cppcut_assert_equal(true, connection->connect());
+		cppcut_assert_equal(true, connection->startConsuming());
+		vector<AMQPMessage> messages;
+		cppcut_assert_equal((size_t)2,
+				    connection->consumeBatch(messages, 2, 2000));
+		cppcut_assert_equal((size_t)1,
+				    connection->consumeBatch(messages, 2, 2000));
+		cppcut_assert_equal((size_t)3, messages.size());
+		for (int i = 0; i < 3; i++) {
+			cppcut_assert_equal(
+			  StringUtils::sprintf("{\"id\":%d}", i),
+			  messages[i].body);
+		}
+	}
+
+	void test_ackWithPrefetchCount(void)
+	{
+		AMQPJSONMessage message;
+		message.body = "{\"body\":\"example\"}";
+		AMQPPublisher publisher(getConnectionInfo());
+		publisher.setMessage(message);
+		cppcut_assert_equal(true, publisher.publish());
+
+		AMQPConnectionInfo info(getConnectionInfo());
+		info.setPrefetchCount(1);
+		connection = AMQPConnection::create(info);
+		cppcut_assert_equal(true, connection->connect());
+		cppcut_assert_equal(true, connection->startConsuming());
+		vector<AMQPMessage> messages;
+		cppcut_assert_equal((size_t)1,
+				    connection->consumeBatch(messages, 1, 2000));
+		cppcut_assert_equal(message.body, messages[0].body);
+		cppcut_assert_equal(true, connection->ack(messages[0]));
+	}
+
 	void test_transferMessage(void)
 	{
 		AMQPJSONMessage message;
@@ -88,6 +88,11 @@ namespace defaultValue {
 	{
 		cppcut_assert_equal(string(""), info->getPublisherQueueName());
 	}
+
+	void test_prefetchCount(void)
+	{
+		cppcut_assert_equal((uint16_t)0, info->getPrefetchCount());
+	}
 }
 
 namespace setter {
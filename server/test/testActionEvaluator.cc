@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cppcutter.h>
+#include <gcutter.h>
+#include <thread>
+#include <vector>
+#include "Hatohol.h"
+#include "ActionEvaluator.h"
+#include "DBTablesTest.h"
+#include "Helpers.h"
+using namespace std;
+using namespace mlpl;
+
+namespace testActionEvaluator {
+
+static void getTestEventInfoList(EventInfoList &eventList)
+{
+	for (size_t i = 0; i < NumTestEventInfo; i++)
+		eventList.push_back(testEventInfo[i]);
+}
+
+void cut_setup(void)
+{
+	hatoholInit();
+	setupTestDB();
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_evaluateWithoutStart(void)
+{
+	ActionEvaluator evaluator;
+	EventInfoList eventList;
+	getTestEventInfoList(eventList);
+	evaluator.evaluate(eventList);
+
+	// Evaluated in this thread
+	ActionEvaluator::Statistics stat;
+	evaluator.getStatistics(stat);
+	cppcut_assert_equal(false, evaluator.isStarted());
+	cppcut_assert_equal((size_t)0, stat.numWorkers);
+	cppcut_assert_equal((uint64_t)0, stat.numQueuedEvents);
+}
+
+void test_startWithDefaultNumWorkers(void)
+{
+	ActionEvaluator evaluator;
+	evaluator.start();
+	ActionEvaluator::Statistics stat;
+	evaluator.getStatistics(stat);
+	cppcut_assert_equal(true, evaluator.isStarted());
+	cppcut_assert_equal(ActionEvaluator::DEFAULT_NUM_WORKERS,
+	                    stat.numWorkers);
+}
+
+void test_evaluateWithWorkers(void)
+{
+	ActionEvaluator evaluator;
+	evaluator.start(3);
+	EventInfoList eventList;
+	getTestEventInfoList(eventList);
+	evaluator.evaluate(eventList);
+
+	// Queued events are evaluated before the workers exit.
+	evaluator.stop();
+	ActionEvaluator::Statistics stat;
+	evaluator.getStatistics(stat);
+	cppcut_assert_equal(false, evaluator.isStarted());
+	cppcut_assert_equal((size_t)0, stat.numWorkers);
+	cppcut_assert_equal((size_t)0, stat.queueDepth);
+	cppcut_assert_equal((uint64_t)eventList.size(), stat.numQueuedEvents);
+	cppcut_assert_equal((uint64_t)eventList.size(),
+	                    stat.numEvaluatedEvents);
+}
+
+void test_evaluateFromMultipleThreads(void)
+{
+	const size_t numThreads = 4;
+	const size_t numCallsPerThread = 50;
+	ActionEvaluator evaluator;
+	evaluator.start(2);
+	EventInfoList eventList;
+	getTestEventInfoList(eventList);
+
+	vector<thread> threads;
+	for (size_t i = 0; i < numThreads; i++) {
+		threads.push_back(thread([&] {
+			for (size_t j = 0; j < numCallsPerThread; j++)
+				evaluator.evaluate(eventList);
+		}));
+	}
+	for (auto &t : threads)
+		t.join();
+	evaluator.stop();
+
+	// Each queued event is evaluated exactly once.
+	const uint64_t expected =
+	  numThreads * numCallsPerThread * eventList.size();
+	ActionEvaluator::Statistics stat;
+	evaluator.getStatistics(stat);
+	cppcut_assert_equal((size_t)0, stat.queueDepth);
+	cppcut_assert_equal(expected, stat.numQueuedEvents);
+	cppcut_assert_equal(expected, stat.numEvaluatedEvents);
+}
+
+} // namespace testActionEvaluator
@@ -1422,18 +1422,13 @@ void test_checkEventsWithMultipleIncidentSender(void)
 	EventInfoList eventList;
 	eventList.push_back(event);
 
-	// We get the first entry of the action list that is obtained by
-	// DBTablesAction::getActionList(). It changes depending on the
-	// storage engine. For example, HATOHOL_MYSQL_ENGINE_MEMORY=1
-	// is set, the first entry may be different from that w/o it.
+	// We get the first entry of the action list that is used by
+	// ActionManager::checkEvents().
 	//
 	// However, this way is not the best. The expected action ID
 	// may change when the implementation of Hatohol server is modified.
 	ActionDefList actionDefList;
-	ActionsQueryOption option(USER_ID_SYSTEM);
-	option.setActionType(ACTION_ALL);
-	option.setTargetEventInfo(&event);
-	dbAction.getActionList(actionDefList, option);
+	dbAction.getActionListForEvent(actionDefList, event);
 	cppcut_assert_equal(false, actionDefList.empty());
 	const ActionIdType expectedActionId = actionDefList.begin()->id;
 
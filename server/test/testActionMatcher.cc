@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cppcutter.h>
+#include "ActionMatcher.h"
+using namespace std;
+
+namespace testActionMatcher {
+
+static ActionDef makeActionDef(const ActionIdType &id,
+                               const ActionCondition &condition)
+{
+	ActionDef actionDef;
+	actionDef.id = id;
+	actionDef.condition = condition;
+	actionDef.type = ACTION_COMMAND;
+	actionDef.command = "/bin/true";
+	actionDef.timeout = 0;
+	actionDef.ownerUserId = USER_ID_SYSTEM;
+	return actionDef;
+}
+
+static EventInfo makeEventInfo(void)
+{
+	EventInfo eventInfo;
+	initEventInfo(eventInfo);
+	eventInfo.serverId       = 1;
+	eventInfo.hostIdInServer = "10";
+	eventInfo.triggerId      = "100";
+	eventInfo.status         = TRIGGER_STATUS_PROBLEM;
+	eventInfo.severity       = TRIGGER_SEVERITY_ERROR;
+	return eventInfo;
+}
+
+static string makeIdString(const ActionDefList &actionDefList)
+{
+	string s;
+	for (const auto &actionDef : actionDefList)
+		s += to_string(actionDef.id) + " ";
+	return s;
+}
+
+static void noHostgroup(HostgroupIdSet &hostgroupIdSet,
+                        const EventInfo &eventInfo)
+{
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_matchWithoutCondition(void)
+{
+	const ActionDefList actionDefList = {
+	  makeActionDef(1, ActionCondition()),
+	};
+	ActionMatcher matcher(actionDefList);
+	cppcut_assert_equal((size_t)1, matcher.getNumberOfActions());
+
+	ActionDefList matched;
+	matcher.match(matched, makeEventInfo(), noHostgroup);
+	cppcut_assert_equal(string("1 "), makeIdString(matched));
+}
+
+void test_matchInOrderOfId(void)
+{
+	const ActionDefList actionDefList = {
+	  makeActionDef(5, ActionCondition(ACTCOND_TRIGGER_ID,
+	                                   0, "", "", "100", 0, 0,
+	                                   CMP_INVALID)),
+	  makeActionDef(2, ActionCondition(ACTCOND_SERVER_ID,
+	                                   1, "", "", "", 0, 0,
+	                                   CMP_INVALID)),
+	  makeActionDef(3, ActionCondition(ACTCOND_HOST_ID,
+	                                   0, "11", "", "", 0, 0,
+	                                   CMP_INVALID)),
+	  makeActionDef(4, ActionCondition(ACTCOND_SERVER_ID |
+	                                   ACTCOND_HOST_ID,
+	                                   1, "10", "", "", 0, 0,
+	                                   CMP_INVALID)),
+	};
+	ActionMatcher matcher(actionDefList);
+	ActionDefList matched;
+	matcher.match(matched, makeEventInfo(), noHostgroup);
+	cppcut_assert_equal(string("2 4 5 "), makeIdString(matched));
+}
+
+void test_matchWithStatus(void)
+{
+	const ActionDefList actionDefList = {
+	  makeActionDef(1, ActionCondition(ACTCOND_TRIGGER_STATUS,
+	                                   0, "", "", "",
+	                                   TRIGGER_STATUS_OK, 0,
+	                                   CMP_INVALID)),
+	  makeActionDef(2, ActionCondition(ACTCOND_TRIGGER_STATUS,
+	                                   0, "", "", "",
+	                                   TRIGGER_STATUS_PROBLEM, 0,
+	                                   CMP_INVALID)),
+	};
+	ActionMatcher matcher(actionDefList);
+	ActionDefList matched;
+	matcher.match(matched, makeEventInfo(), noHostgroup);
+	cppcut_assert_equal(string("2 "), makeIdString(matched));
+}
+
+void test_matchWithSeverity(void)
+{
+	auto makeCond = [](const int &severity, const ComparisonType &cmp) {
+		return ActionCondition(ACTCOND_TRIGGER_SEVERITY,
+		                       0, "", "", "", 0, severity, cmp);
+	};
+	const ActionDefList actionDefList = {
+	  makeActionDef(1, makeCond(TRIGGER_SEVERITY_ERROR, CMP_EQ)),
+	  makeActionDef(2, makeCond(TRIGGER_SEVERITY_WARNING, CMP_EQ)),
+	  makeActionDef(3, makeCond(TRIGGER_SEVERITY_WARNING, CMP_EQ_GT)),
+	  makeActionDef(4, makeCond(TRIGGER_SEVERITY_ERROR, CMP_EQ_GT)),
+	  makeActionDef(5, makeCond(TRIGGER_SEVERITY_CRITICAL, CMP_EQ_GT)),
+	  makeActionDef(6, makeCond(TRIGGER_SEVERITY_ERROR, CMP_INVALID)),
+	};
+	ActionMatcher matcher(actionDefList);
+	ActionDefList matched;
+	matcher.match(matched, makeEventInfo(), noHostgroup);
+	cppcut_assert_equal(string("1 3 4 "), makeIdString(matched));
+}
+
+void test_matchWithHostgroup(void)
+{
+	const ActionDefList actionDefList = {
+	  makeActionDef(1, ActionCondition(ACTCOND_HOST_GROUP_ID,
+	                                   0, "", "3", "", 0, 0,
+	                                   CMP_INVALID)),
+	  makeActionDef(2, ActionCondition(ACTCOND_HOST_GROUP_ID,
+	                                   0, "", "4", "", 0, 0,
+	                                   CMP_INVALID)),
+	};
+	ActionMatcher matcher(actionDefList);
+	size_t numCalled = 0;
+	auto getHostgroupIdSet = [&](HostgroupIdSet &hostgroupIdSet,
+	                             const EventInfo &eventInfo) {
+		numCalled++;
+		hostgroupIdSet.insert("1");
+		hostgroupIdSet.insert("3");
+	};
+	ActionDefList matched;
+	matcher.match(matched, makeEventInfo(), getHostgroupIdSet);
+	cppcut_assert_equal(string("1 "), makeIdString(matched));
+	cppcut_assert_equal((size_t)1, numCalled);
+}
+
+void test_hostgroupIsNotQueriedWithoutCandidates(void)
+{
+	const ActionDefList actionDefList = {
+	  makeActionDef(1, ActionCondition(ACTCOND_SERVER_ID,
+	                                   1, "", "", "", 0, 0,
+	                                   CMP_INVALID)),
+	};
+	ActionMatcher matcher(actionDefList);
+	size_t numCalled = 0;
+	auto getHostgroupIdSet = [&](HostgroupIdSet &hostgroupIdSet,
+	                             const EventInfo &eventInfo) {
+		numCalled++;
+	};
+	ActionDefList matched;
+	matcher.match(matched, makeEventInfo(), getHostgroupIdSet);
+	cppcut_assert_equal(string("1 "), makeIdString(matched));
+	cppcut_assert_equal((size_t)0, numCalled);
+}
+
+} // namespace testActionMatcher
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cppcutter.h>
+#include "AuthorizationCache.h"
+#include "ThreadLocalDBCache.h"
+#include "Hatohol.h"
+#include "Helpers.h"
+#include "DBTablesTest.h"
+using namespace std;
+
+namespace testAuthorizationCache {
+
+static const UserIdType TEST_USER_ID = 1;
+
+void cut_setup(void)
+{
+	hatoholInit();
+	setupTestDB();
+	loadTestDBTablesConfig();
+	loadTestDBTablesUser();
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_getReturnsSharedEntry(void)
+{
+	AuthorizationCache::EntryPtr entry0 =
+	  AuthorizationCache::get(TEST_USER_ID);
+	AuthorizationCache::EntryPtr entry1 =
+	  AuthorizationCache::get(TEST_USER_ID);
+	cppcut_assert_equal(entry0.get(), entry1.get());
+	cppcut_assert_equal(TEST_USER_ID, entry0->getUserId());
+	cppcut_assert_equal((size_t)1, AuthorizationCache::getNumberOfEntries());
+}
+
+void test_getServerHostGrpSetMap(void)
+{
+	ServerHostGrpSetMap expected;
+	ThreadLocalDBCache cache;
+	cache.getUser().getServerHostGrpSetMap(expected, TEST_USER_ID);
+
+	AuthorizationCache::EntryPtr entry =
+	  AuthorizationCache::get(TEST_USER_ID);
+	cppcut_assert_equal(true, expected == entry->getServerHostGrpSetMap());
+}
+
+void test_invalidate(void)
+{
+	const uint64_t generation = AuthorizationCache::getGeneration();
+	AuthorizationCache::EntryPtr entry0 =
+	  AuthorizationCache::get(TEST_USER_ID);
+	AuthorizationCache::invalidate();
+	cppcut_assert_equal(generation + 1,
+	                    AuthorizationCache::getGeneration());
+	cppcut_assert_equal((size_t)0, AuthorizationCache::getNumberOfEntries());
+
+	AuthorizationCache::EntryPtr entry1 =
+	  AuthorizationCache::get(TEST_USER_ID);
+	cppcut_assert_not_equal(entry0.get(), entry1.get());
+}
+
+void test_addAccessInfoInvalidates(void)
+{
+	AuthorizationCache::EntryPtr entry0 =
+	  AuthorizationCache::get(TEST_USER_ID);
+	const ServerIdType newServerId = 12345;
+	cppcut_assert_equal(
+	  true, entry0->getServerHostGrpSetMap().find(newServerId) ==
+	        entry0->getServerHostGrpSetMap().end());
+
+	AccessInfo accessInfo;
+	accessInfo.id = 0;
+	accessInfo.userId = TEST_USER_ID;
+	accessInfo.serverId = newServerId;
+	accessInfo.hostgroupId = "7";
+	OperationPrivilege privilege(OperationPrivilege::ALL_PRIVILEGES);
+	ThreadLocalDBCache cache;
+	assertHatoholError(HTERR_OK,
+	                   cache.getUser().addAccessInfo(accessInfo, privilege));
+
+	AuthorizationCache::EntryPtr entry1 =
+	  AuthorizationCache::get(TEST_USER_ID);
+	const ServerHostGrpSetMap &srvHostGrpSetMap =
+	  entry1->getServerHostGrpSetMap();
+	auto it = srvHostGrpSetMap.find(newServerId);
+	cppcut_assert_equal(true, it != srvHostGrpSetMap.end());
+	cppcut_assert_equal((size_t)1, it->second.count("7"));
+}
+
+void test_getValidServerIdSetIsLoadedOncePerFlags(void)
+{
+	AuthorizationCache::EntryPtr entry =
+	  AuthorizationCache::get(TEST_USER_ID);
+	size_t numCalled = 0;
+	auto loader = [&](ServerIdSet &serverIdSet) {
+		numCalled++;
+		serverIdSet.insert(numCalled);
+	};
+	const OperationPrivilegeFlag flags0 = 0;
+	const OperationPrivilegeFlag flags1 =
+	  OperationPrivilege::makeFlag(OPPRVLG_GET_ALL_SERVER);
+
+	cppcut_assert_equal((size_t)1,
+	                    entry->getValidServerIdSet(flags0, loader).count(1));
+	cppcut_assert_equal((size_t)1,
+	                    entry->getValidServerIdSet(flags0, loader).count(1));
+	cppcut_assert_equal((size_t)1,
+	                    entry->getValidServerIdSet(flags1, loader).count(2));
+	cppcut_assert_equal((size_t)2, numCalled);
+}
+
+void test_getConditionIsMadeOnce(void)
+{
+	AuthorizationCache::EntryPtr entry =
+	  AuthorizationCache::get(TEST_USER_ID);
+	size_t numCalled = 0;
+	auto maker = [&] {
+		numCalled++;
+		return string("server_id IN (1,2)");
+	};
+	cppcut_assert_equal(string("server_id IN (1,2)"),
+	                    entry->getCondition("foo", maker));
+	cppcut_assert_equal(string("server_id IN (1,2)"),
+	                    entry->getCondition("foo", maker));
+	cppcut_assert_equal((size_t)1, numCalled);
+}
+
+} // namespace testAuthorizationCache
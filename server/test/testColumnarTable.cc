@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2014 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <gcutter.h>
+#include <cppcutter.h>
+#include "Helpers.h"
+#include "ColumnarTable.h"
+#include "Monitoring.h"
+using namespace std;
+using namespace mlpl;
+
+namespace testColumnarTable {
+
+static ColumnarTablePtr makeTestTable(void)
+{
+	vector<SQLColumnType> types = {
+	  SQL_COLUMN_TYPE_BIGUINT, SQL_COLUMN_TYPE_INT,
+	  SQL_COLUMN_TYPE_VARCHAR, SQL_COLUMN_TYPE_DOUBLE,
+	};
+	return ColumnarTablePtr(new ColumnarTable(types));
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_addAndGet(void)
+{
+	ColumnarTablePtr table = makeTestTable();
+	table->reserve(2);
+	table->addUint64(0xfedcba9876543210);
+	table->addInt(-3);
+	table->addString("dog", 3);
+	table->addDouble(0.5);
+	table->addUint64(5);
+	table->addInt(8);
+	table->addString("", 0);
+	table->addDouble(-1.03e5);
+
+	cppcut_assert_equal((size_t)2, table->getNumberOfRows());
+	cppcut_assert_equal((size_t)4, table->getNumberOfColumns());
+	cppcut_assert_equal((uint64_t)0xfedcba9876543210,
+	                    table->getUint64(0, 0));
+	cppcut_assert_equal(-3, table->getInt(0, 1));
+	cppcut_assert_equal(string("dog"), table->getString(0, 2));
+	cppcut_assert_equal(0.5, table->getDouble(0, 3));
+	cppcut_assert_equal((uint64_t)5, table->getUint64(1, 0));
+	cppcut_assert_equal(8, table->getInt(1, 1));
+	cppcut_assert_equal(string(""), table->getString(1, 2));
+	cppcut_assert_equal(-1.03e5, table->getDouble(1, 3));
+}
+
+void test_addFromString(void)
+{
+	ColumnarTablePtr table = makeTestTable();
+	const char *values[] = {"18446744073709551615", "-5", "cat", "3.25"};
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++)
+		table->addFromString(values[i], strlen(values[i]));
+
+	cppcut_assert_equal((size_t)1, table->getNumberOfRows());
+	cppcut_assert_equal((uint64_t)18446744073709551615UL,
+	                    table->getUint64(0, 0));
+	cppcut_assert_equal(-5, table->getInt(0, 1));
+	cppcut_assert_equal(string("cat"), table->getString(0, 2));
+	cppcut_assert_equal(3.25, table->getDouble(0, 3));
+}
+
+void test_addFromStringNull(void)
+{
+	ColumnarTablePtr table = makeTestTable();
+	for (size_t i = 0; i < table->getNumberOfColumns(); i++)
+		table->addFromString(NULL, 0);
+
+	cppcut_assert_equal((size_t)1, table->getNumberOfRows());
+	for (size_t i = 0; i < table->getNumberOfColumns(); i++)
+		cppcut_assert_equal(true, table->isNull(0, i));
+	cppcut_assert_equal((uint64_t)0, table->getUint64(0, 0));
+	cppcut_assert_equal(0, table->getInt(0, 1));
+	cppcut_assert_equal(string(""), table->getString(0, 2));
+	cppcut_assert_equal(0.0, table->getDouble(0, 3));
+}
+
+void test_typeMismatch(void)
+{
+	ColumnarTablePtr table = makeTestTable();
+	bool gotException = false;
+	try {
+		table->addInt(1);
+	} catch (const HatoholException &e) {
+		gotException = true;
+	}
+	cppcut_assert_equal(true, gotException);
+}
+
+void test_stream(void)
+{
+	ColumnarTablePtr table = makeTestTable();
+	for (int i = 0; i < 3; i++) {
+		const string name = StringUtils::sprintf("name%d", i);
+		table->addUint64(i * 10);
+		table->addInt(EVENT_TYPE_BAD);
+		table->addString(name.c_str(), name.size());
+		table->addDouble(i * 1.5);
+	}
+
+	ColumnarTableStream stream(*table, 0);
+	for (int i = 0; i < 3; i++) {
+		stream.setRow(i);
+		cppcut_assert_equal(false, stream.isNull());
+		uint64_t id;
+		EventType type;
+		string name;
+		double val;
+		stream >> id;
+		stream >> type;
+		stream >> name;
+		stream >> val;
+		cppcut_assert_equal((uint64_t)(i * 10), id);
+		cppcut_assert_equal(EVENT_TYPE_BAD, type);
+		cppcut_assert_equal(StringUtils::sprintf("name%d", i), name);
+		cppcut_assert_equal(i * 1.5, val);
+	}
+}
+
+void test_streamReadWithCast(void)
+{
+	ColumnarTablePtr table = makeTestTable();
+	table->addUint64(12345);
+	table->addInt(-7);
+	table->addString("67890", 5);
+	table->addDouble(0);
+
+	ColumnarTableStream stream(*table, 0);
+	cppcut_assert_equal(string("12345"), (stream.read<uint64_t, string>()));
+	cppcut_assert_equal(string("-7"), (stream.read<int, string>()));
+	cppcut_assert_equal((uint64_t)67890, (stream.read<string, uint64_t>()));
+}
+
+} // namespace testColumnarTable
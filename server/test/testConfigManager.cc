@@ -121,6 +121,21 @@ void test_parseTestModeEnabled(void)
 	cppcut_assert_equal(true, ConfigManager::getInstance()->isTestMode());
 }
 
+void test_parseAsyncLogDefault(void)
+{
+	cppcut_assert_equal(false,
+	                    ConfigManager::getInstance()->isAsyncLogEnabled());
+}
+
+void test_parseAsyncLogEnabled(void)
+{
+	CommandArgHelper cmds;
+	cmds << "--async-log";
+	cmds.activate();
+	cppcut_assert_equal(true,
+	                    ConfigManager::getInstance()->isAsyncLogEnabled());
+}
+
 void test_parseFaceRestPortDefault(void)
 {
 	cppcut_assert_equal(
@@ -286,4 +301,53 @@ void test_getFaceRestNumWorkers(void)
 	cppcut_assert_equal(expect, actual);
 }
 
+void test_setFaceRestMaxNumWorkers(void)
+{
+	const int maxNumWorkers = 20;
+	ConfigManager *mng = ConfigManager::getInstance();
+	mng->setFaceRestMaxNumWorkers(maxNumWorkers);
+	cppcut_assert_equal(maxNumWorkers, mng->getFaceRestMaxNumWorkers());
+}
+
+void test_setActionNumWorkers(void)
+{
+	const int numWorkers = 3;
+	ConfigManager *mng = ConfigManager::getInstance();
+	mng->setActionNumWorkers(numWorkers);
+	cppcut_assert_equal(numWorkers, mng->getActionNumWorkers());
+}
+
+void test_setJSONGateBatchSize(void)
+{
+	const int batchSize = 50;
+	ConfigManager *mng = ConfigManager::getInstance();
+	mng->setJSONGateBatchSize(batchSize);
+	cppcut_assert_equal(batchSize, mng->getJSONGateBatchSize());
+}
+
+void test_setJSONGateBatchIntervalMSec(void)
+{
+	const int intervalMSec = 200;
+	ConfigManager *mng = ConfigManager::getInstance();
+	mng->setJSONGateBatchIntervalMSec(intervalMSec);
+	cppcut_assert_equal(intervalMSec, mng->getJSONGateBatchIntervalMSec());
+}
+
+void test_setOnDemandFetchMaxRunningFetchers(void)
+{
+	const int numFetchers = 4;
+	ConfigManager *mng = ConfigManager::getInstance();
+	mng->setOnDemandFetchMaxRunningFetchers(numFetchers);
+	cppcut_assert_equal(numFetchers,
+	                    mng->getOnDemandFetchMaxRunningFetchers());
+}
+
+void test_setOnDemandFetchCacheTTLSec(void)
+{
+	const int cacheTTLSec = 30;
+	ConfigManager *mng = ConfigManager::getInstance();
+	mng->setOnDemandFetchCacheTTLSec(cacheTTLSec);
+	cppcut_assert_equal(cacheTTLSec, mng->getOnDemandFetchCacheTTLSec());
+}
+
 } // namespace testConfigManager
@@ -520,6 +520,19 @@ void test_insert(void)
 	dbAgentTestInsert(dbAgent, dbAgentChecker);
 }
 
+void test_insertWithoutPreparedStatement(void)
+{
+	DBAgentMySQL dbAgent(TEST_DB_NAME);
+	dbAgent.setPreparedStatementEnabled(false);
+	dbAgentTestInsert(dbAgent, dbAgentChecker);
+}
+
+void test_insertConvertedByColumnType(void)
+{
+	DBAgentMySQL dbAgent(TEST_DB_NAME);
+	dbAgentTestInsertConvertedByColumnType(dbAgent, dbAgentChecker);
+}
+
 void test_insertUint64_0x7fffffffffffffff(void)
 {
 	DBAgentMySQL dbAgent(TEST_DB_NAME);
@@ -550,12 +563,37 @@ void test_upsert(void)
 	dbAgentTestUpsert(dbAgent, dbAgentChecker);
 }
 
+void test_upsertWithoutPreparedStatement(void)
+{
+	DBAgentMySQL dbAgent(TEST_DB_NAME);
+	dbAgent.setPreparedStatementEnabled(false);
+	dbAgentTestUpsert(dbAgent, dbAgentChecker);
+}
+
 void test_upsertWithPrimaryKeyAutoInc(void)
 {
 	DBAgentMySQL dbAgent(TEST_DB_NAME);
 	dbAgentTestUpsertWithPrimaryKeyAutoInc(dbAgent, dbAgentChecker);
 }
 
+void test_insertBatch(void)
+{
+	DBAgentMySQL dbAgent(TEST_DB_NAME);
+	dbAgentTestInsertBatch(dbAgent, dbAgentChecker);
+}
+
+void test_insertBatchUpsert(void)
+{
+	DBAgentMySQL dbAgent(TEST_DB_NAME);
+	dbAgentTestInsertBatchUpsert(dbAgent, dbAgentChecker);
+}
+
+void test_insertBatchAutoIncrement(void)
+{
+	DBAgentMySQL dbAgent(TEST_DB_NAME);
+	dbAgentTestInsertBatchAutoIncrement(dbAgent, dbAgentChecker);
+}
+
 void test_update(void)
 {
 	DBAgentMySQL dbAgent(TEST_DB_NAME);
@@ -598,6 +636,12 @@ void test_selectExWithCondAllColumns(void)
 	dbAgentTestSelectExWithCondAllColumns(dbAgent);
 }
 
+void test_selectExColumnar(void)
+{
+	DBAgentMySQL dbAgent(TEST_DB_NAME);
+	dbAgentTestSelectExColumnar(dbAgent);
+}
+
 void test_selectExWithOrderBy(void)
 {
 	DBAgentMySQL dbAgent(TEST_DB_NAME);
@@ -451,6 +451,19 @@ void test_insert(void)
 	dbAgentTestInsert(dbAgent, dbAgentChecker);
 }
 
+void test_insertWithoutPreparedStatement(void)
+{
+	DBAgentSQLite3 dbAgent;
+	dbAgent.setPreparedStatementEnabled(false);
+	dbAgentTestInsert(dbAgent, dbAgentChecker);
+}
+
+void test_insertConvertedByColumnType(void)
+{
+	DBAgentSQLite3 dbAgent;
+	dbAgentTestInsertConvertedByColumnType(dbAgent, dbAgentChecker);
+}
+
 void test_insertUint64_0x7fffffffffffffff(void)
 {
 	DBAgentSQLite3 dbAgent;
@@ -481,12 +494,37 @@ void test_upsert(void)
 	dbAgentTestUpsert(dbAgent, dbAgentChecker);
 }
 
+void test_upsertWithoutPreparedStatement(void)
+{
+	DBAgentSQLite3 dbAgent;
+	dbAgent.setPreparedStatementEnabled(false);
+	dbAgentTestUpsert(dbAgent, dbAgentChecker);
+}
+
 void test_upsertWithPrimaryKeyAutoInc(void)
 {
 	DBAgentSQLite3 dbAgent;
 	dbAgentTestUpsertWithPrimaryKeyAutoInc(dbAgent, dbAgentChecker);
 }
 
+void test_insertBatch(void)
+{
+	DBAgentSQLite3 dbAgent;
+	dbAgentTestInsertBatch(dbAgent, dbAgentChecker);
+}
+
+void test_insertBatchUpsert(void)
+{
+	DBAgentSQLite3 dbAgent;
+	dbAgentTestInsertBatchUpsert(dbAgent, dbAgentChecker);
+}
+
+void test_insertBatchAutoIncrement(void)
+{
+	DBAgentSQLite3 dbAgent;
+	dbAgentTestInsertBatchAutoIncrement(dbAgent, dbAgentChecker);
+}
+
 void test_update(void)
 {
 	DBAgentSQLite3 dbAgent;
@@ -511,6 +549,13 @@ void test_selectEx(void)
 	dbAgentTestSelectEx(dbAgent);
 }
 
+void test_selectExWithoutPreparedStatement(void)
+{
+	DBAgentSQLite3 dbAgent;
+	dbAgent.setPreparedStatementEnabled(false);
+	dbAgentTestSelectEx(dbAgent);
+}
+
 void test_selectExWithCond(void)
 {
 	DBAgentSQLite3 dbAgent;
@@ -523,6 +568,12 @@ void test_selectExWithCondAllColumns(void)
 	dbAgentTestSelectExWithCondAllColumns(dbAgent);
 }
 
+void test_selectExColumnar(void)
+{
+	DBAgentSQLite3 dbAgent;
+	dbAgentTestSelectExColumnar(dbAgent);
+}
+
 void test_selectExWithOrderBy(void)
 {
 	DBAgentSQLite3 dbAgent;
@@ -768,6 +768,73 @@ void test_getTriggerActionListWithAllCondition(void)
 	assertEqual(testActionDef[idxTarget], actual);
 }
 
+void test_getActionListForEventWithAllCondition(void)
+{
+	loadTestDBAction();
+	loadTestDBHostgroupMember();
+
+	int idxTarget = 3;
+	const ActionCondition condTarget = testActionDef[idxTarget].condition;
+	EventInfo eventInfo;
+	initEventInfo(eventInfo);
+	eventInfo.serverId  = condTarget.serverId;
+	eventInfo.id        = "0";
+	eventInfo.triggerId = condTarget.triggerId;
+	eventInfo.status    = (TriggerStatusType) condTarget.triggerStatus;
+	eventInfo.severity  = (TriggerSeverityType) condTarget.triggerSeverity;
+	eventInfo.hostIdInServer = condTarget.hostIdInServer;
+
+	DECLARE_DBTABLES_ACTION(dbAction);
+	ActionDefList actionDefList;
+	dbAction.getActionListForEvent(actionDefList, eventInfo);
+	cppcut_assert_equal((size_t)1, actionDefList.size());
+	assertEqual(testActionDef[idxTarget], *actionDefList.begin());
+}
+
+void test_getActionListForEventAfterAddAndDelete(void)
+{
+	loadTestDBAction();
+
+	int idxTarget = 1;
+	const ActionCondition condTarget = testActionDef[idxTarget].condition;
+	EventInfo eventInfo;
+	initEventInfo(eventInfo);
+	eventInfo.serverId  = condTarget.serverId;
+	eventInfo.id        = "0";
+	eventInfo.triggerId = testActionDef[0].condition.triggerId;
+	eventInfo.status    = (TriggerStatusType) condTarget.triggerStatus;
+	eventInfo.severity  = (TriggerSeverityType) condTarget.triggerSeverity;
+	eventInfo.hostIdInServer = testActionDef[2].condition.hostIdInServer;
+
+	DECLARE_DBTABLES_ACTION(dbAction);
+	auto assertNumberOfActions = [&](const size_t &expected) {
+		ActionDefList actionDefList;
+		dbAction.getActionListForEvent(actionDefList, eventInfo);
+		cppcut_assert_equal(expected, actionDefList.size());
+	};
+	assertNumberOfActions(1);
+
+	// The in-memory index should be updated.
+	OperationPrivilege privilege(USER_ID_SYSTEM);
+	ActionDef actionDef = testActionDef[idxTarget];
+	assertHatoholError(HTERR_OK, dbAction.addAction(actionDef, privilege));
+	assertNumberOfActions(2);
+
+	actionDef.condition.triggerStatus++;
+	assertHatoholError(HTERR_OK,
+	                   dbAction.updateAction(actionDef, privilege));
+	assertNumberOfActions(1);
+
+	actionDef.condition.triggerStatus--;
+	assertHatoholError(HTERR_OK,
+	                   dbAction.updateAction(actionDef, privilege));
+	assertNumberOfActions(2);
+
+	const ActionIdList idList = {actionDef.id};
+	assertHatoholError(HTERR_OK, dbAction.deleteActions(idList, privilege));
+	assertNumberOfActions(1);
+}
+
 static void _assertGetActionWithSeverity(
   const TriggerSeverityType &severity,
   const int &targetActionIdx, const bool &expectFound = true)
@@ -804,12 +871,17 @@ static void _assertGetActionWithSeverity(
 	  HTERR_OK,
 	  dbAction.getActionList(actionDefList, option));
 
-	if (!expectFound) {
-		cppcut_assert_equal((size_t)0, actionDefList.size());
-	} else {
-		cppcut_assert_equal((size_t)1, actionDefList.size());
+	ActionDefList matchedActionDefList;
+	dbAction.getActionListForEvent(matchedActionDefList, eventInfo);
+
+	for (auto list : {&actionDefList, &matchedActionDefList}) {
+		if (!expectFound) {
+			cppcut_assert_equal((size_t)0, list->size());
+			continue;
+		}
+		cppcut_assert_equal((size_t)1, list->size());
 		// check the content
-		const ActionDef &actual = *actionDefList.begin();
+		const ActionDef &actual = *list->begin();
 		assertEqual(testActionDef[targetActionIdx], actual);
 	}
 }
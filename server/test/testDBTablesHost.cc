@@ -1131,6 +1131,40 @@ void test_getNumberOfHosts(void)
 	cppcut_assert_equal((size_t)NumTestServerHostDef, numberOfHosts);
 }
 
+void data_getNumberOfHostsEachServer(void)
+{
+	prepareForAllUserIds();
+}
+
+void test_getNumberOfHostsEachServer(gconstpointer data)
+{
+	const UserIdType userId = gcut_data_get_int(data, "userId");
+	loadTestDBUser();
+	loadTestDBServer();
+	loadTestDBAccessList();
+	loadTestDBServerHostDef();
+	loadTestDBHostgroupMember();
+	DECLARE_DBTABLES_HOST(dbHost);
+
+	HostsQueryOption option(userId);
+	ServerHostDefVect svHostDefVect;
+	assertHatoholError(HTERR_OK,
+	                   dbHost.getServerHostDefs(svHostDefVect, option));
+	map<ServerIdType, size_t> expectMap;
+	for (const auto &svHostDef : svHostDefVect)
+		expectMap[svHostDef.serverId]++;
+
+	map<ServerIdType, size_t> actualMap;
+	assertHatoholError(HTERR_OK,
+	                   dbHost.getNumberOfHostsEachServer(actualMap, option));
+	cppcut_assert_equal(expectMap.size(), actualMap.size());
+	for (const auto &expect : expectMap) {
+		cppcut_assert_equal(
+		  expect.second, actualMap[expect.first],
+		  cut_message("sv: %" FMT_SERVER_ID, expect.first));
+	}
+}
+
 void test_syncHostsMarkInvalid(void)
 {
 	loadTestDBServerHostDef();
@@ -1248,6 +1248,50 @@ void test_updateItemCategories()
 	}
 }
 
+void test_updateItemCategoriesWithList()
+{
+	const vector<string> categoriesArray[][2] = {
+		{{"DOG", "CAT"}, {"Bread"}},
+		{{"DOG"},        {"Bread", "CPU"}},
+		{{"(^_^)"},      {}},
+	};
+
+	auto toString = [] (vector<string> names) {
+		sort(names.begin(), names.end());
+		string str;
+		for (const auto &name : names)
+			str += name + "\n";
+		return str;
+	};
+
+	DECLARE_DBTABLES_MONITORING(dbMonitoring);
+	ItemsQueryOption option(USER_ID_SYSTEM);
+	option.setTargetServerId(testItemInfo[0].serverId);
+	ItemInfo itemInfo0 = testItemInfo[0];
+	ItemInfo itemInfo1 = testItemInfo[0];
+	itemInfo1.id += "-1";
+	for (const auto &categories: categoriesArray) {
+		ItemInfoList itemInfoList;
+		// The last one should be used for the duplicated item.
+		itemInfo0.categoryNames = {"Should be overwritten"};
+		itemInfoList.push_back(itemInfo0);
+		itemInfo0.categoryNames = categories[0];
+		itemInfoList.push_back(itemInfo0);
+		itemInfo1.categoryNames = categories[1];
+		itemInfoList.push_back(itemInfo1);
+		dbMonitoring.addItemInfoList(itemInfoList);
+
+		ItemInfoList actualItemInfoList;
+		dbMonitoring.getItemInfoList(actualItemInfoList, option);
+		cppcut_assert_equal((size_t)2, actualItemInfoList.size());
+		for (const auto &actual : actualItemInfoList) {
+			const size_t idx = (actual.id == itemInfo0.id) ? 0 : 1;
+			cppcut_assert_equal(toString(categories[idx]),
+			                    toString(actual.categoryNames));
+		}
+	}
+}
+
 void data_addEventInfoList(void)
 {
 	prepareTestDataExcludeDefunctServers();
@@ -1317,6 +1361,52 @@ void test_addDupEventInfoList(gconstpointer data)
 	assertGetEvents(arg);
 }
 
+void test_addEventInfoListWithTriggerInfoMerged(void)
+{
+	loadTestDBTriggers();
+
+	DECLARE_DBTABLES_MONITORING(dbMonitoring);
+	EventInfoList eventInfoList;
+	for (size_t i = 0; i < NumTestTriggerInfo; i++) {
+		const TriggerInfo &trigInfo = testTriggerInfo[i];
+		EventInfo eventInfo;
+		initEventInfo(eventInfo);
+		eventInfo.serverId = trigInfo.serverId;
+		eventInfo.id = StringUtils::sprintf("%zd", i);
+		eventInfo.type = EVENT_TYPE_BAD;
+		eventInfo.triggerId = trigInfo.id;
+		eventInfo.status = TRIGGER_STATUS_PROBLEM;
+		eventInfoList.push_back(eventInfo);
+	}
+	// The values in the event have priority over the trigger.
+	eventInfoList.front().brief = "Given brief";
+	// No trigger for this event
+	EventInfo unknownEventInfo = eventInfoList.back();
+	unknownEventInfo.id = "unknown";
+	unknownEventInfo.triggerId = "No such trigger";
+	eventInfoList.push_back(unknownEventInfo);
+
+	dbMonitoring.addEventInfoList(eventInfoList);
+
+	auto eventInfo = eventInfoList.begin();
+	for (size_t i = 0; i < NumTestTriggerInfo; i++, ++eventInfo) {
+		const TriggerInfo &trigInfo = testTriggerInfo[i];
+		cppcut_assert_equal(trigInfo.severity, eventInfo->severity);
+		cppcut_assert_equal(trigInfo.globalHostId,
+		                    eventInfo->globalHostId);
+		cppcut_assert_equal(trigInfo.hostIdInServer,
+		                    eventInfo->hostIdInServer);
+		cppcut_assert_equal(trigInfo.hostName, eventInfo->hostName);
+		cppcut_assert_equal(i == 0 ? string("Given brief") :
+		                             trigInfo.brief,
+		                    eventInfo->brief);
+		cppcut_assert_equal(trigInfo.extendedInfo,
+		                    eventInfo->extendedInfo);
+	}
+	cppcut_assert_equal(TRIGGER_SEVERITY_UNKNOWN, eventInfo->severity);
+	cppcut_assert_equal(string(""), eventInfo->brief);
+}
+
 void data_getLastEventId(void)
 {
 	prepareTestDataExcludeDefunctServers();
@@ -1536,6 +1626,73 @@ void test_getNumberOfBadHostsWithOneAuthorizedServer(void)
 	assertGetNumberOfHostsWithUserAndStatus(userId, false);
 }
 
+void test_getTriggerStatistics(void)
+{
+	loadTestDBTriggers();
+	loadTestDBHostgroupMember();
+
+	DECLARE_DBTABLES_MONITORING(dbMonitoring);
+	DBTablesMonitoring::ServerTriggerStatisticsMap statisticsMap;
+	TriggersQueryOption option(USER_ID_SYSTEM);
+	dbMonitoring.getTriggerStatistics(statisticsMap, option);
+	cppcut_assert_equal(false, statisticsMap.empty());
+
+	for (auto &serverStatPair : statisticsMap) {
+		const ServerIdType &serverId = serverStatPair.first;
+		auto &serverStat = serverStatPair.second;
+		TriggersQueryOption serverOption(USER_ID_SYSTEM);
+		serverOption.setTargetServerId(serverId);
+		cppcut_assert_equal(
+		  dbMonitoring.getNumberOfTriggers(serverOption),
+		  serverStat.numTriggers,
+		  cut_message("sv: %" FMT_SERVER_ID, serverId));
+
+		cppcut_assert_equal(
+		  static_cast<size_t>(1),
+		  serverStat.hostgroups.count(ALL_HOST_GROUPS));
+		for (auto &hgrpStatPair : serverStat.hostgroups) {
+			const HostgroupIdType &hostgroupId =
+			  hgrpStatPair.first;
+			auto &stat = hgrpStatPair.second;
+			TriggersQueryOption hgrpOption(USER_ID_SYSTEM);
+			hgrpOption.setTargetServerId(serverId);
+			hgrpOption.setTargetHostgroupId(hostgroupId);
+			const string msg = StringUtils::sprintf(
+			  "sv: %" FMT_SERVER_ID ", "
+			  "hostgroup: %" FMT_HOST_GROUP_ID,
+			  serverId, hostgroupId.c_str());
+			cppcut_assert_equal(
+			  dbMonitoring.getNumberOfHosts(hgrpOption),
+			  stat.numHosts, cut_message("%s", msg.c_str()));
+			cppcut_assert_equal(
+			  dbMonitoring.getNumberOfBadHosts(hgrpOption),
+			  stat.numBadHosts, cut_message("%s", msg.c_str()));
+			for (int i = 0; i < NUM_TRIGGER_SEVERITY; i++) {
+				const TriggerSeverityType severity =
+				  static_cast<TriggerSeverityType>(i);
+				cppcut_assert_equal(
+				  dbMonitoring.getNumberOfBadTriggers(
+				    hgrpOption, severity),
+				  stat.numBadTriggers[i],
+				  cut_message("%s, severity: %d",
+				              msg.c_str(), i));
+			}
+		}
+	}
+}
+
+void test_getTriggerStatisticsWithNoAuthorizedServer(void)
+{
+	loadTestDBTriggers();
+
+	DECLARE_DBTABLES_MONITORING(dbMonitoring);
+	DBTablesMonitoring::ServerTriggerStatisticsMap statisticsMap;
+	const UserIdType userId = 4;
+	TriggersQueryOption option(userId);
+	dbMonitoring.getTriggerStatistics(statisticsMap, option);
+	cppcut_assert_equal(true, statisticsMap.empty());
+}
+
 void test_getEventSortAscending(void)
 {
 	prepareTestDataExcludeDefunctServers();
@@ -1655,6 +1812,167 @@ void test_getEventWithSortTimeDescending(gconstpointer data)
 	assertGetEventsWithFilter(arg);
 }
 
+static void _assertGetEventsWithCursor(
+  const EventsQueryOption::SortType &sortType,
+  const DataQueryOption::SortDirection &sortDirection)
+{
+	loadTestDBEvents();
+	DECLARE_DBTABLES_MONITORING(dbMonitoring);
+
+	EventsQueryOption option(USER_ID_SYSTEM);
+	option.setSortType(sortType, sortDirection);
+	EventInfoList expectedList;
+	assertHatoholError(HTERR_OK,
+	                   dbMonitoring.getEventInfoList(expectedList, option));
+	cppcut_assert_equal(true, expectedList.size() > 2);
+	string expected;
+	for (const auto &eventInfo : expectedList)
+		expected += makeEventOutput(eventInfo);
+
+	// Concatenated pages should be the same as the whole list.
+	string actual;
+	string cursor;
+	for (size_t numPages = 0; ; numPages++) {
+		cppcut_assert_equal(true, numPages <= expectedList.size());
+		EventsQueryOption pageOption(USER_ID_SYSTEM);
+		pageOption.setSortType(sortType, sortDirection);
+		pageOption.setMaximumNumber(2);
+		if (!cursor.empty())
+			cppcut_assert_equal(true, pageOption.setCursor(cursor));
+		EventInfoList page;
+		assertHatoholError(HTERR_OK,
+		                   dbMonitoring.getEventInfoList(page,
+		                                                 pageOption));
+		if (page.empty())
+			break;
+		for (const auto &eventInfo : page)
+			actual += makeEventOutput(eventInfo);
+		cursor = pageOption.makeCursor(page.back());
+	}
+	cppcut_assert_equal(expected, actual);
+}
+#define assertGetEventsWithCursor(T,D) \
+  cut_trace(_assertGetEventsWithCursor(T,D))
+
+void test_getEventWithCursorSortUnifiedIdAscending(void)
+{
+	assertGetEventsWithCursor(EventsQueryOption::SORT_UNIFIED_ID,
+	                          DataQueryOption::SORT_ASCENDING);
+}
+
+void test_getEventWithCursorSortUnifiedIdDescending(void)
+{
+	assertGetEventsWithCursor(EventsQueryOption::SORT_UNIFIED_ID,
+	                          DataQueryOption::SORT_DESCENDING);
+}
+
+void test_getEventWithCursorSortTimeAscending(void)
+{
+	assertGetEventsWithCursor(EventsQueryOption::SORT_TIME,
+	                          DataQueryOption::SORT_ASCENDING);
+}
+
+void test_getEventWithCursorSortTimeDescending(void)
+{
+	assertGetEventsWithCursor(EventsQueryOption::SORT_TIME,
+	                          DataQueryOption::SORT_DESCENDING);
+}
+
+void test_setInvalidEventCursor(void)
+{
+	EventsQueryOption option(USER_ID_SYSTEM);
+	option.setSortType(EventsQueryOption::SORT_TIME,
+	                   DataQueryOption::SORT_DESCENDING);
+	cppcut_assert_equal(false, option.setCursor("U5"));
+	cppcut_assert_equal(false, option.setCursor("T1.2"));
+	cppcut_assert_equal(false, option.setCursor("T1.2.3x"));
+	cppcut_assert_equal(true, option.setCursor("T1.2.3"));
+}
+
+void test_getItemsWithSeekPosition(void)
+{
+	loadTestDBItems();
+	DECLARE_DBTABLES_MONITORING(dbMonitoring);
+
+	ItemsQueryOption option(USER_ID_SYSTEM);
+	option.setSeekPosition(0);
+	ItemInfoList expectedList;
+	dbMonitoring.getItemInfoList(expectedList, option);
+	cppcut_assert_equal(true, expectedList.size() > 2);
+	string expected;
+	for (const auto &itemInfo : expectedList)
+		expected += makeItemOutput(itemInfo);
+
+	string actual;
+	GenericIdType lastGlobalId = 0;
+	for (size_t numPages = 0; ; numPages++) {
+		cppcut_assert_equal(true, numPages <= expectedList.size());
+		ItemsQueryOption pageOption(USER_ID_SYSTEM);
+		pageOption.setMaximumNumber(2);
+		pageOption.setSeekPosition(lastGlobalId);
+		ItemInfoList page;
+		dbMonitoring.getItemInfoList(page, pageOption);
+		if (page.empty())
+			break;
+		for (const auto &itemInfo : page) {
+			cppcut_assert_equal(true, itemInfo.globalId > lastGlobalId);
+			actual += makeItemOutput(itemInfo);
+		}
+		lastGlobalId = page.back().globalId;
+	}
+	cppcut_assert_equal(expected, actual);
+}
+
+void test_hasSeekPosition(void)
+{
+	ItemsQueryOption option(USER_ID_SYSTEM);
+	cppcut_assert_equal(false, option.hasSeekPosition());
+	option.setSeekPosition(0);
+	cppcut_assert_equal(true, option.hasSeekPosition());
+}
+
+void test_getTriggersWithCursor(void)
+{
+	loadTestDBTriggers();
+	DECLARE_DBTABLES_MONITORING(dbMonitoring);
+
+	TriggersQueryOption option(USER_ID_SYSTEM);
+	cppcut_assert_equal(true, option.setCursor(""));
+	TriggerInfoList expectedList;
+	dbMonitoring.getTriggerInfoList(expectedList, option);
+	cppcut_assert_equal(true, expectedList.size() > 2);
+	string expected;
+	for (const auto &triggerInfo : expectedList)
+		expected += makeTriggerOutput(triggerInfo);
+
+	// Concatenated pages should be the same as the whole list.
+	string actual;
+	string cursor;
+	for (size_t numPages = 0; ; numPages++) {
+		cppcut_assert_equal(true, numPages <= expectedList.size());
+		TriggersQueryOption pageOption(USER_ID_SYSTEM);
+		pageOption.setMaximumNumber(2);
+		cppcut_assert_equal(true, pageOption.setCursor(cursor));
+		TriggerInfoList page;
+		dbMonitoring.getTriggerInfoList(page, pageOption);
+		if (page.empty())
+			break;
+		for (const auto &triggerInfo : page)
+			actual += makeTriggerOutput(triggerInfo);
+		cursor = pageOption.makeCursor(page.back());
+	}
+	cppcut_assert_equal(expected, actual);
+}
+
+void test_setInvalidTriggerCursor(void)
+{
+	TriggersQueryOption option(USER_ID_SYSTEM);
+	cppcut_assert_equal(false, option.setCursor("1"));
+	cppcut_assert_equal(false, option.setCursor("x:1"));
+	cppcut_assert_equal(false, option.setCursor("-1:1"));
+	cppcut_assert_equal(true, option.setCursor("1:a:b"));
+}
+
 void data_getEventWithOffsetWithoutLimit(void)
 {
 	prepareTestDataExcludeDefunctServers();
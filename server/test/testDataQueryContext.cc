@@ -64,4 +64,21 @@ void test_getValidServerIdSet(void)
 	cppcut_assert_not_null(&svIdSet);
 }
 
+void test_shareServerHostGrpSetMapAmongContexts(void)
+{
+	DataQueryContextPtr dqctx0 = setupAndCreateDataQueryContext();
+	DataQueryContextPtr dqctx1 = setupAndCreateDataQueryContext();
+	cppcut_assert_equal(&dqctx0->getServerHostGrpSetMap(),
+	                    &dqctx1->getServerHostGrpSetMap());
+}
+
+void test_isValidServer(void)
+{
+	DataQueryContextPtr dqctx = setupAndCreateDataQueryContext();
+	const ServerIdSet &svIdSet = dqctx->getValidServerIdSet();
+	cppcut_assert_equal(false, svIdSet.empty());
+	cppcut_assert_equal(true, dqctx->isValidServer(*svIdSet.begin()));
+	cppcut_assert_equal(false, dqctx->isValidServer(-1));
+}
+
 } // namespace testDataQueryContext
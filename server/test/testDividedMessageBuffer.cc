@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cppcutter.h>
+#include "DividedMessageBuffer.h"
+using namespace std;
+
+namespace testDividedMessageBuffer {
+
+typedef list<string> StringList;
+typedef DividedMessageBuffer<StringList> StringListBuffer;
+typedef DividedMessageBuffer<vector<int>> IntVectorBuffer;
+
+static const size_t MAX_BYTES = 1024 * 1024;
+static const size_t TIMEOUT_MSEC = 60 * 1000;
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_appendAndTakeList(void)
+{
+	StringListBuffer buffer(MAX_BYTES, TIMEOUT_MSEC);
+	cppcut_assert_equal(StringListBuffer::APPENDED,
+	                    buffer.append("req", 0, StringList{"a", "b"}));
+	cppcut_assert_equal(StringListBuffer::APPENDED,
+	                    buffer.append("req", 1, StringList{"c"}));
+	cppcut_assert_equal((size_t)1, buffer.getNumberOfRequests());
+
+	StringList message;
+	cppcut_assert_equal(true, buffer.take("req", message));
+	cppcut_assert_equal(true, (StringList{"a", "b", "c"}) == message);
+	cppcut_assert_equal((size_t)0, buffer.getNumberOfRequests());
+	cppcut_assert_equal((size_t)0, buffer.getNumberOfBufferedBytes());
+}
+
+void test_appendAndTakeVector(void)
+{
+	IntVectorBuffer buffer(MAX_BYTES, TIMEOUT_MSEC);
+	buffer.append("req", 0, vector<int>{1, 2});
+	buffer.append("req", 1, vector<int>{3});
+	buffer.append("req", 2, vector<int>{4, 5});
+
+	vector<int> message;
+	cppcut_assert_equal(true, buffer.take("req", message));
+	const vector<int> expected = {1, 2, 3, 4, 5};
+	cppcut_assert_equal(true, expected == message);
+}
+
+void test_requestsAreIndependent(void)
+{
+	IntVectorBuffer buffer(MAX_BYTES, TIMEOUT_MSEC);
+	buffer.append("req1", 0, vector<int>{1});
+	buffer.append("req2", 0, vector<int>{10});
+	buffer.append("req1", 1, vector<int>{2});
+	cppcut_assert_equal((size_t)2, buffer.getNumberOfRequests());
+
+	vector<int> message;
+	cppcut_assert_equal(true, buffer.take("req1", message));
+	cppcut_assert_equal(true, (vector<int>{1, 2}) == message);
+	cppcut_assert_equal((size_t)1, buffer.getNumberOfRequests());
+}
+
+void test_takeUnknownRequest(void)
+{
+	IntVectorBuffer buffer(MAX_BYTES, TIMEOUT_MSEC);
+	vector<int> message;
+	cppcut_assert_equal(false, buffer.take("unknown", message));
+}
+
+void test_invalidSerialId(void)
+{
+	IntVectorBuffer buffer(MAX_BYTES, TIMEOUT_MSEC);
+	buffer.append("req", 0, vector<int>{1});
+
+	uint64_t expectedSerialId = 0;
+	cppcut_assert_equal(IntVectorBuffer::INVALID_SERIAL_ID,
+	                    buffer.append("req", 2, vector<int>{2},
+	                                  &expectedSerialId));
+	cppcut_assert_equal((uint64_t)1, expectedSerialId);
+	// The request is dropped.
+	cppcut_assert_equal((size_t)0, buffer.getNumberOfRequests());
+	cppcut_assert_equal((size_t)0, buffer.getNumberOfBufferedBytes());
+}
+
+void test_firstSerialIdMustBeZero(void)
+{
+	IntVectorBuffer buffer(MAX_BYTES, TIMEOUT_MSEC);
+	cppcut_assert_equal(IntVectorBuffer::INVALID_SERIAL_ID,
+	                    buffer.append("req", 1, vector<int>{1}));
+	cppcut_assert_equal((size_t)0, buffer.getNumberOfRequests());
+}
+
+void test_tooLarge(void)
+{
+	IntVectorBuffer buffer(4 * sizeof(int), TIMEOUT_MSEC);
+	buffer.append("req1", 0, vector<int>{1, 2, 3});
+	cppcut_assert_equal(3 * sizeof(int), buffer.getNumberOfBufferedBytes());
+
+	cppcut_assert_equal(IntVectorBuffer::TOO_LARGE,
+	                    buffer.append("req2", 0, vector<int>{4, 5}));
+	cppcut_assert_equal(IntVectorBuffer::TOO_LARGE,
+	                    buffer.append("req1", 1, vector<int>{4, 5}));
+	// Both requests are dropped.
+	cppcut_assert_equal((size_t)0, buffer.getNumberOfRequests());
+	cppcut_assert_equal((size_t)0, buffer.getNumberOfBufferedBytes());
+}
+
+void test_expire(void)
+{
+	IntVectorBuffer buffer(MAX_BYTES, TIMEOUT_MSEC);
+	buffer.append("req1", 0, vector<int>{1});
+	buffer.append("req2", 0, vector<int>{2});
+
+	const gint64 now = g_get_monotonic_time();
+	cppcut_assert_equal((size_t)0, buffer.expire(now));
+	cppcut_assert_equal((size_t)2,
+	                    buffer.expire(now + TIMEOUT_MSEC * 1000 + 1));
+	cppcut_assert_equal((size_t)0, buffer.getNumberOfRequests());
+}
+
+void test_setTimeout(void)
+{
+	IntVectorBuffer buffer(MAX_BYTES, TIMEOUT_MSEC);
+	buffer.append("req", 0, vector<int>{1});
+	buffer.setTimeout(10);
+
+	const gint64 now = g_get_monotonic_time();
+	cppcut_assert_equal((size_t)1, buffer.expire(now + 10 * 1000 + 1));
+	cppcut_assert_equal((size_t)0, buffer.getNumberOfRequests());
+}
+
+void test_erase(void)
+{
+	IntVectorBuffer buffer(MAX_BYTES, TIMEOUT_MSEC);
+	buffer.append("req", 0, vector<int>{1});
+	cppcut_assert_equal(true, buffer.erase("req"));
+	cppcut_assert_equal(false, buffer.erase("req"));
+	cppcut_assert_equal((size_t)0, buffer.getNumberOfBufferedBytes());
+}
+
+} // namespace testDividedMessageBuffer
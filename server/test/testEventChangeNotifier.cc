@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cppcutter.h>
+#include "EventChangeNotifier.h"
+#include "Hatohol.h"
+#include "Helpers.h"
+#include "DBTablesTest.h"
+#include "ThreadLocalDBCache.h"
+using namespace std;
+
+namespace testEventChangeNotifier {
+
+void cut_setup(void)
+{
+	EventChangeNotifier::reset();
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_notify(void)
+{
+	size_t numCalled = 0;
+	EventChangeNotifier::WaiterId id;
+	const uint64_t generation = EventChangeNotifier::getGeneration();
+	cppcut_assert_equal(
+	  true, EventChangeNotifier::addWaiter(
+	          generation, [&] { numCalled++; }, id));
+	cppcut_assert_equal((size_t)1,
+	                    EventChangeNotifier::getNumberOfWaiters());
+
+	EventChangeNotifier::notify();
+	cppcut_assert_equal((size_t)1, numCalled);
+	cppcut_assert_equal(generation + 1,
+	                    EventChangeNotifier::getGeneration());
+	cppcut_assert_equal((size_t)0,
+	                    EventChangeNotifier::getNumberOfWaiters());
+
+	// The waiter is called only once.
+	EventChangeNotifier::notify();
+	cppcut_assert_equal((size_t)1, numCalled);
+}
+
+void test_addWaiterWithOldGeneration(void)
+{
+	const uint64_t generation = EventChangeNotifier::getGeneration();
+	EventChangeNotifier::notify();
+
+	bool called = false;
+	EventChangeNotifier::WaiterId id;
+	cppcut_assert_equal(
+	  false, EventChangeNotifier::addWaiter(
+	           generation, [&] { called = true; }, id));
+	cppcut_assert_equal((size_t)0,
+	                    EventChangeNotifier::getNumberOfWaiters());
+	EventChangeNotifier::notify();
+	cppcut_assert_equal(false, called);
+}
+
+void test_removeWaiter(void)
+{
+	bool called = false;
+	EventChangeNotifier::WaiterId id;
+	EventChangeNotifier::addWaiter(EventChangeNotifier::getGeneration(),
+	                               [&] { called = true; }, id);
+	cppcut_assert_equal(true, EventChangeNotifier::removeWaiter(id));
+	cppcut_assert_equal(false, EventChangeNotifier::removeWaiter(id));
+	EventChangeNotifier::notify();
+	cppcut_assert_equal(false, called);
+}
+
+void test_removeNotifiedWaiter(void)
+{
+	EventChangeNotifier::WaiterId id;
+	EventChangeNotifier::addWaiter(EventChangeNotifier::getGeneration(),
+	                               [] {}, id);
+	EventChangeNotifier::notify();
+	cppcut_assert_equal(false, EventChangeNotifier::removeWaiter(id));
+}
+
+void test_waiterIdIsNotReused(void)
+{
+	const uint64_t generation = EventChangeNotifier::getGeneration();
+	EventChangeNotifier::WaiterId id0, id1;
+	EventChangeNotifier::addWaiter(generation, [] {}, id0);
+	EventChangeNotifier::removeWaiter(id0);
+	EventChangeNotifier::addWaiter(generation, [] {}, id1);
+	cppcut_assert_not_equal(id0, id1);
+}
+
+void test_addWaiterInCallback(void)
+{
+	EventChangeNotifier::WaiterId id;
+	size_t numCalled = 0;
+	function<void (void)> callback = [&] {
+		numCalled++;
+		EventChangeNotifier::WaiterId newId;
+		EventChangeNotifier::addWaiter(
+		  EventChangeNotifier::getGeneration(), callback, newId);
+	};
+	EventChangeNotifier::addWaiter(EventChangeNotifier::getGeneration(),
+	                               callback, id);
+	EventChangeNotifier::notify();
+	cppcut_assert_equal((size_t)1, numCalled);
+	cppcut_assert_equal((size_t)1,
+	                    EventChangeNotifier::getNumberOfWaiters());
+	EventChangeNotifier::notify();
+	cppcut_assert_equal((size_t)2, numCalled);
+}
+
+void test_addEventInfoListNotifies(void)
+{
+	hatoholInit();
+	setupTestDB();
+	loadTestDBTablesConfig();
+
+	const uint64_t generation = EventChangeNotifier::getGeneration();
+	ThreadLocalDBCache cache;
+	EventInfoList eventInfoList;
+	eventInfoList.push_back(testEventInfo[0]);
+	cache.getMonitoring().addEventInfoList(eventInfoList);
+	cppcut_assert_equal(generation + 1,
+	                    EventChangeNotifier::getGeneration());
+}
+
+} // namespace testEventChangeNotifier
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <cppcutter.h>
+#include <mutex>
+#include <vector>
+#include "EventCoalescer.h"
+using namespace std;
+
+namespace testEventCoalescer {
+
+struct BatchRecorder {
+	mutex          lock;
+	vector<size_t> batchSizes;
+	EventInfoList  events;
+
+	EventCoalescer::FlushFunc getFlushFunc(void)
+	{
+		return [this](EventInfoList &eventList) {
+			lock_guard<mutex> guard(lock);
+			batchSizes.push_back(eventList.size());
+			events.splice(events.end(), eventList);
+		};
+	}
+
+	size_t getNumberOfEvents(void)
+	{
+		lock_guard<mutex> guard(lock);
+		return events.size();
+	}
+};
+
+static EventInfo makeEvent(const size_t &index)
+{
+	EventInfo eventInfo;
+	initEventInfo(eventInfo);
+	eventInfo.id = to_string(index);
+	return eventInfo;
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_defaultParameters(void)
+{
+	BatchRecorder recorder;
+	EventCoalescer coalescer(recorder.getFlushFunc());
+	cppcut_assert_equal(EventCoalescer::DEFAULT_MAX_BATCH_SIZE,
+	                    coalescer.getMaxBatchSize());
+	cppcut_assert_equal(EventCoalescer::DEFAULT_FLUSH_INTERVAL_MSEC,
+	                    coalescer.getFlushIntervalMSec());
+}
+
+void test_flushFullBatch(void)
+{
+	BatchRecorder recorder;
+	// The interval is long enough not to cause a timed flush.
+	EventCoalescer coalescer(recorder.getFlushFunc(), 3, 60 * 1000);
+	for (size_t i = 0; i < 7; i++)
+		coalescer.add(makeEvent(i));
+	cppcut_assert_equal(true, (vector<size_t>{3, 3}) == recorder.batchSizes);
+
+	coalescer.flush();
+	cppcut_assert_equal(true,
+	                    (vector<size_t>{3, 3, 1}) == recorder.batchSizes);
+	size_t index = 0;
+	for (auto &eventInfo : recorder.events)
+		cppcut_assert_equal(to_string(index++), eventInfo.id);
+
+	EventCoalescer::Statistics stat;
+	coalescer.getStatistics(stat);
+	cppcut_assert_equal((uint64_t)3, stat.numFlushes);
+	cppcut_assert_equal((uint64_t)7, stat.numEvents);
+	cppcut_assert_equal((size_t)3, stat.maxBatchSize);
+	cppcut_assert_equal(true,
+	                    stat.maxFlushLatencyUSec <= stat.totalFlushLatencyUSec);
+}
+
+void test_flushAfterInterval(void)
+{
+	BatchRecorder recorder;
+	EventCoalescer coalescer(recorder.getFlushFunc(), 100, 10);
+	coalescer.start();
+	coalescer.add(makeEvent(0));
+	coalescer.add(makeEvent(1));
+
+	const gint64 timeout = g_get_monotonic_time() + 5 * G_USEC_PER_SEC;
+	while (recorder.getNumberOfEvents() < 2 &&
+	       g_get_monotonic_time() < timeout)
+		g_usleep(1000);
+	cppcut_assert_equal((size_t)2, recorder.getNumberOfEvents());
+
+	EventCoalescer::Statistics stat;
+	coalescer.getStatistics(stat);
+	cppcut_assert_equal((uint64_t)1, stat.numFlushes);
+	cppcut_assert_equal(true, stat.maxFlushLatencyUSec >= 10 * 1000);
+}
+
+void test_flushRemainingEventsOnDestruction(void)
+{
+	BatchRecorder recorder;
+	{
+		EventCoalescer coalescer(recorder.getFlushFunc(), 100,
+		                         60 * 1000);
+		coalescer.start();
+		coalescer.add(makeEvent(0));
+	}
+	cppcut_assert_equal((size_t)1, recorder.getNumberOfEvents());
+}
+
+void test_globalStatistics(void)
+{
+	EventCoalescer::Statistics before, after;
+	EventCoalescer::getGlobalStatistics(before);
+	BatchRecorder recorder;
+	EventCoalescer coalescer(recorder.getFlushFunc(), 2, 60 * 1000);
+	coalescer.add(makeEvent(0));
+	coalescer.add(makeEvent(1));
+	EventCoalescer::getGlobalStatistics(after);
+	cppcut_assert_equal(before.numFlushes + 1, after.numFlushes);
+	cppcut_assert_equal(before.numEvents + 2, after.numEvents);
+}
+
+} // namespace testEventCoalescer
@@ -18,6 +18,8 @@
  */
 
 #include <cppcutter.h>
+#include <thread>
+#include <unistd.h>
 #include "Hatohol.h"
 #include "FaceRest.h"
 #include "Helpers.h"
@@ -243,6 +245,9 @@ static void _assertTriggers(
 		parser->endElement();
 	}
 	parser->endObject();
+	string nextCursor;
+	cppcut_assert_equal(expectedNumTrig > 0,
+	                    parser->read("nextCursor", nextCursor));
 	assertHostsIdNameHashInParser(testTriggerInfo, expectedNumTrig, parser);
 	assertServersIdNameHashInParser(parser);
 }
@@ -412,6 +417,8 @@ static void _assertItems(const string &path, const string &callbackName = "",
 		cppcut_assert_equal(true, result.second);
 	}
 	parser->endObject();
+	string nextCursor;
+	cppcut_assert_equal(true, parser->read("nextCursor", nextCursor));
 	assertServersIdNameHashInParser(parser);
 }
 #define assertItems(P,...) cut_trace(_assertItems(P,##__VA_ARGS__))
@@ -616,6 +623,54 @@ void test_triggersWithTimeRangeAndHostgroupName(void)
 		       beginTime, endTime, numExpectedTriggers, query);
 }
 
+void test_triggersWithCursor(void)
+{
+	loadTestDBTriggers();
+	loadTestDBServerHostDef();
+	startFaceRest();
+
+	// The first request has no cursor. Each page has 2 triggers at most.
+	RequestArg arg("/trigger");
+	arg.userId = findUserWith(OPPRVLG_GET_ALL_SERVER);
+	set<string> triggerKeys;
+	int64_t totalNumTriggers = 0;
+	string cursor;
+	for (size_t numPages = 0; ; numPages++) {
+		cppcut_assert_equal(true, numPages <= NumTestTriggerInfo);
+		arg.parameters["limit"] = "2";
+		if (numPages > 0)
+			arg.parameters["cursor"] = cursor;
+		unique_ptr<JSONParser> parserPtr(getResponseAsJSONParser(arg));
+		JSONParser *parser = parserPtr.get();
+		assertErrorCode(parser);
+		int64_t numTriggers = 0;
+		cppcut_assert_equal(
+		  true, parser->read("numberOfTriggers", numTriggers));
+		cppcut_assert_equal(
+		  true, parser->read("totalNumberOfTriggers", totalNumTriggers));
+		if (numTriggers == 0) {
+			assertNoValueInParser(parser, "nextCursor");
+			break;
+		}
+		assertStartObject(parser, "triggers");
+		for (int64_t i = 0; i < numTriggers; i++) {
+			int64_t serverId = 0;
+			string triggerId;
+			parser->startElement(i);
+			cppcut_assert_equal(true, parser->read("serverId", serverId));
+			cppcut_assert_equal(true, parser->read("id", triggerId));
+			parser->endElement();
+			const string key = StringUtils::sprintf(
+			  "%" PRId64 ":%s", serverId, triggerId.c_str());
+			cppcut_assert_equal(true, triggerKeys.insert(key).second);
+		}
+		parser->endObject();
+		cppcut_assert_equal(true, parser->read("nextCursor", cursor));
+	}
+	cppcut_assert_equal(static_cast<size_t>(totalNumTriggers),
+	                    triggerKeys.size());
+}
+
 void test_events(void)
 {
 	assertEvents("/event");
@@ -684,6 +739,87 @@ void test_eventsWithHostname(void)
 		     eventsArg);
 }
 
+void test_eventChanges(void)
+{
+	loadTestDBTriggers();
+	loadTestDBEvents();
+	loadTestDBServerHostDef();
+	startFaceRest();
+
+	RequestArg arg("/event/changes?lastUnifiedEventId=5");
+	arg.userId = findUserWith(OPPRVLG_GET_ALL_SERVER);
+	JSONParser *parser = getResponseAsJSONParser(arg);
+	unique_ptr<JSONParser> parserPtr(parser);
+	assertErrorCode(parser);
+	assertValueInParser(parser, "numberOfEvents", 2);
+	assertValueInParser(parser, "lastUnifiedEventId", 7);
+	assertStartObject(parser, "events");
+	parser->startElement(0);
+	assertValueInParser(parser, "unifiedId", 6);
+	parser->endElement();
+	parser->startElement(1);
+	assertValueInParser(parser, "unifiedId", 7);
+	parser->endElement();
+	parser->endObject();
+}
+
+void test_eventChangesTimedOut(void)
+{
+	loadTestDBTriggers();
+	loadTestDBEvents();
+	loadTestDBServerHostDef();
+	startFaceRest();
+
+	RequestArg arg("/event/changes?lastUnifiedEventId=7&timeout=1");
+	arg.userId = findUserWith(OPPRVLG_GET_ALL_SERVER);
+	JSONParser *parser = getResponseAsJSONParser(arg);
+	unique_ptr<JSONParser> parserPtr(parser);
+	assertErrorCode(parser);
+	assertValueInParser(parser, "numberOfEvents", 0);
+	assertValueInParser(parser, "lastUnifiedEventId", 7);
+}
+
+void test_eventChangesWokenByAddedEvent(void)
+{
+	loadTestDBTriggers();
+	loadTestDBEvents();
+	loadTestDBServerHostDef();
+	startFaceRest();
+
+	thread adder([] {
+		// Wait for the request to be blocked.
+		usleep(500 * 1000);
+		ThreadLocalDBCache cache;
+		EventInfoList eventInfoList;
+		eventInfoList.push_back(testEventInfo[0]);
+		eventInfoList.back().id = "100";
+		cache.getMonitoring().addEventInfoList(eventInfoList);
+	});
+	RequestArg arg("/event/changes?lastUnifiedEventId=7&timeout=60");
+	arg.userId = findUserWith(OPPRVLG_GET_ALL_SERVER);
+	const SmartTime startTime(SmartTime::INIT_CURR_TIME);
+	JSONParser *parser = getResponseAsJSONParser(arg);
+	unique_ptr<JSONParser> parserPtr(parser);
+	adder.join();
+	SmartTime elapsed(SmartTime::INIT_CURR_TIME);
+	elapsed -= startTime;
+	cppcut_assert_equal(true, elapsed.getAsSec() < 30);
+
+	assertErrorCode(parser);
+	assertValueInParser(parser, "numberOfEvents", 1);
+	assertValueInParser(parser, "lastUnifiedEventId", 8);
+}
+
+void test_eventChangesWithInvalidTimeout(void)
+{
+	startFaceRest();
+	RequestArg arg("/event/changes?lastUnifiedEventId=0&timeout=10000");
+	arg.userId = findUserWith(OPPRVLG_GET_ALL_SERVER);
+	JSONParser *parser = getResponseAsJSONParser(arg);
+	unique_ptr<JSONParser> parserPtr(parser);
+	assertErrorCode(parser, HTERR_INVALID_PARAMETER);
+}
+
 void test_items(void)
 {
 	assertItems("/item");
@@ -955,7 +1091,8 @@ void test_eventsWithHostsFilter(void)
 			"\"brief\":\"TEST Trigger 1b\","
 			"\"extendedInfo\":\"\""
 			"}],"
-			"\"numberOfEvents\":1,");
+			"\"numberOfEvents\":1,"
+			"\"nextCursor\":\"T1389123457.0.5\",");
 	expected += getExpectedServers() + ",";
 	expected += getExpectedIncidentTrackers() + "}";
 	assertEqualJSONString(expected, arg.response);
@@ -1007,7 +1144,8 @@ void test_eventsWithTypesFilter(void)
 	  "\"{\\\"expandedDescription\\\":\\\"Test Trigger on hostZ1\\\"}\""
 	  "}"
 	  "],"
-	  "\"numberOfEvents\":2,");
+	  "\"numberOfEvents\":2,"
+	  "\"nextCursor\":\"T1390000000.123456789.6\",");
 
 	expected += getExpectedServers() + ",";
 	expected += getExpectedIncidentTrackers() + "}";
@@ -1074,7 +1212,8 @@ void test_eventsWithSeveritiesFilter(void)
 	  "\"{\\\"expandedDescription\\\":\\\"Test Trigger on hostZ1\\\"}\""
 	  "}"
 	  "],"
-	  "\"numberOfEvents\":3,");
+	  "\"numberOfEvents\":3,"
+	  "\"nextCursor\":\"T1362957200.0.1\",");
 
 	expected += getExpectedServers() + ",";
 	expected += getExpectedIncidentTrackers() + "}";
@@ -1126,7 +1265,8 @@ void test_eventsWithStatusesFilter(void)
 	  "\"extendedInfo\":\"\""
 	  "}"
 	  "],"
-	  "\"numberOfEvents\":2,");
+	  "\"numberOfEvents\":2,"
+	  "\"nextCursor\":\"T1378900022.0.4\",");
 
 	expected += getExpectedServers() + ",";
 	expected += getExpectedIncidentTrackers() + "}";
@@ -1181,7 +1321,8 @@ void test_eventsWithIncidentStatusesFilter(void)
 	  "\"extendedInfo\":\"\""
 	  "}"
 	  "],"
-	  "\"numberOfEvents\":2,");
+	  "\"numberOfEvents\":2,"
+	  "\"nextCursor\":\"T1378900022.0.4\",");
 
 	expected += getExpectedServers() + ",";
 	expected += getExpectedIncidentTrackers() + "}";
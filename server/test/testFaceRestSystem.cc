@@ -74,6 +74,49 @@ void test_systemInfo(void)
 		}
 		parser->endElement();
 	}
+	parser->endObject(); // eventRates
+
+	assertStartObject(parser, "faceRestWorkers");
+	int64_t numWorkers = 0;
+	cppcut_assert_equal(true, parser->read("numWorkers", numWorkers));
+	cppcut_assert_equal(true, numWorkers >= 1);
+	for (auto label : {"numIdleWorkers", "queueDepth",
+	                   "numProcessedJobs", "numOverflowedJobs",
+	                   "totalWaitTimeUSec", "maxWaitTimeUSec"}) {
+		int64_t n;
+		cppcut_assert_equal(true, parser->read(label, n));
+	}
+	parser->endObject(); // faceRestWorkers
+
+	assertStartObject(parser, "actionEvaluator");
+	for (auto label : {"numWorkers", "queueDepth", "numQueuedEvents",
+	                   "numEvaluatedEvents", "numQueueFullWaits"}) {
+		int64_t n;
+		cppcut_assert_equal(true, parser->read(label, n));
+	}
+	parser->endObject(); // actionEvaluator
+
+	assertStartObject(parser, "jsonGateEventBatches");
+	for (auto label : {"numFlushes", "numEvents", "maxBatchSize",
+	                   "totalFlushLatencyUSec", "maxFlushLatencyUSec"}) {
+		int64_t n;
+		cppcut_assert_equal(true, parser->read(label, n));
+	}
+	parser->endObject(); // jsonGateEventBatches
+
+	assertStartObject(parser, "recentEventFilter");
+	for (auto label : {"numPassedEvents", "numDroppedEvents"}) {
+		int64_t n;
+		cppcut_assert_equal(true, parser->read(label, n));
+	}
+	parser->endObject(); // recentEventFilter
+
+	assertStartObject(parser, "eventTriggerMerge");
+	for (auto label : {"numHits", "numMisses"}) {
+		int64_t n;
+		cppcut_assert_equal(true, parser->read(label, n));
+	}
+	parser->endObject(); // eventTriggerMerge
 }
 
 } // namespace testFaceRestSystem
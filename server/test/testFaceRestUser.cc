@@ -158,7 +158,7 @@ static void _assertLoginAsTarget1(string &sessionId)
 	cppcut_assert_equal(true, session.hasData());
 	cppcut_assert_equal(targetIdx + 1, session->userId);
 	assertTimeIsNow(session->loginTime);
-	assertTimeIsNow(session->lastAccessTime);
+	assertTimeIsNow(session->getLastAccessTime());
 }
 #define assertLoginAsTarget1(SID) cut_trace(_assertLoginAsTarget1(SID))
 
@@ -29,6 +29,7 @@
 #include <AMQPConsumer.h>
 #include <AMQPMessageHandler.h>
 #include <ThreadLocalDBCache.h>
+#include <RecentEventFilter.h>
 #include "Helpers.h"
 #include "DBTablesTest.h"
 
@@ -606,6 +607,48 @@ void test_procedureHandlerPutItemsWithDivideInfo(void)
 	cppcut_assert_equal(expectedOutput, actualOutput);
 }
 
+void test_procedureHandlerPutItemsWithDivideInfoTimedOut(void)
+{
+	loadDummyHosts();
+	shared_ptr<HatoholArmPluginGateHAPI2> gate =
+	  make_shared<HatoholArmPluginGateHAPI2>(monitoringServerInfo, false);
+	const guint timeoutMSec = 10;
+	gate->setDividedRequestTimeout(timeoutMSec);
+	auto makeJSON = [](const int &serialId, const bool &isLast) {
+		return StringUtils::sprintf(
+		  "{\"jsonrpc\":\"2.0\",\"method\":\"putItems\","
+		  " \"params\":{\"items\":["
+		  "{\"itemId\":\"%d\", \"hostId\":\"1\","
+		  " \"brief\":\"example brief\","
+		  " \"lastValueTime\":\"20150410175523\","
+		  " \"lastValue\":\"example value\","
+		  " \"itemGroupName\":[], \"unit\":\"example unit\"}],"
+		  " \"fetchId\":\"1\","
+		  " \"divideInfo\":"
+		  "  {\"isLast\":%s,\"serialId\":%d,"
+		  "  \"requestId\":\"2029dcdd-db29-4ac4-8006-3d975874b5a8\"}"
+		  " }, \"id\":83241245}",
+		  serialId + 1, isLast ? "true" : "false", serialId);
+	};
+	gate->setEstablished(true);
+	JSONParser parser1(makeJSON(0, false));
+	string actual1 = gate->interpretHandler(HAPI2_PUT_ITEMS, parser1);
+	string expected1 =
+		"{\"jsonrpc\":\"2.0\",\"result\":\"SUCCESS\",\"id\":83241245}";
+	cppcut_assert_equal(expected1, actual1);
+
+	// The time-out callback runs in this thread. It used to dead-lock.
+	g_usleep(timeoutMSec * 2 * 1000);
+	while (g_main_context_iteration(NULL, FALSE))
+		;
+
+	// The first chunk has been dropped.
+	JSONParser parser2(makeJSON(1, true));
+	string actual2 = gate->interpretHandler(HAPI2_PUT_ITEMS, parser2);
+	JSONParser reply(actual2);
+	cppcut_assert_equal(true, reply.isMember("error"));
+}
+
 void test_procedureHandlerPutItemsInvalidJSON(void)
 {
 	loadDummyHosts();
@@ -779,6 +822,51 @@ void test_procedureHandlerPutHosts(void)
 	cppcut_assert_equal(expectedOutput, actualOutput);
 }
 
+static string getLastInfoValue(const LastInfoType &type)
+{
+	ThreadLocalDBCache cache;
+	LastInfoDefList lastInfoList;
+	LastInfoQueryOption option(USER_ID_SYSTEM);
+	option.setLastInfoType(type);
+	option.setTargetServerId(monitoringServerInfo.id);
+	assertHatoholError(
+	  HTERR_OK, cache.getLastInfo().getLastInfoList(lastInfoList, option));
+	return lastInfoList.empty() ? "" : lastInfoList.begin()->value;
+}
+
+void test_procedureHandlerPutHostsSkipsUnchangedFullSync(void)
+{
+	shared_ptr<HatoholArmPluginGateHAPI2> gate =
+	  make_shared<HatoholArmPluginGateHAPI2>(monitoringServerInfo, false);
+	gate->setEstablished(true);
+	auto putHosts = [&](const char *updateType, const char *lastInfo) {
+		string json = StringUtils::sprintf(
+		  "{\"jsonrpc\":\"2.0\",\"method\":\"putHosts\", \"params\":"
+		  "{\"hosts\":[{\"hostId\":\"1\", \"hostName\":\"host1\"}],"
+		  " \"updateType\":\"%s\",\"lastInfo\":\"%s\"},"
+		  " \"id\":\"deadbeaf\"}", updateType, lastInfo);
+		JSONParser parser(json);
+		gate->interpretHandler(HAPI2_PUT_HOSTS, parser);
+	};
+
+	putHosts("ALL", "201504091052");
+	const string fingerprint =
+	  getLastInfoValue(LAST_INFO_HOST_FINGERPRINT);
+	cppcut_assert_equal(false, fingerprint.empty());
+
+	// The sync is skipped. But the last info is still saved.
+	putHosts("ALL", "201504091100");
+	cppcut_assert_equal(fingerprint,
+	                    getLastInfoValue(LAST_INFO_HOST_FINGERPRINT));
+	cppcut_assert_equal(string("201504091100"),
+	                    getLastInfoValue(LAST_INFO_HOST));
+
+	// A partial update makes the fingerprint unknown.
+	putHosts("UPDATED", "201504091200");
+	cppcut_assert_equal(string(),
+	                    getLastInfoValue(LAST_INFO_HOST_FINGERPRINT));
+}
+
 void test_procedureHandlerPutHostsWithDivideInfo(void)
 {
 	shared_ptr<HatoholArmPluginGateHAPI2> gate =
@@ -1526,6 +1614,100 @@ void test_procedureHandlerPutEvents(gconstpointer data)
 	cppcut_assert_equal(expectedOutput, actualOutput);
 }
 
+void test_procedureHandlerPutEventsDropsResentEvents(void)
+{
+	loadDummyHosts();
+	shared_ptr<HatoholArmPluginGateHAPI2> gate =
+	  make_shared<HatoholArmPluginGateHAPI2>(monitoringServerInfo, false);
+	gate->setEstablished(true);
+	auto putEvents = [&](const char *eventIds[], const size_t &num) {
+		string events;
+		for (size_t i = 0; i < num; i++) {
+			if (i > 0)
+				events += ",";
+			events += StringUtils::sprintf(
+			  "{\"eventId\":\"%s\", \"time\":\"20150323151300\","
+			  " \"type\":\"GOOD\", \"status\": \"OK\","
+			  " \"severity\":\"INFO\", \"hostId\":\"3\","
+			  " \"hostName\":\"exampleHostName\","
+			  " \"brief\":\"example brief\"}", eventIds[i]);
+		}
+		string json = StringUtils::sprintf(
+		  "{\"jsonrpc\":\"2.0\", \"method\":\"putEvents\","
+		  " \"params\":{\"events\":[%s]},\"id\":2374234}",
+		  events.c_str());
+		JSONParser parser(json);
+		gate->interpretHandler(HAPI2_PUT_EVENTS, parser);
+	};
+
+	RecentEventFilter::Statistics before, after;
+	RecentEventFilter::getGlobalStatistics(before);
+	const char *firstEventIds[] = {"1", "2"};
+	putEvents(firstEventIds, ARRAY_SIZE(firstEventIds));
+	// The plugin resends the overlapping events.
+	const char *secondEventIds[] = {"2", "3"};
+	putEvents(secondEventIds, ARRAY_SIZE(secondEventIds));
+	RecentEventFilter::getGlobalStatistics(after);
+	cppcut_assert_equal(before.numPassedEvents + 3, after.numPassedEvents);
+	cppcut_assert_equal(before.numDroppedEvents + 1,
+	                    after.numDroppedEvents);
+
+	ThreadLocalDBCache cache;
+	EventInfoList eventInfoList;
+	EventsQueryOption option(USER_ID_SYSTEM);
+	option.setTargetServerId(monitoringServerInfo.id);
+	cache.getMonitoring().getEventInfoList(eventInfoList, option);
+	cppcut_assert_equal((size_t)3, eventInfoList.size());
+}
+
+void test_procedureHandlerPutEventsDropsResentEventsWithTrigger(void)
+{
+	loadDummyHosts();
+	shared_ptr<HatoholArmPluginGateHAPI2> gate =
+	  make_shared<HatoholArmPluginGateHAPI2>(monitoringServerInfo, false);
+	gate->setEstablished(true);
+	string triggersJSON =
+		"{\"jsonrpc\":\"2.0\", \"method\":\"putTriggers\","
+		" \"params\":{\"updateType\":\"UPDATED\","
+		" \"triggers\":[{\"triggerId\":\"1\", \"status\":\"OK\","
+		" \"severity\":\"INFO\",\"lastChangeTime\":\"20150323175800\","
+		" \"hostId\":\"1\", \"hostName\":\"exampleHostName\","
+		" \"brief\":\"example brief\","
+		" \"extendedInfo\": \"sample extended info\"}]},\"id\":34031}";
+	JSONParser triggersParser(triggersJSON);
+	gate->interpretHandler(HAPI2_PUT_TRIGGERS, triggersParser);
+
+	// extendedInfo of the event is filled with the trigger's one when
+	// it's stored.
+	string eventsJSON =
+		"{\"jsonrpc\":\"2.0\", \"method\":\"putEvents\","
+		" \"params\":{\"events\":[{\"eventId\":\"1\","
+		" \"time\":\"20150323151300\", \"type\":\"GOOD\","
+		" \"triggerId\":\"1\", \"status\": \"OK\","
+		" \"severity\":\"INFO\", \"hostId\":\"1\","
+		" \"hostName\":\"exampleHostName\","
+		" \"brief\":\"example brief\"}]},\"id\":2374234}";
+	RecentEventFilter::Statistics before, after;
+	RecentEventFilter::getGlobalStatistics(before);
+	for (int i = 0; i < 2; i++) {
+		JSONParser parser(eventsJSON);
+		gate->interpretHandler(HAPI2_PUT_EVENTS, parser);
+	}
+	RecentEventFilter::getGlobalStatistics(after);
+	cppcut_assert_equal(before.numPassedEvents + 1, after.numPassedEvents);
+	cppcut_assert_equal(before.numDroppedEvents + 1,
+	                    after.numDroppedEvents);
+
+	ThreadLocalDBCache cache;
+	EventInfoList eventInfoList;
+	EventsQueryOption option(USER_ID_SYSTEM);
+	option.setTargetServerId(monitoringServerInfo.id);
+	cache.getMonitoring().getEventInfoList(eventInfoList, option);
+	cppcut_assert_equal((size_t)1, eventInfoList.size());
+	cppcut_assert_equal(string("sample extended info"),
+	                    eventInfoList.front().extendedInfo);
+}
+
 void data_procedureHandlerPutEventsWithDivideInfo(void)
 {
 	gcut_add_datum("WithTriggerId",
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <cppcutter.h>
+#include <vector>
+#include <glib.h>
+#include "HistoryFetchWorker.h"
+#include "DataStoreFake.h"
+#include "Helpers.h"
+using namespace std;
+
+namespace testHistoryFetchWorker {
+
+// Returns a sample every 10 seconds in the requested range.
+class TestDataStore : public DataStoreFake {
+public:
+	vector<pair<time_t, time_t>> requestedRanges;
+	vector<Closure1<HistoryInfoVect> *> pendingClosures;
+	bool replyImmediately;
+
+	TestDataStore(const MonitoringServerInfo &serverInfo)
+	: DataStoreFake(serverInfo, false),
+	  replyImmediately(true)
+	{
+	}
+
+	virtual ~TestDataStore()
+	{
+		for (auto closure : pendingClosures)
+			delete closure;
+	}
+
+	virtual void startOnDemandFetchHistory(
+	  const ItemInfo &itemInfo,
+	  const time_t &beginTime,
+	  const time_t &endTime,
+	  Closure1<HistoryInfoVect> *closure) override
+	{
+		requestedRanges.push_back({beginTime, endTime});
+		if (replyImmediately)
+			reply(closure, beginTime, endTime);
+		else
+			pendingClosures.push_back(closure);
+	}
+
+	void reply(Closure1<HistoryInfoVect> *closure,
+	           const time_t &beginTime, const time_t &endTime)
+	{
+		HistoryInfoVect historyInfoVect;
+		for (time_t sec = (beginTime + 9) / 10 * 10; sec <= endTime;
+		     sec += 10) {
+			HistoryInfo historyInfo;
+			historyInfo.serverId = getMonitoringServerInfo().id;
+			historyInfo.itemId = "1";
+			historyInfo.value = to_string(sec);
+			historyInfo.clock.tv_sec = sec;
+			historyInfo.clock.tv_nsec = 0;
+			historyInfoVect.push_back(historyInfo);
+		}
+		(*closure)(historyInfoVect);
+		delete closure;
+	}
+};
+
+struct HistoryReceiver : public Closure1<HistoryInfoVect> {
+	HistoryInfoVect &received;
+
+	HistoryReceiver(HistoryInfoVect &_received)
+	: received(_received)
+	{
+	}
+
+	virtual void operator()(const HistoryInfoVect &historyInfoVect)
+	  override
+	{
+		received = historyInfoVect;
+	}
+};
+
+static shared_ptr<TestDataStore> g_dataStore;
+
+static ItemInfo makeItemInfo(void)
+{
+	ItemInfo itemInfo;
+	itemInfo.serverId = g_dataStore->getMonitoringServerInfo().id;
+	itemInfo.id = "1";
+	itemInfo.hostIdInServer = "10";
+	return itemInfo;
+}
+
+void cut_setup(void)
+{
+	MonitoringServerInfo serverInfo;
+	initServerInfo(serverInfo);
+	serverInfo.id = 1;
+	g_dataStore = make_shared<TestDataStore>(serverInfo);
+}
+
+void cut_teardown(void)
+{
+	g_dataStore = nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_answerFromStore(void)
+{
+	HistoryFetchWorker worker;
+	HistoryInfoVect first, second;
+	worker.start(g_dataStore, makeItemInfo(), 1000, 1999,
+	             new HistoryReceiver(first));
+	worker.start(g_dataStore, makeItemInfo(), 1000, 1999,
+	             new HistoryReceiver(second));
+
+	cppcut_assert_equal((size_t)1, g_dataStore->requestedRanges.size());
+	cppcut_assert_equal((size_t)100, first.size());
+	cppcut_assert_equal((size_t)100, second.size());
+	HistoryFetchWorker::Statistics stat;
+	worker.getStatistics(stat);
+	cppcut_assert_equal((uint64_t)1, stat.numStoreHits);
+}
+
+void test_fetchOnlyMissingRange(void)
+{
+	HistoryFetchWorker worker;
+	HistoryInfoVect first, second;
+	worker.start(g_dataStore, makeItemInfo(), 1000, 1999,
+	             new HistoryReceiver(first));
+	worker.start(g_dataStore, makeItemInfo(), 1500, 2499,
+	             new HistoryReceiver(second));
+
+	cppcut_assert_equal((size_t)2, g_dataStore->requestedRanges.size());
+	cppcut_assert_equal((time_t)2000,
+	                    g_dataStore->requestedRanges[1].first);
+	cppcut_assert_equal((time_t)2499,
+	                    g_dataStore->requestedRanges[1].second);
+	cppcut_assert_equal((size_t)100, second.size());
+	cppcut_assert_equal((time_t)1500, second.front().clock.tv_sec);
+	cppcut_assert_equal((time_t)2490, second.back().clock.tv_sec);
+}
+
+void test_refetchUnsettledRange(void)
+{
+	HistoryFetchWorker worker;
+	const time_t endTime = time(NULL);
+	const time_t beginTime = endTime - 600;
+	HistoryInfoVect received;
+	worker.start(g_dataStore, makeItemInfo(), beginTime, endTime,
+	             new HistoryReceiver(received));
+	worker.start(g_dataStore, makeItemInfo(), beginTime, endTime,
+	             new HistoryReceiver(received));
+
+	cppcut_assert_equal((size_t)2, g_dataStore->requestedRanges.size());
+	cppcut_assert_equal(
+	  true, g_dataStore->requestedRanges[1].first >
+	        endTime - HistoryFetchWorker::SETTLING_TIME_SEC - 10);
+}
+
+void test_coalesceIdenticalRequests(void)
+{
+	HistoryFetchWorker worker;
+	g_dataStore->replyImmediately = false;
+	HistoryInfoVect first, second;
+	worker.start(g_dataStore, makeItemInfo(), 1000, 1999,
+	             new HistoryReceiver(first));
+	worker.start(g_dataStore, makeItemInfo(), 1000, 1999,
+	             new HistoryReceiver(second));
+	cppcut_assert_equal((size_t)1, g_dataStore->pendingClosures.size());
+
+	Closure1<HistoryInfoVect> *closure =
+	  g_dataStore->pendingClosures.back();
+	g_dataStore->pendingClosures.pop_back();
+	g_dataStore->reply(closure, 1000, 1999);
+	cppcut_assert_equal((size_t)100, first.size());
+	cppcut_assert_equal((size_t)100, second.size());
+	HistoryFetchWorker::Statistics stat;
+	worker.getStatistics(stat);
+	cppcut_assert_equal((uint64_t)1, stat.numCoalescedRequests);
+}
+
+void test_expireRunningFetch(void)
+{
+	HistoryFetchWorker worker;
+	worker.setFetchTimeout(10);
+	g_dataStore->replyImmediately = false;
+	// The receivers clear them when they are called.
+	HistoryInfoVect first(1), second(1);
+	worker.start(g_dataStore, makeItemInfo(), 1000, 1999,
+	             new HistoryReceiver(first));
+	worker.start(g_dataStore, makeItemInfo(), 1000, 1999,
+	             new HistoryReceiver(second));
+
+	HistoryFetchWorker::Statistics stat;
+	do {
+		g_main_context_iteration(NULL, TRUE);
+		worker.getStatistics(stat);
+	} while (stat.numTimedOutFetches == 0);
+	cppcut_assert_equal(true, first.empty());
+	cppcut_assert_equal(true, second.empty());
+
+	// A reply after the time-out is only stored.
+	Closure1<HistoryInfoVect> *closure =
+	  g_dataStore->pendingClosures.back();
+	g_dataStore->pendingClosures.pop_back();
+	g_dataStore->reply(closure, 1000, 1999);
+	cppcut_assert_equal(true, first.empty());
+
+	HistoryInfoVect third;
+	worker.start(g_dataStore, makeItemInfo(), 1000, 1999,
+	             new HistoryReceiver(third));
+	cppcut_assert_equal((size_t)100, third.size());
+	cppcut_assert_equal((size_t)1, g_dataStore->requestedRanges.size());
+}
+
+} // namespace testHistoryFetchWorker
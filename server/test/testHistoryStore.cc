@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <cppcutter.h>
+#include "HistoryStore.h"
+#include "Utils.h"
+using namespace std;
+
+namespace testHistoryStore {
+
+static const ServerIdType TEST_SERVER_ID = 1;
+static const ItemIdType TEST_ITEM_ID = "100";
+
+static HistoryInfo makeHistory(const time_t &sec, const long &nsec,
+                               const string &value)
+{
+	HistoryInfo historyInfo;
+	historyInfo.serverId = TEST_SERVER_ID;
+	historyInfo.itemId = TEST_ITEM_ID;
+	historyInfo.value = value;
+	historyInfo.clock.tv_sec = sec;
+	historyInfo.clock.tv_nsec = nsec;
+	return historyInfo;
+}
+
+static void assertHistoryInfoVect(const HistoryInfoVect &expected,
+                                  const HistoryInfoVect &actual)
+{
+	cppcut_assert_equal(expected.size(), actual.size());
+	for (size_t i = 0; i < expected.size(); i++) {
+		cppcut_assert_equal(expected[i].serverId, actual[i].serverId);
+		cppcut_assert_equal(expected[i].itemId, actual[i].itemId);
+		cppcut_assert_equal(expected[i].value, actual[i].value);
+		cppcut_assert_equal(expected[i].clock.tv_sec,
+		                    actual[i].clock.tv_sec);
+		cppcut_assert_equal(expected[i].clock.tv_nsec,
+		                    actual[i].clock.tv_nsec);
+	}
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_getMissingRangeOfUnknownItem(void)
+{
+	HistoryStore store;
+	time_t beginTime = 0, endTime = 0;
+	cppcut_assert_equal(true,
+	  store.getMissingRange(TEST_SERVER_ID, TEST_ITEM_ID, 1000, 2000,
+	                        beginTime, endTime));
+	cppcut_assert_equal((time_t)1000, beginTime);
+	cppcut_assert_equal((time_t)2000, endTime);
+}
+
+void test_restoreValues(void)
+{
+	HistoryStore store;
+	// The numbers that can't be restored as they are written are
+	// stored as strings.
+	const char *values[] = {
+	  "1.5", "1.5", "0", "-3", "12345", "0.1", "1.5000", "abc", "", "abc",
+	  "2.25", "1e+300",
+	};
+	HistoryInfoVect historyInfoVect;
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		historyInfoVect.push_back(
+		  makeHistory(1000 + i * 30, i * 1000, values[i]));
+	}
+	store.add(TEST_SERVER_ID, TEST_ITEM_ID, historyInfoVect, 1000, 2000);
+
+	HistoryInfoVect actual;
+	store.get(actual, TEST_SERVER_ID, TEST_ITEM_ID, 1000, 2000);
+	assertHistoryInfoVect(historyInfoVect, actual);
+}
+
+void test_getInRange(void)
+{
+	HistoryStore store;
+	HistoryInfoVect historyInfoVect;
+	for (time_t sec = 1000; sec < 2000; sec += 10)
+		historyInfoVect.push_back(makeHistory(sec, 0, "1"));
+	store.add(TEST_SERVER_ID, TEST_ITEM_ID, historyInfoVect, 1000, 1999);
+
+	HistoryInfoVect actual;
+	store.get(actual, TEST_SERVER_ID, TEST_ITEM_ID, 1500, 1520);
+	HistoryInfoVect expected = {
+	  makeHistory(1500, 0, "1"),
+	  makeHistory(1510, 0, "1"),
+	  makeHistory(1520, 0, "1"),
+	};
+	assertHistoryInfoVect(expected, actual);
+}
+
+void test_getMissingRange(void)
+{
+	HistoryStore store;
+	HistoryInfoVect historyInfoVect = {makeHistory(1500, 0, "1")};
+	store.add(TEST_SERVER_ID, TEST_ITEM_ID, historyInfoVect, 1000, 1999);
+
+	time_t beginTime = 0, endTime = 0;
+	cppcut_assert_equal(false,
+	  store.getMissingRange(TEST_SERVER_ID, TEST_ITEM_ID, 1000, 1999,
+	                        beginTime, endTime));
+	cppcut_assert_equal(true,
+	  store.getMissingRange(TEST_SERVER_ID, TEST_ITEM_ID, 1500, 2500,
+	                        beginTime, endTime));
+	cppcut_assert_equal((time_t)2000, beginTime);
+	cppcut_assert_equal((time_t)2500, endTime);
+	cppcut_assert_equal(true,
+	  store.getMissingRange(TEST_SERVER_ID, TEST_ITEM_ID, 500, 1500,
+	                        beginTime, endTime));
+	cppcut_assert_equal((time_t)500, beginTime);
+	cppcut_assert_equal((time_t)999, endTime);
+}
+
+void test_mergeFetchedRanges(void)
+{
+	HistoryStore store;
+	HistoryInfoVect historyInfoVect = {makeHistory(1500, 0, "1")};
+	store.add(TEST_SERVER_ID, TEST_ITEM_ID, historyInfoVect, 1000, 1999);
+	store.add(TEST_SERVER_ID, TEST_ITEM_ID, historyInfoVect, 3000, 3999);
+	store.add(TEST_SERVER_ID, TEST_ITEM_ID, historyInfoVect, 2000, 2999);
+
+	time_t beginTime = 0, endTime = 0;
+	cppcut_assert_equal(false,
+	  store.getMissingRange(TEST_SERVER_ID, TEST_ITEM_ID, 1000, 3999,
+	                        beginTime, endTime));
+}
+
+void test_addEarlierSamples(void)
+{
+	HistoryStore store;
+	HistoryInfoVect laterVect = {
+	  makeHistory(2000, 0, "2"),
+	  makeHistory(2010, 0, "3"),
+	};
+	store.add(TEST_SERVER_ID, TEST_ITEM_ID, laterVect, 2000, 2010);
+	HistoryInfoVect earlierVect = {
+	  makeHistory(2010, 0, "4"),
+	  makeHistory(1990, 0, "1"),
+	};
+	store.add(TEST_SERVER_ID, TEST_ITEM_ID, earlierVect, 1990, 2010);
+
+	HistoryInfoVect actual;
+	store.get(actual, TEST_SERVER_ID, TEST_ITEM_ID, 0, 3000);
+	HistoryInfoVect expected = {
+	  makeHistory(1990, 0, "1"),
+	  makeHistory(2000, 0, "2"),
+	  makeHistory(2010, 0, "4"),
+	};
+	assertHistoryInfoVect(expected, actual);
+}
+
+void test_dropOldestSamples(void)
+{
+	const size_t maxSamples = 200;
+	HistoryStore store(HistoryStore::DEFAULT_MAX_ITEMS, maxSamples);
+	HistoryInfoVect historyInfoVect;
+	for (time_t sec = 0; sec < 1000; sec++)
+		historyInfoVect.push_back(makeHistory(sec, 0, "1"));
+	store.add(TEST_SERVER_ID, TEST_ITEM_ID, historyInfoVect, 0, 999);
+
+	HistoryStore::Statistics stat;
+	store.getStatistics(stat);
+	cppcut_assert_equal(true, stat.numSamples <= maxSamples);
+
+	HistoryInfoVect actual;
+	store.get(actual, TEST_SERVER_ID, TEST_ITEM_ID, 0, 999);
+	cppcut_assert_equal(stat.numSamples, actual.size());
+	const time_t firstTime = actual.front().clock.tv_sec;
+	time_t beginTime = 0, endTime = 0;
+	cppcut_assert_equal(true,
+	  store.getMissingRange(TEST_SERVER_ID, TEST_ITEM_ID, 0, 999,
+	                        beginTime, endTime));
+	cppcut_assert_equal((time_t)0, beginTime);
+	cppcut_assert_equal(firstTime, endTime);
+}
+
+void test_dropLeastRecentlyUsedItem(void)
+{
+	HistoryStore store(2);
+	HistoryInfoVect historyInfoVect = {makeHistory(1500, 0, "1")};
+	store.add(TEST_SERVER_ID, "1", historyInfoVect, 1000, 1999);
+	store.add(TEST_SERVER_ID, "2", historyInfoVect, 1000, 1999);
+
+	HistoryInfoVect actual;
+	store.get(actual, TEST_SERVER_ID, "1", 1000, 1999);
+	store.add(TEST_SERVER_ID, "3", historyInfoVect, 1000, 1999);
+
+	time_t beginTime = 0, endTime = 0;
+	cppcut_assert_equal(false,
+	  store.getMissingRange(TEST_SERVER_ID, "1", 1000, 1999,
+	                        beginTime, endTime));
+	cppcut_assert_equal(true,
+	  store.getMissingRange(TEST_SERVER_ID, "2", 1000, 1999,
+	                        beginTime, endTime));
+	HistoryStore::Statistics stat;
+	store.getStatistics(stat);
+	cppcut_assert_equal((size_t)2, stat.numItems);
+}
+
+} // namespace testHistoryStore
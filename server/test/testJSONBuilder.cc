@@ -18,6 +18,7 @@
  */
 
 #include <cppcutter.h>
+#include <stdint.h>
 #include <StringUtils.h>
 #include "JSONBuilder.h"
 using namespace std;
@@ -61,6 +62,70 @@ void test_array(void)
 	cppcut_assert_equal(expected, agent.generate());
 }
 
+void test_nestedContainers(void)
+{
+	JSONBuilder agent;
+	agent.startObject();
+	agent.add("name", "foo");
+	agent.startArray("items");
+	agent.startObject();
+	agent.add("id", 1);
+	agent.addTrue("enabled");
+	agent.endObject();
+	agent.startObject();
+	agent.add("id", 2);
+	agent.addFalse("enabled");
+	agent.addNull("parent");
+	agent.endObject();
+	agent.endArray();
+	agent.startObject("empty");
+	agent.endObject();
+	agent.endObject();
+
+	string expected =
+	  "{\"name\":\"foo\",\"items\":["
+	  "{\"id\":1,\"enabled\":true},"
+	  "{\"id\":2,\"enabled\":false,\"parent\":null}],"
+	  "\"empty\":{}}";
+	cppcut_assert_equal(expected, agent.generate());
+}
+
+void test_int64(void)
+{
+	JSONBuilder agent;
+	agent.startObject();
+	agent.add("max", INT64_MAX);
+	agent.add("min", INT64_MIN);
+	agent.endObject();
+	string expected =
+	  "{\"max\":9223372036854775807,\"min\":-9223372036854775808}";
+	cppcut_assert_equal(expected, agent.generate());
+}
+
+void test_escape(void)
+{
+	JSONBuilder agent;
+	agent.startObject();
+	agent.add("quote\"key", "\"\\/\b\f\n\r\t\x01\x1f\xe3\x81\x82");
+	agent.endObject();
+	string expected =
+	  "{\"quote\\\"key\":\"\\\"\\\\/\\b\\f\\n\\r\\t\\u0001\\u001f"
+	  "\xe3\x81\x82\"}";
+	cppcut_assert_equal(expected, agent.generate());
+}
+
+void test_takeGenerated(void)
+{
+	JSONBuilder agent;
+	agent.startObject();
+	agent.add("foo", "bar");
+	agent.endObject();
+	string actual;
+	agent.takeGenerated(actual);
+	cppcut_assert_equal(string("{\"foo\":\"bar\"}"), actual);
+	cppcut_assert_equal(string(), agent.generate());
+}
+
 } //namespace testJSONBuilder
 
 
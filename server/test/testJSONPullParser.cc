@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <gcutter.h>
+#include <cppcutter.h>
+#include <string>
+#include "JSONPullParser.h"
+using namespace std;
+
+namespace testJSONPullParser {
+
+typedef JSONPullParser::TokenType TokenType;
+
+static void assertNext(JSONPullParser &parser, const TokenType &expected)
+{
+	cppcut_assert_equal(expected, parser.next(),
+	                    cut_message("%s",
+	                                parser.getErrorMessage().c_str()));
+}
+
+static void assertNextMember(JSONPullParser &parser, const string &name)
+{
+	assertNext(parser, JSONPullParser::TOKEN_MEMBER);
+	cppcut_assert_equal(name, parser.getString());
+}
+
+static void assertError(const string &json)
+{
+	JSONPullParser parser(json);
+	TokenType type;
+	do {
+		type = parser.next();
+	} while (type != JSONPullParser::TOKEN_ERROR &&
+	         type != JSONPullParser::TOKEN_END);
+	cppcut_assert_equal(JSONPullParser::TOKEN_ERROR, type,
+	                    cut_message("%s", json.c_str()));
+	cppcut_assert_equal(true, parser.hasError());
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_emptyObject(void)
+{
+	JSONPullParser parser(" { } ");
+	assertNext(parser, JSONPullParser::TOKEN_START_OBJECT);
+	assertNext(parser, JSONPullParser::TOKEN_END_OBJECT);
+	assertNext(parser, JSONPullParser::TOKEN_END);
+	assertNext(parser, JSONPullParser::TOKEN_END);
+}
+
+void test_scalars(void)
+{
+	JSONPullParser parser(
+	  "{\"s\":\"foo\",\"i\":-123,\"d\":1.5e2,\"t\":true,\"f\":false,"
+	  "\"n\":null,\"big\":9223372036854775807}");
+	assertNext(parser, JSONPullParser::TOKEN_START_OBJECT);
+	assertNextMember(parser, "s");
+	assertNext(parser, JSONPullParser::TOKEN_STRING);
+	cppcut_assert_equal(string("foo"), parser.getString());
+	assertNextMember(parser, "i");
+	assertNext(parser, JSONPullParser::TOKEN_INT64);
+	cppcut_assert_equal((int64_t)-123, parser.getInt64());
+	assertNextMember(parser, "d");
+	assertNext(parser, JSONPullParser::TOKEN_DOUBLE);
+	cppcut_assert_equal(150.0, parser.getDouble());
+	assertNextMember(parser, "t");
+	assertNext(parser, JSONPullParser::TOKEN_TRUE);
+	assertNextMember(parser, "f");
+	assertNext(parser, JSONPullParser::TOKEN_FALSE);
+	assertNextMember(parser, "n");
+	assertNext(parser, JSONPullParser::TOKEN_NULL);
+	assertNextMember(parser, "big");
+	assertNext(parser, JSONPullParser::TOKEN_INT64);
+	cppcut_assert_equal(INT64_MAX, parser.getInt64());
+	assertNext(parser, JSONPullParser::TOKEN_END_OBJECT);
+	assertNext(parser, JSONPullParser::TOKEN_END);
+}
+
+void test_nestedArray(void)
+{
+	JSONPullParser parser("[1, [], [2, {\"a\": [3]}]]");
+	assertNext(parser, JSONPullParser::TOKEN_START_ARRAY);
+	assertNext(parser, JSONPullParser::TOKEN_INT64);
+	assertNext(parser, JSONPullParser::TOKEN_START_ARRAY);
+	assertNext(parser, JSONPullParser::TOKEN_END_ARRAY);
+	assertNext(parser, JSONPullParser::TOKEN_START_ARRAY);
+	cppcut_assert_equal((size_t)2, parser.getDepth());
+	assertNext(parser, JSONPullParser::TOKEN_INT64);
+	cppcut_assert_equal((int64_t)2, parser.getInt64());
+	assertNext(parser, JSONPullParser::TOKEN_START_OBJECT);
+	assertNextMember(parser, "a");
+	assertNext(parser, JSONPullParser::TOKEN_START_ARRAY);
+	cppcut_assert_equal((size_t)4, parser.getDepth());
+	assertNext(parser, JSONPullParser::TOKEN_INT64);
+	assertNext(parser, JSONPullParser::TOKEN_END_ARRAY);
+	assertNext(parser, JSONPullParser::TOKEN_END_OBJECT);
+	assertNext(parser, JSONPullParser::TOKEN_END_ARRAY);
+	assertNext(parser, JSONPullParser::TOKEN_END_ARRAY);
+	assertNext(parser, JSONPullParser::TOKEN_END);
+}
+
+void test_escapedString(void)
+{
+	JSONPullParser parser(
+	  "[\"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t\\u0041\\u00e9\\u3042"
+	  "\\ud83d\\ude00\"]");
+	assertNext(parser, JSONPullParser::TOKEN_START_ARRAY);
+	assertNext(parser, JSONPullParser::TOKEN_STRING);
+	cppcut_assert_equal(
+	  string("a\"b\\c/d\b\f\n\r\tA\xc3\xa9\xe3\x81\x82\xf0\x9f\x98\x80"),
+	  parser.getString());
+}
+
+void test_skipChildren(void)
+{
+	const string json = "{\"skipped\":{\"a\":[1,{\"b\":2}]},\"next\":3}";
+	JSONPullParser parser(json);
+	assertNext(parser, JSONPullParser::TOKEN_START_OBJECT);
+	assertNextMember(parser, "skipped");
+	assertNext(parser, JSONPullParser::TOKEN_START_OBJECT);
+	const size_t begin = parser.getTokenOffset();
+	cppcut_assert_equal(true, parser.skipChildren());
+	cppcut_assert_equal(JSONPullParser::TOKEN_END_OBJECT,
+	                    parser.getTokenType());
+	cppcut_assert_equal(string("{\"a\":[1,{\"b\":2}]}"),
+	                    json.substr(begin, parser.getOffset() - begin));
+	assertNextMember(parser, "next");
+	assertNext(parser, JSONPullParser::TOKEN_INT64);
+	cppcut_assert_equal((int64_t)3, parser.getInt64());
+}
+
+void test_skipChildrenOfScalar(void)
+{
+	JSONPullParser parser("[1,2]");
+	assertNext(parser, JSONPullParser::TOKEN_START_ARRAY);
+	assertNext(parser, JSONPullParser::TOKEN_INT64);
+	cppcut_assert_equal(true, parser.skipChildren());
+	assertNext(parser, JSONPullParser::TOKEN_INT64);
+	cppcut_assert_equal((int64_t)2, parser.getInt64());
+}
+
+void data_invalidJSON(void)
+{
+	gcut_add_datum("Empty", "json", G_TYPE_STRING, "", NULL);
+	gcut_add_datum("Unclosed object",
+	               "json", G_TYPE_STRING, "{\"a\":1", NULL);
+	gcut_add_datum("Unclosed string",
+	               "json", G_TYPE_STRING, "[\"abc]", NULL);
+	gcut_add_datum("Trailing comma in an array",
+	               "json", G_TYPE_STRING, "[1,]", NULL);
+	gcut_add_datum("Trailing comma in an object",
+	               "json", G_TYPE_STRING, "{\"a\":1,}", NULL);
+	gcut_add_datum("Missing colon",
+	               "json", G_TYPE_STRING, "{\"a\" 1}", NULL);
+	gcut_add_datum("Missing comma",
+	               "json", G_TYPE_STRING, "[1 2]", NULL);
+	gcut_add_datum("Missing value",
+	               "json", G_TYPE_STRING, "{\"a\":}", NULL);
+	gcut_add_datum("Unquoted member",
+	               "json", G_TYPE_STRING, "{a:1}", NULL);
+	gcut_add_datum("Invalid literal",
+	               "json", G_TYPE_STRING, "[tru]", NULL);
+	gcut_add_datum("Invalid number",
+	               "json", G_TYPE_STRING, "[1.2.3]", NULL);
+	gcut_add_datum("Invalid escape",
+	               "json", G_TYPE_STRING, "[\"\\x\"]", NULL);
+	gcut_add_datum("Lone surrogate",
+	               "json", G_TYPE_STRING, "[\"\\ud83d\"]", NULL);
+	gcut_add_datum("Trailing data",
+	               "json", G_TYPE_STRING, "{} {}", NULL);
+}
+
+void test_invalidJSON(gconstpointer data)
+{
+	assertError(gcut_data_get_string(data, "json"));
+}
+
+} // namespace testJSONPullParser
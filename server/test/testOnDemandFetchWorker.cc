@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <cppcutter.h>
+#include <vector>
+#include <glib.h>
+#include "OnDemandFetchWorker.h"
+#include "DataStoreFake.h"
+#include "Helpers.h"
+using namespace std;
+
+namespace testOnDemandFetchWorker {
+
+struct CountClosure : public Closure0 {
+	size_t &count;
+
+	CountClosure(size_t &_count)
+	: count(_count)
+	{
+	}
+
+	virtual void operator()(void) override
+	{
+		count++;
+	}
+};
+
+class TestFetchWorker : public OnDemandFetchWorker {
+public:
+	struct StartedFetch {
+		ServerIdType      serverId;
+		LocalHostIdVector hostIds;
+		Closure0         *closure;
+	};
+
+	vector<StartedFetch> startedFetches;
+	bool                 fetchSupported;
+
+	TestFetchWorker(const time_t &cacheTTLSec)
+	: OnDemandFetchWorker(cacheTTLSec),
+	  fetchSupported(true)
+	{
+	}
+
+	virtual ~TestFetchWorker()
+	{
+		for (auto &fetch : startedFetches)
+			delete fetch.closure;
+	}
+
+	void complete(const size_t &index)
+	{
+		Closure0 *closure = startedFetches[index].closure;
+		startedFetches[index].closure = NULL;
+		(*closure)();
+		delete closure;
+	}
+
+protected:
+	virtual bool startFetch(DataStore &dataStore,
+	                        const LocalHostIdVector &hostIds,
+	                        Closure0 *closure) override
+	{
+		if (!fetchSupported)
+			return false;
+		ServerIdType serverId = dataStore.getMonitoringServerInfo().id;
+		startedFetches.push_back({serverId, hostIds, closure});
+		return true;
+	}
+};
+
+static DataStoreVector makeDataStores(const size_t &numServers)
+{
+	DataStoreVector dataStores;
+	for (size_t i = 0; i < numServers; i++) {
+		MonitoringServerInfo serverInfo;
+		initServerInfo(serverInfo);
+		serverInfo.id = i + 1;
+		dataStores.push_back(
+		  make_shared<DataStoreFake>(serverInfo, false));
+	}
+	return dataStores;
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_coalesceIdenticalRequests(void)
+{
+	DataStoreVector dataStores = makeDataStores(1);
+	TestFetchWorker worker(0);
+	size_t count = 0;
+	cppcut_assert_equal(true, worker.start(dataStores, 1, "10",
+	                                       new CountClosure(count)));
+	cppcut_assert_equal(true, worker.start(dataStores, 1, "10",
+	                                       new CountClosure(count)));
+	cppcut_assert_equal((size_t)1, worker.startedFetches.size());
+	cppcut_assert_equal(true,
+	  LocalHostIdVector{"10"} == worker.startedFetches[0].hostIds);
+
+	worker.complete(0);
+	cppcut_assert_equal((size_t)2, count);
+
+	OnDemandFetchWorker::Statistics stat;
+	worker.getStatistics(stat);
+	cppcut_assert_equal((uint64_t)2, stat.numRequests);
+	cppcut_assert_equal((uint64_t)1, stat.numCoalescedRequests);
+	cppcut_assert_equal((uint64_t)1, stat.numStartedFetches);
+}
+
+void test_fetchDifferentHostsSeparately(void)
+{
+	DataStoreVector dataStores = makeDataStores(1);
+	TestFetchWorker worker(0);
+	cppcut_assert_equal(true, worker.start(dataStores, 1, "10"));
+	cppcut_assert_equal(true, worker.start(dataStores, 1, "11"));
+	cppcut_assert_equal((size_t)2, worker.startedFetches.size());
+}
+
+void test_allHostsFetchSatisfiesHostRequest(void)
+{
+	DataStoreVector dataStores = makeDataStores(1);
+	TestFetchWorker worker(0);
+	size_t count = 0;
+	cppcut_assert_equal(true, worker.start(dataStores, ALL_SERVERS,
+	                                       ALL_LOCAL_HOSTS));
+	cppcut_assert_equal(true, worker.start(dataStores, 1, "10",
+	                                       new CountClosure(count)));
+	cppcut_assert_equal((size_t)1, worker.startedFetches.size());
+	cppcut_assert_equal(true, worker.startedFetches[0].hostIds.empty());
+
+	worker.complete(0);
+	cppcut_assert_equal((size_t)1, count);
+}
+
+void test_reuseCompletedFetch(void)
+{
+	DataStoreVector dataStores = makeDataStores(1);
+	TestFetchWorker worker(60);
+	cppcut_assert_equal(true, worker.start(dataStores, 1, "10"));
+	worker.complete(0);
+
+	cppcut_assert_equal(false, worker.start(dataStores, 1, "10"));
+	cppcut_assert_equal((size_t)1, worker.startedFetches.size());
+
+	OnDemandFetchWorker::Statistics stat;
+	worker.getStatistics(stat);
+	cppcut_assert_equal((uint64_t)1, stat.numCacheHits);
+}
+
+void test_noReuseWithZeroTTL(void)
+{
+	DataStoreVector dataStores = makeDataStores(1);
+	TestFetchWorker worker(0);
+	cppcut_assert_equal(true, worker.start(dataStores, 1, "10"));
+	worker.complete(0);
+
+	cppcut_assert_equal(true, worker.start(dataStores, 1, "10"));
+	cppcut_assert_equal((size_t)2, worker.startedFetches.size());
+}
+
+void test_queueFetchesOverLimit(void)
+{
+	DataStoreVector dataStores = makeDataStores(3);
+	TestFetchWorker worker(0);
+	worker.setMaxRunningFetchers(2);
+	size_t count = 0;
+	cppcut_assert_equal(true, worker.start(dataStores, ALL_SERVERS,
+	                                       ALL_LOCAL_HOSTS,
+	                                       new CountClosure(count)));
+	cppcut_assert_equal((size_t)2, worker.startedFetches.size());
+
+	worker.complete(0);
+	cppcut_assert_equal((size_t)3, worker.startedFetches.size());
+	cppcut_assert_equal((ServerIdType)3,
+	                    worker.startedFetches[2].serverId);
+	worker.complete(1);
+	cppcut_assert_equal((size_t)0, count);
+	worker.complete(2);
+	cppcut_assert_equal((size_t)1, count);
+}
+
+void test_startWithUnsupportedFetch(void)
+{
+	DataStoreVector dataStores = makeDataStores(2);
+	TestFetchWorker worker(60);
+	worker.fetchSupported = false;
+	cppcut_assert_equal(false, worker.start(dataStores, ALL_SERVERS,
+	                                        ALL_LOCAL_HOSTS));
+
+	// A failed start isn't reused.
+	worker.fetchSupported = true;
+	cppcut_assert_equal(true, worker.start(dataStores, ALL_SERVERS,
+	                                       ALL_LOCAL_HOSTS));
+	cppcut_assert_equal((size_t)2, worker.startedFetches.size());
+}
+
+void test_expireRunningFetch(void)
+{
+	DataStoreVector dataStores = makeDataStores(2);
+	TestFetchWorker worker(0);
+	worker.setMaxRunningFetchers(1);
+	worker.setFetchTimeout(10);
+	size_t count = 0;
+	cppcut_assert_equal(true, worker.start(dataStores, ALL_SERVERS,
+	                                       ALL_LOCAL_HOSTS,
+	                                       new CountClosure(count)));
+	cppcut_assert_equal((size_t)1, worker.startedFetches.size());
+
+	// The first fetch expires and the queued one starts.
+	while (worker.startedFetches.size() < 2)
+		g_main_context_iteration(NULL, TRUE);
+	cppcut_assert_equal((ServerIdType)2,
+	                    worker.startedFetches[1].serverId);
+	cppcut_assert_equal((size_t)0, count);
+
+	// A completion after the time-out is ignored.
+	worker.complete(0);
+	cppcut_assert_equal((size_t)0, count);
+
+	worker.complete(1);
+	cppcut_assert_equal((size_t)1, count);
+
+	OnDemandFetchWorker::Statistics stat;
+	worker.getStatistics(stat);
+	cppcut_assert_equal((uint64_t)2, stat.numStartedFetches);
+	cppcut_assert_equal((uint64_t)1, stat.numTimedOutFetches);
+}
+
+} // namespace testOnDemandFetchWorker
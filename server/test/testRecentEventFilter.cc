@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <cppcutter.h>
+#include "RecentEventFilter.h"
+using namespace std;
+
+namespace testRecentEventFilter {
+
+static EventInfo makeEvent(const string &eventId,
+                           const string &brief = "brief")
+{
+	EventInfo eventInfo;
+	initEventInfo(eventInfo);
+	eventInfo.serverId = 1;
+	eventInfo.id = eventId;
+	eventInfo.brief = brief;
+	return eventInfo;
+}
+
+static string getEventIds(const EventInfoList &eventInfoList)
+{
+	string eventIds;
+	for (auto &eventInfo : eventInfoList)
+		eventIds += eventInfo.id + ",";
+	return eventIds;
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_passNewEvents(void)
+{
+	RecentEventFilter filter;
+	EventInfoList eventInfoList = {makeEvent("1"), makeEvent("2")};
+	cppcut_assert_equal((size_t)0, filter.filter(eventInfoList));
+	cppcut_assert_equal(string("1,2,"), getEventIds(eventInfoList));
+}
+
+void test_dropRememberedEvents(void)
+{
+	RecentEventFilter filter;
+	filter.remember({makeEvent("1"), makeEvent("2")});
+	EventInfoList eventInfoList = {makeEvent("2"), makeEvent("3")};
+	cppcut_assert_equal((size_t)1, filter.filter(eventInfoList));
+	cppcut_assert_equal(string("3,"), getEventIds(eventInfoList));
+
+	RecentEventFilter::Statistics stat;
+	filter.getStatistics(stat);
+	cppcut_assert_equal((uint64_t)1, stat.numPassedEvents);
+	cppcut_assert_equal((uint64_t)1, stat.numDroppedEvents);
+}
+
+void test_dropDuplicatesInList(void)
+{
+	RecentEventFilter filter;
+	EventInfoList eventInfoList =
+	  {makeEvent("1"), makeEvent("2"), makeEvent("1")};
+	cppcut_assert_equal((size_t)1, filter.filter(eventInfoList));
+	cppcut_assert_equal(string("1,2,"), getEventIds(eventInfoList));
+}
+
+void test_passUpdatedEvent(void)
+{
+	RecentEventFilter filter;
+	filter.remember({makeEvent("1")});
+	EventInfoList eventInfoList = {makeEvent("1", "updated brief")};
+	cppcut_assert_equal((size_t)0, filter.filter(eventInfoList));
+	filter.remember(eventInfoList);
+
+	EventInfoList resentEventInfoList = {makeEvent("1", "updated brief")};
+	cppcut_assert_equal((size_t)1, filter.filter(resentEventInfoList));
+}
+
+static EventInfo makeEventWithTrigger(const string &eventId)
+{
+	EventInfo eventInfo = makeEvent(eventId, "");
+	eventInfo.triggerId = "10";
+	return eventInfo;
+}
+
+// The empty members are filled with the ones of the trigger when the
+// event is stored.
+static void mergeTrigger(EventInfo &eventInfo)
+{
+	eventInfo.severity = TRIGGER_SEVERITY_WARNING;
+	eventInfo.brief = "trigger brief";
+	eventInfo.extendedInfo = "trigger extended info";
+}
+
+void test_rememberKeysGotBeforeStoring(void)
+{
+	RecentEventFilter filter;
+	EventInfoList eventInfoList = {makeEventWithTrigger("1")};
+	RecentEventFilter::EventKeyVect passedEventKeys;
+	cppcut_assert_equal((size_t)0,
+	                    filter.filter(eventInfoList, passedEventKeys));
+	cppcut_assert_equal((size_t)1, passedEventKeys.size());
+	mergeTrigger(eventInfoList.front());
+	filter.remember(passedEventKeys);
+
+	EventInfoList resentEventInfoList = {makeEventWithTrigger("1")};
+	cppcut_assert_equal((size_t)1, filter.filter(resentEventInfoList));
+}
+
+void test_dropResentEventMergedInDB(void)
+{
+	RecentEventFilter filter;
+	EventInfo storedEventInfo = makeEventWithTrigger("1");
+	mergeTrigger(storedEventInfo);
+	filter.rememberStored({storedEventInfo});
+
+	EventInfoList eventInfoList = {makeEventWithTrigger("1")};
+	cppcut_assert_equal((size_t)1, filter.filter(eventInfoList));
+}
+
+void test_passEventWithTriggerAndUpdatedBrief(void)
+{
+	RecentEventFilter filter;
+	EventInfoList eventInfoList = {makeEventWithTrigger("1")};
+	RecentEventFilter::EventKeyVect passedEventKeys;
+	filter.filter(eventInfoList, passedEventKeys);
+	filter.remember(passedEventKeys);
+
+	EventInfo updatedEventInfo = makeEventWithTrigger("1");
+	updatedEventInfo.brief = "updated brief";
+	EventInfoList updatedEventInfoList = {updatedEventInfo};
+	cppcut_assert_equal((size_t)0, filter.filter(updatedEventInfoList));
+}
+
+void test_passStoredEventWithUpdatedStatus(void)
+{
+	RecentEventFilter filter;
+	EventInfo storedEventInfo = makeEventWithTrigger("1");
+	mergeTrigger(storedEventInfo);
+	filter.rememberStored({storedEventInfo});
+
+	EventInfo updatedEventInfo = makeEventWithTrigger("1");
+	updatedEventInfo.status = TRIGGER_STATUS_PROBLEM;
+	EventInfoList eventInfoList = {updatedEventInfo};
+	cppcut_assert_equal((size_t)0, filter.filter(eventInfoList));
+}
+
+void test_passEventsWithoutId(void)
+{
+	RecentEventFilter filter;
+	filter.remember({makeEvent("")});
+	EventInfoList eventInfoList = {makeEvent(""), makeEvent("")};
+	cppcut_assert_equal((size_t)0, filter.filter(eventInfoList));
+	cppcut_assert_equal((size_t)0, filter.getNumberOfEvents());
+}
+
+void test_forgetOldestEvents(void)
+{
+	const size_t capacity = 10;
+	RecentEventFilter filter(capacity);
+	// The Bloom filter is rebuilt while the events are remembered.
+	for (size_t i = 0; i < capacity * 3; i++)
+		filter.remember({makeEvent(to_string(i))});
+	cppcut_assert_equal(capacity, filter.getNumberOfEvents());
+
+	EventInfoList eventInfoList = {
+	  makeEvent(to_string(capacity * 2 - 1)),
+	  makeEvent(to_string(capacity * 2)),
+	  makeEvent(to_string(capacity * 3 - 1)),
+	};
+	cppcut_assert_equal((size_t)2, filter.filter(eventInfoList));
+	cppcut_assert_equal(to_string(capacity * 2 - 1) + ",",
+	                    getEventIds(eventInfoList));
+}
+
+void test_globalStatistics(void)
+{
+	RecentEventFilter::Statistics before, after;
+	RecentEventFilter::getGlobalStatistics(before);
+	RecentEventFilter filter;
+	filter.remember({makeEvent("1")});
+	EventInfoList eventInfoList = {makeEvent("1"), makeEvent("2")};
+	filter.filter(eventInfoList);
+	RecentEventFilter::getGlobalStatistics(after);
+	cppcut_assert_equal(before.numPassedEvents + 1, after.numPassedEvents);
+	cppcut_assert_equal(before.numDroppedEvents + 1,
+	                    after.numDroppedEvents);
+}
+
+} // namespace testRecentEventFilter
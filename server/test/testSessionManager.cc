@@ -18,6 +18,7 @@
  */
 
 #include <string>
+#include <set>
 #include <cppcutter.h>
 #include <unistd.h>
 #include <errno.h>
@@ -124,7 +125,7 @@ void test_create(void)
 	const Session *session = sessionIdMap.begin()->second;
 	cppcut_assert_equal(userId, session->userId);
 	assertTimeIsNow(session->loginTime);
-	assertTimeIsNow(session->lastAccessTime);
+	assertTimeIsNow(session->getLastAccessTime());
 }
 
 void test_createWithoutTimeout(void)
@@ -136,30 +137,30 @@ void test_createWithoutTimeout(void)
 	SessionPtr sessionPtr = sessionMgr->getSession(sessionId);
 	cppcut_assert_equal(true, sessionPtr.hasData()); 
 	cppcut_assert_equal(SessionManager::NO_TIMEOUT, sessionPtr->timeout);
-	cppcut_assert_equal(INVALID_EVENT_ID, sessionPtr->timerId);
+	cppcut_assert_equal(false, sessionPtr->isTimerScheduled());
 }
 
 void test_timeout(void)
 {
-	const size_t timeout = 1; // 1ms.
+	const size_t timeout = 1; // 1sec.
 	const UserIdType userId = 103;
 	SessionManager *sessionMgr = SessionManager::getInstance();
 	string sessionId = sessionMgr->create(userId, timeout);
 	SessionPtr sessionPtr = sessionMgr->getSession(sessionId);
 	cppcut_assert_equal(true, sessionPtr.hasData()); 
 	cppcut_assert_equal(timeout, sessionPtr->timeout);
-	cppcut_assert_not_equal(INVALID_EVENT_ID, sessionPtr->timerId);
+	cppcut_assert_equal(true, sessionPtr->isTimerScheduled());
 
 	// wait for the session's timeout
 	struct : public Watcher
 	{
-		guint *timerId;
+		Session *session;
 		virtual bool watch(void)
 		{
-			return *timerId == INVALID_EVENT_ID;
+			return !session->isTimerScheduled();
 		}
 	} watcher;
-	watcher.timerId = &sessionPtr->timerId;
+	watcher.session = sessionPtr;
 
 	const size_t watcherTimeout = 5*1000; // 5sec
 	cppcut_assert_equal(true, watcher.start(watcherTimeout));
@@ -177,7 +178,7 @@ void test_getSession(void)
 		cppcut_assert_equal(true, session.hasData());
 		cppcut_assert_equal(userId, session->userId);
 		// 1st: added when it was created.
-		// 2nd: added in updateTimer().
+		// 2nd: added when it was scheduled to be expired.
 		// 3rd: added due to getSession().
 		cppcut_assert_equal(3, session->getUsedCount());
 	}
@@ -199,8 +200,7 @@ void test_update(void)
 	SessionPtr sessionPtr = sessionMgr->getSession(sessionId);
 	cppcut_assert_equal(true, sessionPtr.hasData()); 
 
-	SmartTime prevAccessTime = sessionPtr->lastAccessTime;
-	guint     prevTimerId    = sessionPtr->timerId;
+	SmartTime prevAccessTime = sessionPtr->getLastAccessTime();
 
 	// call getSession a short time later
 	const int sleepTimeMSec = 1;
@@ -209,10 +209,10 @@ void test_update(void)
 	cppcut_assert_equal(true, sessionPtr.hasData()); 
 
 	// check
-	SmartTime diffAccessTime = sessionPtr->lastAccessTime;
+	SmartTime diffAccessTime = sessionPtr->getLastAccessTime();
 	diffAccessTime -= prevAccessTime;
 	cppcut_assert_equal(true, diffAccessTime.getAsMSec() > sleepTimeMSec);
-	cppcut_assert_not_equal(prevTimerId, sessionPtr->timerId);
+	cppcut_assert_equal(true, sessionPtr->isTimerScheduled());
 
 	const SessionIdMap &sessionIdMap = safeGetSessionIdMap(sessionMgr);
 	cppcut_assert_equal((size_t)1, sessionIdMap.size());
@@ -276,14 +276,49 @@ void test_sessionCancelTimer(void)
 	const UserIdType userId = 103;
 	const string sessionId = sessionMgr->create(userId);
 	SessionPtr sessionPtr = sessionMgr->getSession(sessionId);
-	guint origTimerId = sessionPtr->timerId;
-	cppcut_assert_not_equal(INVALID_EVENT_ID, sessionPtr->timerId);
+	cppcut_assert_equal(true, sessionPtr->isTimerScheduled());
+	cppcut_assert_equal(3, sessionPtr->getUsedCount());
 	sessionPtr->cancelTimer();
-	cppcut_assert_equal(INVALID_EVENT_ID, sessionPtr->timerId);
+	cppcut_assert_equal(false, sessionPtr->isTimerScheduled());
+	cppcut_assert_equal(2, sessionPtr->getUsedCount());
 
-	// This test will show a GLib-CRITICAL message, since the same source
-	// is removed again.
-	cppcut_assert_equal(false, Utils::removeGSourceIfNeeded(origTimerId));
+	// Cancel again: nothing happens.
+	sessionPtr->cancelTimer();
+	cppcut_assert_equal(2, sessionPtr->getUsedCount());
+}
+
+void test_sessionsAreSpreadOverShards(void)
+{
+	SessionManager *sessionMgr = SessionManager::getInstance();
+	const UserIdType userId = 103;
+	const size_t numSessions = 100;
+	set<string> sessionIds;
+	for (size_t i = 0; i < numSessions; i++)
+		sessionIds.insert(sessionMgr->create(userId));
+
+	for (auto &sessionId : sessionIds) {
+		SessionPtr sessionPtr = sessionMgr->getSession(sessionId);
+		cppcut_assert_equal(true, sessionPtr.hasData());
+		cppcut_assert_equal(sessionId, sessionPtr->id);
+	}
+
+	const SessionIdMap &sessionIdMap = safeGetSessionIdMap(sessionMgr);
+	cppcut_assert_equal(numSessions, sessionIdMap.size());
+	for (auto &pair : sessionIdMap)
+		cppcut_assert_equal(1, (int)sessionIds.count(pair.first));
+}
+
+void test_removeDuringTimerScheduled(void)
+{
+	SessionManager *sessionMgr = SessionManager::getInstance();
+	const UserIdType userId = 103;
+	const string sessionId = sessionMgr->create(userId);
+	SessionPtr sessionPtr = sessionMgr->getSession(sessionId);
+	cppcut_assert_equal(true, sessionPtr->isTimerScheduled());
+	cppcut_assert_equal(true, sessionMgr->remove(sessionId));
+	cppcut_assert_equal(false, sessionPtr->isTimerScheduled());
+	// Only sessionPtr has the reference.
+	cppcut_assert_equal(1, sessionPtr->getUsedCount());
 }
 
 } // namespace testSessionManager
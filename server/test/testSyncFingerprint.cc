@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2015 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <cppcutter.h>
+#include "SyncFingerprint.h"
+using namespace std;
+
+namespace testSyncFingerprint {
+
+static ServerHostDef makeHost(const string &hostIdInServer,
+                              const string &name)
+{
+	ServerHostDef svHostDef;
+	svHostDef.id = AUTO_INCREMENT_VALUE;
+	svHostDef.hostId = AUTO_ASSIGNED_ID;
+	svHostDef.serverId = 1;
+	svHostDef.hostIdInServer = hostIdInServer;
+	svHostDef.name = name;
+	svHostDef.status = HOST_STAT_NORMAL;
+	return svHostDef;
+}
+
+static string calcFingerprint(const ServerHostDefVect &svHostDefs)
+{
+	SyncFingerprint fingerprint;
+	fingerprint.addAll(svHostDefs);
+	return fingerprint.toString();
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_empty(void)
+{
+	SyncFingerprint fingerprint;
+	cppcut_assert_equal((size_t)0, fingerprint.getNumberOfElements());
+	cppcut_assert_equal((size_t)16, fingerprint.toString().size());
+	cppcut_assert_not_equal(fingerprint.toString(),
+	                        calcFingerprint({makeHost("1", "a")}));
+}
+
+void test_sameElements(void)
+{
+	cppcut_assert_equal(
+	  calcFingerprint({makeHost("1", "a"), makeHost("2", "b")}),
+	  calcFingerprint({makeHost("1", "a"), makeHost("2", "b")}));
+}
+
+void test_orderIndependent(void)
+{
+	cppcut_assert_equal(
+	  calcFingerprint({makeHost("1", "a"), makeHost("2", "b")}),
+	  calcFingerprint({makeHost("2", "b"), makeHost("1", "a")}));
+}
+
+void test_changedName(void)
+{
+	cppcut_assert_not_equal(
+	  calcFingerprint({makeHost("1", "a"), makeHost("2", "b")}),
+	  calcFingerprint({makeHost("1", "a"), makeHost("2", "c")}));
+}
+
+void test_movedCharacter(void)
+{
+	// Each string is hashed with its length.
+	cppcut_assert_not_equal(calcFingerprint({makeHost("1", "ab")}),
+	                        calcFingerprint({makeHost("1a", "b")}));
+}
+
+void test_duplicatedElement(void)
+{
+	cppcut_assert_not_equal(
+	  calcFingerprint({makeHost("1", "a")}),
+	  calcFingerprint({makeHost("1", "a"), makeHost("1", "a")}));
+}
+
+void test_differentElementTypes(void)
+{
+	Hostgroup hostgroup;
+	hostgroup.id = AUTO_INCREMENT_VALUE;
+	hostgroup.serverId = 1;
+	hostgroup.idInServer = "1";
+	hostgroup.name = "a";
+	SyncFingerprint fingerprint;
+	fingerprint.add(hostgroup);
+	cppcut_assert_not_equal(fingerprint.toString(),
+	                        calcFingerprint({makeHost("1", "a")}));
+}
+
+void test_triggerStatus(void)
+{
+	TriggerInfo triggerInfo;
+	triggerInfo.serverId = 1;
+	triggerInfo.id = "1";
+	triggerInfo.status = TRIGGER_STATUS_OK;
+	triggerInfo.severity = TRIGGER_SEVERITY_INFO;
+	triggerInfo.lastChangeTime = {0, 0};
+	triggerInfo.globalHostId = 10;
+	triggerInfo.hostIdInServer = "1";
+	triggerInfo.hostName = "a";
+	triggerInfo.brief = "brief";
+	triggerInfo.validity = TRIGGER_VALID;
+
+	SyncFingerprint ok, problem;
+	ok.add(triggerInfo);
+	triggerInfo.status = TRIGGER_STATUS_PROBLEM;
+	problem.add(triggerInfo);
+	cppcut_assert_not_equal(ok.getValue(), problem.getValue());
+}
+
+} // namespace testSyncFingerprint
@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2014 Project Hatohol
+ *
+ * This file is part of Hatohol.
+ *
+ * Hatohol is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License, version 3
+ * as published by the Free Software Foundation.
+ *
+ * Hatohol is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Hatohol. If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include <cppcutter.h>
+#include "TriggerStateIndex.h"
+
+using namespace std;
+
+namespace testTriggerStateIndex {
+
+static TriggerInfo makeTrigger(
+  const ServerIdType &serverId, const TriggerIdType &id,
+  const LocalHostIdType &hostIdInServer,
+  const TriggerStatusType &status, const TriggerSeverityType &severity,
+  const TriggerValidity &validity = TRIGGER_VALID)
+{
+	TriggerInfo triggerInfo;
+	triggerInfo.serverId       = serverId;
+	triggerInfo.id             = id;
+	triggerInfo.status         = status;
+	triggerInfo.severity       = severity;
+	triggerInfo.hostIdInServer = hostIdInServer;
+	triggerInfo.validity       = validity;
+	return triggerInfo;
+}
+
+static TriggerInfoList sourceTriggers;
+static size_t numLoaded;
+
+static void loader(const ServerIdType &serverId,
+                   TriggerInfoList &triggerInfoList)
+{
+	numLoaded++;
+	for (const auto &triggerInfo : sourceTriggers) {
+		if (triggerInfo.serverId == serverId)
+			triggerInfoList.push_back(triggerInfo);
+	}
+}
+
+static const ServerIdSet SERVER1 = {1};
+
+void cut_setup(void)
+{
+	numLoaded = 0;
+	sourceTriggers = {
+	  makeTrigger(1, "1", "h1", TRIGGER_STATUS_PROBLEM,
+	              TRIGGER_SEVERITY_CRITICAL),
+	  makeTrigger(1, "2", "h1", TRIGGER_STATUS_OK,
+	              TRIGGER_SEVERITY_CRITICAL),
+	  makeTrigger(1, "3", "h2", TRIGGER_STATUS_PROBLEM,
+	              TRIGGER_SEVERITY_WARNING),
+	  makeTrigger(1, "4", "h3", TRIGGER_STATUS_PROBLEM,
+	              TRIGGER_SEVERITY_WARNING, TRIGGER_INVALID),
+	  makeTrigger(1, "5", "h4", TRIGGER_STATUS_OK,
+	              TRIGGER_SEVERITY_INFO,
+	              TRIGGER_VALID_SELF_MONITORING),
+	  makeTrigger(2, "1", "h1", TRIGGER_STATUS_PROBLEM,
+	              TRIGGER_SEVERITY_EMERGENCY),
+	};
+}
+
+// ---------------------------------------------------------------------------
+// Test cases
+// ---------------------------------------------------------------------------
+void test_loadOnDemand(void)
+{
+	TriggerStateIndex index;
+	cppcut_assert_equal(static_cast<size_t>(0), numLoaded);
+	cppcut_assert_equal(
+	  static_cast<size_t>(5),
+	  index.getNumberOfTriggers(SERVER1, NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(static_cast<size_t>(1), numLoaded);
+	cppcut_assert_equal(
+	  static_cast<size_t>(5),
+	  index.getNumberOfTriggers(SERVER1, NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(static_cast<size_t>(1), numLoaded);
+}
+
+void test_getNumberOfTriggersOfMultipleServers(void)
+{
+	TriggerStateIndex index;
+	cppcut_assert_equal(
+	  static_cast<size_t>(6),
+	  index.getNumberOfTriggers({1, 2}, NO_EXCLUDE_HOST, loader));
+}
+
+void test_getNumberOfTriggersWithExcludeFlags(void)
+{
+	TriggerStateIndex index;
+	cppcut_assert_equal(
+	  static_cast<size_t>(4),
+	  index.getNumberOfTriggers(SERVER1, EXCLUDE_INVALID_HOST, loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(4),
+	  index.getNumberOfTriggers(SERVER1, EXCLUDE_SELF_MONITORING,
+	                            loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(3),
+	  index.getNumberOfTriggers(
+	    SERVER1, EXCLUDE_INVALID_HOST|EXCLUDE_SELF_MONITORING, loader));
+}
+
+void test_getNumberOfBadTriggers(void)
+{
+	TriggerStateIndex index;
+	cppcut_assert_equal(
+	  static_cast<size_t>(3),
+	  index.getNumberOfBadTriggers(SERVER1, TRIGGER_SEVERITY_ALL,
+	                               NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(2),
+	  index.getNumberOfBadTriggers(SERVER1, TRIGGER_SEVERITY_WARNING,
+	                               NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(1),
+	  index.getNumberOfBadTriggers(SERVER1, TRIGGER_SEVERITY_WARNING,
+	                               EXCLUDE_INVALID_HOST, loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(0),
+	  index.getNumberOfBadTriggers(SERVER1, TRIGGER_SEVERITY_INFO,
+	                               NO_EXCLUDE_HOST, loader));
+}
+
+void test_getNumberOfHosts(void)
+{
+	TriggerStateIndex index;
+	cppcut_assert_equal(
+	  static_cast<size_t>(4),
+	  index.getNumberOfHosts(SERVER1, NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(2),
+	  index.getNumberOfHosts(
+	    SERVER1, EXCLUDE_INVALID_HOST|EXCLUDE_SELF_MONITORING, loader));
+}
+
+void test_getNumberOfBadHosts(void)
+{
+	TriggerStateIndex index;
+	cppcut_assert_equal(
+	  static_cast<size_t>(3),
+	  index.getNumberOfBadHosts(SERVER1, NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(2),
+	  index.getNumberOfBadHosts(SERVER1, EXCLUDE_INVALID_HOST, loader));
+}
+
+void test_update(void)
+{
+	TriggerStateIndex index;
+	index.getNumberOfTriggers(SERVER1, NO_EXCLUDE_HOST, loader);
+
+	// Recover the trigger of h1 and add a new one to h5.
+	index.update({
+	  makeTrigger(1, "1", "h1", TRIGGER_STATUS_OK,
+	              TRIGGER_SEVERITY_CRITICAL),
+	  makeTrigger(1, "6", "h5", TRIGGER_STATUS_PROBLEM,
+	              TRIGGER_SEVERITY_CRITICAL),
+	});
+	cppcut_assert_equal(
+	  static_cast<size_t>(6),
+	  index.getNumberOfTriggers(SERVER1, NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(1),
+	  index.getNumberOfBadTriggers(SERVER1, TRIGGER_SEVERITY_CRITICAL,
+	                               NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(5),
+	  index.getNumberOfHosts(SERVER1, NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(3),
+	  index.getNumberOfBadHosts(SERVER1, NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(static_cast<size_t>(1), numLoaded);
+}
+
+void test_updateChangesHost(void)
+{
+	TriggerStateIndex index;
+	index.getNumberOfTriggers(SERVER1, NO_EXCLUDE_HOST, loader);
+
+	index.update(makeTrigger(1, "3", "h1", TRIGGER_STATUS_PROBLEM,
+	                         TRIGGER_SEVERITY_WARNING));
+	cppcut_assert_equal(
+	  static_cast<size_t>(3),
+	  index.getNumberOfHosts(SERVER1, NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(2),
+	  index.getNumberOfBadHosts(SERVER1, NO_EXCLUDE_HOST, loader));
+}
+
+void test_updateIgnoresNotLoadedServer(void)
+{
+	TriggerStateIndex index;
+	index.update(makeTrigger(1, "6", "h5", TRIGGER_STATUS_PROBLEM,
+	                         TRIGGER_SEVERITY_CRITICAL));
+	cppcut_assert_equal(
+	  static_cast<size_t>(5),
+	  index.getNumberOfTriggers(SERVER1, NO_EXCLUDE_HOST, loader));
+}
+
+void test_remove(void)
+{
+	TriggerStateIndex index;
+	index.getNumberOfTriggers(SERVER1, NO_EXCLUDE_HOST, loader);
+
+	index.remove(1, {"1", "3", "no-such-trigger"});
+	cppcut_assert_equal(
+	  static_cast<size_t>(3),
+	  index.getNumberOfTriggers(SERVER1, NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(1),
+	  index.getNumberOfBadHosts(SERVER1, NO_EXCLUDE_HOST, loader));
+	cppcut_assert_equal(
+	  static_cast<size_t>(3),
+	  index.getNumberOfHosts(SERVER1, NO_EXCLUDE_HOST, loader));
+}
+
+void test_invalidate(void)
+{
+	TriggerStateIndex index;
+	index.getNumberOfTriggers(SERVER1, NO_EXCLUDE_HOST, loader);
+	index.invalidate(1);
+	index.getNumberOfTriggers(SERVER1, NO_EXCLUDE_HOST, loader);
+	cppcut_assert_equal(static_cast<size_t>(2), numLoaded);
+}
+
+void test_clear(void)
+{
+	TriggerStateIndex index;
+	index.getNumberOfTriggers({1, 2}, NO_EXCLUDE_HOST, loader);
+	index.clear();
+	index.getNumberOfTriggers({1, 2}, NO_EXCLUDE_HOST, loader);
+	cppcut_assert_equal(static_cast<size_t>(4), numLoaded);
+}
+
+} // namespace testTriggerStateIndex